@@ -67,6 +67,13 @@ Builder* Builder::Create(
     return CreateBuilderRecorder(context, UseBuilderRecorder == 1 /*wantReplay*/);
 }
 
+// =====================================================================================================================
+// Whether Create records the Builder calls and replays them in the patch phase
+bool Builder::IsRecordAndReplay()
+{
+    return (UseBuilderRecorder == 1);
+}
+
 // =====================================================================================================================
 // Create a BuilderImpl object
 Builder* Builder::CreateBuilderImpl(
@@ -172,6 +172,10 @@ public:
     // Create the BuilderImpl or BuilderRecorder, depending on -use-builder-recorder option
     static Builder* Create(LLVMContext& context);
 
+    // Whether Create records the Builder calls and replays them in the patch phase, depending on
+    // -use-builder-recorder option. Only then is the IR of the lowering phase independent of the target.
+    static bool IsRecordAndReplay();
+
     // If this is a BuilderRecorder, create the BuilderReplayer pass, otherwise return nullptr.
     virtual ModulePass* CreateBuilderReplayer() { return nullptr; }
 
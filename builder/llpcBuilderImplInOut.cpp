@@ -131,7 +131,7 @@ Value* BuilderImplInOut::ReadGenericInputOutput(
     MarkGenericInputOutputUsage(isOutput, location, locationCount, inOutInfo, pVertexIndex);
 
     // Generate LLPC call for reading the input/output.
-    StringRef baseCallName = LlpcName::InputImportGeneric;
+    const char* pBaseCallName = LlpcName::InputImportGeneric;
     SmallVector<Value*, 6> args;
     switch (m_shaderStage)
     {
@@ -155,7 +155,7 @@ Value* BuilderImplInOut::ReadGenericInputOutput(
             args.push_back((pVertexIndex != nullptr) ? pVertexIndex : getInt32(InvalidValue));
             if (isOutput)
             {
-                baseCallName = LlpcName::OutputImportGeneric;
+                pBaseCallName = LlpcName::OutputImportGeneric;
             }
             break;
         }
@@ -179,7 +179,7 @@ Value* BuilderImplInOut::ReadGenericInputOutput(
             {
                 // Prepare arguments for import interpolant call
                 Value* pAuxInterpValue = ModifyAuxInterpValue(pVertexIndex, inOutInfo);
-                baseCallName  = LlpcName::InputImportInterpolant;
+                pBaseCallName = LlpcName::InputImportInterpolant;
                 args.push_back(getInt32(location));
                 args.push_back(pLocationOffset);
                 args.push_back(pElemIdx);
@@ -202,14 +202,12 @@ Value* BuilderImplInOut::ReadGenericInputOutput(
         break;
     }
 
-    std::string callName = baseCallName;
-    AddTypeMangling(pResultTy, args, callName);
-    Value* pResult = EmitCall(GetInsertBlock()->getModule(),
-                              callName,
-                              pResultTy,
-                              args,
-                              Attribute::ReadOnly,
-                              &*GetInsertPoint());
+    Value* pResult = EmitMangledCall(GetInsertBlock()->getModule(),
+                                     pBaseCallName,
+                                     pResultTy,
+                                     args,
+                                     Attribute::ReadOnly,
+                                     &*GetInsertPoint());
 
     pResult->setName(instName);
     return pResult;
@@ -300,14 +298,12 @@ Instruction* BuilderImplInOut::CreateWriteGenericOutput(
     }
     args.push_back(pValueToWrite);
 
-    std::string llpcCallName = LlpcName::OutputExportGeneric;
-    AddTypeMangling(nullptr, args, llpcCallName);
-    return EmitCall(GetInsertBlock()->getModule(),
-                    llpcCallName,
-                    getVoidTy(),
-                    args,
-                    NoAttrib,
-                    &*GetInsertPoint());
+    return EmitMangledCall(GetInsertBlock()->getModule(),
+                           LlpcName::OutputExportGeneric,
+                           getVoidTy(),
+                           args,
+                           NoAttrib,
+                           &*GetInsertPoint());
 }
 
 // =====================================================================================================================
@@ -659,18 +655,16 @@ Instruction* BuilderImplInOut::CreateWriteXfbOutput(
 
     // XFB: @llpc.output.export.xfb.%Type%(i32 xfbBuffer, i32 xfbOffset, i32 xfbLocOffset, %Type% outputValue)
     SmallVector<Value*, 4> args;
-    std::string instName = LlpcName::OutputExportXfb;
     args.push_back(getInt32(xfbBuffer));
     args.push_back(pXfbOffset);
     args.push_back(getInt32(0));
     args.push_back(pValueToWrite);
-    AddTypeMangling(nullptr, args, instName);
-    return EmitCall(GetInsertBlock()->getParent()->getParent(),
-                    instName,
-                    getVoidTy(),
-                    args,
-                    NoAttrib,
-                    &*GetInsertPoint());
+    return EmitMangledCall(GetInsertBlock()->getParent()->getParent(),
+                           LlpcName::OutputExportXfb,
+                           getVoidTy(),
+                           args,
+                           NoAttrib,
+                           &*GetInsertPoint());
 }
 
 // =====================================================================================================================
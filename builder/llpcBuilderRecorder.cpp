@@ -39,257 +39,19 @@ using namespace Llpc;
 using namespace llvm;
 
 // =====================================================================================================================
-// Given an opcode, get the call name (without the "llpc.call." prefix)
-StringRef BuilderRecorder::GetCallName(
+// Given an opcode, get its static information
+const BuilderRecorder::OpcodeInfo& BuilderRecorder::GetOpcodeInfo(
     Opcode opcode)    // Opcode
 {
-    switch (opcode)
+    static const OpcodeInfo OpcodeInfos[] =
     {
-    case Opcode::Nop:
-        return "nop";
-    case Opcode::DotProduct:
-        return "dot.product";
-    case Opcode::CubeFaceCoord:
-        return "cube.face.coord";
-    case Opcode::CubeFaceIndex:
-        return "cube.face.index";
-    case Opcode::FpTruncWithRounding:
-        return "fp.trunc.with.rounding";
-    case Opcode::QuantizeToFp16:
-        return "quantize.to.fp16";
-    case Opcode::SMod:
-        return "smod";
-    case Opcode::FMod:
-        return "fmod";
-    case Opcode::Fma:
-        return "fma";
-    case Tan:
-        return "tan";
-    case ASin:
-        return "asin";
-    case ACos:
-        return "acos";
-    case ATan:
-        return "atan";
-    case ATan2:
-        return "atan2";
-    case Sinh:
-        return "sinh";
-    case Cosh:
-        return "cosh";
-    case Tanh:
-        return "tanh";
-    case ASinh:
-        return "asinh";
-    case ACosh:
-        return "acosh";
-    case ATanh:
-        return "atanh";
-    case Power:
-        return "power";
-    case Exp:
-        return "exp";
-    case Log:
-        return "log";
-    case InverseSqrt:
-        return "inverse.sqrt";
-    case SAbs:
-        return "sabs";
-    case FSign:
-        return "fsign";
-    case SSign:
-        return "ssign";
-    case Fract:
-        return "fract";
-    case SmoothStep:
-        return "smooth.step";
-    case Ldexp:
-        return "ldexp";
-    case ExtractSignificand:
-        return "extract.significand";
-    case ExtractExponent:
-        return "extract.exponent";
-    case CrossProduct:
-        return "cross.product";
-    case NormalizeVector:
-        return "normalize.vector";
-    case FaceForward:
-        return "face.forward";
-    case Reflect:
-        return "reflect";
-    case Refract:
-        return "refract";
-    case Opcode::FClamp:
-        return "fclamp";
-    case Opcode::FMin:
-        return "fmin";
-    case Opcode::FMax:
-        return "fmax";
-    case Opcode::FMin3:
-        return "fmin3";
-    case Opcode::FMax3:
-        return "fmax3";
-    case Opcode::FMid3:
-        return "fmid3";
-    case Opcode::IsInf:
-        return "isinf";
-    case Opcode::IsNaN:
-        return "isnan";
-    case Opcode::InsertBitField:
-        return "insert.bit.field";
-    case Opcode::ExtractBitField:
-        return "extract.bit.field";
-    case Opcode::FindSMsb:
-        return "find.smsb";
-    case Opcode::LoadBufferDesc:
-        return "load.buffer.desc";
-    case Opcode::IndexDescPtr:
-        return "index.desc.ptr";
-    case Opcode::LoadDescFromPtr:
-        return "load.desc.from.ptr";
-    case Opcode::GetSamplerDescPtr:
-        return "get.sampler.desc.ptr";
-    case Opcode::GetImageDescPtr:
-        return "get.image.desc.ptr";
-    case Opcode::GetTexelBufferDescPtr:
-        return "get.texel.buffer.desc.ptr";
-    case Opcode::GetFmaskDescPtr:
-        return "get.fmask.desc.ptr";
-    case Opcode::LoadPushConstantsPtr:
-        return "load.push.constants.ptr";
-    case Opcode::GetBufferDescLength:
-        return "get.buffer.desc.length";
-    case Opcode::ReadGenericInput:
-        return "read.generic.input";
-    case Opcode::ReadGenericOutput:
-        return "read.generic.output";
-    case Opcode::WriteGenericOutput:
-        return "write.generic.output";
-    case Opcode::WriteXfbOutput:
-        return "write.xfb.output";
-    case Opcode::ReadBuiltInInput:
-        return "read.builtin.input";
-    case Opcode::ReadBuiltInOutput:
-        return "read.builtin.output";
-    case Opcode::WriteBuiltInOutput:
-        return "write.builtin.output";
-    case Opcode::TransposeMatrix:
-        return "transpose.matrix";
-    case Opcode::MatrixTimesScalar:
-        return "matrix.times.scalar";
-    case Opcode::VectorTimesMatrix:
-        return "vector.times.matrix";
-    case Opcode::MatrixTimesVector:
-        return "matrix.times.vector";
-    case Opcode::MatrixTimesMatrix:
-        return "matrix.times.matrix";
-    case Opcode::OuterProduct:
-        return "outer.product";
-    case Opcode::Determinant:
-        return "determinant";
-    case Opcode::MatrixInverse:
-        return "matrix.inverse";
-    case Opcode::EmitVertex:
-        return "emit.vertex";
-    case Opcode::EndPrimitive:
-        return "end.primitive";
-    case Opcode::Barrier:
-        return "barrier";
-    case Opcode::Kill:
-        return "kill";
-    case Opcode::ReadClock:
-        return "read.clock";
-    case Opcode::Derivative:
-        return "derivative";
-    case Opcode::DemoteToHelperInvocation:
-        return "demote.to.helper.invocation";
-    case Opcode::IsHelperInvocation:
-        return "is.helper.invocation";
-    case Opcode::ImageLoad:
-        return "image.load";
-    case Opcode::ImageLoadWithFmask:
-        return "image.load.with.fmask";
-    case Opcode::ImageStore:
-        return "image.store";
-    case Opcode::ImageSample:
-        return "image.sample";
-    case Opcode::ImageGather:
-        return "image.gather";
-    case Opcode::ImageAtomic:
-        return "image.atomic";
-    case Opcode::ImageAtomicCompareSwap:
-        return "image.atomic.compare.swap";
-    case Opcode::ImageQueryLevels:
-        return "image.query.levels";
-    case Opcode::ImageQuerySamples:
-        return "image.query.samples";
-    case Opcode::ImageQuerySize:
-        return "image.query.size";
-    case Opcode::ImageGetLod:
-        return "image.get.lod";
-    case GetSubgroupSize:
-        return "get.subgroup.size";
-    case SubgroupElect:
-        return "subgroup.elect";
-    case SubgroupAll:
-        return "subgroup.all";
-    case SubgroupAny:
-        return "subgroup.any";
-    case SubgroupAllEqual:
-        return "subgroup.all.equal";
-    case SubgroupBroadcast:
-        return "subgroup.broadcast";
-    case SubgroupBroadcastFirst:
-        return "subgroup.broadcast.first";
-    case SubgroupBallot:
-        return "subgroup.ballot";
-    case SubgroupInverseBallot:
-        return "subgroup.inverse.ballot";
-    case SubgroupBallotBitExtract:
-        return "subgroup.ballot.bit.extract";
-    case SubgroupBallotBitCount:
-        return "subgroup.ballot.bit.count";
-    case SubgroupBallotInclusiveBitCount:
-        return "subgroup.ballot.inclusive.bit.count";
-    case SubgroupBallotExclusiveBitCount:
-        return "subgroup.ballot.exclusive.bit.count";
-    case SubgroupBallotFindLsb:
-        return "subgroup.ballot.find.lsb";
-    case SubgroupBallotFindMsb:
-        return "subgroup.ballot.find.msb";
-    case SubgroupShuffle:
-        return "subgroup.shuffle";
-    case SubgroupShuffleXor:
-        return "subgroup.shuffle.xor";
-    case SubgroupShuffleUp:
-        return "subgroup.shuffle.up";
-    case SubgroupShuffleDown:
-        return "subgroup.shuffle.down";
-    case SubgroupClusteredReduction:
-        return "subgroup.clustered.reduction";
-    case SubgroupClusteredInclusive:
-        return "subgroup.clustered.inclusive";
-    case SubgroupClusteredExclusive:
-        return "subgroup.clustered.exclusive";
-    case SubgroupQuadBroadcast:
-        return "subgroup.quad.broadcast";
-    case SubgroupQuadSwapHorizontal:
-        return "subgroup.quad.swap.horizontal";
-    case SubgroupQuadSwapVertical:
-        return "subgroup.quad.swap.vertical";
-    case SubgroupQuadSwapDiagonal:
-        return "subgroup.quad.swap.diagonal";
-    case SubgroupSwizzleQuad:
-        return "subgroup.swizzle.quad";
-    case SubgroupSwizzleMask:
-        return "subgroup.swizzle.mask";
-    case SubgroupWriteInvocation:
-        return "subgroup.write.invocation";
-    case SubgroupMbcnt:
-        return "subgroup.mbcnt";
-    }
-    LLPC_NEVER_CALLED();
-    return "";
+#define BUILDER_OPCODE(name, callName, minArgCount, maxArgCount) { callName, minArgCount, maxArgCount },
+#include "llpcBuilderRecorderOpcodes.def"
+    };
+    static_assert(sizeof(OpcodeInfos) / sizeof(OpcodeInfos[0]) == OpcodeCount, "Incomplete opcode table");
+
+    LLPC_ASSERT(opcode < OpcodeCount);
+    return OpcodeInfos[opcode];
 }
 
 // =====================================================================================================================
@@ -1899,6 +1661,10 @@ Instruction* BuilderRecorder::Record(
 #ifndef NDEBUG
     // In a debug build, check that each enclosing function is consistently in the same shader stage.
     CheckFuncShaderStage(GetInsertBlock()->getParent(), m_shaderStage);
+
+    // Check the recorded arguments against the opcode table.
+    const OpcodeInfo& opcodeInfo = GetOpcodeInfo(opcode);
+    LLPC_ASSERT((args.size() >= opcodeInfo.minArgCount) && (args.size() <= opcodeInfo.maxArgCount));
 #endif
 
     // Create mangled name of builder call. This only needs to be mangled on return type.
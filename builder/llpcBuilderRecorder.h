@@ -67,148 +67,25 @@ public:
     // llpc.call.* opcodes
     enum Opcode : uint32_t
     {
-        // NOP
-        Nop = 0,
-
-        // Base class
-        DotProduct,
-
-        // Arithmetic
-        CubeFaceCoord,
-        CubeFaceIndex,
-        FpTruncWithRounding,
-        QuantizeToFp16,
-        SMod,
-        FMod,
-        Fma,
-        Tan,
-        ASin,
-        ACos,
-        ATan,
-        ATan2,
-        Sinh,
-        Cosh,
-        Tanh,
-        ASinh,
-        ACosh,
-        ATanh,
-        Power,
-        Exp,
-        Log,
-        InverseSqrt,
-        SAbs,
-        FSign,
-        SSign,
-        Fract,
-        SmoothStep,
-        Ldexp,
-        ExtractSignificand,
-        ExtractExponent,
-        CrossProduct,
-        NormalizeVector,
-        FaceForward,
-        Reflect,
-        Refract,
-        FClamp,
-        FMin,
-        FMax,
-        FMin3,
-        FMax3,
-        FMid3,
-        IsInf,
-        IsNaN,
-        InsertBitField,
-        ExtractBitField,
-        FindSMsb,
-
-        // Descriptor
-        LoadBufferDesc,
-        IndexDescPtr,
-        LoadDescFromPtr,
-        GetSamplerDescPtr,
-        GetImageDescPtr,
-        GetTexelBufferDescPtr,
-        GetFmaskDescPtr,
-        LoadPushConstantsPtr,
-        GetBufferDescLength,
-
-        // Image
-        ImageLoad,
-        ImageLoadWithFmask,
-        ImageStore,
-        ImageSample,
-        ImageGather,
-        ImageAtomic,
-        ImageAtomicCompareSwap,
-        ImageQueryLevels,
-        ImageQuerySamples,
-        ImageQuerySize,
-        ImageGetLod,
-
-        // Input/output
-        ReadGenericInput,
-        ReadGenericOutput,
-        WriteGenericOutput,
-        WriteXfbOutput,
-        ReadBuiltInInput,
-        ReadBuiltInOutput,
-        WriteBuiltInOutput,
-
-        // Matrix
-        TransposeMatrix,
-        MatrixTimesScalar,
-        VectorTimesMatrix,
-        MatrixTimesVector,
-        MatrixTimesMatrix,
-        OuterProduct,
-        Determinant,
-        MatrixInverse,
-
-        // Misc.
-        EmitVertex,
-        EndPrimitive,
-        Barrier,
-        Kill,
-        ReadClock,
-        Derivative,
-        DemoteToHelperInvocation,
-        IsHelperInvocation,
-
-        // Subgroup
-        GetSubgroupSize,
-        SubgroupElect,
-        SubgroupAll,
-        SubgroupAny,
-        SubgroupAllEqual,
-        SubgroupBroadcast,
-        SubgroupBroadcastFirst,
-        SubgroupBallot,
-        SubgroupInverseBallot,
-        SubgroupBallotBitExtract,
-        SubgroupBallotBitCount,
-        SubgroupBallotInclusiveBitCount,
-        SubgroupBallotExclusiveBitCount,
-        SubgroupBallotFindLsb,
-        SubgroupBallotFindMsb,
-        SubgroupShuffle,
-        SubgroupShuffleXor,
-        SubgroupShuffleUp,
-        SubgroupShuffleDown,
-        SubgroupClusteredReduction,
-        SubgroupClusteredInclusive,
-        SubgroupClusteredExclusive,
-        SubgroupQuadBroadcast,
-        SubgroupQuadSwapHorizontal,
-        SubgroupQuadSwapVertical,
-        SubgroupQuadSwapDiagonal,
-        SubgroupSwizzleQuad,
-        SubgroupSwizzleMask,
-        SubgroupWriteInvocation,
-        SubgroupMbcnt,
+#define BUILDER_OPCODE(name, callName, minArgCount, maxArgCount) name,
+#include "llpcBuilderRecorderOpcodes.def"
+
+        OpcodeCount
     };
 
+    // Static information about an opcode, from llpcBuilderRecorderOpcodes.def
+    struct OpcodeInfo
+    {
+        const char* pCallName;      // Call name (without the "llpc.call." prefix)
+        uint32_t    minArgCount;    // Minimum count of recorded call arguments
+        uint32_t    maxArgCount;    // Maximum count of recorded call arguments
+    };
+
+    // Given an opcode, get its static information
+    static const OpcodeInfo& GetOpcodeInfo(Opcode opcode);
+
     // Given an opcode, get the call name (without the "llpc.call." prefix)
-    static StringRef GetCallName(Opcode opcode);
+    static StringRef GetCallName(Opcode opcode) { return GetOpcodeInfo(opcode).pCallName; }
 
     BuilderRecorder(LLVMContext& context, bool wantReplay)
         : Builder(context), BuilderRecorderMetadataKinds(context), m_wantReplay(wantReplay)
@@ -40,12 +40,18 @@
 using namespace Llpc;
 using namespace llvm;
 
-// User data nodes metadata name prefix
-static const char* const BuilderUserDataMetadataName = "llpc.user.data.nodes";
+// Pipeline state metadata name
+static const char* const PipelineStateMetadataName = "llpc.pipeline.state";
+
+// Version of the serialized pipeline state blob. Bump it whenever the blob layout changes.
+static const uint32_t PipelineStateBlobVersion = 1;
+
+// Size in dwords of an immutable descriptor. An immutable descriptor is always a sampler.
+static const uint32_t SamplerDescriptorSize = 4;
 
 // =====================================================================================================================
 // Set the resource mapping nodes for the pipeline.
-// The table entries are flattened and stored in IR metadata.
+// The table entries are flattened, and later serialized into IR metadata by RecordState.
 void PipelineState::SetUserDataNodes(
     ArrayRef<ResourceMappingNode>   nodes,            // The resource mapping nodes
     ArrayRef<DescriptorRangeValue>  rangeValues)      // The descriptor range values
@@ -155,244 +161,265 @@ void PipelineState::SetUserDataNodesTable(
 }
 
 // =====================================================================================================================
-// Record the pipeline state to IR metadata
+// Record the pipeline state to IR metadata. The whole state is serialized into a single binary blob held in one
+// MDString, so that we do not intern an MDNode (and a ConstantInt per immutable descriptor dword) for every user
+// data node in the LLVMContext.
 void PipelineState::RecordState(
     Module* pModule)    // [in/out] Module to record the IR metadata in
 {
-    RecordUserDataNodes(pModule);
+    SmallVector<uint32_t, 64> blob;
+    Serialize(blob);
+
+    auto pBlobMetaString = MDString::get(*m_pContext,
+                                         StringRef(reinterpret_cast<const char*>(blob.data()),
+                                                   blob.size() * sizeof(uint32_t)));
+    auto pStateMetaNode = pModule->getOrInsertNamedMetadata(PipelineStateMetadataName);
+    pStateMetaNode->clearOperands();
+    pStateMetaNode->addOperand(MDNode::get(*m_pContext, pBlobMetaString));
 }
 
 // =====================================================================================================================
-// Record user data nodes into IR metadata.
-void PipelineState::RecordUserDataNodes(
-    Module*   pModule)    // [in/out] Module to write IR metadata to
+// Set up the pipeline state from the specified linked IR module.
+void PipelineState::ReadStateFromModule(
+    Module* pModule)  // [in] Module
 {
-    auto pUserDataMetaNode = pModule->getOrInsertNamedMetadata(BuilderUserDataMetadataName);
-    RecordUserDataTable(m_userDataNodes, pUserDataMetaNode);
+    auto pStateMetaNode = pModule->getNamedMetadata(PipelineStateMetadataName);
+    if ((pStateMetaNode != nullptr) && (pStateMetaNode->getNumOperands() > 0))
+    {
+        auto pBlobMetaString = cast<MDString>(pStateMetaNode->getOperand(0)->getOperand(0));
+        bool success = Deserialize(pBlobMetaString->getString());
+        LLPC_ASSERT(success);
+        LLPC_UNUSED(success);
+    }
 }
 
 // =====================================================================================================================
-// Record one table of user data nodes into IR metadata, calling itself recursively for inner tables.
-void PipelineState::RecordUserDataTable(
-    ArrayRef<ResourceNode>  nodes,              // Table of user data nodes
-    NamedMDNode*            pUserDataMetaNode)  // IR metadata node to record them into
+// Serialize the pipeline state into a compact binary blob of dwords.
+//
+// The layout is:
+//   dword 0: PipelineStateBlobVersion
+//   dword 1: Total count of user data nodes, including those in inner tables
+//   dword 2: Count of user data nodes in the top-level table
+//   Then the top-level user data nodes (see SerializeUserDataTable).
+void PipelineState::Serialize(
+    SmallVectorImpl<uint32_t>& blob     // [out] Blob to append the serialized state to
+    ) const
 {
-    IRBuilder<> builder(*m_pContext);
+    uint32_t totalNodeCount = m_userDataNodes.size();
+    for (const ResourceNode& node : m_userDataNodes)
+    {
+        if (node.type == ResourceMappingNodeType::DescriptorTableVaPtr)
+        {
+            totalNodeCount += node.innerTable.size();
+        }
+    }
 
+    blob.push_back(PipelineStateBlobVersion);
+    blob.push_back(totalNodeCount);
+    blob.push_back(m_userDataNodes.size());
+    SerializeUserDataTable(m_userDataNodes, blob);
+}
+
+// =====================================================================================================================
+// Serialize one table of user data nodes, calling itself recursively for inner tables. Each node is:
+//   type, offsetInDwords, sizeInDwords, then
+//   - DescriptorTableVaPtr: inner node count, followed by the inner nodes
+//   - IndirectUserDataVaPtr/StreamOutTableVaPtr: indirectSizeInDwords
+//   - otherwise: set, binding, immutable descriptor count, then the dwords of each immutable descriptor
+void PipelineState::SerializeUserDataTable(
+    ArrayRef<ResourceNode>      nodes,  // Table of user data nodes
+    SmallVectorImpl<uint32_t>&  blob    // [out] Blob to append the serialized nodes to
+    ) const
+{
     for (const ResourceNode& node : nodes)
     {
-        SmallVector<Metadata*, 5> operands;
         LLPC_ASSERT(node.type < ResourceMappingNodeType::Count);
-        // Operand 0: type
-        operands.push_back(GetResourceTypeName(node.type));
-        // Operand 1: offsetInDwords
-        operands.push_back(ConstantAsMetadata::get(builder.getInt32(node.offsetInDwords)));
-        // Operand 2: sizeInDwords
-        operands.push_back(ConstantAsMetadata::get(builder.getInt32(node.sizeInDwords)));
+        blob.push_back(static_cast<uint32_t>(node.type));
+        blob.push_back(node.offsetInDwords);
+        blob.push_back(node.sizeInDwords);
 
         switch (node.type)
         {
         case ResourceMappingNodeType::DescriptorTableVaPtr:
             {
-                // Operand 3: Node count in sub-table.
-                operands.push_back(ConstantAsMetadata::get(builder.getInt32(node.innerTable.size())));
-                // Create the metadata node here.
-                pUserDataMetaNode->addOperand(MDNode::get(*m_pContext, operands));
-                // Create nodes for the sub-table.
-                RecordUserDataTable(node.innerTable, pUserDataMetaNode);
-                continue;
+                blob.push_back(node.innerTable.size());
+                SerializeUserDataTable(node.innerTable, blob);
+                break;
             }
         case ResourceMappingNodeType::IndirectUserDataVaPtr:
         case ResourceMappingNodeType::StreamOutTableVaPtr:
             {
-                // Operand 3: Size of the indirect data in dwords.
-                operands.push_back(ConstantAsMetadata::get(builder.getInt32(node.indirectSizeInDwords)));
+                blob.push_back(node.indirectSizeInDwords);
                 break;
             }
         default:
             {
-                // Operand 3: set
-                operands.push_back(ConstantAsMetadata::get(builder.getInt32(node.set)));
-                // Operand 4: binding
-                operands.push_back(ConstantAsMetadata::get(builder.getInt32(node.binding)));
+                blob.push_back(node.set);
+                blob.push_back(node.binding);
                 if (node.pImmutableValue != nullptr)
                 {
-                    // Operand 5 onwards: immutable descriptor constant.
-                    // Writing the constant array directly does not seem to work, as it does not survive IR linking.
-                    // Maybe it is a problem with the IR linker when metadata contains a non-ConstantData constant.
-                    // So we write the individual ConstantInts instead.
-                    // We can assume that the descriptor is <4 x i32> as an immutable descriptor is always a sampler.
-                    static const uint32_t SamplerDescriptorSize = 4;
+                    // The immutable value is an array of <4 x i32> sampler descriptors.
                     uint32_t elemCount = node.pImmutableValue->getType()->getArrayNumElements();
+                    blob.push_back(elemCount);
                     for (uint32_t elemIdx = 0; elemIdx != elemCount; ++elemIdx)
                     {
-                        Constant* pVectorValue = ConstantExpr::getExtractValue(node.pImmutableValue, elemIdx);
+                        Constant* pVectorValue = node.pImmutableValue->getAggregateElement(elemIdx);
                         for (uint32_t compIdx = 0; compIdx != SamplerDescriptorSize; ++compIdx)
                         {
-                            operands.push_back(ConstantAsMetadata::get(
-                                                      ConstantExpr::getExtractElement(pVectorValue,
-                                                                                      builder.getInt32(compIdx))));
+                            blob.push_back(
+                                cast<ConstantInt>(pVectorValue->getAggregateElement(compIdx))->getZExtValue());
                         }
                     }
                 }
+                else
+                {
+                    blob.push_back(0);
+                }
                 break;
             }
         }
-
-        // Create the metadata node.
-        pUserDataMetaNode->addOperand(MDNode::get(*m_pContext, operands));
     }
 }
 
 // =====================================================================================================================
-// Set up the pipeline state from the specified linked IR module.
-void PipelineState::ReadStateFromModule(
-    Module* pModule)  // [in] Module
+// Set up the pipeline state from a binary blob created by Serialize. Returns false if the blob is malformed.
+bool PipelineState::Deserialize(
+    StringRef blob)   // Serialized pipeline state
 {
-    ReadUserDataNodes(pModule);
-}
+    LLPC_ASSERT(m_allocUserDataNodes == nullptr);
 
-// =====================================================================================================================
-// Read user data nodes for the pipeline from IR metadata
-void PipelineState::ReadUserDataNodes(
-    Module* pModule)  // [in] Module
-{
-    LLPC_ASSERT(m_allocUserDataNodes.get() == nullptr);
+    // The blob might not be dword-aligned (e.g. when it lives in an MDString), so copy it out first.
+    if ((blob.size() % sizeof(uint32_t)) != 0)
+    {
+        return false;
+    }
+    SmallVector<uint32_t, 64> dwords(blob.size() / sizeof(uint32_t));
+    memcpy(dwords.data(), blob.data(), blob.size());
+
+    if ((dwords.size() < 3) || (dwords[0] != PipelineStateBlobVersion))
+    {
+        return false;
+    }
 
-    // Find the named metadata node.
-    auto pUserDataMetaNode = pModule->getNamedMetadata(BuilderUserDataMetadataName);
+    uint32_t totalNodeCount = dwords[1];
+    uint32_t topNodeCount = dwords[2];
+    if (topNodeCount > totalNodeCount)
+    {
+        return false;
+    }
 
-    // Prepare to read the resource nodes from the named MD node. We allocate a single buffer, with the
-    // outer table at the start, and inner tables allocated from the end backwards.
-    uint32_t totalNodeCount = pUserDataMetaNode->getNumOperands();
+    // We allocate a single buffer, with the outer table at the start, and inner tables allocated from the end
+    // backwards, the same as in SetUserDataNodes.
     m_allocUserDataNodes = std::make_unique<ResourceNode[]>(totalNodeCount);
+    ResourceNode* pDestTable = m_allocUserDataNodes.get();
+    ResourceNode* pDestInnerTable = pDestTable + totalNodeCount;
+
+    const uint32_t* pData = dwords.data() + 3;
+    bool success = DeserializeUserDataTable(pData,
+                                            dwords.data() + dwords.size(),
+                                            pDestTable,
+                                            topNodeCount,
+                                            pDestInnerTable);
+    success = success && (pDestInnerTable == pDestTable + topNodeCount);
+    if (success == false)
+    {
+        m_allocUserDataNodes = nullptr;
+        return false;
+    }
 
-    ResourceNode* pNextOuterNode = m_allocUserDataNodes.get();
-    ResourceNode* pNextNode = pNextOuterNode;
-    ResourceNode* pEndNextInnerTable = pNextOuterNode + totalNodeCount;
-    ResourceNode* pEndThisInnerTable = nullptr;
+    m_userDataNodes = ArrayRef<ResourceNode>(pDestTable, topNodeCount);
+    return true;
+}
 
-    // Read the nodes.
-    for (uint32_t nodeIndex = 0; nodeIndex < totalNodeCount; ++nodeIndex)
+// =====================================================================================================================
+// Deserialize one table of user data nodes, calling itself recursively for inner tables. Returns false if the blob
+// is malformed.
+bool PipelineState::DeserializeUserDataTable(
+    const uint32_t*&  pData,            // [in/out] Current read position in the blob
+    const uint32_t*   pDataEnd,         // [in] End of the blob
+    ResourceNode*     pDestTable,       // [out] Where to write nodes
+    uint32_t          nodeCount,        // Count of nodes in this table
+    ResourceNode*&    pDestInnerTable)  // [in/out] End of space available for inner tables
+{
+    for (uint32_t idx = 0; idx != nodeCount; ++idx)
     {
-        MDNode* pMetadataNode = pUserDataMetaNode->getOperand(nodeIndex);
-        // Operand 0: node type
-        pNextNode->type = GetResourceTypeFromName(cast<MDString>(pMetadataNode->getOperand(0)));
-        // Operand 1: offsetInDwords
-        pNextNode->offsetInDwords =
-              mdconst::dyn_extract<ConstantInt>(pMetadataNode->getOperand(1))->getZExtValue();
-        // Operand 2: sizeInDwords
-        pNextNode->sizeInDwords =
-              mdconst::dyn_extract<ConstantInt>(pMetadataNode->getOperand(2))->getZExtValue();
-
-        if (pNextNode->type == ResourceMappingNodeType::DescriptorTableVaPtr)
+        auto& destNode = pDestTable[idx];
+
+        if (pDataEnd - pData < 4)
         {
-            // Operand 3: number of nodes in inner table
-            uint32_t innerNodeCount =
-                  mdconst::dyn_extract<ConstantInt>(pMetadataNode->getOperand(3))->getZExtValue();
-            // Go into inner table.
-            LLPC_ASSERT(pEndThisInnerTable == nullptr);
-            pEndThisInnerTable = pEndNextInnerTable;
-            pEndNextInnerTable -= innerNodeCount;
-            pNextNode = pEndNextInnerTable;
-            pNextOuterNode->innerTable = ArrayRef<ResourceNode>(pNextNode, innerNodeCount);
-            ++pNextOuterNode;
+            return false;
         }
-        else
+        destNode.type = static_cast<ResourceMappingNodeType>(*pData++);
+        destNode.offsetInDwords = *pData++;
+        destNode.sizeInDwords = *pData++;
+
+        switch (destNode.type)
         {
-            if ((pNextNode->type == ResourceMappingNodeType::IndirectUserDataVaPtr) ||
-                (pNextNode->type == ResourceMappingNodeType::StreamOutTableVaPtr))
+        case ResourceMappingNodeType::DescriptorTableVaPtr:
             {
-                // Operand 3: Size of the indirect data in dwords
-                pNextNode->indirectSizeInDwords =
-                    mdconst::dyn_extract<ConstantInt>(pMetadataNode->getOperand(3))->getZExtValue();
+                uint32_t innerNodeCount = *pData++;
+                if (pDestInnerTable - innerNodeCount < pDestTable + nodeCount)
+                {
+                    return false;
+                }
+                pDestInnerTable -= innerNodeCount;
+                destNode.innerTable = ArrayRef<ResourceNode>(pDestInnerTable, innerNodeCount);
+                if (DeserializeUserDataTable(pData, pDataEnd, pDestInnerTable, innerNodeCount, pDestInnerTable) ==
+                    false)
+                {
+                    return false;
+                }
+                break;
+            }
+        case ResourceMappingNodeType::IndirectUserDataVaPtr:
+        case ResourceMappingNodeType::StreamOutTableVaPtr:
+            {
+                destNode.indirectSizeInDwords = *pData++;
+                break;
             }
-            else
+        default:
             {
-                // Operand 3: set
-                pNextNode->set =
-                    mdconst::dyn_extract<ConstantInt>(pMetadataNode->getOperand(3))->getZExtValue();
-                // Operand 4: binding
-                pNextNode->binding =
-                    mdconst::dyn_extract<ConstantInt>(pMetadataNode->getOperand(4))->getZExtValue();
-                pNextNode->pImmutableValue = nullptr;
-                if (pMetadataNode->getNumOperands() >= 6)
+                if (destNode.type >= ResourceMappingNodeType::Count)
                 {
-                    // Operand 5 onward: immutable descriptor constant
-                    static const uint32_t SamplerDescriptorSize = 4;
-                    static const uint32_t OperandStartIdx = 5;
+                    return false;
+                }
 
-                    uint32_t elemCount = (pMetadataNode->getNumOperands() - OperandStartIdx) / SamplerDescriptorSize;
+                destNode.set = *pData++;
+                if (pDataEnd - pData < 2)
+                {
+                    return false;
+                }
+                destNode.binding = *pData++;
+                uint32_t elemCount = *pData++;
+                destNode.pImmutableValue = nullptr;
+
+                if (elemCount != 0)
+                {
+                    if (static_cast<size_t>(pDataEnd - pData) < elemCount * SamplerDescriptorSize)
+                    {
+                        return false;
+                    }
+
+                    IRBuilder<> builder(*m_pContext);
                     SmallVector<Constant*, 4> descriptors;
                     for (uint32_t elemIdx = 0; elemIdx < elemCount; ++elemIdx)
                     {
                         Constant* compValues[SamplerDescriptorSize];
                         for (uint32_t compIdx = 0; compIdx < SamplerDescriptorSize; ++compIdx)
                         {
-                            compValues[compIdx] = mdconst::dyn_extract<ConstantInt>(
-                                  pMetadataNode->getOperand(OperandStartIdx + SamplerDescriptorSize * elemIdx + compIdx));
+                            compValues[compIdx] = builder.getInt32(*pData++);
                         }
                         descriptors.push_back(ConstantVector::get(compValues));
                     }
-                    pNextNode->pImmutableValue = ConstantArray::get(ArrayType::get(descriptors[0]->getType(),
-                                                                                   elemCount),
-                                                                    descriptors);
+                    destNode.pImmutableValue = ConstantArray::get(ArrayType::get(descriptors[0]->getType(),
+                                                                                 elemCount),
+                                                                  descriptors);
                 }
+                break;
             }
-            // Move on to next node to write in table.
-            ++pNextNode;
-            if (pEndThisInnerTable == nullptr)
-            {
-                pNextOuterNode = pNextNode;
-            }
-        }
-        // See if we have reached the end of the inner table.
-        if (pNextNode == pEndThisInnerTable)
-        {
-            pEndThisInnerTable = nullptr;
-            pNextNode = pNextOuterNode;
-        }
-    }
-    m_userDataNodes = ArrayRef<ResourceNode>(m_allocUserDataNodes.get(), pNextOuterNode);
-}
-
-// =====================================================================================================================
-// Get the cached MDString for the name of a resource mapping node type, as used in IR metadata for user data nodes.
-MDString* PipelineState::GetResourceTypeName(
-    ResourceMappingNodeType type)   // Resource mapping node type
-{
-    return GetResourceTypeNames()[static_cast<uint32_t>(type)];
-}
-
-// =====================================================================================================================
-// Get the resource mapping node type given its MDString name.
-ResourceMappingNodeType PipelineState::GetResourceTypeFromName(
-    MDString* pTypeName)  // [in] Name of resource type as MDString
-{
-    auto typeNames = GetResourceTypeNames();
-    for (uint32_t type = 0; ; ++type)
-    {
-        if (typeNames[type] == pTypeName)
-        {
-            return static_cast<ResourceMappingNodeType>(type);
-        }
-    }
-}
-
-// =====================================================================================================================
-// Get the array of cached MDStrings for names of resource mapping node type, as used in IR metadata for user
-// data nodes.
-ArrayRef<MDString*> PipelineState::GetResourceTypeNames()
-{
-    if (m_resourceNodeTypeNames[0] == nullptr)
-    {
-        for (uint32_t type = 0; type < static_cast<uint32_t>(ResourceMappingNodeType::Count); ++type)
-        {
-            m_resourceNodeTypeNames[type] =
-                MDString::get(*m_pContext, GetResourceMappingNodeTypeName(static_cast<ResourceMappingNodeType>(type)));
         }
     }
-    return ArrayRef<MDString*>(m_resourceNodeTypeNames);
+    return true;
 }
 
 // =====================================================================================================================
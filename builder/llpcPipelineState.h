@@ -33,6 +33,7 @@
 #include "llpc.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
 #include <map>
 
 namespace llvm
@@ -104,6 +105,12 @@ public:
     // Set up the pipeline state from the specified linked IR module.
     void ReadStateFromModule(llvm::Module* pModule);
 
+    // Serialize the pipeline state into a compact binary blob, for attaching to the module or passing out-of-band.
+    void Serialize(llvm::SmallVectorImpl<uint32_t>& blob) const;
+
+    // Set up the pipeline state from a binary blob created by Serialize. Returns false if the blob is malformed.
+    bool Deserialize(llvm::StringRef blob);
+
     // Get user data nodes
     llvm::ArrayRef<ResourceNode> GetUserDataNodes() const { return m_userDataNodes; }
 
@@ -115,28 +122,21 @@ private:
                                const ImmutableNodesMap&             immutableNodesMap,
                                ResourceNode*                        pDestTable,
                                ResourceNode*&                       pDestInnerTable);
-    void RecordUserDataNodes(llvm::Module* pModule);
-    void RecordUserDataTable(llvm::ArrayRef<ResourceNode> nodes, llvm::NamedMDNode* pUserDataMetaNode);
-
-    // Read user data nodes for each shader stage from IR metadata
-    void ReadUserDataNodes(llvm::Module* pModule);
-
-    // Get the array of cached MDStrings for names of resource mapping node type, as used in IR metadata for user
-    // data nodes.
-    llvm::ArrayRef<llvm::MDString*> GetResourceTypeNames();
 
-    // Get the cached MDString for the name of a resource mapping node type, as used in IR metadata for user data nodes.
-    llvm::MDString* GetResourceTypeName(ResourceMappingNodeType type);
+    // Serialize one table of user data nodes, calling itself recursively for inner tables.
+    void SerializeUserDataTable(llvm::ArrayRef<ResourceNode> nodes, llvm::SmallVectorImpl<uint32_t>& blob) const;
 
-    // Get the resource mapping node type given its MDString name.
-    ResourceMappingNodeType GetResourceTypeFromName(llvm::MDString* pTypeName);
+    // Deserialize one table of user data nodes, calling itself recursively for inner tables.
+    bool DeserializeUserDataTable(const uint32_t*&  pData,
+                                  const uint32_t*   pDataEnd,
+                                  ResourceNode*     pDestTable,
+                                  uint32_t          nodeCount,
+                                  ResourceNode*&    pDestInnerTable);
 
     // -----------------------------------------------------------------------------------------------------------------
     llvm::LLVMContext*              m_pContext;                         // LLVM context
     std::unique_ptr<ResourceNode[]> m_allocUserDataNodes;               // Allocated buffer for user data
     llvm::ArrayRef<ResourceNode>    m_userDataNodes;                    // Top-level user data node table
-    llvm::MDString*                 m_resourceNodeTypeNames[uint32_t(ResourceMappingNodeType::Count)] = {};
-                                                                        // Cached MDString for each resource node type
 };
 
 // =====================================================================================================================
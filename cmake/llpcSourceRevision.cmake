@@ -0,0 +1,58 @@
+##
+ #######################################################################################################################
+ #
+ #  Copyright (c) 2019 Advanced Micro Devices, Inc. All Rights Reserved.
+ #
+ #  Permission is hereby granted, free of charge, to any person obtaining a copy
+ #  of this software and associated documentation files (the "Software"), to deal
+ #  in the Software without restriction, including without limitation the rights
+ #  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ #  copies of the Software, and to permit persons to whom the Software is
+ #  furnished to do so, subject to the following conditions:
+ #
+ #  The above copyright notice and this permission notice shall be included in all
+ #  copies or substantial portions of the Software.
+ #
+ #  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ #  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ #  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ #  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ #  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ #  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ #  SOFTWARE.
+ #
+ #######################################################################################################################
+
+# Writes llpcSourceRevision.h with the source revision of LLPC. It runs on every build (not at configure time), so that
+# the shader cache build ID follows each commit. The header is only rewritten when the revision changes, so an
+# unchanged revision does not trigger a recompile.
+#
+# Inputs: SOURCE_DIR (LLPC source directory), OUTPUT_FILE (header to write), GIT_EXECUTABLE (may be empty),
+#         LLPC_SOURCE_REVISION (may be provided by the client to override the git revision).
+
+if(NOT LLPC_SOURCE_REVISION AND GIT_EXECUTABLE)
+    execute_process(
+        COMMAND ${GIT_EXECUTABLE} describe --always --dirty --abbrev=40
+        WORKING_DIRECTORY ${SOURCE_DIR}
+        OUTPUT_VARIABLE LLPC_SOURCE_REVISION
+        OUTPUT_STRIP_TRAILING_WHITESPACE
+        ERROR_QUIET
+    )
+    # A locally modified tree falls back to the build time.
+    if(LLPC_SOURCE_REVISION MATCHES "-dirty$")
+        set(LLPC_SOURCE_REVISION "")
+    endif()
+endif()
+
+set(REVISION_HEADER "// Generated by llpcSourceRevision.cmake, do not edit.\n#pragma once\n")
+if(LLPC_SOURCE_REVISION)
+    string(APPEND REVISION_HEADER "#define LLPC_SOURCE_REVISION \"${LLPC_SOURCE_REVISION}\"\n")
+endif()
+
+set(OLD_REVISION_HEADER "")
+if(EXISTS ${OUTPUT_FILE})
+    file(READ ${OUTPUT_FILE} OLD_REVISION_HEADER)
+endif()
+if(NOT OLD_REVISION_HEADER STREQUAL REVISION_HEADER)
+    file(WRITE ${OUTPUT_FILE} "${REVISION_HEADER}")
+endif()
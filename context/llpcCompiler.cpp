@@ -32,6 +32,8 @@
 
 #include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/BinaryFormat/MsgPackDocument.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/Bitcode/BitcodeWriterPass.h"
 #include "llvm/IR/IRPrintingPasses.h"
 #include "llvm/IR/DiagnosticInfo.h"
@@ -49,7 +51,9 @@
 #include "spirvExt.h"
 #include "SPIRVInternal.h"
 
+#include "llpcAbiMetadata.h"
 #include "llpcBuilder.h"
+#include "llpcBuildBudget.h"
 #include "llpcCodeGenManager.h"
 #include "llpcCompiler.h"
 #include "llpcComputeContext.h"
@@ -57,17 +61,21 @@
 #include "llpcGfx6Chip.h"
 #include "llpcGfx9Chip.h"
 #include "llpcGraphicsContext.h"
+#include "llpcLoweredStageCache.h"
 #include "llpcElfReader.h"
 #include "llpcElfWriter.h"
+#include "llpcEventTracer.h"
 #include "llpcFile.h"
 #include "llpcPassManager.h"
 #include "llpcPatch.h"
 #include "llpcPipelineDumper.h"
+#include "llpcPipelineSpeculator.h"
 #include "llpcSpirvLower.h"
 #include "llpcTimerProfiler.h"
 #include "llpcVertexFetch.h"
 #include <mutex>
 #include <set>
+#include <thread>
 #include <unordered_set>
 
 #ifdef LLPC_ENABLE_SPIRV_OPT
@@ -153,6 +161,24 @@ opt<bool> TrimDebugInfo("trim-debug-info", cl::desc("Trim debug information in S
 // -enable-per-stage-cache: Enable shader cache per shader stage
 opt<bool> EnablePerStageCache("enable-per-stage-cache", cl::desc("Enable shader cache per shader stage"), init(true));
 
+// -enable-vertex-fetch-prolog: compile vertex shaders independently of vertex input state
+opt<bool> EnableVertexFetchProlog("enable-vertex-fetch-prolog",
+                                  cl::desc("Compile vertex shaders independently of vertex input state, and generate "
+                                           "vertex fetches in a separate per-layout prolog"),
+                                  init(false));
+
+// -enable-color-export-epilog: compile fragment shaders independently of color target formats
+opt<bool> EnableColorExportEpilog("enable-color-export-epilog",
+                                  cl::desc("Compile fragment shaders independently of color target formats, and "
+                                           "generate color exports in a separate per-format epilog"),
+                                  init(false));
+
+// -speculative-compile-threads: count of background threads building pipelines queued for speculative compilation
+opt<uint32_t> SpeculativeCompileThreads("speculative-compile-threads",
+                                        cl::desc("Count of low-priority background threads building pipelines queued "
+                                                 "for speculative compilation (0 - disable speculative compilation)"),
+                                        init(1));
+
 extern opt<bool> EnableOuts;
 
 extern opt<bool> EnableErrs;
@@ -161,6 +187,12 @@ extern opt<std::string> LogFileDbgs;
 
 extern opt<std::string> LogFileOuts;
 
+extern opt<std::string> TraceFile;
+
+extern opt<uint32_t> LoweredStageCacheSize;
+
+extern opt<uint32_t> TraceSampleRate;
+
 } // cl
 
 } // llvm
@@ -180,7 +212,6 @@ enum ShaderReplaceMode
 };
 
 static ManagedStatic<sys::Mutex> s_compilerMutex;
-static MetroHash::Hash s_optionHash = {};
 
 uint32_t Compiler::m_instanceCount = 0;
 uint32_t Compiler::m_outRedirectCount = 0;
@@ -238,57 +269,17 @@ Result VKAPI_CALL ICompiler::Create(
 {
     Result result = Result::Success;
 
-    const char* pClient = options[0];
-    bool ignoreErrors = (strcmp(pClient, VkIcdName) == 0);
-
-    raw_null_ostream nullStream;
-
     std::lock_guard<sys::Mutex> lock(*s_compilerMutex);
     MetroHash::Hash optionHash = Compiler::GenerateHashForCompileOptions(optionCount, options);
 
-    bool parseCmdOption = true;
-    if (Compiler::GetInstanceCount() > 0)
-    {
-        bool isSameOption = memcmp(&optionHash, &s_optionHash, sizeof(optionHash)) == 0;
-
-        parseCmdOption = false;
-        if (isSameOption == false)
-        {
-            if (Compiler::GetOutRedirectCount() == 0)
-            {
-                // All compiler instances are destroyed, we can reset LLVM options in safe
-                auto& options = cl::getRegisteredOptions();
-                for (auto it = options.begin(); it != options.end(); ++it)
-                {
-                    it->second->reset();
-                }
-                parseCmdOption = true;
-            }
-            else
-            {
-                LLPC_ERRS("Incompatible compiler options cross compiler instances!");
-                result = Result::ErrorInvalidValue;
-                LLPC_NEVER_CALLED();
-            }
-        }
-    }
-
-    if (parseCmdOption)
-    {
-        // LLVM command options can't be parsed multiple times
-        if (cl::ParseCommandLineOptions(optionCount,
-                                        options,
-                                        "AMD LLPC compiler",
-                                        ignoreErrors ? &nullStream : nullptr) == false)
-        {
-            result = Result::ErrorInvalidValue;
-        }
-    }
+    // NOTE: Compilers with different options may coexist, the options of each compiler are applied while it compiles.
+    OptionScope optionScope(optionCount, options, optionHash);
+    OptionScope::Guard optionScopeGuard(optionScope);
+    result = optionScopeGuard.GetResult();
 
     if (result == Result::Success)
     {
-        s_optionHash = optionHash;
-        *ppCompiler = new Compiler(gfxIp, optionCount, options, s_optionHash);
+        *ppCompiler = new Compiler(gfxIp, optionScope);
         LLPC_ASSERT(*ppCompiler != nullptr);
     }
     else
@@ -426,6 +417,7 @@ OStream& operator << (
     binOut << resUsage.globalConstant;
     binOut << resUsage.numSgprsAvailable;
     binOut << resUsage.numVgprsAvailable;
+    binOut << resUsage.waveSize;
     binOut << resUsage.builtInUsage.perStage.u64All;
     binOut << resUsage.builtInUsage.allStage.u64All;
 
@@ -434,6 +426,8 @@ OStream& operator << (
     binOut << resUsage.inOutUsage.outputLocMap;
     binOut << resUsage.inOutUsage.perPatchInputLocMap;
     binOut << resUsage.inOutUsage.perPatchOutputLocMap;
+    binOut << resUsage.inOutUsage.inputCompMap;
+    binOut << resUsage.inOutUsage.outputCompMap;
     binOut << resUsage.inOutUsage.builtInInputLocMap;
     binOut << resUsage.inOutUsage.builtInOutputLocMap;
     binOut << resUsage.inOutUsage.perPatchBuiltInInputLocMap;
@@ -484,6 +478,7 @@ IStream& operator >> (
     binIn >> resUsage.globalConstant;
     binIn >> resUsage.numSgprsAvailable;
     binIn >> resUsage.numVgprsAvailable;
+    binIn >> resUsage.waveSize;
     binIn >> resUsage.builtInUsage.perStage.u64All;
     binIn >> resUsage.builtInUsage.allStage.u64All;
 
@@ -491,6 +486,8 @@ IStream& operator >> (
     binIn >> resUsage.inOutUsage.outputLocMap;
     binIn >> resUsage.inOutUsage.perPatchInputLocMap;
     binIn >> resUsage.inOutUsage.perPatchOutputLocMap;
+    binIn >> resUsage.inOutUsage.inputCompMap;
+    binIn >> resUsage.inOutUsage.outputCompMap;
     binIn >> resUsage.inOutUsage.builtInInputLocMap;
     binIn >> resUsage.inOutUsage.builtInOutputLocMap;
     binIn >> resUsage.inOutUsage.perPatchBuiltInInputLocMap;
@@ -524,24 +521,43 @@ IStream& operator >> (
     return in;
 }
 
+// =====================================================================================================================
+// Serializes resource usage in the binary format stored with shader module entries.
+void SerializeResourceUsage(
+    const ResourceUsage& resUsage,  // [in] Resource usage object
+    std::string*         pData)     // [out] Serialized resource usage
+{
+    raw_string_ostream stream(*pData);
+    stream << resUsage;
+    stream.flush();
+}
+
+// =====================================================================================================================
+// Deserializes resource usage from the binary format stored with shader module entries.
+void DeserializeResourceUsage(
+    const std::string& data,        // [in] Serialized resource usage
+    ResourceUsage*     pResUsage)   // [out] Resource usage object
+{
+    std::istringstream stream(data);
+    stream >> *pResUsage;
+}
+
 // =====================================================================================================================
 Compiler::Compiler(
-    GfxIpVersion      gfxIp,        // Graphics IP version info
-    uint32_t          optionCount,  // Count of compilation-option strings
-    const char*const* pOptions,     // [in] An array of compilation-option strings
-    MetroHash::Hash   optionHash)   // Hash code of compilation options
+    GfxIpVersion        gfxIp,        // Graphics IP version info
+    const OptionScope&  optionScope)  // [in] Scope of compilation options, active during construction
     :
-    m_optionHash(optionHash),
+    m_optionScope(optionScope),
     m_gfxIp(gfxIp)
 {
-    for (uint32_t i = 0; i < optionCount; ++i)
-    {
-        m_options.push_back(pOptions[i]);
-    }
-
     if (m_outRedirectCount == 0)
     {
-        RedirectLogOutput(false, optionCount, pOptions);
+        std::vector<const char*> options;
+        for (const auto& option : m_optionScope.GetOptions())
+        {
+            options.push_back(option.c_str());
+        }
+        RedirectLogOutput(false, options.size(), &options[0]);
     }
 
     if (m_instanceCount == 0)
@@ -583,7 +599,7 @@ Compiler::Compiler(
     uint32_t shaderCacheMode = cl::ShaderCacheMode;
     auxCreateInfo.shaderCacheMode = static_cast<ShaderCacheMode>(shaderCacheMode);
     auxCreateInfo.gfxIp           = m_gfxIp;
-    auxCreateInfo.hash            = m_optionHash;
+    auxCreateInfo.hash            = m_optionScope.GetHash();
     auxCreateInfo.pExecutableName = cl::ExecutableName.c_str();
     auxCreateInfo.pCacheFilePath  = cl::ShaderCacheFileDir.c_str();
     if (cl::ShaderCacheFileDir.empty())
@@ -597,6 +613,8 @@ Compiler::Compiler(
 
     m_shaderCache = ShaderCacheManager::GetShaderCacheManager()->GetShaderCacheObject(&createInfo, &auxCreateInfo);
 
+    m_pSpeculator.reset(new PipelineSpeculator(this));
+
     InitGpuProperty();
     InitGpuWorkaround();
 
@@ -607,6 +625,9 @@ Compiler::Compiler(
 // =====================================================================================================================
 Compiler::~Compiler()
 {
+    // Cancel speculative builds first, they use the compiler.
+    m_pSpeculator.reset();
+
     bool shutdown = false;
     {
         // Free context pool
@@ -652,7 +673,7 @@ Compiler::~Compiler()
         ShaderCacheManager::GetShaderCacheManager()->ReleaseShaderCacheObject(m_shaderCache);
     }
 
-    if (m_options[0] == VkIcdName)
+    if (m_optionScope.GetOptions()[0] == VkIcdName)
     {
         // NOTE: Skip subsequent cleanup work for Vulkan ICD. The work will be done by system itself
         return;
@@ -691,6 +712,13 @@ Result Compiler::BuildShaderModule(
     ShaderModuleBuildOut*        pShaderOut     // [out] Output of building this shader module
     ) const
 {
+    // Apply the compilation options of this compiler for the duration of the build
+    OptionScope::Guard optionScopeGuard(m_optionScope);
+    if (optionScopeGuard.GetResult() != Result::Success)
+    {
+        return optionScopeGuard.GetResult();
+    }
+
     Result result = Result::Success;
     void* pAllocBuf = nullptr;
     const void* pCacheData = nullptr;
@@ -719,6 +747,9 @@ Result Compiler::BuildShaderModule(
 
     memcpy(moduleData.hash, &hash, sizeof(hash));
 
+    TraceScope traceScope("BuildShaderModule", TraceCategoryPipeline);
+    traceScope.SetHash(MetroHash::Compact64(&hash));
+
     TimerProfiler timerProfiler(MetroHash::Compact64(&hash),
                                 "LLPC ShaderModule",
                                 TimerProfiler::ShaderModuleTimerEnableMask);
@@ -810,6 +841,9 @@ Result Compiler::BuildShaderModule(
 
                 for (uint32_t i = 0; i < entryNames.size(); ++i)
                 {
+                    TraceScope stageTraceScope(GetShaderStageName(static_cast<ShaderStage>(entryNames[i].stage)),
+                                               TraceCategoryStage);
+
                     ShaderModuleEntry moduleEntry = {};
                     ResourceUsage resUsage;
                     PipelineContext::InitShaderResourceUsage(entryNames[i].stage, &resUsage);
@@ -974,95 +1008,179 @@ Result Compiler::BuildShaderModule(
 }
 
 // =====================================================================================================================
-// Build pipeline internally -- common code for graphics and compute
-Result Compiler::BuildPipelineInternal(
-    Context*                            pContext,                   // [in] Acquired context
-    ArrayRef<const PipelineShaderInfo*> shaderInfo,                 // [in] Shader info of this pipeline
-    uint32_t                            forceLoopUnrollCount,       // [in] Force loop unroll count (0 means disable)
-    ElfPackage*                         pPipelineElf)               // [out] Output Elf package
+// Checks the compile-time budget of the pipeline build in the context, between the pass managers of the build. Returns
+// ErrorCanceled if the budget has expired.
+static Result CheckBuildBudget(
+    Context* pContext)    // [in] Acquired context
 {
-    Result          result = Result::Success;
+    BuildBudget* pBudget = pContext->GetPipelineContext()->GetBuildBudget();
+    return ((pBudget != nullptr) && pBudget->IsExpired()) ? Result::ErrorCanceled : Result::Success;
+}
 
-    uint32_t passIndex = 0;
-    TimerProfiler timerProfiler(pContext->GetPiplineHashCode(), "LLPC", TimerProfiler::PipelineTimerEnableMask);
+// =====================================================================================================================
+// Gets the compile-time budget specified in the info to build a pipeline. Returns null if the client interface does
+// not have the budget yet.
+template<class PipelineBuildInfoType>
+static const PipelineBuildBudget* GetPipelineBuildBudget(
+    const PipelineBuildInfoType* pPipelineInfo)   // [in] Info to build the pipeline
+{
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 37
+    return &pPipelineInfo->budget;
+#else
+    return nullptr;
+#endif
+}
 
-    pContext->setDiagnosticHandler(std::make_unique<LlpcDiagnosticHandler>());
+// =====================================================================================================================
+// Builds the key of a shader stage in the lowered stage cache, from the inputs of SPIR-V translation and lowering:
+// the shader module, entry point, specialization data and the options read by them.
+static MetroHash::Hash GetLoweredStageKey(
+    const PipelineShaderInfo* pShaderInfo,      // [in] Info of the pipeline shader
+    const PipelineOptions*    pPipelineOptions, // [in] Pipeline options
+    const MetroHash::Hash&    optionHash)       // [in] Hash code of the compilation options
+{
+    MetroHash64 hasher;
+    hasher.Update(optionHash);
+    hasher.Update(pShaderInfo->entryStage);
 
-    // Create the AMDGPU TargetMachine.
-    result = CodeGenManager::CreateTargetMachine(pContext, pContext->GetPipelineContext()->GetPipelineOptions());
+    auto pModuleData = reinterpret_cast<const ShaderModuleData*>(pShaderInfo->pModuleData);
+    hasher.Update(reinterpret_cast<const uint8_t*>(pModuleData->moduleInfo.cacheHash),
+                  sizeof(pModuleData->moduleInfo.cacheHash));
 
-    Module* pPipelineModule = nullptr;
+    const size_t entryNameLen = (pShaderInfo->pEntryTarget != nullptr) ? strlen(pShaderInfo->pEntryTarget) : 0;
+    hasher.Update(entryNameLen);
+    hasher.Update(reinterpret_cast<const uint8_t*>(pShaderInfo->pEntryTarget), entryNameLen);
 
-    // NOTE: If input is LLVM IR, read it now. There is now only ever one IR module representing the
-    // whole pipeline.
-    bool IsLlvmBc = false;
-    const PipelineShaderInfo* pShaderInfo = (shaderInfo[0] != nullptr) ? shaderInfo[0] : shaderInfo.back();
-    if (pShaderInfo != nullptr)
+    auto pSpecializationInfo = pShaderInfo->pSpecializationInfo;
+    const uint32_t mapEntryCount = (pSpecializationInfo != nullptr) ? pSpecializationInfo->mapEntryCount : 0;
+    hasher.Update(mapEntryCount);
+    if (mapEntryCount > 0)
     {
-        const ShaderModuleData* pModuleData = reinterpret_cast<const ShaderModuleData*>(pShaderInfo->pModuleData);
-        if ((pModuleData != nullptr) && (pModuleData->binType == BinaryType::LlvmBc))
-        {
-            IsLlvmBc = true;
-            pPipelineModule = pContext->LoadLibary(&pModuleData->binCode).release();
-        }
+        hasher.Update(reinterpret_cast<const uint8_t*>(pSpecializationInfo->pMapEntries),
+                      sizeof(VkSpecializationMapEntry) * mapEntryCount);
+        hasher.Update(pSpecializationInfo->dataSize);
+        hasher.Update(reinterpret_cast<const uint8_t*>(pSpecializationInfo->pData), pSpecializationInfo->dataSize);
     }
 
-    // Merge user data for shader stages into one.
-    pContext->GetPipelineContext()->DoUserDataNodeMerge();
+    hasher.Update(pPipelineOptions->scalarBlockLayout);
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 28
+    hasher.Update(pPipelineOptions->reconfigWorkgroupLayout);
+#endif
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 23
+    hasher.Update(pPipelineOptions->robustBufferAccess);
+#endif
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 24
+    hasher.Update(pShaderInfo->options.forceLoopUnrollCount);
+#endif
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 35
+    hasher.Update(pShaderInfo->options.disableLicm);
+#endif
 
-    // If not IR input, run the per-shader passes, including SPIR-V translation, and then link the modules
-    // into a single pipeline module.
-    if (pPipelineModule == nullptr)
+    MetroHash::Hash key = {};
+    hasher.Finalize(key.bytes);
+    return key;
+}
+
+// =====================================================================================================================
+// Runs the per-shader passes of a pipeline, including SPIR-V translation and lowering, and then links the shader
+// modules into a single pipeline module.
+Result Compiler::LowerPipeline(
+    Context*                            pContext,                   // [in] Acquired context
+    ArrayRef<const PipelineShaderInfo*> shaderInfo,                 // [in] Shader info of this pipeline
+    uint32_t                            forceLoopUnrollCount,       // [in] Force loop unroll count (0 means disable)
+    TimerProfiler&                      timerProfiler,              // [in] Timer profiler of the pipeline build
+    uint32_t*                           pPassIndex,                 // [in,out] Running pass index
+    Module**                            ppPipelineModule)           // [out] Linked pipeline module
+{
+    Result result = Result::Success;
+
+    // Create empty modules and set target machine in each.
+    std::vector<Module*> modules(shaderInfo.size());
+    std::vector<MetroHash::Hash> loweredStageKeys(shaderInfo.size());
+    const bool useLoweredStageCache = LoweredStageCache::IsEnabled();
+    uint32_t stageSkipMask = 0;
+    for (uint32_t shaderIndex = 0; (shaderIndex < shaderInfo.size()) && (result == Result::Success); ++shaderIndex)
     {
-        // Create empty modules and set target machine in each.
-        std::vector<Module*> modules(shaderInfo.size());
-        uint32_t stageSkipMask = 0;
-        for (uint32_t shaderIndex = 0; (shaderIndex < shaderInfo.size()) && (result == Result::Success); ++shaderIndex)
+        const PipelineShaderInfo* pShaderInfo = shaderInfo[shaderIndex];
+        if ((pShaderInfo == nullptr) || (pShaderInfo->pModuleData == nullptr))
         {
-            const PipelineShaderInfo* pShaderInfo = shaderInfo[shaderIndex];
-            if ((pShaderInfo == nullptr) || (pShaderInfo->pModuleData == nullptr))
-            {
-                continue;
-            }
+            continue;
+        }
 
-            const ShaderModuleData* pModuleData = reinterpret_cast<const ShaderModuleData*>(pShaderInfo->pModuleData);
+        const ShaderModuleData* pModuleData = reinterpret_cast<const ShaderModuleData*>(pShaderInfo->pModuleData);
 
-            Module* pModule = nullptr;
-            if (pModuleData->binType == BinaryType::MultiLlvmBc)
-            {
-                timerProfiler.StartStopTimer(TimerLoadBc, true);
+        Module* pModule = nullptr;
+        if (pModuleData->binType == BinaryType::MultiLlvmBc)
+        {
+            TraceScope stageTraceScope(GetShaderStageName(pShaderInfo->entryStage), TraceCategoryStage);
+            timerProfiler.StartStopTimer(TimerLoadBc, true);
 
-                MetroHash::Hash entryNameHash = {};
+            MetroHash::Hash entryNameHash = {};
 
-                LLPC_ASSERT(pShaderInfo->pEntryTarget != nullptr);
-                MetroHash64::Hash(reinterpret_cast<const uint8_t*>(pShaderInfo->pEntryTarget),
-                                  strlen(pShaderInfo->pEntryTarget),
-                                  entryNameHash.bytes);
+            LLPC_ASSERT(pShaderInfo->pEntryTarget != nullptr);
+            MetroHash64::Hash(reinterpret_cast<const uint8_t*>(pShaderInfo->pEntryTarget),
+                              strlen(pShaderInfo->pEntryTarget),
+                              entryNameHash.bytes);
 
-                BinaryData binCode = {};
-                for (uint32_t i = 0; i < pModuleData->moduleInfo.entryCount; ++i)
+            BinaryData binCode = {};
+            for (uint32_t i = 0; i < pModuleData->moduleInfo.entryCount; ++i)
+            {
+                auto pEntry = &pModuleData->moduleInfo.entries[i];
+                if ((pEntry->stage == pShaderInfo->entryStage) &&
+                    (memcmp(pEntry->entryNameHash, &entryNameHash, sizeof(MetroHash::Hash)) == 0))
                 {
-                    auto pEntry = &pModuleData->moduleInfo.entries[i];
-                    if ((pEntry->stage == pShaderInfo->entryStage) &&
-                        (memcmp(pEntry->entryNameHash, &entryNameHash, sizeof(MetroHash::Hash)) == 0))
-                    {
-                        // LLVM bitcode
-                        binCode.codeSize = pEntry->entrySize;
-                        binCode.pCode = VoidPtrInc(pModuleData->binCode.pCode, pEntry->entryOffset);
-
-                        // Resource usage
-                        const char* pResUsagePtr = reinterpret_cast<const char*>(
-                            VoidPtrInc(pModuleData->binCode.pCode, pEntry->entryOffset + pEntry->entrySize));
-                        std::string resUsageBuf(pResUsagePtr, pEntry->resUsageSize);
-                        std::istringstream resUsageStrem(resUsageBuf);
-                        resUsageStrem >> *(pContext->GetShaderResourceUsage(static_cast<ShaderStage>(shaderIndex)));
-                        break;
-                    }
+                    // LLVM bitcode
+                    binCode.codeSize = pEntry->entrySize;
+                    binCode.pCode = VoidPtrInc(pModuleData->binCode.pCode, pEntry->entryOffset);
+
+                    // Resource usage
+                    const char* pResUsagePtr = reinterpret_cast<const char*>(
+                        VoidPtrInc(pModuleData->binCode.pCode, pEntry->entryOffset + pEntry->entrySize));
+                    std::string resUsageBuf(pResUsagePtr, pEntry->resUsageSize);
+                    std::istringstream resUsageStrem(resUsageBuf);
+                    resUsageStrem >> *(pContext->GetShaderResourceUsage(static_cast<ShaderStage>(shaderIndex)));
+                    break;
                 }
+            }
+
+            if (binCode.codeSize > 0)
+            {
+                pModule = pContext->LoadLibary(&binCode).release();
+                stageSkipMask |= (1 << shaderIndex);
+            }
+            else
+            {
+                result = Result::ErrorInvalidShader;
+            }
+
+             timerProfiler.StartStopTimer(TimerLoadBc, false);
+        }
+        else
+        {
+            // A stage seen before in any pipeline is loaded from the lowered stage cache, skipping its translation
+            // and lowering.
+            std::shared_ptr<const LoweredStage> pLoweredStage;
+            if (useLoweredStageCache && (pModuleData->binType == BinaryType::Spirv))
+            {
+                loweredStageKeys[shaderIndex] = GetLoweredStageKey(pShaderInfo,
+                                                                   pContext->GetPipelineContext()->GetPipelineOptions(),
+                                                                   m_optionScope.GetHash());
+                pLoweredStage = LoweredStageCache::Get()->Find(loweredStageKeys[shaderIndex]);
+            }
+
+            if (pLoweredStage != nullptr)
+            {
+                TraceScope stageTraceScope(GetShaderStageName(pShaderInfo->entryStage), TraceCategoryCache);
+                timerProfiler.StartStopTimer(TimerLoadBc, true);
 
-                if (binCode.codeSize > 0)
+                BinaryData binCode = {};
+                binCode.codeSize = pLoweredStage->bitcode.size();
+                binCode.pCode = pLoweredStage->bitcode.data();
+                pModule = pContext->LoadLibary(&binCode).release();
+                if (pModule != nullptr)
                 {
-                    pModule = pContext->LoadLibary(&binCode).release();
+                    DeserializeResourceUsage(pLoweredStage->resUsage,
+                                             pContext->GetShaderResourceUsage(static_cast<ShaderStage>(shaderIndex)));
                     stageSkipMask |= (1 << shaderIndex);
                 }
                 else
@@ -1070,102 +1188,227 @@ Result Compiler::BuildPipelineInternal(
                     result = Result::ErrorInvalidShader;
                 }
 
-                 timerProfiler.StartStopTimer(TimerLoadBc, false);
+                timerProfiler.StartStopTimer(TimerLoadBc, false);
             }
             else
             {
                 pModule = new Module((Twine("llpc") + GetShaderStageName(pShaderInfo->entryStage)).str() +
                                      std::to_string(GetModuleIdByIndex(shaderIndex)), *pContext);
             }
+        }
+
+        modules[shaderIndex] = pModule;
+        pContext->SetModuleTargetMachine(pModule);
+    }
+
+    // Give the pipeline state to the Builder. (If we know we are using BuilderRecorder, in a future change
+    // we could choose to delay this until after linking into a pipeline module.)
+    pContext->GetPipelineContext()->SetBuilderPipelineState(pContext->GetBuilder());
 
-            modules[shaderIndex] = pModule;
-            pContext->SetModuleTargetMachine(pModule);
+    for (uint32_t shaderIndex = 0; (shaderIndex < shaderInfo.size()) && (result == Result::Success); ++shaderIndex)
+    {
+        const PipelineShaderInfo* pShaderInfo = shaderInfo[shaderIndex];
+        if ((pShaderInfo == nullptr) ||
+            (pShaderInfo->pModuleData == nullptr) ||
+            (stageSkipMask & ShaderStageToMask(pShaderInfo->entryStage)))
+        {
+            continue;
         }
 
-        // Give the pipeline state to the Builder. (If we know we are using BuilderRecorder, in a future change
-        // we could choose to delay this until after linking into a pipeline module.)
-        pContext->GetPipelineContext()->SetBuilderPipelineState(pContext->GetBuilder());
+        TraceScope stageTraceScope(GetShaderStageName(pShaderInfo->entryStage), TraceCategoryStage);
+        PassManager lowerPassMgr(pPassIndex);
+
+        // Set the shader stage in the Builder.
+        pContext->GetBuilder()->SetShaderStage(pShaderInfo->entryStage);
 
-        for (uint32_t shaderIndex = 0; (shaderIndex < shaderInfo.size()) && (result == Result::Success); ++shaderIndex)
+        // Start timer for translate.
+        timerProfiler.AddTimerStartStopPass(&lowerPassMgr, TimerTranslate, true);
+
+        // SPIR-V translation, then dump the result.
+        lowerPassMgr.add(CreateSpirvLowerTranslator(pShaderInfo->entryStage, pShaderInfo));
+        if (EnableOuts())
         {
-            const PipelineShaderInfo* pShaderInfo = shaderInfo[shaderIndex];
-            if ((pShaderInfo == nullptr) ||
-                (pShaderInfo->pModuleData == nullptr) ||
-                (stageSkipMask & ShaderStageToMask(pShaderInfo->entryStage)))
-            {
-                continue;
-            }
+            lowerPassMgr.add(createPrintModulePass(outs(), "\n"
+                        "===============================================================================\n"
+                        "// LLPC SPIRV-to-LLVM translation results\n"));
+        }
+        {
+            lowerPassMgr.add(CreateSpirvLowerResourceCollect());
+        }
+
+        // Stop timer for translate.
+        timerProfiler.AddTimerStartStopPass(&lowerPassMgr, TimerTranslate, false);
+
+        // Run the passes.
+        bool success = RunPasses(&lowerPassMgr, modules[shaderIndex]);
+        if (success == false)
+        {
+            LLPC_ERRS("Failed to translate SPIR-V or run per-shader passes\n");
+            result = Result::ErrorInvalidShader;
+        }
+        else
+        {
+            result = CheckBuildBudget(pContext);
+        }
+    }
 
-            PassManager lowerPassMgr(&passIndex);
+    for (uint32_t shaderIndex = 0; (shaderIndex < shaderInfo.size()) && (result == Result::Success); ++shaderIndex)
+    {
+        // Per-shader SPIR-V lowering passes.
+        const PipelineShaderInfo* pShaderInfo = shaderInfo[shaderIndex];
+        if ((pShaderInfo == nullptr) ||
+            (pShaderInfo->pModuleData == nullptr) ||
+            (stageSkipMask & ShaderStageToMask(pShaderInfo->entryStage)))
+        {
+            continue;
+        }
 
-            // Set the shader stage in the Builder.
-            pContext->GetBuilder()->SetShaderStage(pShaderInfo->entryStage);
+        TraceScope stageTraceScope(GetShaderStageName(pShaderInfo->entryStage), TraceCategoryStage);
+        pContext->GetBuilder()->SetShaderStage(pShaderInfo->entryStage);
+        PassManager lowerPassMgr(pPassIndex);
 
-            // Start timer for translate.
-            timerProfiler.AddTimerStartStopPass(&lowerPassMgr, TimerTranslate, true);
+        SpirvLower::AddPasses(pContext,
+                              pShaderInfo->entryStage,
+                              lowerPassMgr,
+                              timerProfiler.GetTimer(TimerLower),
+                              forceLoopUnrollCount);
 
-            // SPIR-V translation, then dump the result.
-            lowerPassMgr.add(CreateSpirvLowerTranslator(pShaderInfo->entryStage, pShaderInfo));
-            if (EnableOuts())
-            {
-                lowerPassMgr.add(createPrintModulePass(outs(), "\n"
-                            "===============================================================================\n"
-                            "// LLPC SPIRV-to-LLVM translation results\n"));
-            }
-            {
-                lowerPassMgr.add(CreateSpirvLowerResourceCollect());
-            }
+        // Run the passes.
+        bool success = RunPasses(&lowerPassMgr, modules[shaderIndex]);
+        if (success == false)
+        {
+            LLPC_ERRS("Failed to translate SPIR-V or run per-shader passes\n");
+            result = Result::ErrorInvalidShader;
+        }
+        else
+        {
+            result = CheckBuildBudget(pContext);
+        }
+    }
+
+    // Store the newly lowered stages in the lowered stage cache, before they are consumed by linking.
+    for (uint32_t shaderIndex = 0;
+         useLoweredStageCache && (shaderIndex < shaderInfo.size()) && (result == Result::Success);
+         ++shaderIndex)
+    {
+        const PipelineShaderInfo* pShaderInfo = shaderInfo[shaderIndex];
+        if ((pShaderInfo == nullptr) ||
+            (pShaderInfo->pModuleData == nullptr) ||
+            (reinterpret_cast<const ShaderModuleData*>(pShaderInfo->pModuleData)->binType != BinaryType::Spirv) ||
+            (stageSkipMask & ShaderStageToMask(pShaderInfo->entryStage)))
+        {
+            continue;
+        }
 
-            // Stop timer for translate.
-            timerProfiler.AddTimerStartStopPass(&lowerPassMgr, TimerTranslate, false);
+        std::string bitcode;
+        raw_string_ostream bitcodeStream(bitcode);
+        WriteBitcodeToFile(*modules[shaderIndex], bitcodeStream);
+        bitcodeStream.flush();
 
-            // Run the passes.
-            bool success = RunPasses(&lowerPassMgr, modules[shaderIndex]);
-            if (success == false)
+        std::string resUsage;
+        SerializeResourceUsage(*pContext->GetShaderResourceUsage(pShaderInfo->entryStage), &resUsage);
+
+        LoweredStageCache::Get()->Insert(loweredStageKeys[shaderIndex], std::move(bitcode), std::move(resUsage));
+    }
+
+    // Link the shader modules into a single pipeline module.
+    *ppPipelineModule = pContext->GetBuilder()->Link(modules, true);
+    if (*ppPipelineModule == nullptr)
+    {
+        LLPC_ERRS("Failed to link shader modules into pipeline module\n");
+        result = Result::ErrorInvalidShader;
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Build pipeline internally -- common code for graphics and compute
+Result Compiler::BuildPipelineInternal(
+    Context*                            pContext,                   // [in] Acquired context
+    ArrayRef<const PipelineShaderInfo*> shaderInfo,                 // [in] Shader info of this pipeline
+    uint32_t                            forceLoopUnrollCount,       // [in] Force loop unroll count (0 means disable)
+    ElfPackage*                         pPipelineElf,               // [out] Output Elf package
+    LoweredPipeline*                    pLoweredPipeline)           // [in] Pipeline lowered for multiple targets
+                                                                    //      (could be null)
+{
+    Result          result = Result::Success;
+
+    uint32_t passIndex = 0;
+    TimerProfiler timerProfiler(pContext->GetPiplineHashCode(), "LLPC", TimerProfiler::PipelineTimerEnableMask);
+
+    pContext->setDiagnosticHandler(std::make_unique<LlpcDiagnosticHandler>());
+
+    // Create the AMDGPU TargetMachine.
+    result = CodeGenManager::CreateTargetMachine(pContext, pContext->GetPipelineContext()->GetPipelineOptions());
+
+    Module* pPipelineModule = nullptr;
+
+    // NOTE: If input is LLVM IR, read it now. There is now only ever one IR module representing the
+    // whole pipeline.
+    bool IsLlvmBc = false;
+    const PipelineShaderInfo* pShaderInfo = (shaderInfo[0] != nullptr) ? shaderInfo[0] : shaderInfo.back();
+    if (pShaderInfo != nullptr)
+    {
+        const ShaderModuleData* pModuleData = reinterpret_cast<const ShaderModuleData*>(pShaderInfo->pModuleData);
+        if ((pModuleData != nullptr) && (pModuleData->binType == BinaryType::LlvmBc))
+        {
+            IsLlvmBc = true;
+            pPipelineModule = pContext->LoadLibary(&pModuleData->binCode).release();
+            if (EnableOuts() && (pPipelineModule != nullptr))
             {
-                LLPC_ERRS("Failed to translate SPIR-V or run per-shader passes\n");
-                result = Result::ErrorInvalidShader;
+                LLPC_OUTS("===============================================================================\n"
+                          "// LLPC loaded LLVM bitcode\n" << *pPipelineModule << "\n");
             }
         }
+    }
 
-        for (uint32_t shaderIndex = 0; (shaderIndex < shaderInfo.size()) && (result == Result::Success); ++shaderIndex)
+    // In a multi-target build, the pipeline is translated and lowered once for all targets. Load the lowered pipeline
+    // module and the resource usage collected by lowering into the context of this target.
+    if ((pPipelineModule == nullptr) && (pLoweredPipeline != nullptr) && (result == Result::Success))
+    {
+        result = pLoweredPipeline->Lower();
+        if (result == Result::Success)
         {
-            // Per-shader SPIR-V lowering passes.
-            const PipelineShaderInfo* pShaderInfo = shaderInfo[shaderIndex];
-            if ((pShaderInfo == nullptr) ||
-                (pShaderInfo->pModuleData == nullptr) ||
-                (stageSkipMask & ShaderStageToMask(pShaderInfo->entryStage)))
+            auto moduleOrErr = parseBitcodeFile(MemoryBufferRef(pLoweredPipeline->GetBitcode(), ""), *pContext);
+            if (moduleOrErr)
             {
-                continue;
+                pPipelineModule = moduleOrErr->release();
             }
-
-            pContext->GetBuilder()->SetShaderStage(pShaderInfo->entryStage);
-            PassManager lowerPassMgr(&passIndex);
-
-            SpirvLower::AddPasses(pContext,
-                                  pShaderInfo->entryStage,
-                                  lowerPassMgr,
-                                  timerProfiler.GetTimer(TimerLower),
-                                  forceLoopUnrollCount);
-
-            // Run the passes.
-            bool success = RunPasses(&lowerPassMgr, modules[shaderIndex]);
-            if (success == false)
+            else
             {
-                LLPC_ERRS("Failed to translate SPIR-V or run per-shader passes\n");
+                LLPC_ERRS("Fails to load lowered pipeline: " << toString(moduleOrErr.takeError()) << "\n");
                 result = Result::ErrorInvalidShader;
             }
         }
 
-        // Link the shader modules into a single pipeline module.
-        pPipelineModule = pContext->GetBuilder()->Link(modules, true);
-        if (pPipelineModule == nullptr)
+        for (uint32_t stage = 0; (stage < ShaderStageNativeStageCount) && (result == Result::Success); ++stage)
         {
-            LLPC_ERRS("Failed to link shader modules into pipeline module\n");
-            result = Result::ErrorInvalidShader;
+            const std::string& resUsage = pLoweredPipeline->GetResourceUsage(static_cast<ShaderStage>(stage));
+            if (resUsage.empty() == false)
+            {
+                DeserializeResourceUsage(resUsage,
+                                         pContext->GetShaderResourceUsage(static_cast<ShaderStage>(stage)));
+            }
         }
     }
 
+    // Merge user data for shader stages into one.
+    pContext->GetPipelineContext()->DoUserDataNodeMerge();
+
+    // If not IR input, run the per-shader passes, including SPIR-V translation, and then link the modules
+    // into a single pipeline module.
+    if ((pPipelineModule == nullptr) && (result == Result::Success))
+    {
+        result = LowerPipeline(pContext, shaderInfo, forceLoopUnrollCount, timerProfiler, &passIndex, &pPipelineModule);
+    }
+
+    // A speculative build of the pipeline past this point is joined by the client's build, rather than preempted.
+    if (result == Result::Success)
+    {
+        m_pSpeculator->PassCheckpoint(pContext->GetPipelineBuildInfo());
+    }
+
     // Run necessary patch pass to prepare per shader stage cache
     PassManager prePatchPassMgr(&passIndex);
     if (result == Result::Success)
@@ -1178,6 +1421,10 @@ Result Compiler::BuildPipelineInternal(
         {
             result = Result::ErrorInvalidShader;
         }
+        else
+        {
+            result = CheckBuildBudget(pContext);
+        }
     }
 
     constexpr uint32_t ShaderCacheCount = 2;
@@ -1192,10 +1439,17 @@ Result Compiler::BuildPipelineInternal(
     BinaryData fragmentElf = {};
     BinaryData nonFragmentElf = {};
 
+    ShaderEntryState bodyCacheEntryState = ShaderEntryState::New;
+    ShaderCache* pBodyShaderCache[ShaderCacheCount] = { nullptr, nullptr };
+    CacheEntryHandle hBodyEntry[ShaderCacheCount] = { nullptr, nullptr };
+    std::unique_ptr<Module> pBodyModule;
+
     uint32_t stageMask = pContext->GetShaderStageMask();
 
-    // Only enable per stage cache for full graphic pipeline
+    // Only enable per stage cache for full graphic pipeline. Shaders compiled with the fast optimization tier are not
+    // cached.
     bool checkPerStageCache = cl::EnablePerStageCache &&
+                              (pContext->GetPipelineContext()->IsFastOptTier() == false) &&
                               pContext->IsGraphics() &&
                               (stageMask & ShaderStageToMask(ShaderStageVertex)) &&
                               (stageMask & ShaderStageToMask(ShaderStageFragment));
@@ -1205,7 +1459,9 @@ Result Compiler::BuildPipelineInternal(
         // Check per stage shader cache
         MetroHash::Hash fragmentHash = {};
         MetroHash::Hash nonFragmentHash = {};
-        BuildShaderCacheHash(pContext, &fragmentHash, &nonFragmentHash);
+        MetroHash::Hash fragmentBodyHash = {};
+        MetroHash::Hash nonFragmentBodyHash = {};
+        BuildShaderCacheHash(pContext, &fragmentHash, &nonFragmentHash, &fragmentBodyHash, &nonFragmentBodyHash);
 
         // NOTE: Global constant are added to the end of pipeline binary. we can't merge ELF binaries if global constant
         // is used in non-fragment shader stages.
@@ -1242,6 +1498,65 @@ Result Compiler::BuildPipelineInternal(
                                                                 pNonFragmentShaderCache,
                                                                 hNonFragmentEntry);
             }
+
+            // In vertex fetch prolog mode, the patched non-fragment shaders are also cached as LLVM bitcode, keyed
+            // independently of vertex input state. For a new vertex input layout, only the vertex fetch prolog and
+            // code generation have to be redone. Likewise, in color export epilog mode, the patched fragment shader is
+            // cached independently of color target formats, and only the color export epilog has to be redone.
+            MetroHash::Hash* pBodyHash = nullptr;
+            if (cl::EnableVertexFetchProlog &&
+                (fragmentCacheEntryState == ShaderEntryState::Ready) &&
+                (nonFragmentCacheEntryState == ShaderEntryState::Compiling))
+            {
+                pBodyHash = &nonFragmentBodyHash;
+            }
+            else if (cl::EnableColorExportEpilog &&
+                     (nonFragmentCacheEntryState == ShaderEntryState::Ready) &&
+                     (fragmentCacheEntryState == ShaderEntryState::Compiling))
+            {
+                pBodyHash = &fragmentBodyHash;
+            }
+
+            if (pBodyHash != nullptr)
+            {
+                BinaryData bodyBitcode = {};
+                bodyCacheEntryState = LookUpShaderCaches(pPipelineInfo->pShaderCache,
+                                                         pBodyHash,
+                                                         &bodyBitcode,
+                                                         pBodyShaderCache,
+                                                         hBodyEntry);
+
+                if (bodyCacheEntryState == ShaderEntryState::Ready)
+                {
+                    StringRef bitcode(static_cast<const char*>(bodyBitcode.pCode), bodyBitcode.codeSize);
+                    auto moduleOrErr = parseBitcodeFile(MemoryBufferRef(bitcode, ""), *pContext);
+                    if (moduleOrErr)
+                    {
+                        pBodyModule = std::move(*moduleOrErr);
+                    }
+                    else
+                    {
+                        // Fall back to patching the shaders.
+                        LLPC_ERRS("Fails to load cached patched shaders: " << toString(moduleOrErr.takeError())
+                                  << "\n");
+                        bodyCacheEntryState = ShaderEntryState::New;
+                    }
+                }
+            }
+
+            if (EnableOuts())
+            {
+                auto GetCacheResultName = [](ShaderEntryState state) -> const char*
+                {
+                    return (state == ShaderEntryState::Ready) ? "hit" :
+                           (state == ShaderEntryState::Compiling) ? "miss" : "not used";
+                };
+                LLPC_OUTS("===============================================================================\n");
+                LLPC_OUTS("// LLPC per-stage shader cache results\n\n");
+                LLPC_OUTS("Fragment ELF      : " << GetCacheResultName(fragmentCacheEntryState) << "\n");
+                LLPC_OUTS("Non-fragment ELF  : " << GetCacheResultName(nonFragmentCacheEntryState) << "\n");
+                LLPC_OUTS("Patched body      : " << GetCacheResultName(bodyCacheEntryState) << "\n\n");
+            }
         }
     }
 
@@ -1258,6 +1573,10 @@ Result Compiler::BuildPipelineInternal(
         PassManager patchPassMgr(&passIndex);
         patchPassMgr.add(createTargetTransformInfoWrapperPass(pContext->GetTargetMachine()->getTargetIRAnalysis()));
 
+        // From here on, optional optimization and code generation passes are skipped once the build budget expires,
+        // so that a build which exceeds its budget finishes the running pass manager quickly.
+        pContext->SetBuildBudget(pContext->GetPipelineContext()->GetBuildBudget());
+
         // Manually add a target-aware TLI pass, so optimizations do not think that we have library functions.
         AddTargetLibInfo(pContext, &patchPassMgr);
 
@@ -1278,7 +1597,7 @@ Result Compiler::BuildPipelineInternal(
             skipStageMask = pContext->GetShaderStageMask() & ~ShaderStageToMask(ShaderStageFragment);
         }
 
-        if (result == Result::Success)
+        if ((result == Result::Success) && (pBodyModule == nullptr))
         {
             // Patching.
             Patch::AddPasses(pContext,
@@ -1292,8 +1611,17 @@ Result Compiler::BuildPipelineInternal(
         delete pContext->GetBuilder();
         pContext->SetBuilder(nullptr);
 
+        if ((result == Result::Success) && (pBodyModule != nullptr))
+        {
+            // Continue with the cached patched shaders instead of patching them again. Their PAL metadata still holds
+            // the hashes of the pipeline that was patched first.
+            delete pPipelineModule;
+            pPipelineModule = pBodyModule.release();
+            UpdatePalMetadataPipelineHash(pContext, pPipelineModule);
+            CodeGenManager::SetupTargetFeatures(pPipelineModule);
+        }
         // Run the "whole pipeline" passes, excluding the target backend.
-        if (result == Result::Success)
+        else if (result == Result::Success)
         {
             bool success = RunPasses(&patchPassMgr, pPipelineModule);
             if (success)
@@ -1312,6 +1640,63 @@ Result Compiler::BuildPipelineInternal(
             }
         }
 
+        // Do not publish the patched shaders to the cache if the build budget expired during patching.
+        if (result == Result::Success)
+        {
+            result = CheckBuildBudget(pContext);
+        }
+
+        // Cache the patched shaders before the vertex fetch prolog or the color export epilog is generated.
+        if ((result == Result::Success) && (bodyCacheEntryState == ShaderEntryState::Compiling))
+        {
+            SmallVector<char, 0> bitcode;
+            raw_svector_ostream bitcodeStream(bitcode);
+            WriteBitcodeToFile(*pPipelineModule, bitcodeStream);
+
+            BinaryData bodyBitcode = {};
+            bodyBitcode.codeSize = bitcode.size();
+            bodyBitcode.pCode = bitcode.data();
+            UpdateShaderCaches(true, &bodyBitcode, pBodyShaderCache, hBodyEntry, ShaderCacheCount);
+            bodyCacheEntryState = ShaderEntryState::Ready;
+        }
+
+        // Generate the vertex fetch prolog of the vertex input layout and the color export epilog of the color target
+        // formats of this pipeline.
+        if ((result == Result::Success) && (cl::EnableVertexFetchProlog || cl::EnableColorExportEpilog))
+        {
+            PassManager prologEpilogPassMgr(&passIndex);
+            auto pPatchTimer = timerProfiler.GetTimer(TimerPatch);
+            if (pPatchTimer != nullptr)
+            {
+                prologEpilogPassMgr.add(CreateStartStopTimer(pPatchTimer, true));
+            }
+            if (cl::EnableVertexFetchProlog)
+            {
+                prologEpilogPassMgr.add(CreatePatchVertexFetchProlog());
+            }
+            if (cl::EnableColorExportEpilog)
+            {
+                prologEpilogPassMgr.add(CreatePatchColorExportEpilog());
+            }
+            if (pPatchTimer != nullptr)
+            {
+                prologEpilogPassMgr.add(CreateStartStopTimer(pPatchTimer, false));
+            }
+
+            bool success = RunPasses(&prologEpilogPassMgr, pPipelineModule);
+            if (success == false)
+            {
+                LLPC_ERRS("Fails to generate vertex fetch prolog or color export epilog\n");
+                result = Result::ErrorInvalidShader;
+            }
+        }
+
+        // Do not start code generation if the build budget expired during patching.
+        if (result == Result::Success)
+        {
+            result = CheckBuildBudget(pContext);
+        }
+
         // A separate "whole pipeline" pass manager for code generation.
         PassManager codeGenPassMgr(&passIndex);
 
@@ -1335,6 +1720,29 @@ Result Compiler::BuildPipelineInternal(
             }
         }
 
+        // Do not store the pipeline ELF in the shader caches if the build budget expired during code generation.
+        if (result == Result::Success)
+        {
+            result = CheckBuildBudget(pContext);
+        }
+
+        // Attach the LLVM IR recorded by PatchLlvmIrInclusion to the generated ELF.
+        if (result == Result::Success)
+        {
+            auto& llvmIrBitcode = pContext->GetPipelineContext()->GetLlvmIrBitcode();
+            if (llvmIrBitcode.empty() == false)
+            {
+                result = AttachLlvmIrBitcode(llvmIrBitcode, partialCompile ? &partialPipelineElf : pPipelineElf);
+                llvmIrBitcode.clear();
+            }
+        }
+
+        // Release the cache entry of the patched shaders if patching failed.
+        if (bodyCacheEntryState == ShaderEntryState::Compiling)
+        {
+            UpdateShaderCaches(false, nullptr, pBodyShaderCache, hBodyEntry, ShaderCacheCount);
+        }
+
         // Only non-fragment shaders are compiled
         if ((fragmentCacheEntryState == ShaderEntryState::Ready) &&
             (nonFragmentCacheEntryState == ShaderEntryState::Compiling))
@@ -1422,13 +1830,15 @@ Result Compiler::BuildGraphicsPipelineInternal(
     GraphicsContext*                    pGraphicsContext,           // [in] Graphics context this graphics pipeline
     ArrayRef<const PipelineShaderInfo*> shaderInfo,                 // Shader info of this graphics pipeline
     uint32_t                            forceLoopUnrollCount,       // [in] Force loop unroll count (0 means disable)
-    ElfPackage*                         pPipelineElf)               // [out] Output Elf package
+    ElfPackage*                         pPipelineElf,               // [out] Output Elf package
+    LoweredPipeline*                    pLoweredPipeline)           // [in] Pipeline lowered for multiple targets
+                                                                    //      (could be null)
 {
     Context* pContext = AcquireContext();
     pContext->AttachPipelineContext(pGraphicsContext);
     pContext->SetBuilder(Builder::Create(*pContext));
 
-    Result result = BuildPipelineInternal(pContext, shaderInfo, forceLoopUnrollCount, pPipelineElf);
+    Result result = BuildPipelineInternal(pContext, shaderInfo, forceLoopUnrollCount, pPipelineElf, pLoweredPipeline);
 
     delete pContext->GetBuilder();
     pContext->SetBuilder(nullptr);
@@ -1442,10 +1852,84 @@ Result Compiler::BuildGraphicsPipeline(
     const GraphicsPipelineBuildInfo* pPipelineInfo,     // [in] Info to build this graphics pipeline
     GraphicsPipelineBuildOut*        pPipelineOut,      // [out] Output of building this graphics pipeline
     void*                            pPipelineDumpFile) // [in] Handle of pipeline dump file
+{
+    // Apply the compilation options of this compiler for the duration of the build
+    OptionScope::Guard optionScopeGuard(m_optionScope);
+    if (optionScopeGuard.GetResult() != Result::Success)
+    {
+        return optionScopeGuard.GetResult();
+    }
+
+    return BuildGraphicsPipelineImpl(pPipelineInfo, pPipelineOut, pPipelineDumpFile, nullptr);
+}
+
+// =====================================================================================================================
+// Queues graphics pipelines which are likely to be built later for speculative compilation, see
+// ICompiler::SpeculateGraphicsPipelines.
+Result Compiler::SpeculateGraphicsPipelines(
+    uint32_t                         pipelineCount,     // Count of pipelines
+    const GraphicsPipelineBuildInfo* pPipelineInfos)    // [in] Infos to build the graphics pipelines
+{
+    // Apply the compilation options of this compiler to read the speculation options
+    OptionScope::Guard optionScopeGuard(m_optionScope);
+    if (optionScopeGuard.GetResult() != Result::Success)
+    {
+        return optionScopeGuard.GetResult();
+    }
+
+    for (uint32_t i = 0; i < pipelineCount; ++i)
+    {
+        // Speculation is useless if there is no shader cache to store the result into.
+        if ((cl::SpeculativeCompileThreads > 0) &&
+            ((cl::ShaderCacheMode != ShaderCacheDisable) || (pPipelineInfos[i].pShaderCache != nullptr)))
+        {
+            m_pSpeculator->QueueGraphicsPipeline(&pPipelineInfos[i], cl::SpeculativeCompileThreads);
+        }
+    }
+
+    return Result::Success;
+}
+
+// =====================================================================================================================
+// Queues compute pipelines which are likely to be built later for speculative compilation, see
+// ICompiler::SpeculateGraphicsPipelines.
+Result Compiler::SpeculateComputePipelines(
+    uint32_t                        pipelineCount,      // Count of pipelines
+    const ComputePipelineBuildInfo* pPipelineInfos)     // [in] Infos to build the compute pipelines
+{
+    // Apply the compilation options of this compiler to read the speculation options
+    OptionScope::Guard optionScopeGuard(m_optionScope);
+    if (optionScopeGuard.GetResult() != Result::Success)
+    {
+        return optionScopeGuard.GetResult();
+    }
+
+    for (uint32_t i = 0; i < pipelineCount; ++i)
+    {
+        // Speculation is useless if there is no shader cache to store the result into.
+        if ((cl::SpeculativeCompileThreads > 0) &&
+            ((cl::ShaderCacheMode != ShaderCacheDisable) || (pPipelineInfos[i].pShaderCache != nullptr)))
+        {
+            m_pSpeculator->QueueComputePipeline(&pPipelineInfos[i], cl::SpeculativeCompileThreads);
+        }
+    }
+
+    return Result::Success;
+}
+
+// =====================================================================================================================
+// Build graphics pipeline from the specified info, with the option scope of this compiler active.
+Result Compiler::BuildGraphicsPipelineImpl(
+    const GraphicsPipelineBuildInfo* pPipelineInfo,     // [in] Info to build this graphics pipeline
+    GraphicsPipelineBuildOut*        pPipelineOut,      // [out] Output of building this graphics pipeline
+    void*                            pPipelineDumpFile, // [in] Handle of pipeline dump file
+    LoweredPipeline*                 pLoweredPipeline)  // [in] Pipeline lowered for multiple targets (could be null)
 {
     Result           result = Result::Success;
     BinaryData       elfBin = {};
 
+    TraceScope traceScope("BuildGraphicsPipeline", TraceCategoryPipeline);
+
     const PipelineShaderInfo* shaderInfo[ShaderStageGfxCount] =
     {
         &pPipelineInfo->vs,
@@ -1464,6 +1948,7 @@ Result Compiler::BuildGraphicsPipeline(
     MetroHash::Hash pipelineHash = {};
     cacheHash = PipelineDumper::GenerateHashForGraphicsPipeline(pPipelineInfo, true);
     pipelineHash = PipelineDumper::GenerateHashForGraphicsPipeline(pPipelineInfo, false);
+    traceScope.SetHash(MetroHash::Compact64(&pipelineHash));
 
     if ((result == Result::Success) && EnableOuts())
     {
@@ -1488,7 +1973,7 @@ Result Compiler::BuildGraphicsPipeline(
     {
         std::stringstream strStream;
         strStream << ";Compiler Options: ";
-        for (auto& option : m_options)
+        for (auto& option : m_optionScope.GetOptions())
         {
             strStream << option << " ";
         }
@@ -1496,6 +1981,21 @@ Result Compiler::BuildGraphicsPipeline(
         PipelineDumper::DumpPipelineExtraInfo(reinterpret_cast<PipelineDumpFile*>(pPipelineDumpFile), &extraInfo);
     }
 
+    // Preempt a speculative build of this pipeline, so that this build does not wait for a low-priority thread, unless
+    // it is past lowering. This build then joins it through the shader cache entries it is compiling.
+    if (result == Result::Success)
+    {
+        auto preemptResult = m_pSpeculator->Preempt(MetroHash::Compact64(&cacheHash), pPipelineInfo);
+        if (preemptResult == PipelineSpeculator::PreemptResult::Preempted)
+        {
+            LLPC_OUTS("// LLPC preempted the speculative build of this pipeline\n\n");
+        }
+        else if (preemptResult == PipelineSpeculator::PreemptResult::Joined)
+        {
+            LLPC_OUTS("// LLPC joined the speculative build of this pipeline\n\n");
+        }
+    }
+
     constexpr uint32_t ShaderCacheCount = 2;
     ShaderEntryState cacheEntryState  = ShaderEntryState::New;
     ShaderCache*     pShaderCache[ShaderCacheCount]  = { nullptr, nullptr };
@@ -1508,6 +2008,8 @@ Result Compiler::BuildGraphicsPipeline(
     if (cacheEntryState == ShaderEntryState::Compiling)
     {
         uint32_t                      forceLoopUnrollCount = cl::ForceLoopUnrollCount;
+        const PipelineBuildBudget*    pBudgetInfo = GetPipelineBuildBudget(pPipelineInfo);
+        BuildBudget                   budget(pBudgetInfo);
 
         GraphicsContext graphicsContext(m_gfxIp,
                                         &m_gpuProperty,
@@ -1515,10 +2017,12 @@ Result Compiler::BuildGraphicsPipeline(
                                         pPipelineInfo,
                                         &pipelineHash,
                                         &cacheHash);
+        graphicsContext.SetBuildBudget(&budget);
         result = BuildGraphicsPipelineInternal(&graphicsContext,
                                                shaderInfo,
                                                forceLoopUnrollCount,
-                                               &candidateElf);
+                                               &candidateElf,
+                                               pLoweredPipeline);
 
         if (result == Result::Success)
         {
@@ -1527,6 +2031,36 @@ Result Compiler::BuildGraphicsPipeline(
         }
 
         UpdateShaderCaches((result == Result::Success), &elfBin, pShaderCache, hEntry, ShaderCacheCount);
+
+        // Retry a build which exceeded its time limit with the fast optimization tier. The cache entries have been
+        // reset above, and the retried pipeline is not cached, so that it does not replace the fully optimized one.
+        if ((result == Result::ErrorCanceled) && budget.IsTimedOut() && pBudgetInfo->retryOnTimeout)
+        {
+            PipelineBuildBudget retryBudgetInfo = {};
+            retryBudgetInfo.pCancelToken = pBudgetInfo->pCancelToken;
+            BuildBudget retryBudget(&retryBudgetInfo);
+
+            GraphicsContext retryContext(m_gfxIp,
+                                         &m_gpuProperty,
+                                         &m_gpuWorkarounds,
+                                         pPipelineInfo,
+                                         &pipelineHash,
+                                         &cacheHash);
+            retryContext.SetBuildBudget(&retryBudget);
+            retryContext.SetFastOptTier(true);
+
+            candidateElf.clear();
+            result = BuildGraphicsPipelineInternal(&retryContext,
+                                                   shaderInfo,
+                                                   forceLoopUnrollCount,
+                                                   &candidateElf,
+                                                   nullptr);
+            if (result == Result::Success)
+            {
+                elfBin.codeSize = candidateElf.size();
+                elfBin.pCode = candidateElf.data();
+            }
+        }
     }
 
     if (result == Result::Success)
@@ -1558,7 +2092,9 @@ Result Compiler::BuildComputePipelineInternal(
     ComputeContext*                 pComputeContext,                // [in] Compute context this compute pipeline
     const ComputePipelineBuildInfo* pPipelineInfo,                  // [in] Pipeline info of this compute pipeline
     uint32_t                        forceLoopUnrollCount,           // [in] Force loop unroll count (0 means disable)
-    ElfPackage*                     pPipelineElf)                   // [out] Output Elf package
+    ElfPackage*                     pPipelineElf,                   // [out] Output Elf package
+    LoweredPipeline*                pLoweredPipeline)               // [in] Pipeline lowered for multiple targets
+                                                                    //      (could be null)
 {
     Context* pContext = AcquireContext();
     pContext->AttachPipelineContext(pComputeContext);
@@ -1574,7 +2110,7 @@ Result Compiler::BuildComputePipelineInternal(
         &pPipelineInfo->cs,
     };
 
-    Result result = BuildPipelineInternal(pContext, shaderInfo, forceLoopUnrollCount, pPipelineElf);
+    Result result = BuildPipelineInternal(pContext, shaderInfo, forceLoopUnrollCount, pPipelineElf, pLoweredPipeline);
 
     delete pContext->GetBuilder();
     pContext->SetBuilder(nullptr);
@@ -1588,9 +2124,29 @@ Result Compiler::BuildComputePipeline(
     const ComputePipelineBuildInfo* pPipelineInfo,     // [in] Info to build this compute pipeline
     ComputePipelineBuildOut*        pPipelineOut,      // [out] Output of building this compute pipeline
     void*                           pPipelineDumpFile) // [in] Handle of pipeline dump file
+{
+    // Apply the compilation options of this compiler for the duration of the build
+    OptionScope::Guard optionScopeGuard(m_optionScope);
+    if (optionScopeGuard.GetResult() != Result::Success)
+    {
+        return optionScopeGuard.GetResult();
+    }
+
+    return BuildComputePipelineImpl(pPipelineInfo, pPipelineOut, pPipelineDumpFile, nullptr);
+}
+
+// =====================================================================================================================
+// Build compute pipeline from the specified info, with the option scope of this compiler active.
+Result Compiler::BuildComputePipelineImpl(
+    const ComputePipelineBuildInfo* pPipelineInfo,     // [in] Info to build this compute pipeline
+    ComputePipelineBuildOut*        pPipelineOut,      // [out] Output of building this compute pipeline
+    void*                           pPipelineDumpFile, // [in] Handle of pipeline dump file
+    LoweredPipeline*                pLoweredPipeline)  // [in] Pipeline lowered for multiple targets (could be null)
 {
     BinaryData elfBin = {};
 
+    TraceScope traceScope("BuildComputePipeline", TraceCategoryPipeline);
+
 #if LLPC_CLIENT_INTERFACE_MAJOR_VERSION < 32
     // NOTE: It is to workaround the bug in Device::CreateInternalComputePipeline,
     // we forgot to set the entryStage in it. To keep backward compatibility, set the entryStage within LLPC.
@@ -1603,6 +2159,7 @@ Result Compiler::BuildComputePipeline(
     MetroHash::Hash pipelineHash = {};
     cacheHash = PipelineDumper::GenerateHashForComputePipeline(pPipelineInfo, true);
     pipelineHash = PipelineDumper::GenerateHashForComputePipeline(pPipelineInfo, false);
+    traceScope.SetHash(MetroHash::Compact64(&pipelineHash));
 
     if ((result == Result::Success) && EnableOuts())
     {
@@ -1620,7 +2177,7 @@ Result Compiler::BuildComputePipeline(
     {
         std::stringstream strStream;
         strStream << ";Compiler Options: ";
-        for (auto& option : m_options)
+        for (auto& option : m_optionScope.GetOptions())
         {
             strStream << option << " ";
         }
@@ -1628,6 +2185,21 @@ Result Compiler::BuildComputePipeline(
         PipelineDumper::DumpPipelineExtraInfo(reinterpret_cast<PipelineDumpFile*>(pPipelineDumpFile), &extraInfo);
     }
 
+    // Preempt a speculative build of this pipeline, so that this build does not wait for a low-priority thread, unless
+    // it is past lowering. This build then joins it through the shader cache entries it is compiling.
+    if (result == Result::Success)
+    {
+        auto preemptResult = m_pSpeculator->Preempt(MetroHash::Compact64(&cacheHash), pPipelineInfo);
+        if (preemptResult == PipelineSpeculator::PreemptResult::Preempted)
+        {
+            LLPC_OUTS("// LLPC preempted the speculative build of this pipeline\n\n");
+        }
+        else if (preemptResult == PipelineSpeculator::PreemptResult::Joined)
+        {
+            LLPC_OUTS("// LLPC joined the speculative build of this pipeline\n\n");
+        }
+    }
+
     constexpr uint32_t ShaderCacheCount = 2;
     ShaderEntryState cacheEntryState  = ShaderEntryState::New;
     ShaderCache*     pShaderCache[ShaderCacheCount]  = { nullptr, nullptr };
@@ -1640,6 +2212,8 @@ Result Compiler::BuildComputePipeline(
     if (cacheEntryState == ShaderEntryState::Compiling)
     {
         uint32_t                      forceLoopUnrollCount = cl::ForceLoopUnrollCount;
+        const PipelineBuildBudget*    pBudgetInfo = GetPipelineBuildBudget(pPipelineInfo);
+        BuildBudget                   budget(pBudgetInfo);
 
         ComputeContext computeContext(m_gfxIp,
                                       &m_gpuProperty,
@@ -1647,11 +2221,13 @@ Result Compiler::BuildComputePipeline(
                                       pPipelineInfo,
                                       &pipelineHash,
                                       &cacheHash);
+        computeContext.SetBuildBudget(&budget);
 
         result = BuildComputePipelineInternal(&computeContext,
                                               pPipelineInfo,
                                               forceLoopUnrollCount,
-                                              &candidateElf);
+                                              &candidateElf,
+                                              pLoweredPipeline);
 
         if (result == Result::Success)
         {
@@ -1660,6 +2236,36 @@ Result Compiler::BuildComputePipeline(
         }
 
         UpdateShaderCaches((result == Result::Success), &elfBin, pShaderCache, hEntry, ShaderCacheCount);
+
+        // Retry a build which exceeded its time limit with the fast optimization tier. The cache entries have been
+        // reset above, and the retried pipeline is not cached, so that it does not replace the fully optimized one.
+        if ((result == Result::ErrorCanceled) && budget.IsTimedOut() && pBudgetInfo->retryOnTimeout)
+        {
+            PipelineBuildBudget retryBudgetInfo = {};
+            retryBudgetInfo.pCancelToken = pBudgetInfo->pCancelToken;
+            BuildBudget retryBudget(&retryBudgetInfo);
+
+            ComputeContext retryContext(m_gfxIp,
+                                        &m_gpuProperty,
+                                        &m_gpuWorkarounds,
+                                        pPipelineInfo,
+                                        &pipelineHash,
+                                        &cacheHash);
+            retryContext.SetBuildBudget(&retryBudget);
+            retryContext.SetFastOptTier(true);
+
+            candidateElf.clear();
+            result = BuildComputePipelineInternal(&retryContext,
+                                                  pPipelineInfo,
+                                                  forceLoopUnrollCount,
+                                                  &candidateElf,
+                                                  nullptr);
+            if (result == Result::Success)
+            {
+                elfBin.codeSize = candidateElf.size();
+                elfBin.pCode = candidateElf.data();
+            }
+        }
     }
 
     if (result == Result::Success)
@@ -1691,6 +2297,263 @@ Result Compiler::BuildComputePipeline(
     return result;
 }
 
+// =====================================================================================================================
+// Translates and lowers a pipeline in a context of this compiler, for a multi-target build. Returns the bitcode of the
+// linked pipeline module and the serialized resource usage of each shader stage.
+Result Compiler::BuildLoweredPipeline(
+    PipelineContext*                    pPipelineContext,   // [in] Pipeline context of this compiler
+    ArrayRef<const PipelineShaderInfo*> shaderInfo,         // [in] Shader info of this pipeline
+    std::string*                        pBitcode,           // [out] Bitcode of the linked pipeline module
+    std::string*                        pResUsages)         // [out] Serialized resource usage of each shader stage
+{
+    TraceScope traceScope("BuildLoweredPipeline", TraceCategoryPipeline);
+
+    Context* pContext = AcquireContext();
+    pContext->AttachPipelineContext(pPipelineContext);
+    pContext->SetBuilder(Builder::Create(*pContext));
+
+    uint32_t passIndex = 0;
+    TimerProfiler timerProfiler(pContext->GetPiplineHashCode(), "LLPC", TimerProfiler::PipelineTimerEnableMask);
+
+    pContext->setDiagnosticHandler(std::make_unique<LlpcDiagnosticHandler>());
+
+    // The modules need a target machine, although lowering does not depend on the target.
+    Result result = CodeGenManager::CreateTargetMachine(pContext, pPipelineContext->GetPipelineOptions());
+
+    Module* pPipelineModule = nullptr;
+    if (result == Result::Success)
+    {
+        pPipelineContext->DoUserDataNodeMerge();
+        result = LowerPipeline(pContext,
+                               shaderInfo,
+                               cl::ForceLoopUnrollCount,
+                               timerProfiler,
+                               &passIndex,
+                               &pPipelineModule);
+    }
+
+    if (result == Result::Success)
+    {
+        raw_string_ostream bitcodeStream(*pBitcode);
+        WriteBitcodeToFile(*pPipelineModule, bitcodeStream);
+        bitcodeStream.flush();
+
+        const uint32_t stageMask = pContext->GetShaderStageMask();
+        for (uint32_t stage = 0; stage < ShaderStageNativeStageCount; ++stage)
+        {
+            if (stageMask & ShaderStageToMask(static_cast<ShaderStage>(stage)))
+            {
+                SerializeResourceUsage(*(pContext->GetShaderResourceUsage(static_cast<ShaderStage>(stage))),
+                                       &pResUsages[stage]);
+            }
+        }
+    }
+
+    delete pPipelineModule;
+    pContext->setDiagnosticHandlerCallBack(nullptr);
+
+    delete pContext->GetBuilder();
+    pContext->SetBuilder(nullptr);
+    ReleaseContext(pContext);
+    return result;
+}
+
+// =====================================================================================================================
+// Checks the target compilers of a multi-target build. The pipeline is lowered once with the options of this compiler,
+// so each target compiler must have been created with the same options.
+Result Compiler::CheckTargetCompilers(
+    uint32_t          targetCount,          // Count of targets
+    ICompiler*const*  ppTargetCompilers     // [in] Compilers of the targets
+    ) const
+{
+    Result result = ((targetCount > 0) && (ppTargetCompilers != nullptr)) ? Result::Success :
+                                                                            Result::ErrorInvalidValue;
+
+    for (uint32_t i = 0; (i < targetCount) && (result == Result::Success); ++i)
+    {
+        auto pTargetCompiler = static_cast<const Compiler*>(ppTargetCompilers[i]);
+        if ((pTargetCompiler == nullptr) ||
+            (memcmp(&pTargetCompiler->m_optionScope.GetHash(), &m_optionScope.GetHash(), sizeof(MetroHash::Hash)) != 0))
+        {
+            LLPC_ERRS("Target compilers of a multi-target build must be created with the same options\n");
+            result = Result::ErrorInvalidValue;
+        }
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Runs the build of each target of a multi-target build on its own thread. Returns the first failure, if any.
+static Result BuildTargetsInParallel(
+    uint32_t                        targetCount,    // Count of targets
+    std::function<Result(uint32_t)> buildTarget)    // Builds the target with the specified index
+{
+    std::vector<Result> results(targetCount, Result::Success);
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < targetCount; ++i)
+    {
+        threads.push_back(std::thread([&results, &buildTarget, i] { results[i] = buildTarget(i); }));
+    }
+
+    Result result = Result::Success;
+    for (uint32_t i = 0; i < targetCount; ++i)
+    {
+        threads[i].join();
+        if ((result == Result::Success) && (results[i] != Result::Success))
+        {
+            result = results[i];
+        }
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Builds a graphics pipeline for several targets. SPIR-V translation and lowering are done once, in a context of this
+// compiler, when the first target misses its shader caches. Patching and code generation are done by the compiler of
+// each target in parallel, and the result is stored in the shader cache of that compiler.
+Result Compiler::BuildGraphicsPipelineMultiTarget(
+    const GraphicsPipelineBuildInfo* pPipelineInfo,     // [in] Info to build this graphics pipeline
+    uint32_t                         targetCount,       // Count of targets
+    ICompiler*const*                 ppTargetCompilers, // [in] Compilers of the targets
+    GraphicsPipelineBuildOut*        pPipelineOuts)     // [out] Outputs of building this pipeline, one per target
+{
+    // Apply the compilation options of this compiler, which are those of all targets, for the duration of the build
+    OptionScope::Guard optionScopeGuard(m_optionScope);
+    Result result = optionScopeGuard.GetResult();
+
+    if (result == Result::Success)
+    {
+        result = CheckTargetCompilers(targetCount, ppTargetCompilers);
+    }
+
+    if (result == Result::Success)
+    {
+        // NOTE: The app's pipeline cache is created for a single target, so only the internal shader cache of each
+        // target is used.
+        GraphicsPipelineBuildInfo pipelineInfo = *pPipelineInfo;
+        pipelineInfo.pShaderCache = nullptr;
+
+        MetroHash::Hash cacheHash = PipelineDumper::GenerateHashForGraphicsPipeline(&pipelineInfo, true);
+        MetroHash::Hash pipelineHash = PipelineDumper::GenerateHashForGraphicsPipeline(&pipelineInfo, false);
+
+        LoweredPipeline loweredPipeline([&](std::string* pBitcode, std::string* pResUsages)
+        {
+            // NOTE: Lowering is shared by all targets, so it is canceled with the build, rather than with a target.
+            BuildBudget budget(GetPipelineBuildBudget(&pipelineInfo));
+
+            GraphicsContext graphicsContext(m_gfxIp,
+                                            &m_gpuProperty,
+                                            &m_gpuWorkarounds,
+                                            &pipelineInfo,
+                                            &pipelineHash,
+                                            &cacheHash);
+            graphicsContext.SetBuildBudget(&budget);
+
+            const PipelineShaderInfo* shaderInfo[ShaderStageGfxCount] =
+            {
+                &pipelineInfo.vs,
+                &pipelineInfo.tcs,
+                &pipelineInfo.tes,
+                &pipelineInfo.gs,
+                &pipelineInfo.fs,
+            };
+
+            return BuildLoweredPipeline(&graphicsContext, shaderInfo, pBitcode, pResUsages);
+        });
+
+        // NOTE: Without recording and replaying Builder calls, lowering generates IR for the target of the compiler
+        // that does it, so each target then lowers the pipeline itself.
+        LoweredPipeline* pLoweredPipeline = Builder::IsRecordAndReplay() ? &loweredPipeline : nullptr;
+
+        result = BuildTargetsInParallel(targetCount,
+                                        [&](uint32_t targetIndex)
+                                        {
+                                            auto pTargetCompiler = static_cast<Compiler*>(ppTargetCompilers[targetIndex]);
+                                            return pTargetCompiler->BuildGraphicsPipelineImpl(&pipelineInfo,
+                                                                                              &pPipelineOuts[targetIndex],
+                                                                                              nullptr,
+                                                                                              pLoweredPipeline);
+                                        });
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Builds a compute pipeline for several targets. SPIR-V translation and lowering are done once, in a context of this
+// compiler, when the first target misses its shader caches. Patching and code generation are done by the compiler of
+// each target in parallel, and the result is stored in the shader cache of that compiler.
+Result Compiler::BuildComputePipelineMultiTarget(
+    const ComputePipelineBuildInfo* pPipelineInfo,      // [in] Info to build this compute pipeline
+    uint32_t                        targetCount,        // Count of targets
+    ICompiler*const*                ppTargetCompilers,  // [in] Compilers of the targets
+    ComputePipelineBuildOut*        pPipelineOuts)      // [out] Outputs of building this pipeline, one per target
+{
+    // Apply the compilation options of this compiler, which are those of all targets, for the duration of the build
+    OptionScope::Guard optionScopeGuard(m_optionScope);
+    Result result = optionScopeGuard.GetResult();
+
+    if (result == Result::Success)
+    {
+        result = CheckTargetCompilers(targetCount, ppTargetCompilers);
+    }
+
+    if (result == Result::Success)
+    {
+        // NOTE: The app's pipeline cache is created for a single target, so only the internal shader cache of each
+        // target is used.
+        ComputePipelineBuildInfo pipelineInfo = *pPipelineInfo;
+        pipelineInfo.pShaderCache = nullptr;
+
+        MetroHash::Hash cacheHash = PipelineDumper::GenerateHashForComputePipeline(&pipelineInfo, true);
+        MetroHash::Hash pipelineHash = PipelineDumper::GenerateHashForComputePipeline(&pipelineInfo, false);
+
+        LoweredPipeline loweredPipeline([&](std::string* pBitcode, std::string* pResUsages)
+        {
+            // NOTE: Lowering is shared by all targets, so it is canceled with the build, rather than with a target.
+            BuildBudget budget(GetPipelineBuildBudget(&pipelineInfo));
+
+            ComputeContext computeContext(m_gfxIp,
+                                          &m_gpuProperty,
+                                          &m_gpuWorkarounds,
+                                          &pipelineInfo,
+                                          &pipelineHash,
+                                          &cacheHash);
+            computeContext.SetBuildBudget(&budget);
+
+            const PipelineShaderInfo* shaderInfo[ShaderStageNativeStageCount] =
+            {
+                nullptr,
+                nullptr,
+                nullptr,
+                nullptr,
+                nullptr,
+                &pipelineInfo.cs,
+            };
+
+            return BuildLoweredPipeline(&computeContext, shaderInfo, pBitcode, pResUsages);
+        });
+
+        // NOTE: Without recording and replaying Builder calls, lowering generates IR for the target of the compiler
+        // that does it, so each target then lowers the pipeline itself.
+        LoweredPipeline* pLoweredPipeline = Builder::IsRecordAndReplay() ? &loweredPipeline : nullptr;
+
+        result = BuildTargetsInParallel(targetCount,
+                                        [&](uint32_t targetIndex)
+                                        {
+                                            auto pTargetCompiler = static_cast<Compiler*>(ppTargetCompilers[targetIndex]);
+                                            return pTargetCompiler->BuildComputePipelineImpl(&pipelineInfo,
+                                                                                             &pPipelineOuts[targetIndex],
+                                                                                             nullptr,
+                                                                                             pLoweredPipeline);
+                                        });
+    }
+
+    return result;
+}
+
 // =====================================================================================================================
 // Translates SPIR-V binary to machine-independent LLVM module.
 void Compiler::TranslateSpirvToLlvm(
@@ -1850,6 +2713,10 @@ MetroHash::Hash Compiler::GenerateHashForCompileOptions(
         cl::LogFileOuts.ArgStr,
         cl::EnableShadowDescriptorTable.ArgStr,
         cl::ShadowDescTablePtrHigh.ArgStr,
+        cl::TraceFile.ArgStr,
+        cl::TraceSampleRate.ArgStr,
+        cl::SpeculativeCompileThreads.ArgStr,
+        cl::LoweredStageCacheSize.ArgStr,
     };
 
     std::set<StringRef> effectingOptions;
@@ -1943,7 +2810,7 @@ Result Compiler::CreateShaderCache(
     ShaderCacheAuxCreateInfo auxCreateInfo = {};
     auxCreateInfo.shaderCacheMode = ShaderCacheMode::ShaderCacheEnableRuntime;
     auxCreateInfo.gfxIp           = m_gfxIp;
-    auxCreateInfo.hash            = m_optionHash;
+    auxCreateInfo.hash            = m_optionScope.GetHash();
 
     ShaderCache* pShaderCache = new ShaderCache();
 
@@ -2216,6 +3083,7 @@ void Compiler::InitGpuWorkaround()
 // Acquires a free context from context pool.
 Context* Compiler::AcquireContext() const
 {
+    TraceScope traceScope("AcquireContext", TraceCategoryContext);
     Context* pFreeContext = nullptr;
 
     std::lock_guard<sys::Mutex> lock(m_contextPoolMutex);
@@ -2494,6 +3362,7 @@ void Compiler::GetPipelineStatistics(
     pPipelineStats->numUsedVgprs        = 0;
     pPipelineStats->useScratchBuffer    = false;
     pPipelineStats->sgprSpill           = false;
+    memset(pPipelineStats->waveSize, 0, sizeof(pPipelineStats->waveSize));
 
     uint32_t sectionCount = reader.GetSectionCount();
     for (uint32_t secIdx = 0; secIdx < sectionCount; ++secIdx)
@@ -2526,6 +3395,23 @@ void Compiler::GetPipelineStatistics(
                                                           .getArray(true)[0]
                                                           .getMap(true)[Util::Abi::PipelineMetadataKey::HardwareStages]
                                                           .getMap(true);
+#if LLPC_BUILD_GFX10 && (PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 495)
+                        // Record the wave size of every hardware stage present in the pipeline.
+                        for (uint32_t hwStage = 0; hwStage < uint32_t(Util::Abi::HardwareStage::Count); ++hwStage)
+                        {
+                            auto hwStageIt = hwStages.find(HwStageNames[hwStage]);
+                            if (hwStageIt != hwStages.end())
+                            {
+                                auto node = hwStageIt->second.getMap(true)
+                                                [Util::Abi::HardwareStageMetadataKey::WavefrontSize];
+                                if (node.getKind() == msgpack::Type::UInt)
+                                {
+                                    pPipelineStats->waveSize[hwStage] = node.getUInt();
+                                }
+                            }
+                        }
+#endif
+
                         auto stageIt = hwStages.find(".ps");
                         if (stageIt == hwStages.end())
                         {
@@ -2623,6 +3509,9 @@ ShaderEntryState Compiler::LookUpShaderCaches(
     CacheEntryHandle*                phEntry            // [in]    Array of handles of the shader caches entry
     )
 {
+    TraceScope traceScope("LookUpShaderCaches", TraceCategoryCache);
+    traceScope.SetHash(MetroHash::Compact64(pCacheHash));
+
     ShaderEntryState cacheEntryState  = ShaderEntryState::New;
     uint32_t         shaderCacheCount = 1;
     Result           result           = Result::Success;
@@ -2708,12 +3597,17 @@ void Compiler::UpdateShaderCaches(
 // =====================================================================================================================
 // Builds hash code from input context for per shader stage cache
 void Compiler::BuildShaderCacheHash(
-    Context*         pContext,           // [in] Acquired context
-    MetroHash::Hash* pFragmentHash,      // [out] Hash code of fragment shader
-    MetroHash::Hash* pNonFragmentHash)   // [out] Hash code of all non-fragment shader
+    Context*         pContext,              // [in] Acquired context
+    MetroHash::Hash* pFragmentHash,         // [out] Hash code of fragment shader
+    MetroHash::Hash* pNonFragmentHash,      // [out] Hash code of all non-fragment shader
+    MetroHash::Hash* pFragmentBodyHash,     // [out] Hash code of patched fragment shader, excluding color target
+                                            //       formats and blend state (used in color export epilog mode)
+    MetroHash::Hash* pNonFragmentBodyHash)  // [out] Hash code of all patched non-fragment shader, excluding vertex
+                                            //       input state (used in vertex fetch prolog mode)
 {
     MetroHash64 fragmentHasher;
     MetroHash64 nonFragmentHasher;
+    MetroHash64 nonFragmentBodyHasher;
     auto stageMask = pContext->GetShaderStageMask();
     auto pPipelineInfo = reinterpret_cast<const GraphicsPipelineBuildInfo*>(pContext->GetPipelineBuildInfo());
     auto pPipelineOptions = pContext->GetPipelineContext()->GetPipelineOptions();
@@ -2744,6 +3638,11 @@ void Compiler::BuildShaderCacheHash(
         PipelineDumper::UpdateHashForMap(pResUsage->inOutUsage.perPatchBuiltInInputLocMap, &hasher);
         PipelineDumper::UpdateHashForMap(pResUsage->inOutUsage.perPatchBuiltInOutputLocMap, &hasher);
 
+        // NOTE: With packed inputs/outputs, the component placement of the FS inputs decides the export channels of
+        // the previous stage, so a cached VS/TES can only be reused with the same FS component layout.
+        PipelineDumper::UpdateHashForMap(pResUsage->inOutUsage.inputCompMap, &hasher);
+        PipelineDumper::UpdateHashForMap(pResUsage->inOutUsage.outputCompMap, &hasher);
+
         if (stage == ShaderStageGeometry)
         {
             // NOTE: For geometry shader, copy shader will use this special map info (from built-in outputs to
@@ -2752,8 +3651,13 @@ void Compiler::BuildShaderCacheHash(
         }
 
         // Update vertex input state
+        MetroHash::Hash  bodyHash = {};
         if (stage == ShaderStageVertex)
         {
+            // NOTE: In vertex fetch prolog mode, the patched vertex shader does not depend on vertex input state.
+            MetroHash64 bodyHasher = hasher;
+            bodyHasher.Finalize(bodyHash.bytes);
+
             PipelineDumper::UpdateHashForVertexInputState(pPipelineInfo->pVertexInput, &hasher);
         }
 
@@ -2769,6 +3673,8 @@ void Compiler::BuildShaderCacheHash(
         else
         {
             nonFragmentHasher.Update(shaderHashCode);
+            nonFragmentBodyHasher.Update((stage == ShaderStageVertex) ? MetroHash::Compact64(&bodyHash) :
+                                                                        shaderHashCode);
         }
     }
 
@@ -2791,7 +3697,15 @@ void Compiler::BuildShaderCacheHash(
 #if (LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 25) && (LLPC_CLIENT_INTERFACE_MAJOR_VERSION < 27)
         fragmentHasher.Update(pPipelineOptions->includeIrBinary);
 #endif
-        PipelineDumper::UpdateHashForFragmentState(pPipelineInfo, &fragmentHasher);
+
+        // NOTE: The patched fragment shader is cached as LLVM bitcode, so its hash must differ from the hash of the
+        // fragment ELF.
+        MetroHash64 fragmentBodyHasher = fragmentHasher;
+        PipelineDumper::UpdateHashForFragmentState(pPipelineInfo, false, &fragmentBodyHasher);
+        fragmentBodyHasher.Update(LlvmIrBitcodeMagic);
+        fragmentBodyHasher.Finalize(pFragmentBodyHash->bytes);
+
+        PipelineDumper::UpdateHashForFragmentState(pPipelineInfo, true, &fragmentHasher);
         fragmentHasher.Finalize(pFragmentHash->bytes);
     }
 
@@ -2799,6 +3713,12 @@ void Compiler::BuildShaderCacheHash(
     {
         PipelineDumper::UpdateHashForNonFragmentState(pPipelineInfo, true, &nonFragmentHasher);
         nonFragmentHasher.Finalize(pNonFragmentHash->bytes);
+
+        // NOTE: The patched non-fragment shaders are cached as LLVM bitcode, so their hash must differ from the hash
+        // of the non-fragment ELF even when the vertex shader has no inputs.
+        PipelineDumper::UpdateHashForNonFragmentState(pPipelineInfo, true, &nonFragmentBodyHasher);
+        nonFragmentBodyHasher.Update(LlvmIrBitcodeMagic);
+        nonFragmentBodyHasher.Finalize(pNonFragmentBodyHash->bytes);
     }
 }
 
@@ -2810,6 +3730,8 @@ void Compiler::MergeElfBinary(
     const BinaryData* pNonFragmentElf, // [in] ELF binary of non-fragment shaders
     ElfPackage*       pPipelineElf)    // [out] Final ELF binary
 {
+    TraceScope traceScope("MergeElfBinary", TraceCategoryElf);
+
     auto FragmentIsaSymbolName =
         Util::Abi::PipelineAbiSymbolNameStrings[static_cast<uint32_t>(Util::Abi::PipelineSymbolType::PsMainEntry)];
     auto FragmentIntrlTblSymbolName =
@@ -2962,51 +3884,44 @@ void Compiler::MergeElfBinary(
         writer.SetSection(nonFragmentDisassemblySecIndex, &newSection);
     }
 
-    // Merge LLVM IR disassemble
-    const std::string LlvmIrSectionName = std::string(Util::Abi::AmdGpuCommentLlvmIrName);
+    // Merge LLVM IR bitcode records
     ElfSectionBuffer<Elf64::SectionHeader>* pFragmentLlvmIrSection = nullptr;
     const ElfSectionBuffer<Elf64::SectionHeader>* pNonFragmentLlvmIrSection = nullptr;
 
-    auto fragmentLlvmIrSecIndex = reader.GetSectionIndex(LlvmIrSectionName.c_str());
-    auto nonFragmentLlvmIrSecIndex = writer.GetSectionIndex(LlvmIrSectionName.c_str());
+    auto fragmentLlvmIrSecIndex = reader.GetSectionIndex(LlvmIrBitcodeName);
+    auto nonFragmentLlvmIrSecIndex = writer.GetSectionIndex(LlvmIrBitcodeName);
     reader.GetSectionDataBySectionIndex(fragmentLlvmIrSecIndex, &pFragmentLlvmIrSection);
     writer.GetSectionDataBySectionIndex(nonFragmentLlvmIrSecIndex, &pNonFragmentLlvmIrSection);
 
-    if (pNonFragmentLlvmIrSection != nullptr)
+    if (pFragmentLlvmIrSection != nullptr)
     {
-        LLPC_ASSERT(pFragmentLlvmIrSection != nullptr);
-
-        // NOTE: We have to replace last character with null terminator and restore it afterwards. Otherwise, the
-        // text search will be incorrect. It is only needed for ElfReader, ElfWriter always append a null terminator
-        // for all section data.
-        auto pFragmentLlvmIrSectionEnd = pFragmentLlvmIrSection->pData +
-                                         pFragmentLlvmIrSection->secHead.sh_size - 1;
-        uint8_t lastChar = *pFragmentLlvmIrSectionEnd;
-        const_cast<uint8_t*>(pFragmentLlvmIrSectionEnd)[0] = '\0';
-        auto pFragmentLlvmIrStart = strstr(reinterpret_cast<const char*>(pFragmentLlvmIrSection->pData),
-                                           FragmentIsaSymbolName);
-        const_cast<uint8_t*>(pFragmentLlvmIrSectionEnd)[0] = lastChar;
-
-        auto fragmentLlvmIrOffset =
-            (pFragmentLlvmIrStart == nullptr) ?
-            0 :
-            (pFragmentLlvmIrStart - reinterpret_cast<const char*>(pFragmentLlvmIrSection->pData));
-
-        auto pLlvmIrEnd = strstr(reinterpret_cast<const char*>(pNonFragmentLlvmIrSection->pData),
-                                 FragmentIsaSymbolName);
-        auto llvmIrSize = (pLlvmIrEnd == nullptr) ?
-                          pNonFragmentLlvmIrSection->secHead.sh_size :
-                          pLlvmIrEnd - reinterpret_cast<const char*>(pNonFragmentLlvmIrSection->pData);
+        // NOTE: Bitcode records cannot be merged, so the records of the fragment ELF are appended to those of the
+        // non-fragment ELF.
+        std::vector<uint8_t> llvmIrRecords;
+        if (pNonFragmentLlvmIrSection != nullptr)
+        {
+            llvmIrRecords.insert(llvmIrRecords.end(),
+                                 pNonFragmentLlvmIrSection->pData,
+                                 pNonFragmentLlvmIrSection->pData + pNonFragmentLlvmIrSection->secHead.sh_size);
+        }
+        llvmIrRecords.insert(llvmIrRecords.end(),
+                             pFragmentLlvmIrSection->pData,
+                             pFragmentLlvmIrSection->pData + pFragmentLlvmIrSection->secHead.sh_size);
 
-        ElfSectionBuffer<Elf64::SectionHeader> newSection = {};
-        writer.MergeSection(pNonFragmentLlvmIrSection,
-                            llvmIrSize,
-                            firstIsaSymbolName.c_str(),
-                            pFragmentLlvmIrSection,
-                            fragmentLlvmIrOffset,
-                            FragmentIsaSymbolName,
-                            &newSection);
-        writer.SetSection(nonFragmentLlvmIrSecIndex, &newSection);
+        if (pNonFragmentLlvmIrSection != nullptr)
+        {
+            ElfSectionBuffer<Elf64::SectionHeader> newSection = *pNonFragmentLlvmIrSection;
+            auto pData = new uint8_t[llvmIrRecords.size() + 1];
+            memcpy(pData, llvmIrRecords.data(), llvmIrRecords.size());
+            pData[llvmIrRecords.size()] = 0;
+            newSection.pData = pData;
+            newSection.secHead.sh_size = llvmIrRecords.size();
+            writer.SetSection(nonFragmentLlvmIrSecIndex, &newSection);
+        }
+        else
+        {
+            writer.AddSection(LlvmIrBitcodeName, llvmIrRecords.data(), llvmIrRecords.size());
+        }
     }
 
     // Merge PAL metadata
@@ -3023,4 +3938,65 @@ void Compiler::MergeElfBinary(
     writer.WriteToBuffer(pPipelineElf);
 }
 
+// =====================================================================================================================
+// Rewrites the pipeline hash and cache hash in the PAL metadata of the specified module with those of the pipeline being
+// built. This is needed for a patched module loaded from the shader cache, whose PAL metadata was written for the
+// pipeline that was patched first.
+void Compiler::UpdatePalMetadataPipelineHash(
+    Context*      pContext,     // [in] Pipeline context
+    Module*       pModule)      // [in,out] Patched module with PAL metadata
+{
+    auto pNamedMeta = pModule->getNamedMetadata("amdgpu.pal.metadata.msgpack");
+    if ((pNamedMeta == nullptr) || (pNamedMeta->getNumOperands() == 0))
+    {
+        LLPC_NEVER_CALLED();
+        return;
+    }
+
+    auto pAbiMetaString = cast<MDString>(pNamedMeta->getOperand(0)->getOperand(0));
+    msgpack::Document document;
+    if (document.readFromBlob(pAbiMetaString->getString(), false) == false)
+    {
+        LLPC_NEVER_CALLED();
+        return;
+    }
+
+    auto pipelineNode = document.getRoot().getMap(true)[Util::Abi::PalCodeObjectMetadataKey::Pipelines]
+                                          .getArray(true)[0].getMap(true);
+    auto pipelineHashNode = pipelineNode[Util::Abi::PipelineMetadataKey::InternalPipelineHash].getArray(true);
+    pipelineHashNode[0] = document.getNode(pContext->GetPiplineHashCode());
+    pipelineHashNode[1] = document.getNode(pContext->GetCacheHashCode());
+
+    std::string blob;
+    document.writeToBlob(blob);
+    auto pAbiMetaNode = MDNode::get(pModule->getContext(), MDString::get(pModule->getContext(), blob));
+    pNamedMeta->setOperand(0, pAbiMetaNode);
+}
+
+// =====================================================================================================================
+// Attaches an LLVM IR bitcode record to the ELF binary generated by codegen, as the ".AMDGPU.llvmbc" section.
+Result Compiler::AttachLlvmIrBitcode(
+    ArrayRef<uint8_t> bitcodeRecord,    // LLVM IR bitcode record (LlvmIrBitcodeHeader and bitcode)
+    ElfPackage*       pPipelineElf      // [in,out] ELF binary generated by codegen
+    ) const
+{
+    // NOTE: Codegen does not output an ELF binary with -filetype=asm, and there is nothing to attach to then.
+    if (IsElfBinary(pPipelineElf->data(), pPipelineElf->size()) == false)
+    {
+        return Result::Success;
+    }
+
+    ElfWriter<Elf64> writer(m_gfxIp);
+    Result result = writer.ReadFromBuffer(pPipelineElf->data(), pPipelineElf->size());
+    if (result == Result::Success)
+    {
+        writer.AddSection(LlvmIrBitcodeName, bitcodeRecord.data(), bitcodeRecord.size());
+
+        ElfPackage newPipelineElf;
+        writer.WriteToBuffer(&newPipelineElf);
+        *pPipelineElf = std::move(newPipelineElf);
+    }
+    return result;
+}
+
 } // Llpc
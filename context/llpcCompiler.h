@@ -30,11 +30,17 @@
  */
 #pragma once
 
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
 #include "llpc.h"
 #include "llpcDebug.h"
 #include "llpcElfReader.h"
 #include "llpcInternal.h"
 #include "llpcMetroHash.h"
+#include "llpcOptionScope.h"
 #include "llpcShaderCacheManager.h"
 
 namespace Llpc
@@ -46,6 +52,10 @@ class ComputeContext;
 class Context;
 class GraphicsContext;
 class PassManager;
+class PipelineContext;
+class PipelineSpeculator;
+class TimerProfiler;
+struct ResourceUsage;
 
 // Enumerates types of shader binary.
 enum class BinaryType : uint32_t
@@ -208,6 +218,52 @@ struct PipelineStatistics
     uint32_t    numAvailVgprs;      // Number of available VGPRs
     bool        sgprSpill;          // Has SGPR spill
     bool        useScratchBuffer;   // Whether scratch buffer is used
+    uint32_t    waveSize[uint32_t(Util::Abi::HardwareStage::Count)]; // Wave size of each hardware stage, in
+                                                                     // Util::Abi::HardwareStage order (0 if the
+                                                                     // stage is absent or the size is not recorded)
+};
+
+// =====================================================================================================================
+// Represents a pipeline after SPIR-V translation and lowering, which do not depend on the target GPU, serialized so
+// that it can be patched and compiled in the context of any target. The pipeline is lowered on first use, so nothing
+// is lowered if every target finds the pipeline in its shader caches.
+class LoweredPipeline
+{
+public:
+    // Function translating and lowering the pipeline, which returns the bitcode of the linked pipeline module and the
+    // serialized resource usage of each shader stage
+    typedef std::function<Result(std::string* pBitcode, std::string* pResUsages)> LowerFunc;
+
+    LoweredPipeline(LowerFunc lowerFunc) : m_lowerFunc(lowerFunc), m_lowered(false), m_result(Result::Success) {}
+
+    // Lowers the pipeline unless it has been lowered already, and returns the result
+    Result Lower()
+    {
+        std::lock_guard<std::mutex> lock(m_lowerMutex);
+        if (m_lowered == false)
+        {
+            m_result = m_lowerFunc(&m_bitcode, m_resUsages);
+            m_lowered = true;
+        }
+        return m_result;
+    }
+
+    // Gets the bitcode of the linked pipeline module
+    llvm::StringRef GetBitcode() const { return m_bitcode; }
+
+    // Gets the serialized resource usage of the specified shader stage (empty if the stage is not present)
+    const std::string& GetResourceUsage(ShaderStage stage) const { return m_resUsages[stage]; }
+
+private:
+    LLPC_DISALLOW_DEFAULT_CTOR(LoweredPipeline);
+    LLPC_DISALLOW_COPY_AND_ASSIGN(LoweredPipeline);
+
+    LowerFunc     m_lowerFunc;                                // Function translating and lowering the pipeline
+    std::mutex    m_lowerMutex;                               // Mutex serializing lowering
+    bool          m_lowered;                                  // Whether the pipeline has been lowered
+    Result        m_result;                                   // Result of lowering
+    std::string   m_bitcode;                                  // Bitcode of the linked pipeline module
+    std::string   m_resUsages[ShaderStageNativeStageCount];   // Serialized resource usage of each shader stage
 };
 
 // =====================================================================================================================
@@ -215,7 +271,7 @@ struct PipelineStatistics
 class Compiler: public ICompiler
 {
 public:
-    Compiler(GfxIpVersion gfxIp, uint32_t optionCount, const char*const* pOptions, MetroHash::Hash optionHash);
+    Compiler(GfxIpVersion gfxIp, const OptionScope& optionScope);
     ~Compiler();
 
     virtual void VKAPI_CALL Destroy();
@@ -230,20 +286,40 @@ public:
     virtual Result BuildComputePipeline(const ComputePipelineBuildInfo* pPipelineInfo,
                                         ComputePipelineBuildOut*        pPipelineOut,
                                         void*                           pPipelineDumpFile = nullptr);
+
+    virtual Result BuildGraphicsPipelineMultiTarget(const GraphicsPipelineBuildInfo* pPipelineInfo,
+                                                    uint32_t                         targetCount,
+                                                    ICompiler*const*                 ppTargetCompilers,
+                                                    GraphicsPipelineBuildOut*        pPipelineOuts);
+
+    virtual Result BuildComputePipelineMultiTarget(const ComputePipelineBuildInfo* pPipelineInfo,
+                                                   uint32_t                        targetCount,
+                                                   ICompiler*const*                ppTargetCompilers,
+                                                   ComputePipelineBuildOut*        pPipelineOuts);
+
+    virtual Result SpeculateGraphicsPipelines(uint32_t                         pipelineCount,
+                                              const GraphicsPipelineBuildInfo* pPipelineInfos);
+
+    virtual Result SpeculateComputePipelines(uint32_t                        pipelineCount,
+                                             const ComputePipelineBuildInfo* pPipelineInfos);
+
     Result BuildGraphicsPipelineInternal(GraphicsContext*                           pGraphicsContext,
                                          llvm::ArrayRef<const PipelineShaderInfo*>  shaderInfo,
                                          uint32_t                                   forceLoopUnrollCount,
-                                         ElfPackage*                                pPipelineElf);
+                                         ElfPackage*                                pPipelineElf,
+                                         LoweredPipeline*                           pLoweredPipeline = nullptr);
 
     Result BuildComputePipelineInternal(ComputeContext*                 pComputeContext,
                                         const ComputePipelineBuildInfo* pPipelineInfo,
                                         uint32_t                        forceLoopUnrollCount,
-                                        ElfPackage*                     pPipelineElf);
+                                        ElfPackage*                     pPipelineElf,
+                                        LoweredPipeline*                pLoweredPipeline = nullptr);
 
     Result BuildPipelineInternal(Context*                                   pContext,
                                  llvm::ArrayRef<const PipelineShaderInfo*>  shaderInfo,
                                  uint32_t                                   forceLoopUnrollCount,
-                                 ElfPackage*                                pPipelineElf);
+                                 ElfPackage*                                pPipelineElf,
+                                 LoweredPipeline*                           pLoweredPipeline = nullptr);
 
     // Gets the count of compiler instance.
     static uint32_t GetInstanceCount() { return m_instanceCount; }
@@ -265,6 +341,30 @@ private:
 
     Result ValidatePipelineShaderInfo(ShaderStage shaderStage, const PipelineShaderInfo* pShaderInfo) const;
 
+    Result BuildGraphicsPipelineImpl(const GraphicsPipelineBuildInfo* pPipelineInfo,
+                                     GraphicsPipelineBuildOut*        pPipelineOut,
+                                     void*                            pPipelineDumpFile,
+                                     LoweredPipeline*                 pLoweredPipeline);
+
+    Result BuildComputePipelineImpl(const ComputePipelineBuildInfo* pPipelineInfo,
+                                    ComputePipelineBuildOut*        pPipelineOut,
+                                    void*                           pPipelineDumpFile,
+                                    LoweredPipeline*                pLoweredPipeline);
+
+    Result LowerPipeline(Context*                                   pContext,
+                         llvm::ArrayRef<const PipelineShaderInfo*>  shaderInfo,
+                         uint32_t                                   forceLoopUnrollCount,
+                         TimerProfiler&                             timerProfiler,
+                         uint32_t*                                  pPassIndex,
+                         llvm::Module**                             ppPipelineModule);
+
+    Result BuildLoweredPipeline(PipelineContext*                           pPipelineContext,
+                                llvm::ArrayRef<const PipelineShaderInfo*>  shaderInfo,
+                                std::string*                               pBitcode,
+                                std::string*                               pResUsages);
+
+    Result CheckTargetCompilers(uint32_t targetCount, ICompiler*const* ppTargetCompilers) const;
+
     void InitGpuProperty();
     void InitGpuWorkaround();
 
@@ -300,24 +400,36 @@ private:
                             CacheEntryHandle*   phEntry,
                             uint32_t            shaderCacheCount);
 
-    void BuildShaderCacheHash(Context* pContext, MetroHash::Hash* pFragmentHash, MetroHash::Hash* pNonFragmentHash);
+    void BuildShaderCacheHash(Context*         pContext,
+                              MetroHash::Hash* pFragmentHash,
+                              MetroHash::Hash* pNonFragmentHash,
+                              MetroHash::Hash* pFragmentBodyHash,
+                              MetroHash::Hash* pNonFragmentBodyHash);
 
     void MergeElfBinary(Context*          pContext,
                         const BinaryData* pFragmentElf,
                         const BinaryData* pNonFragmentElf,
                         ElfPackage*       pPipelineElf);
+
+    Result AttachLlvmIrBitcode(llvm::ArrayRef<uint8_t> bitcodeRecord, ElfPackage* pPipelineElf) const;
+
+    static void UpdatePalMetadataPipelineHash(Context* pContext, llvm::Module* pModule);
     // -----------------------------------------------------------------------------------------------------------------
 
-    std::vector<std::string>      m_options;          // Compilation options
-    MetroHash::Hash               m_optionHash;       // Hash code of compilation options
+    OptionScope                   m_optionScope;      // Scope of compilation options
     GfxIpVersion                  m_gfxIp;            // Graphics IP version info
     static uint32_t               m_instanceCount;    // The count of compiler instance
     static uint32_t               m_outRedirectCount; // The count of output redirect
     ShaderCachePtr                m_shaderCache;      // Shader cache
     GpuProperty                   m_gpuProperty;      // GPU property
     WorkaroundFlags               m_gpuWorkarounds;   // GPU workarounds;
+    std::unique_ptr<PipelineSpeculator> m_pSpeculator; // Engine of speculative pipeline compilation
     static llvm::sys::Mutex       m_contextPoolMutex; // Mutex for context pool access
     static std::vector<Context*>* m_pContextPool;      // Context pool
 };
 
+void SerializeResourceUsage(const ResourceUsage& resUsage, std::string* pData);
+
+void DeserializeResourceUsage(const std::string& data, ResourceUsage* pResUsage);
+
 } // Llpc
@@ -111,12 +111,17 @@ uint32_t ComputeContext::GetShaderWaveSize(
     {
         // NOTE: GPU property wave size is used in shader, unless:
         //  1) If specified by tuning option, use the specified wave size.
-        //  2) If gl_SubgroupSize is used in shader, use the specified subgroup size when required.
+        //  2) If selected for the shader by the wave size heuristic, use the selected wave size.
+        //  3) If gl_SubgroupSize is used in shader, use the specified subgroup size when required.
 
         if (m_pPipelineInfo->cs.options.waveSize != 0)
         {
             waveSize = m_pPipelineInfo->cs.options.waveSize;
         }
+        else if (GetShaderResourceUsage(ShaderStageCompute)->waveSize != 0)
+        {
+            waveSize = GetShaderResourceUsage(ShaderStageCompute)->waveSize;
+        }
 
         // Check is subgroup size used in shader. If it's used, use the specified subgroup size as wave size.
         const PipelineShaderInfo* pShaderInfo = GetPipelineShaderInfo(ShaderStageCompute);
@@ -49,6 +49,8 @@
 
 #include "llpcCompiler.h"
 #include "llpcContext.h"
+#include "llpcEventTracer.h"
+#include "llpcLoweredStageCache.h"
 #include "llpcMetroHash.h"
 #include "llpcShaderCache.h"
 #include "llpcShaderCacheManager.h"
@@ -65,8 +67,11 @@ Context::Context(
     :
     LLVMContext(),
     m_gfxIp(gfxIp),
-    m_glslEmuLib(this)
+    m_glslEmuLib(this),
+    m_passGate(&getOptPassGate())
 {
+    setOptPassGate(m_passGate);
+
     std::vector<Metadata*> emptyMeta;
     m_pEmptyMetaNode = MDNode::get(*this, emptyMeta);
 
@@ -111,13 +116,111 @@ void Context::Reset()
 {
     m_pPipelineContext = nullptr;
     m_pResUsage = nullptr;
+    m_functionDeclCache.clear();
+    m_passGate.SetBudget(nullptr);
+}
+
+// =====================================================================================================================
+// Gets the cached declaration of the function with the specified base name and type in the module. Returns nullptr if
+// the declaration is not cached or has been erased since.
+Function* Context::GetCachedFunctionDecl(
+    Module*       pModule,    // [in] LLVM module
+    const char*   pBaseName,  // [in] Base name of the function, identified by its address
+    FunctionType* pFuncTy)    // [in] Type of the function
+{
+    Function* pFunc = nullptr;
+    auto it = m_functionDeclCache.find(FunctionDeclKey({ pModule, pBaseName }, pFuncTy));
+    if (it != m_functionDeclCache.end())
+    {
+        // NOTE: A module may be freed and another one allocated at the same address, so check that the declaration
+        // still belongs to the module.
+        pFunc = dyn_cast_or_null<Function>(static_cast<Value*>(it->second));
+        if ((pFunc != nullptr) && (pFunc->getParent() != pModule))
+        {
+            pFunc = nullptr;
+        }
+    }
+    return pFunc;
+}
+
+// =====================================================================================================================
+// Adds the declaration of the function with the specified base name and type in the module to the cache.
+void Context::CacheFunctionDecl(
+    Module*       pModule,    // [in] LLVM module
+    const char*   pBaseName,  // [in] Base name of the function, identified by its address
+    FunctionType* pFuncTy,    // [in] Type of the function
+    Function*     pFunc)      // [in] Declaration of the function
+{
+    m_functionDeclCache[FunctionDeclKey({ pModule, pBaseName }, pFuncTy)] = pFunc;
+}
+
+// =====================================================================================================================
+// Materializes the functions of a lazily loaded module which are reachable from its entry points, and removes the
+// others. Entry points are the functions with external linkage, as identified by GetEntryPoint(): the entry point of
+// a shader stage, or one per stage in a whole pipeline module. Other functions, including linkonce and weak ones, are
+// only kept if they are used.
+static Error MaterializeReachableFunctions(
+    Module* pModule)    // [in,out] Lazily loaded LLVM module
+{
+    // Materializing a function creates uses of its callees, so repeat until no more function is used. Functions used
+    // by global initializers are materialized as well.
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (Function& func : *pModule)
+        {
+            if (func.isMaterializable() && (func.hasExternalLinkage() || (func.use_empty() == false)))
+            {
+                if (Error err = func.materialize())
+                {
+                    return err;
+                }
+                changed = true;
+            }
+        }
+    }
+
+    // The remaining functions are unreachable and their bodies are never parsed.
+    for (auto funcIt = pModule->begin(), funcEnd = pModule->end(); funcIt != funcEnd;)
+    {
+        Function& func = *funcIt++;
+        if (func.isMaterializable())
+        {
+            LLPC_ASSERT(func.use_empty());
+            func.eraseFromParent();
+        }
+    }
+
+    // Finish loading, e.g. metadata and auto-upgrades.
+    return pModule->materializeAll();
 }
 
 // =====================================================================================================================
 // Loads library from external LLVM library.
+//
+// Only the functions reachable from the entry points of the library are materialized. Unless the lowered stage cache
+// is disabled, the loaded library is kept in this context, so loading the same bitcode again, e.g. a cached shader
+// stage in a later pipeline, clones it instead of parsing the bitcode.
 std::unique_ptr<Module> Context::LoadLibary(
     const BinaryData* pLib)     // [in] Bitcodes of external LLVM library
 {
+    MetroHash::Hash hash = {};
+    MetroHash64::Hash(static_cast<const uint8_t*>(pLib->pCode), pLib->codeSize, hash.bytes);
+    const uint64_t compactHash = MetroHash::Compact64(&hash);
+
+    // NOTE: Both caches of lowered IR are disabled together, e.g. by benchmarks which measure builds with cold caches.
+    const bool useLibraryCache = LoweredStageCache::IsEnabled();
+    if (useLibraryCache)
+    {
+        auto libraryIt = m_libraryCache.find(compactHash);
+        if ((libraryIt != m_libraryCache.end()) && (memcmp(&libraryIt->second.hash, &hash, sizeof(hash)) == 0))
+        {
+            TraceScope traceScope("LibraryCache", TraceCategoryCache);
+            return CloneModule(*libraryIt->second.pModule);
+        }
+    }
+
     auto pMemBuffer = MemoryBuffer::getMemBuffer(
         StringRef(static_cast<const char*>(pLib->pCode), pLib->codeSize), "", false);
 
@@ -127,19 +230,34 @@ std::unique_ptr<Module> Context::LoadLibary(
     std::unique_ptr<Module> pLibModule = nullptr;
     if (!moduleOrErr)
     {
-        Error error = moduleOrErr.takeError();
+        consumeError(moduleOrErr.takeError());
         LLPC_ERRS("Fails to load LLVM bitcode \n");
     }
     else
     {
         pLibModule = std::move(*moduleOrErr);
-        if (llvm::Error errCode = pLibModule->materializeAll())
+        if (llvm::Error errCode = MaterializeReachableFunctions(pLibModule.get()))
         {
+            consumeError(std::move(errCode));
             LLPC_ERRS("Fails to materialize \n");
             pLibModule = nullptr;
         }
     }
 
+    if (useLibraryCache && (pLibModule != nullptr))
+    {
+        // NOTE: The cache is bounded by evicting an arbitrary library, libraries are rarely loaded from more than a
+        // few shader stages at a time.
+        if (m_libraryCache.size() >= MaxCachedLibraries)
+        {
+            m_libraryCache.erase(m_libraryCache.begin());
+        }
+
+        CachedLibrary& cachedLibrary = m_libraryCache[compactHash];
+        cachedLibrary.hash = hash;
+        cachedLibrary.pModule = CloneModule(*pLibModule);
+    }
+
     return pLibModule;
 }
 
@@ -30,15 +30,18 @@
  */
 #pragma once
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Metadata.h"
 #include "llvm/IR/Type.h"
+#include "llvm/IR/ValueHandle.h"
 #include "llvm/Target/TargetMachine.h"
 
 #include <unordered_map>
 #include <unordered_set>
 #include "spirvExt.h"
 
+#include "llpcBuildBudget.h"
 #include "llpcEmuLib.h"
 #include "llpcPipelineContext.h"
 
@@ -79,6 +82,9 @@ public:
     // Gets LLPC builder
     Builder* GetBuilder() const { return m_pBuilder; }
 
+    // Sets the budget of the running build, after which optional passes are skipped (could be null).
+    void SetBuildBudget(BuildBudget* pBudget) { m_passGate.SetBudget(pBudget); }
+
     // Sets the target machine.
     void SetTargetMachine(llvm::TargetMachine* pTargetMachine, const PipelineOptions* pPipelineOptions)
     {
@@ -295,6 +301,15 @@ public:
         m_pResUsage = pResUsage;
     }
 
+    // Gets the cached declaration of the function with the specified base name and type in the module.
+    llvm::Function* GetCachedFunctionDecl(llvm::Module* pModule, const char* pBaseName, llvm::FunctionType* pFuncTy);
+
+    // Adds the declaration of the function with the specified base name and type in the module to the cache.
+    void CacheFunctionDecl(llvm::Module*       pModule,
+                           const char*         pBaseName,
+                           llvm::FunctionType* pFuncTy,
+                           llvm::Function*     pFunc);
+
 private:
     LLPC_DISALLOW_DEFAULT_CTOR(Context);
     LLPC_DISALLOW_COPY_AND_ASSIGN(Context);
@@ -314,6 +329,29 @@ private:
 
     llvm::MDNode*       m_pEmptyMetaNode;   // Empty metadata node
 
+    BuildBudgetPassGate m_passGate;         // Pass gate skipping optional passes once the build budget expires
+
+    // Key of function declaration cache: module, base name (by address) and function type
+    typedef std::pair<std::pair<llvm::Module*, const char*>, llvm::FunctionType*> FunctionDeclKey;
+
+    // Library loaded by LoadLibary(), kept for loading the same bitcode again
+    struct CachedLibrary
+    {
+        MetroHash::Hash               hash;     // Hash code of the bitcode
+        std::unique_ptr<llvm::Module> pModule;  // Loaded module, which is cloned when loaded again
+    };
+
+    // Maximum count of libraries kept in the context
+    static const uint32_t MaxCachedLibraries = 32;
+
+    // Libraries loaded in this context, keyed by the compacted hash code of their bitcode. They are kept across
+    // pipelines, since the context is pooled.
+    std::unordered_map<uint64_t, CachedLibrary> m_libraryCache;
+
+    // Function declarations emitted by EmitMangledCall, so that the mangled name does not have to be rebuilt and looked
+    // up on every call. Weak handles are nulled when a declaration is erased.
+    llvm::DenseMap<FunctionDeclKey, llvm::WeakVH> m_functionDeclCache;
+
     // Pre-constructed LLVM types
     struct
     {
@@ -1409,7 +1409,8 @@ uint32_t GraphicsContext::GetShaderWaveSize(
         // NOTE: GPU property wave size is used in shader, unless:
         //  1) A stage-specific default is preferred.
         //  2) If specified by tuning option, use the specified wave size.
-        //  3) If gl_SubgroupSize is used in shader, use the specified subgroup size when required.
+        //  3) If selected for the shader by the wave size heuristic, use the selected wave size.
+        //  4) If gl_SubgroupSize is used in shader, use the specified subgroup size when required.
 
         if (stage == ShaderStageFragment)
         {
@@ -1472,6 +1473,12 @@ uint32_t GraphicsContext::GetShaderWaveSize(
             break;
         }
 
+        // NOTE: The heuristic never selects a wave size for a stage whose wave size is specified by tuning option.
+        if (GetShaderResourceUsage(stage)->waveSize != 0)
+        {
+            waveSize = GetShaderResourceUsage(stage)->waveSize;
+        }
+
         // Check is subgroup size used in shader. If it's used, use the specified subgroup size as wave size.
         for (uint32_t i = ShaderStageVertex; i < ShaderStageGfxCount; ++i)
         {
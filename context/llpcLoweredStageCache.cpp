@@ -0,0 +1,144 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2019 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcLoweredStageCache.cpp
+ * @brief LLPC source file: contains implementation of class Llpc::LoweredStageCache.
+ ***********************************************************************************************************************
+ */
+#define DEBUG_TYPE "llpc-lowered-stage-cache"
+
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ManagedStatic.h"
+
+#include <string.h>
+
+#include "llpcBuilder.h"
+#include "llpcLoweredStageCache.h"
+
+using namespace llvm;
+
+namespace llvm
+{
+
+namespace cl
+{
+
+// -lowered-stage-cache-size: maximum size of the lowered stage cache in KB
+opt<uint32_t> LoweredStageCacheSize("lowered-stage-cache-size",
+                                    desc("Maximum size in KB of the process-wide cache of shader stages after SPIR-V "
+                                         "translation and lowering (0 - disable)"),
+                                    value_desc("size"),
+                                    init(64 * 1024));
+
+} // cl
+
+} // llvm
+
+namespace Llpc
+{
+
+static ManagedStatic<LoweredStageCache> s_loweredStageCache;
+
+// =====================================================================================================================
+// Gets the process-wide lowered stage cache.
+LoweredStageCache* LoweredStageCache::Get()
+{
+    return &*s_loweredStageCache;
+}
+
+// =====================================================================================================================
+// Checks whether the lowered stage cache is enabled by the compilation options.
+//
+// NOTE: Without recording and replaying Builder calls, lowering generates IR for the graphics IP version and user data
+// layout of the pipeline, which the keys of the stages leave out.
+bool LoweredStageCache::IsEnabled()
+{
+    return (cl::LoweredStageCacheSize > 0) && Builder::IsRecordAndReplay();
+}
+
+// =====================================================================================================================
+// Finds the lowered stage with the specified key, and returns it (null if not found).
+std::shared_ptr<const LoweredStage> LoweredStageCache::Find(
+    const MetroHash::Hash& key)     // [in] Key of the stage
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::shared_ptr<const LoweredStage> pStage;
+    auto it = m_stageMap.find(MetroHash::Compact64(&key));
+    if ((it != m_stageMap.end()) && (memcmp(&(*it->second)->key, &key, sizeof(key)) == 0))
+    {
+        // Move the stage to the front of the list as the most recently used.
+        m_stages.splice(m_stages.begin(), m_stages, it->second);
+        pStage = *it->second;
+    }
+    return pStage;
+}
+
+// =====================================================================================================================
+// Inserts a lowered stage with the specified key, replacing the existing one, and evicts the least recently used
+// stages if the cache exceeds its maximum size.
+void LoweredStageCache::Insert(
+    const MetroHash::Hash& key,         // [in] Key of the stage
+    std::string&&          bitcode,     // [in] Bitcode of the lowered shader module
+    std::string&&          resUsage)    // [in] Serialized resource usage of the stage
+{
+    const size_t maxSize = static_cast<size_t>(cl::LoweredStageCacheSize) * 1024;
+    const size_t stageSize = bitcode.size() + resUsage.size();
+    if (stageSize > maxSize)
+    {
+        return;
+    }
+
+    std::shared_ptr<LoweredStage> pStage(new LoweredStage());
+    pStage->key = key;
+    pStage->bitcode = std::move(bitcode);
+    pStage->resUsage = std::move(resUsage);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const uint64_t compactKey = MetroHash::Compact64(&key);
+    auto it = m_stageMap.find(compactKey);
+    if (it != m_stageMap.end())
+    {
+        m_totalSize -= (*it->second)->bitcode.size() + (*it->second)->resUsage.size();
+        m_stages.erase(it->second);
+        m_stageMap.erase(it);
+    }
+
+    while ((m_stages.empty() == false) && (m_totalSize + stageSize > maxSize))
+    {
+        const auto& pLeastRecentStage = m_stages.back();
+        m_totalSize -= pLeastRecentStage->bitcode.size() + pLeastRecentStage->resUsage.size();
+        m_stageMap.erase(MetroHash::Compact64(&pLeastRecentStage->key));
+        m_stages.pop_back();
+    }
+
+    m_stages.push_front(pStage);
+    m_stageMap[compactKey] = m_stages.begin();
+    m_totalSize += stageSize;
+}
+
+} // Llpc
@@ -0,0 +1,88 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2019 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcLoweredStageCache.h
+ * @brief LLPC header file: contains declaration of class Llpc::LoweredStageCache.
+ ***********************************************************************************************************************
+ */
+#pragma once
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "llpc.h"
+#include "llpcDebug.h"
+#include "llpcMetroHash.h"
+
+namespace Llpc
+{
+
+// Represents a shader stage after SPIR-V translation and lowering, before it is linked into a pipeline module.
+struct LoweredStage
+{
+    MetroHash::Hash key;        // Key of the stage
+    std::string     bitcode;    // Bitcode of the lowered shader module
+    std::string     resUsage;   // Serialized resource usage collected by translation and lowering
+};
+
+// =====================================================================================================================
+// Represents the process-wide in-memory cache of lowered shader stages.
+//
+// The lowered module of a stage only depends on its shader module, entry point, specialization data, a few pipeline
+// and shader options, and the compilation options; not on the rest of the pipeline state. So a stage seen before in
+// any pipeline, from any compiler with the same options, is loaded from the cache instead of translated and lowered
+// again. The least recently used stages are evicted once the cache exceeds -lowered-stage-cache-size. The cache is
+// disabled with -use-builder-recorder=0, since lowering then depends on the target and the rest of the pipeline state.
+class LoweredStageCache
+{
+public:
+    LoweredStageCache() : m_totalSize(0) {}
+
+    static LoweredStageCache* Get();
+
+    static bool IsEnabled();
+
+    std::shared_ptr<const LoweredStage> Find(const MetroHash::Hash& key);
+
+    void Insert(const MetroHash::Hash& key, std::string&& bitcode, std::string&& resUsage);
+
+private:
+    LLPC_DISALLOW_COPY_AND_ASSIGN(LoweredStageCache);
+
+    typedef std::list<std::shared_ptr<const LoweredStage>> StageList;
+
+    // -----------------------------------------------------------------------------------------------------------------
+
+    std::mutex                                        m_mutex;      // Mutex protecting the cache
+    StageList                                         m_stages;     // Cached stages, most recently used first
+    std::unordered_map<uint64_t, StageList::iterator> m_stageMap;   // Map from compacted key to cached stage
+    size_t                                            m_totalSize;  // Total size of the cached stages in bytes
+};
+
+} // Llpc
@@ -0,0 +1,223 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2019 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcOptionScope.cpp
+ * @brief LLPC source file: contains implementation of class Llpc::OptionScope.
+ ***********************************************************************************************************************
+ */
+#define DEBUG_TYPE "llpc-option-scope"
+
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+#include "llpcOptionScope.h"
+
+using namespace llvm;
+
+namespace Llpc
+{
+
+static std::mutex               s_scopeMutex;           // Mutex protecting the state of the active option set
+static std::condition_variable  s_scopeCond;            // Signaled when the last compile of the active scope ends
+static bool                     s_hasActiveOptions;     // Whether an option set has been applied
+static std::vector<std::string> s_activeOptions;        // Option strings of the applied option set
+static uint32_t                 s_activeCompileCount;   // Count of compiles running under the applied option set
+static uint32_t                 s_waitingSwitchCount;   // Count of activations waiting to apply another option set
+static uint32_t                 s_switchCount;          // Count of switches between applied option sets
+
+// =====================================================================================================================
+OptionScope::OptionScope(
+    uint32_t          optionCount,  // Count of compilation-option strings
+    const char*const* pOptions,     // [in] An array of compilation-option strings
+    MetroHash::Hash   hash)         // Hash code of the options which affect compilation results
+    :
+    m_options(pOptions, pOptions + optionCount),
+    m_hash(hash)
+{
+}
+
+// =====================================================================================================================
+// Activates this option scope, applying its option set if a different one is applied. Waits until the compiles
+// running under a different option set have finished first. While such a switch is waiting, new compiles of the applied
+// option set wait as well, so that a steady stream of them can't starve the switch.
+//
+// NOTE: The applied option set is identified by its option strings rather than by the hash code, since the hash code
+// leaves out options which don't affect compilation results (e.g. -trace-file), but still have to be applied.
+Result OptionScope::Activate() const
+{
+    const auto startTime = std::chrono::steady_clock::now();
+    bool switched = false;
+    bool waitedForSwitch = false;
+    uint32_t switchCount = 0;
+    Result result = Result::Success;
+
+    {
+        std::unique_lock<std::mutex> lock(s_scopeMutex);
+
+        auto isApplied = [this]
+        {
+            return s_hasActiveOptions && (s_activeOptions == m_options);
+        };
+
+        // NOTE: The applied option set may change while this activation waits, so whether it waits for a switch is
+        // decided again on each wakeup.
+        bool waitsForSwitch = false;
+        s_scopeCond.wait(lock, [&]
+        {
+            bool canActivate = false;
+            if (isApplied())
+            {
+                if (waitsForSwitch)
+                {
+                    --s_waitingSwitchCount;
+                    waitsForSwitch = false;
+                }
+                canActivate = (s_waitingSwitchCount == 0);
+            }
+            else
+            {
+                if (waitsForSwitch == false)
+                {
+                    ++s_waitingSwitchCount;
+                    waitsForSwitch = true;
+                    waitedForSwitch = true;
+                }
+                canActivate = (s_activeCompileCount == 0);
+            }
+            return canActivate;
+        });
+
+        if (waitsForSwitch)
+        {
+            --s_waitingSwitchCount;
+        }
+
+        if (isApplied() == false)
+        {
+            // Switching from the option set of another compiler, rather than applying the first one.
+            switched = (s_activeOptions.empty() == false);
+            switchCount = switched ? ++s_switchCount : s_switchCount;
+            result = Apply();
+        }
+
+        if (result == Result::Success)
+        {
+            ++s_activeCompileCount;
+        }
+    }
+
+    // Wake the activations waiting for this option set to be applied, or for the waiting switches to be done.
+    if (waitedForSwitch)
+    {
+        s_scopeCond.notify_all();
+    }
+
+    // NOTE: A switch drains the compiles of the other option set and parses all options again, which serializes
+    // compilers with different options. Report its cost, now that the option set of this scope (and so -v) is applied
+    // and stays applied until this scope is deactivated.
+    if (switched && (result == Result::Success))
+    {
+        const double switchTime =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+        LLPC_OUTS("// LLPC option set switch " << switchCount << ": " << format("%.3f", switchTime) <<
+                  " ms waiting for other compiles and parsing options\n");
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Deactivates this option scope, allowing a different option set to be applied once all of its compiles have finished.
+void OptionScope::Deactivate() const
+{
+    {
+        std::lock_guard<std::mutex> lock(s_scopeMutex);
+        LLPC_ASSERT(s_activeCompileCount > 0);
+        --s_activeCompileCount;
+    }
+    s_scopeCond.notify_all();
+}
+
+// =====================================================================================================================
+// Applies the option set of this scope to LLVM command-line options. Must be called with the scope mutex held.
+Result OptionScope::Apply() const
+{
+    Result result = Result::Success;
+
+    // Reset the options set by the previously applied option set, as well as those of this one which may still hold
+    // values from an earlier activation, since LLVM command options can't be parsed multiple times.
+    auto& registeredOptions = cl::getRegisteredOptions();
+    const std::vector<std::string>* optionSets[] = { &s_activeOptions, &m_options };
+    for (auto pOptions : optionSets)
+    {
+        for (const auto& option : *pOptions)
+        {
+            StringRef optionName(option);
+            if (optionName.startswith("-"))
+            {
+                optionName = optionName.ltrim('-').split('=').first;
+                auto it = registeredOptions.find(optionName);
+                if (it != registeredOptions.end())
+                {
+                    it->second->reset();
+                }
+            }
+        }
+    }
+
+    // NOTE: The first option string is the program name, so an empty option set leaves all options at their defaults.
+    if (m_options.empty() == false)
+    {
+        std::vector<const char*> options;
+        for (const auto& option : m_options)
+        {
+            options.push_back(option.c_str());
+        }
+
+        const bool ignoreErrors = (m_options[0] == VkIcdName);
+        raw_null_ostream nullStream;
+        if (cl::ParseCommandLineOptions(options.size(),
+                                        &options[0],
+                                        "AMD LLPC compiler",
+                                        ignoreErrors ? &nullStream : nullptr) == false)
+        {
+            result = Result::ErrorInvalidValue;
+        }
+    }
+
+    // NOTE: Even if parsing fails, part of the option set may have been applied, so remember it to reset it next time.
+    s_hasActiveOptions = (result == Result::Success);
+    s_activeOptions    = m_options;
+
+    return result;
+}
+
+} // Llpc
@@ -0,0 +1,102 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2019 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcOptionScope.h
+ * @brief LLPC header file: contains declaration of class Llpc::OptionScope.
+ ***********************************************************************************************************************
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "llpc.h"
+#include "llpcDebug.h"
+#include "llpcMetroHash.h"
+
+namespace Llpc
+{
+
+// =====================================================================================================================
+// Represents the set of compilation options a compiler is created with.
+//
+// Compilation options are LLVM command-line options, which are process-global. The option set of a scope is applied
+// to them while the scope is active, so that compilers with different option sets can live in one process and share
+// its context pool and shader caches. Any number of compiles may run concurrently under the active scope; activating
+// a scope with different option strings waits until those compiles have finished, then parses all options again. New
+// compiles of the active scope are held back while such a switch waits.
+class OptionScope
+{
+public:
+    OptionScope(uint32_t optionCount, const char*const* pOptions, MetroHash::Hash hash);
+
+    Result Activate() const;
+    void Deactivate() const;
+
+    // Gets compilation-option strings of this scope
+    const std::vector<std::string>& GetOptions() const { return m_options; }
+
+    // Gets hash code of the options which affect compilation results
+    const MetroHash::Hash& GetHash() const { return m_hash; }
+
+    // =================================================================================================================
+    // Keeps the option scope active during its lifetime.
+    class Guard
+    {
+    public:
+        Guard(const OptionScope& scope) : m_scope(scope), m_result(scope.Activate()) {}
+
+        ~Guard()
+        {
+            if (m_result == Result::Success)
+            {
+                m_scope.Deactivate();
+            }
+        }
+
+        // Gets the result of the scope activation
+        Result GetResult() const { return m_result; }
+
+    private:
+        LLPC_DISALLOW_DEFAULT_CTOR(Guard);
+        LLPC_DISALLOW_COPY_AND_ASSIGN(Guard);
+
+        const OptionScope&  m_scope;    // Option scope kept active
+        Result              m_result;   // Result of the scope activation
+    };
+
+private:
+    LLPC_DISALLOW_DEFAULT_CTOR(OptionScope);
+
+    Result Apply() const;
+
+    // -----------------------------------------------------------------------------------------------------------------
+
+    std::vector<std::string>  m_options;  // Compilation-option strings
+    MetroHash::Hash           m_hash;     // Hash code of the options which affect compilation results
+};
+
+} // Llpc
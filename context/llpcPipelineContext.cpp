@@ -56,7 +56,9 @@ PipelineContext::PipelineContext(
     m_pipelineHash(*pPipelineHash),
     m_cacheHash(*pCacheHash),
     m_pGpuProperty(pGpuProp),
-    m_pGpuWorkarounds(pGpuWorkarounds)
+    m_pGpuWorkarounds(pGpuWorkarounds),
+    m_pBuildBudget(nullptr),
+    m_fastOptTier(false)
 {
 
 }
@@ -167,6 +169,7 @@ void PipelineContext::InitShaderResourceUsage(
 
     pResUsage->numSgprsAvailable = UINT32_MAX;
     pResUsage->numVgprsAvailable = UINT32_MAX;
+    pResUsage->waveSize = 0;
 
     pResUsage->inOutUsage.inputMapLocCount = 0;
     pResUsage->inOutUsage.outputMapLocCount = 0;
@@ -49,6 +49,7 @@ namespace Llpc
 {
 
 class Builder;
+class BuildBudget;
 
 // Enumerates types of descriptor.
 enum class DescriptorType : uint32_t
@@ -148,6 +149,18 @@ union GsOutLocInfo
     uint32_t  u32All;
 };
 
+// Represents the components that a generic input/output occupies in its mapped location, if generic inputs/outputs
+// are packed
+union InOutCompInfo
+{
+    struct
+    {
+        uint32_t compOffset : 2;    // First component occupied in the mapped location
+        uint32_t compCount  : 3;    // Count of components occupied in the mapped location
+    };
+    uint32_t  u32All;
+};
+
 // Represents transform feedback output info
 union XfbOutInfo
 {
@@ -174,6 +187,8 @@ struct ResourceUsage
     bool                       globalConstant;        // Whether global constant is used
     uint32_t                   numSgprsAvailable;     // Number of available SGPRs
     uint32_t                   numVgprsAvailable;     // Number of available VGPRs
+    uint32_t                   waveSize;              // Wave size selected for the shader by the wave size
+                                                      // heuristic (0 if not selected)
 
     // Usage of built-ins
     struct
@@ -405,6 +420,11 @@ struct ResourceUsage
         std::map<uint32_t, uint32_t> perPatchInputLocMap;
         std::map<uint32_t, uint32_t> perPatchOutputLocMap;
 
+        // Map from shader specified locations to the components they occupy in the mapped locations (InOutCompInfo,
+        // only present for those locations that are packed with others)
+        std::map<uint32_t, uint32_t> inputCompMap;
+        std::map<uint32_t, uint32_t> outputCompMap;
+
         // Map from built-in IDs to specially assigned locations
         std::map<uint32_t, uint32_t> builtInInputLocMap;
         std::map<uint32_t, uint32_t> builtInOutputLocMap;
@@ -817,6 +837,21 @@ public:
     static void InitShaderResourceUsage(ShaderStage shaderStage, ResourceUsage* pResUsage);
 
     static void InitShaderInterfaceData(InterfaceData* pIntfData);
+
+    // Gets the LLVM IR bitcode record (LlvmIrBitcodeHeader and compressed bitcode) to attach to the pipeline ELF
+    std::vector<uint8_t>& GetLlvmIrBitcode() { return m_llvmIrBitcode; }
+
+    // Sets the compile-time budget of the build (could be null)
+    void SetBuildBudget(BuildBudget* pBudget) { m_pBuildBudget = pBudget; }
+
+    // Gets the compile-time budget of the build (could be null)
+    BuildBudget* GetBuildBudget() const { return m_pBuildBudget; }
+
+    // Selects the fast optimization tier, which runs a reduced set of optimizations and no loop unrolling
+    void SetFastOptTier(bool fastOptTier) { m_fastOptTier = fastOptTier; }
+
+    // Checks whether the fast optimization tier is selected
+    bool IsFastOptTier() const { return m_fastOptTier; }
 protected:
     // Gets dummy vertex input create info
     virtual VkPipelineVertexInputStateCreateInfo* GetDummyVertexInputInfo() { return nullptr; }
@@ -834,6 +869,9 @@ protected:
     MetroHash::Hash        m_cacheHash;     // Cache hash code
     const GpuProperty*     m_pGpuProperty;  // GPU Property
     const WorkaroundFlags* m_pGpuWorkarounds;  // GPU workarounds
+    std::vector<uint8_t>   m_llvmIrBitcode;    // LLVM IR bitcode record, set by PatchLlvmIrInclusion
+    BuildBudget*           m_pBuildBudget;     // Compile-time budget of the build (could be null)
+    bool                   m_fastOptTier;      // Whether the fast optimization tier is selected
 
 private:
     LLPC_DISALLOW_DEFAULT_CTOR(PipelineContext);
@@ -0,0 +1,456 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2019 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcPipelineSpeculator.cpp
+ * @brief LLPC source file: contains implementation of class Llpc::PipelineSpeculator.
+ ***********************************************************************************************************************
+ */
+#define DEBUG_TYPE "llpc-pipeline-speculator"
+
+#include "llvm/Support/Debug.h"
+
+#include <algorithm>
+#include <string.h>
+
+#ifdef WIN_OS
+    #include <windows.h>
+#else
+    #include <sys/resource.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+#include "llpcCompiler.h"
+#include "llpcPipelineDumper.h"
+#include "llpcPipelineSpeculator.h"
+#include "llpcUtil.h"
+
+using namespace llvm;
+
+namespace Llpc
+{
+
+// Represents a pipeline queued for speculative compilation, with a deep copy of its build info, so that the client
+// need not keep the build info nor the shader modules alive.
+struct SpeculativePipeline
+{
+    // Copies an array into the storage of this pipeline, and returns the copy (null if the array is empty)
+    template<typename T>
+    T* CopyArray(const T* pSrc, size_t count)
+    {
+        T* pDst = nullptr;
+        if ((pSrc != nullptr) && (count > 0))
+        {
+            storage.emplace_back(new uint8_t[count * sizeof(T)]);
+            pDst = reinterpret_cast<T*>(storage.back().get());
+            memcpy(pDst, pSrc, count * sizeof(T));
+        }
+        return pDst;
+    }
+
+    void CopyUserDataNodes(const ResourceMappingNode** ppNodes, uint32_t nodeCount);
+    void CopyShaderInfo(PipelineShaderInfo* pShaderInfo);
+    void CopyVertexInput(const VkPipelineVertexInputStateCreateInfo** ppVertexInput);
+
+    // Gets the copied build info of this pipeline
+    const void* GetBuildInfo() const
+    {
+        return isGraphics ? static_cast<const void*>(&graphicsInfo) : static_cast<const void*>(&computeInfo);
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------
+
+    bool                                    isGraphics;     // Whether it is a graphics pipeline
+    uint64_t                                cacheKey;       // Compacted cache hash of the pipeline
+    volatile uint32_t                       cancelToken;    // Cancel token of the build, set on shutdown or when the
+                                                            // client's build of the pipeline preempts it
+    bool                                    pastCheckpoint; // Whether the build is past SPIR-V translation and
+                                                            // lowering, so that the client's build joins it
+    GraphicsPipelineBuildInfo               graphicsInfo;   // Copied build info of a graphics pipeline
+    ComputePipelineBuildInfo                computeInfo;    // Copied build info of a compute pipeline
+    std::vector<std::unique_ptr<uint8_t[]>> storage;        // Storage of the data referenced by the copied build info
+    std::vector<uint8_t>                    output;         // Output pipeline binary, which is discarded
+};
+
+// =====================================================================================================================
+// Copies user data nodes, including the nodes of descriptor tables, and replaces the pointer with the copy.
+void SpeculativePipeline::CopyUserDataNodes(
+    const ResourceMappingNode** ppNodes,    // [in,out] User data nodes
+    uint32_t                    nodeCount)  // Count of user data nodes
+{
+    ResourceMappingNode* pNodes = CopyArray(*ppNodes, nodeCount);
+    for (uint32_t i = 0; i < nodeCount; ++i)
+    {
+        if (pNodes[i].type == ResourceMappingNodeType::DescriptorTableVaPtr)
+        {
+            CopyUserDataNodes(&pNodes[i].tablePtr.pNext, pNodes[i].tablePtr.nodeCount);
+        }
+    }
+    *ppNodes = pNodes;
+}
+
+// =====================================================================================================================
+// Copies the data referenced by the info of a pipeline shader, and replaces the pointers with the copies.
+void SpeculativePipeline::CopyShaderInfo(
+    PipelineShaderInfo* pShaderInfo)    // [in,out] Info of a pipeline shader
+{
+    if (pShaderInfo->pModuleData != nullptr)
+    {
+        // The module data is followed by its entries and then the binary code, as built by BuildShaderModule().
+        auto pModuleData = reinterpret_cast<const ShaderModuleData*>(pShaderInfo->pModuleData);
+        const size_t codeOffset = VoidPtrDiff(&pModuleData->moduleInfo.entries[pModuleData->moduleInfo.entryCount],
+                                              pModuleData);
+
+        storage.emplace_back(new uint8_t[codeOffset + pModuleData->binCode.codeSize]);
+        auto pModuleDataCopy = reinterpret_cast<ShaderModuleData*>(storage.back().get());
+        memcpy(pModuleDataCopy, pModuleData, codeOffset);
+        memcpy(VoidPtrInc(pModuleDataCopy, codeOffset), pModuleData->binCode.pCode, pModuleData->binCode.codeSize);
+        pModuleDataCopy->binCode.pCode = VoidPtrInc(pModuleDataCopy, codeOffset);
+        pShaderInfo->pModuleData = pModuleDataCopy;
+    }
+
+    if (pShaderInfo->pSpecializationInfo != nullptr)
+    {
+        VkSpecializationInfo* pSpecializationInfo = CopyArray(pShaderInfo->pSpecializationInfo, 1);
+        pSpecializationInfo->pMapEntries = CopyArray(pSpecializationInfo->pMapEntries,
+                                                     pSpecializationInfo->mapEntryCount);
+        pSpecializationInfo->pData = CopyArray(static_cast<const uint8_t*>(pSpecializationInfo->pData),
+                                               pSpecializationInfo->dataSize);
+        pShaderInfo->pSpecializationInfo = pSpecializationInfo;
+    }
+
+    if (pShaderInfo->pEntryTarget != nullptr)
+    {
+        pShaderInfo->pEntryTarget = CopyArray(pShaderInfo->pEntryTarget, strlen(pShaderInfo->pEntryTarget) + 1);
+    }
+
+    pShaderInfo->pDescriptorRangeValues = CopyArray(pShaderInfo->pDescriptorRangeValues,
+                                                    pShaderInfo->descriptorRangeValueCount);
+    for (uint32_t i = 0; i < pShaderInfo->descriptorRangeValueCount; ++i)
+    {
+        // NOTE: Only static samplers are supported, see PipelineDumper.
+        const uint32_t DescriptorSizeInDw = 4;
+        auto pDescriptorRangeValue = &pShaderInfo->pDescriptorRangeValues[i];
+        pDescriptorRangeValue->pValue = CopyArray(pDescriptorRangeValue->pValue,
+                                                  pDescriptorRangeValue->arraySize * DescriptorSizeInDw);
+    }
+
+    CopyUserDataNodes(&pShaderInfo->pUserDataNodes, pShaderInfo->userDataNodeCount);
+}
+
+// =====================================================================================================================
+// Copies the vertex input state, and replaces the pointer with the copy. The vertex input divisor state is the only
+// structure in the chain which is copied.
+void SpeculativePipeline::CopyVertexInput(
+    const VkPipelineVertexInputStateCreateInfo** ppVertexInput)     // [in,out] Vertex input state
+{
+    VkPipelineVertexInputStateCreateInfo* pVertexInput = CopyArray(*ppVertexInput, 1);
+    pVertexInput->pVertexBindingDescriptions = CopyArray(pVertexInput->pVertexBindingDescriptions,
+                                                         pVertexInput->vertexBindingDescriptionCount);
+    pVertexInput->pVertexAttributeDescriptions = CopyArray(pVertexInput->pVertexAttributeDescriptions,
+                                                           pVertexInput->vertexAttributeDescriptionCount);
+
+    auto pDivisorState = FindVkStructInChain<VkPipelineVertexInputDivisorStateCreateInfoEXT>(
+        VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_DIVISOR_STATE_CREATE_INFO_EXT,
+        pVertexInput->pNext);
+    VkPipelineVertexInputDivisorStateCreateInfoEXT* pDivisorStateCopy = CopyArray(pDivisorState, 1);
+    if (pDivisorStateCopy != nullptr)
+    {
+        pDivisorStateCopy->pNext = nullptr;
+        pDivisorStateCopy->pVertexBindingDivisors = CopyArray(pDivisorStateCopy->pVertexBindingDivisors,
+                                                              pDivisorStateCopy->vertexBindingDivisorCount);
+    }
+    pVertexInput->pNext = pDivisorStateCopy;
+
+    *ppVertexInput = pVertexInput;
+}
+
+// =====================================================================================================================
+// Allocates the output buffer of a speculative build.
+static void* VKAPI_CALL AllocSpeculativeOutput(
+    void*  pInstance,   // [in] Dummy instance object, unused
+    void*  pUserData,   // [in] Speculative pipeline
+    size_t size)        // Requested allocation size
+{
+    auto pPipeline = static_cast<SpeculativePipeline*>(pUserData);
+    pPipeline->output.resize(size);
+    return pPipeline->output.data();
+}
+
+// =====================================================================================================================
+// Lowers the scheduling priority of the calling thread, so that speculative builds do not take CPU time from the
+// builds the client waits for.
+static void SetLowThreadPriority()
+{
+#ifdef WIN_OS
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+#else
+    // NOTE: On Linux, the nice value is per thread.
+    setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 19);
+#endif
+}
+
+// =====================================================================================================================
+PipelineSpeculator::PipelineSpeculator(
+    ICompiler* pCompiler)   // [in] Compiler building the pipelines
+    :
+    m_pCompiler(pCompiler),
+    m_shutdown(false)
+{
+}
+
+// =====================================================================================================================
+// Cancels the running speculative builds and drops the queued ones before returning.
+PipelineSpeculator::~PipelineSpeculator()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_shutdown = true;
+        for (SpeculativePipeline* pPipeline : m_building)
+        {
+            pPipeline->cancelToken = 1;
+        }
+    }
+    m_queueCond.notify_all();
+
+    for (auto& worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+// =====================================================================================================================
+// Queues a graphics pipeline for speculative compilation.
+void PipelineSpeculator::QueueGraphicsPipeline(
+    const GraphicsPipelineBuildInfo* pPipelineInfo, // [in] Info to build the graphics pipeline
+    uint32_t                         workerCount)   // Count of worker threads to build the pipelines with
+{
+    std::unique_ptr<SpeculativePipeline> pPipeline(new SpeculativePipeline());
+    pPipeline->isGraphics     = true;
+    pPipeline->cancelToken    = 0;
+    pPipeline->pastCheckpoint = false;
+
+    MetroHash::Hash cacheHash = PipelineDumper::GenerateHashForGraphicsPipeline(pPipelineInfo, true);
+    pPipeline->cacheKey = MetroHash::Compact64(&cacheHash);
+
+    GraphicsPipelineBuildInfo* pInfo = &pPipeline->graphicsInfo;
+    *pInfo = *pPipelineInfo;
+    pInfo->pInstance      = nullptr;
+    pInfo->pUserData      = pPipeline.get();
+    pInfo->pfnOutputAlloc = AllocSpeculativeOutput;
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 37
+    pInfo->budget         = {};
+    pInfo->budget.pCancelToken = &pPipeline->cancelToken;
+#endif
+
+    pPipeline->CopyShaderInfo(&pInfo->vs);
+    pPipeline->CopyShaderInfo(&pInfo->tcs);
+    pPipeline->CopyShaderInfo(&pInfo->tes);
+    pPipeline->CopyShaderInfo(&pInfo->gs);
+    pPipeline->CopyShaderInfo(&pInfo->fs);
+    if (pInfo->pVertexInput != nullptr)
+    {
+        pPipeline->CopyVertexInput(&pInfo->pVertexInput);
+    }
+
+    Enqueue(std::move(pPipeline), workerCount);
+}
+
+// =====================================================================================================================
+// Queues a compute pipeline for speculative compilation.
+void PipelineSpeculator::QueueComputePipeline(
+    const ComputePipelineBuildInfo* pPipelineInfo,  // [in] Info to build the compute pipeline
+    uint32_t                        workerCount)    // Count of worker threads to build the pipelines with
+{
+    std::unique_ptr<SpeculativePipeline> pPipeline(new SpeculativePipeline());
+    pPipeline->isGraphics     = false;
+    pPipeline->cancelToken    = 0;
+    pPipeline->pastCheckpoint = false;
+
+    MetroHash::Hash cacheHash = PipelineDumper::GenerateHashForComputePipeline(pPipelineInfo, true);
+    pPipeline->cacheKey = MetroHash::Compact64(&cacheHash);
+
+    ComputePipelineBuildInfo* pInfo = &pPipeline->computeInfo;
+    *pInfo = *pPipelineInfo;
+    pInfo->pInstance      = nullptr;
+    pInfo->pUserData      = pPipeline.get();
+    pInfo->pfnOutputAlloc = AllocSpeculativeOutput;
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 37
+    pInfo->budget         = {};
+    pInfo->budget.pCancelToken = &pPipeline->cancelToken;
+#endif
+
+    pPipeline->CopyShaderInfo(&pInfo->cs);
+
+    Enqueue(std::move(pPipeline), workerCount);
+}
+
+// =====================================================================================================================
+// Adds a pipeline to the queue, and starts worker threads up to the specified count. The pipeline is dropped if the
+// queue is full.
+void PipelineSpeculator::Enqueue(
+    std::unique_ptr<SpeculativePipeline> pPipeline,     // [in] Speculative pipeline
+    uint32_t                             workerCount)   // Count of worker threads to build the pipelines with
+{
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        if (m_queue.size() >= MaxQueuedPipelines)
+        {
+            LLVM_DEBUG(dbgs() << "Speculative pipeline dropped, the queue is full\n");
+            return;
+        }
+
+        m_queue.push_back(std::move(pPipeline));
+        while (m_workers.size() < workerCount)
+        {
+            m_workers.push_back(std::thread([this] { RunWorker(); }));
+        }
+    }
+    m_queueCond.notify_one();
+}
+
+// =====================================================================================================================
+// Preempts the speculative build of a pipeline which the client builds now: the pipeline is dropped from the queue, and
+// a running build of it which is still in SPIR-V translation or lowering is canceled. The canceled build releases its
+// shader cache entries, so the client's build, which may be waiting for them, builds the pipeline itself at its own
+// priority. A running build past lowering is not canceled; the client's build joins it by waiting for its shader cache
+// entries in the Compiling state, rather than throwing the work done away.
+//
+// NOTE: A speculative build calls this too, as it uses the same build path as the client. It preempts nothing, so that
+// speculative builds of the same pipeline do not cancel each other.
+PipelineSpeculator::PreemptResult PipelineSpeculator::Preempt(
+    uint64_t    cacheKey,       // Compacted cache hash of the pipeline
+    const void* pPipelineInfo)  // [in] Info to build the pipeline
+{
+    PreemptResult preemptResult = PreemptResult::None;
+
+    std::lock_guard<std::mutex> lock(m_queueMutex);
+    bool isSpeculative = false;
+    for (const SpeculativePipeline* pPipeline : m_building)
+    {
+        isSpeculative |= (pPipeline->GetBuildInfo() == pPipelineInfo);
+    }
+
+    for (auto it = m_queue.begin(); (isSpeculative == false) && (it != m_queue.end()); )
+    {
+        if ((*it)->cacheKey == cacheKey)
+        {
+            it = m_queue.erase(it);
+            preemptResult = PreemptResult::Preempted;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    for (SpeculativePipeline* pPipeline : m_building)
+    {
+        if ((isSpeculative == false) && (pPipeline->cacheKey == cacheKey))
+        {
+            if (pPipeline->pastCheckpoint)
+            {
+                preemptResult = PreemptResult::Joined;
+            }
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 37
+            else
+            {
+                // NOTE: A running build can only be canceled through its build budget.
+                pPipeline->cancelToken = 1;
+                if (preemptResult == PreemptResult::None)
+                {
+                    preemptResult = PreemptResult::Preempted;
+                }
+            }
+#endif
+        }
+    }
+
+    return preemptResult;
+}
+
+// =====================================================================================================================
+// Records that the build with the specified info is past SPIR-V translation and lowering, if it is a speculative build
+// which has not been canceled. From then on, the client's build of the pipeline joins it rather than preempting it.
+void PipelineSpeculator::PassCheckpoint(
+    const void* pPipelineInfo)  // [in] Info to build the pipeline
+{
+    std::lock_guard<std::mutex> lock(m_queueMutex);
+    for (SpeculativePipeline* pPipeline : m_building)
+    {
+        if ((pPipeline->GetBuildInfo() == pPipelineInfo) && (pPipeline->cancelToken == 0))
+        {
+            pPipeline->pastCheckpoint = true;
+        }
+    }
+}
+
+// =====================================================================================================================
+// Builds the queued pipelines until shutdown.
+void PipelineSpeculator::RunWorker()
+{
+    SetLowThreadPriority();
+
+    // Messages of speculative builds would interleave with those of the client's builds.
+    DisableThreadOuts();
+
+    while (true)
+    {
+        std::unique_ptr<SpeculativePipeline> pPipeline;
+        {
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            m_queueCond.wait(lock, [this] { return m_shutdown || (m_queue.empty() == false); });
+            if (m_shutdown)
+            {
+                break;
+            }
+            pPipeline = std::move(m_queue.front());
+            m_queue.pop_front();
+            m_building.push_back(pPipeline.get());
+        }
+
+        // The result is stored in the shader caches by the build; the output binary is discarded.
+        Result result = Result::Success;
+        if (pPipeline->isGraphics)
+        {
+            GraphicsPipelineBuildOut pipelineOut = {};
+            result = m_pCompiler->BuildGraphicsPipeline(&pPipeline->graphicsInfo, &pipelineOut);
+        }
+        else
+        {
+            ComputePipelineBuildOut pipelineOut = {};
+            result = m_pCompiler->BuildComputePipeline(&pPipeline->computeInfo, &pipelineOut);
+        }
+        LLVM_DEBUG(dbgs() << "Speculative pipeline build finished, result = " << static_cast<int32_t>(result) << "\n");
+
+        {
+            std::lock_guard<std::mutex> lock(m_queueMutex);
+            m_building.erase(std::find(m_building.begin(), m_building.end(), pPipeline.get()));
+        }
+    }
+}
+
+} // Llpc
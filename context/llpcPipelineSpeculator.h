@@ -0,0 +1,98 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2019 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcPipelineSpeculator.h
+ * @brief LLPC header file: contains declaration of class Llpc::PipelineSpeculator.
+ ***********************************************************************************************************************
+ */
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "llpc.h"
+#include "llpcDebug.h"
+
+namespace Llpc
+{
+
+struct SpeculativePipeline;
+
+// =====================================================================================================================
+// Represents the engine of speculative pipeline compilation of a compiler.
+//
+// Pipelines the client expects to build later are queued with a deep copy of their build info, and built on
+// low-priority worker threads, which are started on first use. The results are stored in the internal shader cache of
+// the compiler, so a later build of the same pipeline hits the cache. If the client builds a pipeline before its
+// speculative build completes, the client's build preempts it (see Preempt()) while it is queued or still in SPIR-V
+// translation and lowering, rather than waiting for a low-priority thread which other threads may starve. A
+// speculative build past lowering has done most of the front-end work, so the client's build joins it instead.
+class PipelineSpeculator
+{
+public:
+    // Result of preempting the speculative build of a pipeline
+    enum class PreemptResult : uint32_t
+    {
+        None,       // No speculative build of the pipeline is queued or running
+        Preempted,  // The speculative build was dropped from the queue or canceled
+        Joined,     // The speculative build is past lowering, the client's build waits for its shader cache entries
+    };
+
+    PipelineSpeculator(ICompiler* pCompiler);
+    ~PipelineSpeculator();
+
+    void QueueGraphicsPipeline(const GraphicsPipelineBuildInfo* pPipelineInfo, uint32_t workerCount);
+    void QueueComputePipeline(const ComputePipelineBuildInfo* pPipelineInfo, uint32_t workerCount);
+
+    PreemptResult Preempt(uint64_t cacheKey, const void* pPipelineInfo);
+    void PassCheckpoint(const void* pPipelineInfo);
+
+    // Maximum count of pipelines waiting in the queue, further pipelines are dropped
+    static const uint32_t MaxQueuedPipelines = 256;
+
+private:
+    LLPC_DISALLOW_DEFAULT_CTOR(PipelineSpeculator);
+    LLPC_DISALLOW_COPY_AND_ASSIGN(PipelineSpeculator);
+
+    void Enqueue(std::unique_ptr<SpeculativePipeline> pPipeline, uint32_t workerCount);
+    void RunWorker();
+
+    // -----------------------------------------------------------------------------------------------------------------
+
+    ICompiler*                                       m_pCompiler;     // Compiler building the pipelines
+    std::mutex                                       m_queueMutex;    // Mutex protecting the queue
+    std::condition_variable                          m_queueCond;     // Signaled when a pipeline is queued
+    std::deque<std::unique_ptr<SpeculativePipeline>> m_queue;         // Pipelines waiting to be built
+    std::vector<SpeculativePipeline*>                m_building;      // Pipelines being built by the workers
+    std::vector<std::thread>                         m_workers;       // Worker threads building the pipelines
+    bool                                             m_shutdown;      // Whether the workers are shutting down
+};
+
+} // Llpc
@@ -31,10 +31,23 @@
 #define DEBUG_TYPE "llpc-shader-cache"
 
 #include <string.h>
+#include <algorithm>
+#include <thread>
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/FileSystem.h"
+#include "llpcPipelineDumper.h"
 #include "llpcShaderCache.h"
 #include "llvm/Support/DJB.h"
+#include "llvm/Config/llvm-config.h"
+
+#if defined(__has_include)
+#if __has_include("llvm/Support/VCSRevision.h")
+#include "llvm/Support/VCSRevision.h"
+#endif
+#if __has_include("llpcSourceRevision.h")
+#include "llpcSourceRevision.h"
+#endif
+#endif
 
 using namespace llvm;
 
@@ -124,8 +137,9 @@ ShaderCache::ShaderCache()
     m_shaderDataEnd(sizeof(ShaderCacheSerializedHeader)),
     m_totalShaders(0),
     m_serializedSize(sizeof(ShaderCacheSerializedHeader)),
-    m_pfnGetValueFunc(nullptr),
-    m_pfnStoreValueFunc(nullptr)
+    m_pBackend(nullptr),
+    m_callbackBackend(nullptr, nullptr, nullptr),
+    m_pendingFetches(0)
 {
     memset(m_fileFullPath, 0, MaxFilePathLen);
     memset(&m_gfxIp, 0, sizeof(m_gfxIp));
@@ -141,6 +155,12 @@ ShaderCache::~ShaderCache()
 // Destruction, does clean-up work.
 void ShaderCache::Destroy()
 {
+    // Wait for outstanding prefetches, whose completion callbacks reference this cache.
+    {
+        std::unique_lock<std::mutex> lock(m_conditionMutex);
+        m_conditionVariable.wait(lock, [this] { return m_pendingFetches == 0; });
+    }
+
     if (m_onDiskFile.IsOpen())
     {
         m_onDiskFile.Close();
@@ -199,7 +219,7 @@ Result ShaderCache::Serialize(
                 header.headerSize    = sizeof(ShaderCacheSerializedHeader);
                 header.shaderCount   = m_totalShaders;
                 header.shaderDataEnd = m_shaderDataEnd;
-                GetBuildTime(&header.buildId);
+                GetBuildId(&header.buildId);
 
                 memcpy(pBlob, &header, sizeof(ShaderCacheSerializedHeader));
 
@@ -233,8 +253,53 @@ Result ShaderCache::Serialize(
     return result;
 }
 
+// =====================================================================================================================
+// Serializes the shader cache data through the specified callback. Only ready entries are written, one at a time, so
+// no intermediate copy of the cache data is made.
+Result ShaderCache::SerializeToStream(
+    ShaderCacheWriteFunc pfnWrite,    // [in] Callback receiving the serialized data in order
+    void*                pUserData)   // [in] User data passed to the callback
+{
+    Result result = Result::Success;
+
+    LockCacheMap(true);
+
+    ShaderCacheSerializedHeader header = {};
+    header.headerSize    = sizeof(ShaderCacheSerializedHeader);
+    header.shaderDataEnd = sizeof(ShaderCacheSerializedHeader);
+    GetBuildId(&header.buildId);
+
+    for (auto it : m_shaderIndexMap)
+    {
+        if (it.second->state == ShaderEntryState::Ready)
+        {
+            header.shaderCount++;
+            header.shaderDataEnd += it.second->header.size;
+        }
+    }
+
+    result = pfnWrite(pUserData, &header, sizeof(header));
+
+    for (auto it = m_shaderIndexMap.begin(); (it != m_shaderIndexMap.end()) && (result == Result::Success); ++it)
+    {
+        const ShaderIndex* pIndex = it->second;
+        if (pIndex->state == ShaderEntryState::Ready)
+        {
+            // The data blob starts with a copy of the shader header, so it can be written as is.
+            result = pfnWrite(pUserData, pIndex->pDataBlob, pIndex->header.size);
+        }
+    }
+
+    UnlockCacheMap(true);
+
+    return result;
+}
+
 // =====================================================================================================================
 // Merges the shader data of source shader caches into this shader cache.
+//
+// Entries are deduplicated by key against this cache and among the source caches. The unique entries are then copied
+// into a single allocation by several threads.
 Result ShaderCache::Merge(
     uint32_t             srcCacheCount,  // Count of input source shader caches
     const IShaderCache** ppSrcCaches)    // [in] Input shader caches
@@ -242,6 +307,9 @@ Result ShaderCache::Merge(
     // Merge function is supposed to be called by client created shader caches, which are always runtime mode.
     LLPC_ASSERT(m_fileFullPath[0] == '\0');
 
+    // Minimum amount of shader data copied by each merge thread
+    static constexpr size_t MinMergeBytesPerThread = 4 * 1024 * 1024;
+
     Result result = Result::Success;
 
     LockCacheMap(false);
@@ -250,27 +318,85 @@ Result ShaderCache::Merge(
     {
         ShaderCache* pSrcCache = static_cast<ShaderCache*>(const_cast<IShaderCache*>(ppSrcCaches[i]));
         pSrcCache->LockCacheMap(true);
+    }
 
+    // Create the index entries of all keys not yet present, recording where their data comes from.
+    std::vector<std::pair<ShaderIndex*, const void*>> copyList;
+    size_t totalSize = 0;
+    for (uint32_t i = 0; i < srcCacheCount; i++)
+    {
+        ShaderCache* pSrcCache = static_cast<ShaderCache*>(const_cast<IShaderCache*>(ppSrcCaches[i]));
         for (auto it : pSrcCache->m_shaderIndexMap)
         {
-            uint64_t key = it.first;
-
-            auto indexMap = m_shaderIndexMap.find(key);
-            if (indexMap == m_shaderIndexMap.end())
+            if ((it.second->state != ShaderEntryState::Ready) ||
+                (m_shaderIndexMap.find(it.first) != m_shaderIndexMap.end()))
             {
-                ShaderIndex* pIndex = nullptr;
-                void* pMem = GetCacheSpace(it.second->header.size);
-                memcpy(pMem, it.second->pDataBlob, it.second->header.size);
+                continue;
+            }
 
-                pIndex = new ShaderIndex;
-                pIndex->pDataBlob = pMem;
-                pIndex->state = ShaderEntryState::Ready;
-                pIndex->header = it.second->header;
+            ShaderIndex* pIndex = new ShaderIndex;
+            pIndex->pDataBlob = nullptr;
+            pIndex->state = ShaderEntryState::Ready;
+            pIndex->header = it.second->header;
+
+            m_shaderIndexMap[it.first] = pIndex;
+            m_totalShaders++;
+
+            copyList.push_back(std::make_pair(pIndex, it.second->pDataBlob));
+            totalSize += pIndex->header.size;
+        }
+    }
 
-                m_shaderIndexMap[key] = pIndex;
-                m_totalShaders++;
+    if (copyList.empty() == false)
+    {
+        // Assign each new entry its place in one allocation.
+        uint8_t* pMem = static_cast<uint8_t*>(GetCacheSpace(totalSize));
+        size_t offset = 0;
+        for (auto& copyItem : copyList)
+        {
+            copyItem.first->pDataBlob = pMem + offset;
+            offset += copyItem.first->header.size;
+        }
+
+        // Split the entries into ranges of roughly equal byte size, and copy each range on its own thread.
+        const size_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+        const size_t threadCount = std::min(hardwareThreads, (totalSize / MinMergeBytesPerThread) + 1);
+        const size_t bytesPerThread = (totalSize + threadCount - 1) / threadCount;
+
+        auto copyRange = [&copyList](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                memcpy(copyList[i].first->pDataBlob, copyList[i].second, copyList[i].first->header.size);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        size_t rangeBegin = 0;
+        size_t rangeSize = 0;
+        for (size_t i = 0; i < copyList.size(); ++i)
+        {
+            rangeSize += copyList[i].first->header.size;
+            if ((rangeSize >= bytesPerThread) && (i + 1 < copyList.size()))
+            {
+                threads.push_back(std::thread(copyRange, rangeBegin, i + 1));
+                rangeBegin = i + 1;
+                rangeSize = 0;
             }
         }
+
+        // The current thread copies the last range.
+        copyRange(rangeBegin, copyList.size());
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    for (uint32_t i = 0; i < srcCacheCount; i++)
+    {
+        ShaderCache* pSrcCache = static_cast<ShaderCache*>(const_cast<IShaderCache*>(ppSrcCaches[i]));
         pSrcCache->UnlockCacheMap(true);
     }
 
@@ -290,12 +416,24 @@ Result ShaderCache::Init(
     if (pAuxCreateInfo->shaderCacheMode != ShaderCacheDisable)
     {
         m_disableCache = false;
-        m_pClientData       = pCreateInfo->pClientData;
-        m_pfnGetValueFunc   = pCreateInfo->pfnGetValueFunc;
-        m_pfnStoreValueFunc = pCreateInfo->pfnStoreValueFunc;
         m_gfxIp             = pAuxCreateInfo->gfxIp;
         m_hash              = pAuxCreateInfo->hash;
 
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 37
+        if (pCreateInfo->pBackend != nullptr)
+        {
+            m_pBackend = pCreateInfo->pBackend;
+        }
+        else
+#endif
+        if ((pCreateInfo->pfnGetValueFunc != nullptr) && (pCreateInfo->pfnStoreValueFunc != nullptr))
+        {
+            m_callbackBackend = ShaderCacheCallbackBackend(pCreateInfo->pClientData,
+                                                           pCreateInfo->pfnGetValueFunc,
+                                                           pCreateInfo->pfnStoreValueFunc);
+            m_pBackend = &m_callbackBackend;
+        }
+
         LockCacheMap(false);
 
         // If we're in runtime mode and the caller provided a data blob, try to load the from that blob.
@@ -432,7 +570,7 @@ void ShaderCache::ResetCacheFile()
     header.headerSize    = sizeof(ShaderCacheSerializedHeader);
     header.shaderCount   = 0;
     header.shaderDataEnd = header.headerSize;
-    GetBuildTime(&header.buildId);
+    GetBuildId(&header.buildId);
 
     m_onDiskFile.Write(&header, header.headerSize);
 }
@@ -460,6 +598,7 @@ ShaderEntryState ShaderCache::FindShader(
     bool             existed   = false;
     ShaderIndex*     pIndex    = nullptr;
     Result           mapResult = Result::Success;
+    bool             queried   = false;
     LLPC_ASSERT(phEntry != nullptr);
 
     bool readOnlyLock = (allocateOnMiss == false);
@@ -496,65 +635,54 @@ ShaderEntryState ShaderCache::FindShader(
         }
         else
         {
-            bool needsInit = true;
+            // This is a brand new cache entry so we need to initialize the ShaderIndex.
+            memset(pIndex, 0, sizeof(*pIndex));
+            pIndex->header.key = hashKey;
+            pIndex->state      = ShaderEntryState::New;
 
             // We didn't find the entry in our own hash map, now search the external cache if available
-            if (UseExternalCache())
+            IShaderCacheBackend* pBackend = m_pBackend;
+            if (pBackend != nullptr)
             {
-                // The first call to the external cache queries the existence and the size of the cached shader.
-                Result extResult = m_pfnGetValueFunc(m_pClientData, hashKey, nullptr, &pIndex->header.size);
-                if (extResult == Result::Success)
-                {
-                    // An entry was found matching our hash, we should allocate memory to hold the data and call again
-                    LLPC_ASSERT(pIndex->header.size > 0);
-                    pIndex->pDataBlob = GetCacheSpace(pIndex->header.size);
-
-                    if (pIndex->pDataBlob == nullptr)
-                    {
-                        extResult = Result::ErrorOutOfMemory;
-                    }
-                    else
-                    {
-                        extResult =
-                            m_pfnGetValueFunc(m_pClientData, hashKey, pIndex->pDataBlob, &pIndex->header.size);
-                    }
-                }
+                // Query the backend without holding the lock, so a slow backend does not stall other threads. The
+                // entry is marked as compiling meanwhile, so other threads looking for it wait for the result.
+                pIndex->state = ShaderEntryState::Compiling;
+                UnlockCacheMap(readOnlyLock);
 
-                if (extResult == Result::Success)
-                {
-                    // We now have a copy of the shader data from the external cache, just need to update the
-                    // ShaderIndex. The first item in the data blob is a ShaderHeader, followed by the serialized
-                    // data blob for the shader.
-                    const auto*const pHeader = static_cast<const ShaderHeader*>(pIndex->pDataBlob);
-                    LLPC_ASSERT(pIndex->header.size == pHeader->size);
-
-                    pIndex->header = (*pHeader);
-                    pIndex->state  = ShaderEntryState::Ready;
-                    needsInit      = false;
-                }
-                else if (extResult == Result::ErrorUnavailable)
+                struct BackendLookup
                 {
-                    // This means the external cache is unavailable and we shouldn't bother using it anymore. To
-                    // prevent useless calls we'll zero out the function pointers.
-                    m_pfnGetValueFunc   = nullptr;
-                    m_pfnStoreValueFunc = nullptr;
-                }
-                else
+                    std::mutex              mutex;      // Mutex protecting the other members
+                    std::condition_variable condition;  // Signaled once the lookup completes
+                    bool                    done;       // Whether the lookup has completed
+                    Result                  result;     // Result of the lookup
+                    std::vector<uint8_t>    value;      // Value found by the lookup
+                } lookup;
+                lookup.done   = false;
+                lookup.result = Result::ErrorUnavailable;
+
+                pBackend->GetAsync(hashKey,
+                                   [](void* pContext, Result result, uint64_t key, const void* pValue, size_t valueSize)
+                                   {
+                                       auto pLookup = static_cast<BackendLookup*>(pContext);
+                                       std::lock_guard<std::mutex> lock(pLookup->mutex);
+                                       pLookup->result = result;
+                                       if (result == Result::Success)
+                                       {
+                                           auto pBytes = static_cast<const uint8_t*>(pValue);
+                                           pLookup->value.assign(pBytes, pBytes + valueSize);
+                                       }
+                                       pLookup->done = true;
+                                       pLookup->condition.notify_all();
+                                   },
+                                   &lookup);
                 {
-                    // extResult should never be ErrorInvalidMemorySize since Cache space is always allocated based
-                    // on 1st m_pfnGetValueFunc call.
-                    LLPC_ASSERT(extResult != Result::ErrorOutOfMemory);
-
-                    // Any other result means we just need to continue with initializing the new index/compiling.
+                    std::unique_lock<std::mutex> lock(lookup.mutex);
+                    lookup.condition.wait(lock, [&lookup] { return lookup.done; });
                 }
-            }
 
-            if (needsInit)
-            {
-                // This is a brand new cache entry so we need to initialize the ShaderIndex.
-                memset(pIndex, 0, sizeof(*pIndex));
-                pIndex->header.key = hashKey;
-                pIndex->state      = ShaderEntryState::New;
+                LockCacheMap(readOnlyLock);
+                LoadFetchedShader(pIndex, lookup.result, lookup.value.data(), lookup.value.size());
+                queried = true;
             }
         }   // End if (existed == false)
 
@@ -595,9 +723,195 @@ ShaderEntryState ShaderCache::FindShader(
 
     UnlockCacheMap(readOnlyLock);
 
+    if (queried)
+    {
+        // Wake the threads which waited for the backend lookup, on a hit as well as on a miss, so that they do not
+        // have to wait for the polling timeout to notice the state change.
+        m_conditionVariable.notify_all();
+    }
+
     return result;
 }
 
+// =====================================================================================================================
+// Loads the shader data fetched from the backend into the specified entry, which must be in the Compiling state. This
+// function assumes that a write lock has been taken by the calling function.
+//
+// Returns true if the entry is now ready. Otherwise the entry is reset to the New state.
+bool ShaderCache::LoadFetchedShader(
+    ShaderIndex* pIndex,        // [in,out] Shader entry
+    Result       fetchResult,   // Result of the backend lookup
+    const void*  pValue,        // [in] Fetched data, a ShaderHeader followed by the shader data
+    size_t       valueSize)     // Size of fetched data in bytes
+{
+    LLPC_ASSERT(pIndex->state == ShaderEntryState::Compiling);
+
+    bool loaded = false;
+    if (fetchResult == Result::Success)
+    {
+        // The first item in the data blob is a ShaderHeader, followed by the serialized data blob for the shader.
+        // Verify it before accepting it, since the backend may be shared with other compilers.
+        const auto*const pHeader = static_cast<const ShaderHeader*>(pValue);
+        if ((valueSize >= sizeof(ShaderHeader)) &&
+            (pHeader->size == valueSize) &&
+            (pHeader->key == pIndex->header.key) &&
+            (CalculateCrc(static_cast<const uint8_t*>(VoidPtrInc(pValue, sizeof(ShaderHeader))),
+                          valueSize - sizeof(ShaderHeader)) == pHeader->crc))
+        {
+            pIndex->pDataBlob = GetCacheSpace(valueSize);
+            memcpy(pIndex->pDataBlob, pValue, valueSize);
+            pIndex->header = (*pHeader);
+            pIndex->state  = ShaderEntryState::Ready;
+            ++m_totalShaders;
+            loaded = true;
+        }
+    }
+    else if (fetchResult == Result::ErrorUnavailable)
+    {
+        // This means the external cache is unavailable and we shouldn't bother using it anymore.
+        m_pBackend = nullptr;
+    }
+
+    if (loaded == false)
+    {
+        pIndex->state = ShaderEntryState::New;
+    }
+
+    return loaded;
+}
+
+// =====================================================================================================================
+// Starts fetching the shaders with the specified keys from the backend. Entries being fetched are in the Compiling
+// state, so that FindShader waits for the prefetch instead of querying the backend again.
+void ShaderCache::PrefetchShaders(
+    const uint64_t* pKeys,      // [in] Compacted hash keys of shaders
+    uint32_t        keyCount)   // Count of keys
+{
+    if (m_disableCache)
+    {
+        return;
+    }
+
+    std::vector<uint64_t> fetchKeys;
+
+    LockCacheMap(false);
+    IShaderCacheBackend* pBackend = m_pBackend;
+    if (pBackend != nullptr)
+    {
+        for (uint32_t i = 0; i < keyCount; ++i)
+        {
+            if (m_shaderIndexMap.find(pKeys[i]) == m_shaderIndexMap.end())
+            {
+                ShaderIndex* pIndex = new ShaderIndex;
+                memset(pIndex, 0, sizeof(*pIndex));
+                pIndex->header.key = pKeys[i];
+                pIndex->state      = ShaderEntryState::Compiling;
+                m_shaderIndexMap[pKeys[i]] = pIndex;
+                fetchKeys.push_back(pKeys[i]);
+            }
+        }
+    }
+    UnlockCacheMap(false);
+
+    if (fetchKeys.empty() == false)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_conditionMutex);
+            m_pendingFetches += fetchKeys.size();
+        }
+        pBackend->GetBatchAsync(fetchKeys.data(), fetchKeys.size(), OnShaderPrefetched, this);
+    }
+}
+
+// =====================================================================================================================
+// Callback invoked by the backend when a lookup issued by PrefetchShaders completes.
+void ShaderCache::OnShaderPrefetched(
+    void*       pContext,   // [in] Shader cache which issued the lookup
+    Result      result,     // Result of the lookup
+    uint64_t    key,        // Compacted hash key of the shader
+    const void* pValue,     // [in] Fetched data
+    size_t      valueSize)  // Size of fetched data in bytes
+{
+    auto pThis = static_cast<ShaderCache*>(pContext);
+
+    pThis->LockCacheMap(false);
+    auto indexMap = pThis->m_shaderIndexMap.find(key);
+    LLPC_ASSERT(indexMap != pThis->m_shaderIndexMap.end());
+    pThis->LoadFetchedShader(indexMap->second, result, pValue, valueSize);
+    pThis->UnlockCacheMap(false);
+
+    {
+        std::lock_guard<std::mutex> lock(pThis->m_conditionMutex);
+        --pThis->m_pendingFetches;
+    }
+    pThis->m_conditionVariable.notify_all();
+}
+
+// =====================================================================================================================
+// Starts fetching the whole-pipeline entries of the specified pipelines from the backend.
+void ShaderCache::PrefetchPipelines(
+    uint32_t                                graphicsPipelineCount,  // Count of graphics pipelines
+    const GraphicsPipelineBuildInfo* const* ppGraphicsPipelines,    // [in] Build info of graphics pipelines
+    uint32_t                                computePipelineCount,   // Count of compute pipelines
+    const ComputePipelineBuildInfo* const*  ppComputePipelines)     // [in] Build info of compute pipelines
+{
+    std::vector<uint64_t> keys;
+    for (uint32_t i = 0; i < graphicsPipelineCount; ++i)
+    {
+        MetroHash::Hash hash = PipelineDumper::GenerateHashForGraphicsPipeline(ppGraphicsPipelines[i], true);
+        keys.push_back(MetroHash::Compact64(&hash));
+    }
+    for (uint32_t i = 0; i < computePipelineCount; ++i)
+    {
+        MetroHash::Hash hash = PipelineDumper::GenerateHashForComputePipeline(ppComputePipelines[i], true);
+        keys.push_back(MetroHash::Compact64(&hash));
+    }
+
+    PrefetchShaders(keys.data(), keys.size());
+}
+
+// =====================================================================================================================
+// Looks up a value through the GetValue callback, querying its size first.
+void ShaderCacheCallbackBackend::GetAsync(
+    uint64_t                      key,          // Key of the value to look up
+    ShaderCacheBackendGetCallback pfnCallback,  // [in] Callback invoked when the lookup completes
+    void*                         pContext)     // [in] Context passed to the callback
+{
+    size_t valueSize = 0;
+    std::vector<uint8_t> value;
+    Result result = m_pfnGetValueFunc(m_pClientData, key, nullptr, &valueSize);
+    if (result == Result::Success)
+    {
+        value.resize(valueSize);
+        result = m_pfnGetValueFunc(m_pClientData, key, value.data(), &valueSize);
+    }
+    pfnCallback(pContext, result, key, value.data(), valueSize);
+}
+
+// =====================================================================================================================
+// Looks up a batch of values through the GetValue callback.
+void ShaderCacheCallbackBackend::GetBatchAsync(
+    const uint64_t*               pKeys,        // [in] Keys of the values to look up
+    uint32_t                      keyCount,     // Count of keys
+    ShaderCacheBackendGetCallback pfnCallback,  // [in] Callback invoked when the lookup of each key completes
+    void*                         pContext)     // [in] Context passed to the callback
+{
+    for (uint32_t i = 0; i < keyCount; ++i)
+    {
+        GetAsync(pKeys[i], pfnCallback, pContext);
+    }
+}
+
+// =====================================================================================================================
+// Stores a value through the StoreValue callback.
+Result ShaderCacheCallbackBackend::PutAsync(
+    uint64_t    key,        // Key of the value
+    const void* pValue,     // [in] Value to store
+    size_t      valueSize)  // Size of the value in bytes
+{
+    return m_pfnStoreValueFunc(m_pClientData, key, pValue, valueSize);
+}
+
 // =====================================================================================================================
 // Inserts a new shader into the cache. The new shader is written to the cache file if it is in-use, and will also
 // upload it to the client's external cache if it is in-use.
@@ -640,28 +954,6 @@ void ShaderCache::InsertShader(
             pIndex->header.crc = CalculateCrc(static_cast<uint8_t*>(pDataBlob), shaderSize);
             (*pHeader)         = pIndex->header;
 
-            if (UseExternalCache())
-            {
-                // If we're making use of the external shader cache then we need to store the compiled shader data here.
-                Result externalResult = m_pfnStoreValueFunc(m_pClientData,
-                                                            pIndex->header.key,
-                                                            pIndex->pDataBlob,
-                                                            pIndex->header.size);
-                if (externalResult == Result::ErrorUnavailable)
-                {
-                    // This is the only return code we can do anything about. In this case it means the external cache
-                    // is not available and we should zero out the function pointers to avoid making useless calls on
-                    // subsequent shader compiles.
-                    m_pfnGetValueFunc   = nullptr;
-                    m_pfnStoreValueFunc = nullptr;
-                }
-                else
-                {
-                    // Otherwise the store either succeeded (yay!) or failed in some other transient way. Either way,
-                    // we will just continue, there's nothing to be done.
-                }
-            }
-
             // Mark this entry as ready, we'll wake the waiting threads once we release the lock
             pIndex->state = ShaderEntryState::Ready;
 
@@ -684,8 +976,29 @@ void ShaderCache::InsertShader(
         pIndex->pDataBlob   = nullptr;
     }
 
+    IShaderCacheBackend* pBackend = m_pBackend;
     UnlockCacheMap(false);
     m_conditionVariable.notify_all();
+
+    if ((result == Result::Success) && (pBackend != nullptr))
+    {
+        // If we're making use of the external shader cache then we need to store the compiled shader data here. This
+        // is done without holding the lock; the data blob stays valid for the lifetime of the cache.
+        Result externalResult = pBackend->PutAsync(pIndex->header.key, pIndex->pDataBlob, pIndex->header.size);
+        if (externalResult == Result::ErrorUnavailable)
+        {
+            // This is the only return code we can do anything about. In this case it means the external cache is not
+            // available and we should drop it to avoid making useless calls on subsequent shader compiles.
+            LockCacheMap(false);
+            m_pBackend = nullptr;
+            UnlockCacheMap(false);
+        }
+        else
+        {
+            // Otherwise the store either succeeded (yay!) or failed in some other transient way. Either way, we will
+            // just continue, there's nothing to be done.
+        }
+    }
 }
 
 // =====================================================================================================================
@@ -932,15 +1245,12 @@ Result ShaderCache::ValidateAndLoadHeader(
     LLPC_ASSERT(pHeader != nullptr);
 
     BuildUniqueId buildId;
-    GetBuildTime(&buildId);
+    GetBuildId(&buildId);
 
     Result result = Result::Success;
 
-    if (pHeader->headerSize == sizeof(ShaderCacheSerializedHeader) &&
-        (memcmp(pHeader->buildId.buildDate, buildId.buildDate, sizeof(buildId.buildDate)) == 0) &&
-        (memcmp(pHeader->buildId.buildTime, buildId.buildTime, sizeof(buildId.buildTime)) == 0) &&
-        (memcmp(&pHeader->buildId.gfxIp, &buildId.gfxIp, sizeof(buildId.gfxIp)) == 0) &&
-        (memcmp(&pHeader->buildId.hash, &buildId.hash, sizeof(buildId.hash)) == 0))
+    if ((pHeader->headerSize == sizeof(ShaderCacheSerializedHeader)) &&
+        (memcmp(&pHeader->buildId, &buildId, sizeof(buildId)) == 0))
     {
         // The header appears valid so copy the header data to the runtime cache
         m_totalShaders  = pHeader->shaderCount;
@@ -974,15 +1284,177 @@ void* ShaderCache::GetCacheSpace(
 }
 
 // =====================================================================================================================
-// Returns the time & date that pipeline.cpp was compiled.
-void ShaderCache::GetBuildTime(
-    BuildUniqueId *pBuildId)  // [out] Unique ID of build info
+// Builds the content fingerprint of this LLPC build for the specified target and compilation options.
+//
+// NOTE: LLPC_SOURCE_REVISION is provided by the build system (in the generated llpcSourceRevision.h, refreshed on every
+// build) when the sources come from a clean checkout. Otherwise, the build time is used instead, so that locally
+// modified builds never reuse caches from each other.
+void ShaderCache::GetBuildId(
+    GfxIpVersion           gfxIp,       // Graphics IP version info
+    const MetroHash::Hash& optionHash,  // Hash code of compilation options
+    BuildUniqueId*         pBuildId)    // [out] Unique ID of build info
 {
     memset(pBuildId, 0, sizeof(pBuildId[0]));
-    memcpy(&pBuildId->buildDate, __DATE__, std::min(strlen(__DATE__), sizeof(pBuildId->buildDate)));
-    memcpy(&pBuildId->buildTime, __TIME__, std::min(strlen(__TIME__), sizeof(pBuildId->buildTime)));
-    memcpy(&pBuildId->gfxIp, &m_gfxIp, sizeof(m_gfxIp));
-    memcpy(&pBuildId->hash, &m_hash, sizeof(m_hash));
+    pBuildId->formatVersion = ShaderCacheFormatVersion;
+    pBuildId->gfxIp         = gfxIp;
+    pBuildId->hash          = optionHash;
+
+#ifdef LLPC_SOURCE_REVISION
+    static const char LlpcRevision[] = LLPC_SOURCE_REVISION;
+#else
+    static const char LlpcRevision[] = __DATE__ " " __TIME__;
+#endif
+    MetroHash::MetroHash64 llpcHasher;
+    llpcHasher.Update(reinterpret_cast<const uint8_t*>(LlpcRevision), strlen(LlpcRevision));
+    llpcHasher.Update(static_cast<uint32_t>(LLPC_INTERFACE_MAJOR_VERSION));
+    llpcHasher.Update(static_cast<uint32_t>(LLPC_INTERFACE_MINOR_VERSION));
+    llpcHasher.Finalize(pBuildId->llpcRevision.bytes);
+
+#ifdef LLVM_REVISION
+    static const char LlvmRevision[] = LLVM_VERSION_STRING " " LLVM_REVISION;
+#else
+    static const char LlvmRevision[] = LLVM_VERSION_STRING;
+#endif
+    MetroHash::MetroHash64 llvmHasher;
+    llvmHasher.Update(reinterpret_cast<const uint8_t*>(LlvmRevision), strlen(LlvmRevision));
+    llvmHasher.Finalize(pBuildId->llvmRevision.bytes);
+}
+
+// =====================================================================================================================
+// Compares the specified build ID (typically read from a serialized cache) with the one of this shader cache.
+//
+// Returns a mask of BuildIdMismatch flags, BuildIdMismatchNone if the cached code can be used as is.
+uint32_t ShaderCache::CompareBuildId(
+    const BuildUniqueId& buildId)   // [in] Build ID to compare with
+{
+    BuildUniqueId currentBuildId;
+    GetBuildId(&currentBuildId);
+
+    uint32_t mismatch = BuildIdMismatchNone;
+    if (buildId.formatVersion != currentBuildId.formatVersion)
+    {
+        mismatch |= BuildIdMismatchFormat;
+    }
+    if (memcmp(&buildId.gfxIp, &currentBuildId.gfxIp, sizeof(buildId.gfxIp)) != 0)
+    {
+        mismatch |= BuildIdMismatchGfxIp;
+    }
+    if (memcmp(&buildId.llpcRevision, &currentBuildId.llpcRevision, sizeof(buildId.llpcRevision)) != 0)
+    {
+        mismatch |= BuildIdMismatchLlpcRevision;
+    }
+    if (memcmp(&buildId.llvmRevision, &currentBuildId.llvmRevision, sizeof(buildId.llvmRevision)) != 0)
+    {
+        mismatch |= BuildIdMismatchLlvmRevision;
+    }
+    if (memcmp(&buildId.hash, &currentBuildId.hash, sizeof(buildId.hash)) != 0)
+    {
+        mismatch |= BuildIdMismatchOptions;
+    }
+
+    return mismatch;
+}
+
+// =====================================================================================================================
+// Parses a serialized shader cache blob without checking whether it was created by this build of LLPC. The CRC of
+// every entry is still verified. The returned entries point into the specified blob.
+//
+// Returns Unsupported (with the build ID filled in) if the blob has a different cache layout, so its entries cannot be
+// read at all.
+Result ShaderCache::ParseSerializedCache(
+    const void*                         pBlob,      // [in] Serialized shader cache data
+    size_t                              blobSize,   // Size of the serialized data in bytes
+    BuildUniqueId*                      pBuildId,   // [out] Build ID stored in the serialized data
+    std::vector<SerializedShaderEntry>* pEntries)   // [out] Shader entries stored in the serialized data
+{
+    Result result = Result::Success;
+    auto pHeader = static_cast<const ShaderCacheSerializedHeader*>(pBlob);
+
+    if ((blobSize < sizeof(ShaderCacheSerializedHeader)) ||
+        (pHeader->headerSize != sizeof(ShaderCacheSerializedHeader)) ||
+        (pHeader->shaderDataEnd > blobSize))
+    {
+        result = Result::ErrorInvalidValue;
+    }
+    else if (pHeader->buildId.formatVersion != ShaderCacheFormatVersion)
+    {
+        *pBuildId = pHeader->buildId;
+        result = Result::Unsupported;
+    }
+
+    if (result == Result::Success)
+    {
+        *pBuildId = pHeader->buildId;
+
+        const void* pDataEnd = VoidPtrInc(pBlob, pHeader->shaderDataEnd);
+        auto pShaderHeader = static_cast<const ShaderHeader*>(VoidPtrInc(pBlob, pHeader->headerSize));
+
+        for (size_t shader = 0; (shader < pHeader->shaderCount) && (result == Result::Success); ++shader)
+        {
+            if ((VoidPtrDiff(pDataEnd, pShaderHeader) < sizeof(ShaderHeader)) ||
+                (pShaderHeader->size < sizeof(ShaderHeader)) ||
+                (VoidPtrDiff(pDataEnd, pShaderHeader) < pShaderHeader->size))
+            {
+                result = Result::ErrorInvalidValue;
+                break;
+            }
+
+            const void* pData = (pShaderHeader + 1);
+            const size_t dataSize = pShaderHeader->size - sizeof(ShaderHeader);
+            if (CalculateCrc(static_cast<const uint8_t*>(pData), dataSize) != pShaderHeader->crc)
+            {
+                result = Result::ErrorInvalidValue;
+                break;
+            }
+
+            SerializedShaderEntry entry = {};
+            entry.key   = pShaderHeader->key;
+            entry.pData = pData;
+            entry.size  = dataSize;
+            pEntries->push_back(entry);
+
+            pShaderHeader = static_cast<const ShaderHeader*>(VoidPtrInc(pShaderHeader, pShaderHeader->size));
+        }
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Adds a ready shader with the specified key to this shader cache, typically an entry carried over from another
+// serialized cache. Existing entries are left untouched.
+Result ShaderCache::ImportShader(
+    uint64_t    key,     // Compacted hash key of the shader
+    const void* pBlob,   // [in] Shader data
+    size_t      size)    // Size of shader data in bytes
+{
+    // Imported shaders are only supposed to go to client created shader caches, which are always runtime mode.
+    LLPC_ASSERT(m_fileFullPath[0] == '\0');
+
+    Result result = Result::Success;
+
+    LockCacheMap(false);
+
+    if (m_shaderIndexMap.find(key) == m_shaderIndexMap.end())
+    {
+        ShaderIndex* pIndex = new ShaderIndex;
+        pIndex->header.key  = key;
+        pIndex->header.size = size + sizeof(ShaderHeader);
+        pIndex->pDataBlob   = GetCacheSpace(pIndex->header.size);
+        pIndex->state       = ShaderEntryState::Ready;
+
+        void*const pDataBlob = static_cast<ShaderHeader*>(pIndex->pDataBlob) + 1;
+        memcpy(pDataBlob, pBlob, size);
+        pIndex->header.crc = CalculateCrc(static_cast<uint8_t*>(pDataBlob), size);
+        *static_cast<ShaderHeader*>(pIndex->pDataBlob) = pIndex->header;
+
+        m_shaderIndexMap[key] = pIndex;
+        m_totalShaders++;
+    }
+
+    UnlockCacheMap(false);
+
+    return result;
 }
 
 // =====================================================================================================================
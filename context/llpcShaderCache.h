@@ -34,6 +34,7 @@
 #include <list>
 #include <mutex>
 #include <unordered_map>
+#include <vector>
 #include "llvm/Support/Mutex.h"
 
 #include "llpc.h"
@@ -94,30 +95,41 @@ struct ShaderCacheAuxCreateInfo
     const char*            pExecutableName;    // Name of executable file
 };
 
-// Length of date field used in BuildUniqueId
-static constexpr uint8_t DateLength = 11;
+// Version of the serialized shader cache layout. It must be bumped whenever ShaderCacheSerializedHeader,
+// BuildUniqueId or ShaderHeader changes in a way that makes existing cache files unreadable.
+static constexpr uint32_t ShaderCacheFormatVersion = 1;
 
-// Length of time field used in BuildUniqueId
-static constexpr uint8_t TimeLength = 8;
-
-// Opaque data type representing an ID that uniquely identifies a particular build of LLPC. Such an ID will be stored
-// with all serialized pipelines and in the shader cache, and used during load of that data to ensure the version of
-// PAL that loads the data is exactly the same as the version that stored it. Currently, this ID is just the date
-// and time when LLPC was built.
+// Opaque data type representing an ID that uniquely identifies the code generated by a particular build of LLPC. Such
+// an ID will be stored with all serialized pipelines and in the shader cache, and used during load of that data to
+// ensure the compiler that loads the data generates exactly the same code as the one that stored it. The ID is a
+// content fingerprint (source revisions, target and options) rather than the build time, so rebuilding the same
+// sources does not invalidate existing caches.
 struct BuildUniqueId
 {
-    uint8_t buildDate[DateLength];     // Build date
-    uint8_t buildTime[TimeLength];     // Build time
-    GfxIpVersion gfxIp;                // Graphics IP version info
+    uint32_t        formatVersion;     // Version of the serialized cache layout
+    GfxIpVersion    gfxIp;             // Graphics IP version info
+    MetroHash::Hash llpcRevision;      // Hash of the LLPC source revision and interface version
+    MetroHash::Hash llvmRevision;      // Hash of the LLVM version and source revision
     MetroHash::Hash hash;              // Hash code of compilation options
 };
 
+// Enumerates the components of BuildUniqueId which can differ between a serialized cache and the running compiler.
+enum BuildIdMismatch : uint32_t
+{
+    BuildIdMismatchNone         = 0x00,     // Build IDs are identical
+    BuildIdMismatchFormat       = 0x01,     // Cache layout differs, entries cannot be read
+    BuildIdMismatchGfxIp        = 0x02,     // Graphics IP version differs
+    BuildIdMismatchLlpcRevision = 0x04,     // LLPC source revision differs
+    BuildIdMismatchLlvmRevision = 0x08,     // LLVM revision differs
+    BuildIdMismatchOptions      = 0x10,     // Compilation options differ
+};
+
 // This the header for the shader cache data when the cache is serialized/written to disk
 struct ShaderCacheSerializedHeader
 {
     size_t              headerSize;    // Size of the header structure. This member must always be first
                                        // since it is used to validate the serialized data.
-    BuildUniqueId       buildId;       // Build time/date of the PAL version that created the cache file
+    BuildUniqueId       buildId;       // Fingerprint of the LLPC build that created the cache file
     size_t              shaderCount;   // Number of shaders in the shaderIndex array
     size_t              shaderDataEnd; // Offset to the end of shader data
 };
@@ -126,6 +138,46 @@ constexpr uint32_t MaxFilePathLen = 256;
 
 typedef void* CacheEntryHandle;
 
+// Represents one shader entry of a serialized shader cache blob.
+struct SerializedShaderEntry
+{
+    uint64_t    key;    // Compacted hash key used to identify the shader
+    const void* pData;  // Shader data (excluding ShaderHeader)
+    size_t      size;   // Size of shader data in bytes
+};
+
+// =====================================================================================================================
+// Adapts the ShaderCacheGetValue/ShaderCacheStoreValue callback pair of ShaderCacheCreateInfo to IShaderCacheBackend.
+// Requests complete synchronously on the calling thread.
+class ShaderCacheCallbackBackend : public IShaderCacheBackend
+{
+public:
+    ShaderCacheCallbackBackend(const void*           pClientData,
+                               ShaderCacheGetValue   pfnGetValueFunc,
+                               ShaderCacheStoreValue pfnStoreValueFunc)
+        :
+        m_pClientData(pClientData),
+        m_pfnGetValueFunc(pfnGetValueFunc),
+        m_pfnStoreValueFunc(pfnStoreValueFunc)
+    {
+    }
+    virtual ~ShaderCacheCallbackBackend() {}
+
+    virtual void GetAsync(uint64_t key, ShaderCacheBackendGetCallback pfnCallback, void* pContext);
+
+    virtual void GetBatchAsync(const uint64_t*               pKeys,
+                               uint32_t                      keyCount,
+                               ShaderCacheBackendGetCallback pfnCallback,
+                               void*                         pContext);
+
+    virtual Result PutAsync(uint64_t key, const void* pValue, size_t valueSize);
+
+private:
+    const void*           m_pClientData;        // Client data that will be used by function GetValue and StoreValue
+    ShaderCacheGetValue   m_pfnGetValueFunc;    // GetValue function used to query an external cache for shader data
+    ShaderCacheStoreValue m_pfnStoreValueFunc;  // StoreValue function used to store shader data in an external cache
+};
+
 // =====================================================================================================================
 // This class implements a cache for compiled shaders. The shader cache persists in memory at runtime and can be
 // serialized to disk by the client/application for persistence between runs.
@@ -142,6 +194,15 @@ public:
 
     virtual Result Merge(uint32_t srcCacheCount, const IShaderCache** ppSrcCaches);
 
+    virtual Result SerializeToStream(ShaderCacheWriteFunc pfnWrite, void* pUserData);
+
+    virtual void PrefetchPipelines(uint32_t                                graphicsPipelineCount,
+                                   const GraphicsPipelineBuildInfo* const* ppGraphicsPipelines,
+                                   uint32_t                                computePipelineCount,
+                                   const ComputePipelineBuildInfo* const*  ppComputePipelines);
+
+    void PrefetchShaders(const uint64_t* pKeys, uint32_t keyCount);
+
     ShaderEntryState FindShader(MetroHash::Hash   hash,
                                 bool              allocateOnMiss,
                                 CacheEntryHandle* phEntry);
@@ -158,6 +219,19 @@ public:
 
     bool IsCompatible(const ShaderCacheCreateInfo* pCreateInfo, const ShaderCacheAuxCreateInfo* pAuxCreateInfo);
 
+    uint32_t CompareBuildId(const BuildUniqueId& buildId);
+
+    Result ImportShader(uint64_t key, const void* pBlob, size_t size);
+
+    static void GetBuildId(GfxIpVersion gfxIp, const MetroHash::Hash& optionHash, BuildUniqueId* pBuildId);
+
+    static Result ParseSerializedCache(const void*                         pBlob,
+                                       size_t                              blobSize,
+                                       BuildUniqueId*                      pBuildId,
+                                       std::vector<SerializedShaderEntry>* pEntries);
+
+    static uint64_t CalculateCrc(const uint8_t* pData, size_t numBytes);
+
 private:
     LLPC_DISALLOW_COPY_AND_ASSIGN(ShaderCache);
 
@@ -168,7 +242,6 @@ private:
     Result ValidateAndLoadHeader(const ShaderCacheSerializedHeader* pHeader, size_t dataSourceSize);
     Result LoadCacheFromBlob(const void* pInitialData, size_t initialDataSize);
     Result PopulateIndexMap(void* pDataStart, size_t dataSize);
-    uint64_t CalculateCrc(const uint8_t* pData, size_t numBytes);
 
     Result LoadCacheFromFile();
     void ResetCacheFile();
@@ -182,11 +255,16 @@ private:
     // Unlock cache map
     void UnlockCacheMap(bool readOnly) { m_lock.unlock(); }
 
-    bool UseExternalCache()
-        { return ((m_pfnGetValueFunc != nullptr) && (m_pfnStoreValueFunc != nullptr)); }
+    bool LoadFetchedShader(ShaderIndex* pIndex, Result fetchResult, const void* pValue, size_t valueSize);
+
+    static void OnShaderPrefetched(void*       pContext,
+                                   Result      result,
+                                   uint64_t    key,
+                                   const void* pValue,
+                                   size_t      valueSize);
 
     void ResetRuntimeCache();
-    void GetBuildTime(BuildUniqueId *pBuildId);
+    void GetBuildId(BuildUniqueId* pBuildId) { GetBuildId(m_gfxIp, m_hash, pBuildId); }
 
     // -----------------------------------------------------------------------------------------------------------------
 
@@ -206,12 +284,12 @@ private:
     char            m_fileFullPath[MaxFilePathLen]; // Full path/filename of the shader cache on-disk file
 
     std::list<std::pair<uint8_t*, size_t> > m_allocationList;  // Memory allcoated by GetCacheSpace
-    uint32_t                 m_serializedSize;      // Serialized byte size of whole shader cache
+    size_t                   m_serializedSize;      // Serialized byte size of whole shader cache
     std::mutex               m_conditionMutex;      // Mutex that will be used with the condition variable
     std::condition_variable  m_conditionVariable;   // Condition variable that will be used to wait compile finish
-    const void*              m_pClientData;         // Client data that will be used by function GetValue and StoreValue
-    ShaderCacheGetValue      m_pfnGetValueFunc;     // GetValue function used to query an external cache for shader data
-    ShaderCacheStoreValue    m_pfnStoreValueFunc;   // StoreValue function used to store shader data in an external cache
+    IShaderCacheBackend*     m_pBackend;            // External store backing this cache, null if none
+    ShaderCacheCallbackBackend m_callbackBackend;   // Backend adapting the GetValue/StoreValue callbacks
+    uint32_t                 m_pendingFetches;      // Count of backend lookups issued by prefetch still in flight
     GfxIpVersion             m_gfxIp;               // Graphics IP version info
     MetroHash::Hash          m_hash;                // Hash code of compilation options
 };
@@ -40,7 +40,7 @@
 #undef Bool
 
 /// LLPC major interface version.
-#define LLPC_INTERFACE_MAJOR_VERSION 36
+#define LLPC_INTERFACE_MAJOR_VERSION 37
 
 /// LLPC minor interface version.
 #define LLPC_INTERFACE_MINOR_VERSION 0
@@ -51,6 +51,12 @@
 //* %Version History
 //* | %Version | Change Description                                                                                    |
 //* | -------- | ----------------------------------------------------------------------------------------------------- |
+//* |     37.0 | Add ShaderCacheCreateInfo::pBackend, and PipelineBuildBudget to pipeline build info                   |
+//* |     36.5 | Add ICompiler::SpeculateGraphicsPipelines and ICompiler::SpeculateComputePipelines                    |
+//* |     36.4 | Add Result::ErrorCanceled                                                                             |
+//* |     36.3 | Add ICompiler::BuildGraphicsPipelineMultiTarget and ICompiler::BuildComputePipelineMultiTarget        |
+//* |     36.2 | Add IShaderCacheBackend and IShaderCache::PrefetchPipelines                                           |
+//* |     36.1 | Add IShaderCache::SerializeToStream to serialize shader cache data through a callback                 |
 //* |     36.0 | Add 128 bit hash as clientHash in PipelineShaderOptions                                               |
 //* |     35.0 | Added disableLicm to PipelineShaderOptions                                                            |
 //* |     33.0 | Add enableLoadScalarizer option into PipelineShaderOptions.                                           |
@@ -99,6 +105,8 @@ enum class Result : int32_t
     ErrorInvalidPointer             = -(0x00000005),
     /// The operaton encountered an unknown error
     ErrorUnknown                    = -(0x00000006),
+    /// The operation was canceled by the client or exceeded its time limit
+    ErrorCanceled                   = -(0x00000007),
 };
 
 /// Enumerates LLPC shader stages.
@@ -203,7 +211,8 @@ struct PipelineOptions
 #if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 28
     bool reconfigWorkgroupLayout;  ///< If set, allows automatic workgroup reconfigure to take place on compute shaders.
 #endif
-    bool includeIr;                ///< If set, the IR for all compiled shaders will be included in the pipeline ELF.
+    bool includeIr;                ///< If set, the IR for all compiled shaders will be included in the pipeline ELF,
+                                   ///  as compressed bitcode in the .AMDGPU.llvmbc section.
 #if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 23
     bool robustBufferAccess;       ///< If set, out of bounds accesses to buffer or private array will be handled.
                                    ///  for now this option is used by LLPC shader and affects only the private array,
@@ -441,6 +450,18 @@ struct NggState
 };
 #endif
 
+/// Represents the compile-time budget of a pipeline build. The budget is checked between the compilation phases, and
+/// optional optimization passes are skipped once it is exceeded, so that the build aborts with Result::ErrorCanceled.
+struct PipelineBuildBudget
+{
+    uint32_t                 timeLimitMs;       ///< Time limit of the compilation in milliseconds (0 - no limit)
+    const volatile uint32_t* pCancelToken;      ///< The build is canceled once the value pointed to becomes nonzero
+                                                ///  (could be null)
+    bool                     retryOnTimeout;    ///< Whether to retry a build which exceeds its time limit with the
+                                                ///  fast optimization tier, instead of returning ErrorCanceled. The
+                                                ///  retried pipeline is not stored in the shader caches.
+};
+
 /// Represents info to build a graphics pipeline.
 struct GraphicsPipelineBuildInfo
 {
@@ -510,6 +531,9 @@ struct GraphicsPipelineBuildInfo
 #endif
 
     PipelineOptions     options;            ///< Per pipeline tuning/debugging options
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 37
+    PipelineBuildBudget budget;             ///< Compile-time budget of this build
+#endif
 };
 
 /// Represents info to build a compute pipeline.
@@ -522,6 +546,9 @@ struct ComputePipelineBuildInfo
     uint32_t            deviceIndex;        ///< Device index for device group
     PipelineShaderInfo  cs;                 ///< Compute shader
     PipelineOptions     options;            ///< Per pipeline tuning options
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 37
+    PipelineBuildBudget budget;             ///< Compile-time budget of this build
+#endif
 };
 
 /// Represents output of building a compute pipeline.
@@ -544,6 +571,65 @@ typedef Result (*ShaderCacheGetValue)(const void* pClientData, uint64_t hash, vo
 /// Defines callback function used to store shader cache info in an external cache
 typedef Result (*ShaderCacheStoreValue)(const void* pClientData, uint64_t hash, const void* pValue, size_t valueLen);
 
+/// Defines callback function used to receive a chunk of serialized shader cache data
+typedef Result (*ShaderCacheWriteFunc)(void* pUserData, const void* pData, size_t dataSize);
+
+/// Defines callback function invoked when a lookup in a shader cache backend completes. On success, pValue points to
+/// the value (owned by the backend and valid only during the call) and valueSize is its size in bytes.
+typedef void (*ShaderCacheBackendGetCallback)(void*       pContext,
+                                              Result      result,
+                                              uint64_t    key,
+                                              const void* pValue,
+                                              size_t      valueSize);
+
+// =====================================================================================================================
+/// Represents the interface of an external store backing a shader cache, e.g. a remote or on-disk key-value store.
+/// Requests may complete asynchronously on any thread, so the implementation must be thread safe. LLPC never calls into
+/// the backend while holding a shader cache lock.
+class IShaderCacheBackend
+{
+public:
+    /// Looks up the value with the specified key. The callback is invoked exactly once, with Success and the value if
+    /// it was found, ErrorUnavailable if the backend is unusable from now on, or any other result on a miss.
+    ///
+    /// @param [in]  key          Key of the value to look up
+    /// @param [in]  pfnCallback  Callback invoked when the lookup completes
+    /// @param [in]  pContext     Context passed to the callback
+    virtual void GetAsync(
+        uint64_t                      key,
+        ShaderCacheBackendGetCallback pfnCallback,
+        void*                         pContext) = 0;
+
+    /// Looks up a batch of values, typically every key of a batch of pipelines about to be built. The callback is
+    /// invoked once per key, in any order. The key array only has to be valid during the call.
+    ///
+    /// @param [in]  pKeys        Keys of the values to look up
+    /// @param [in]  keyCount     Count of keys
+    /// @param [in]  pfnCallback  Callback invoked when the lookup of each key completes
+    /// @param [in]  pContext     Context passed to the callback
+    virtual void GetBatchAsync(
+        const uint64_t*               pKeys,
+        uint32_t                      keyCount,
+        ShaderCacheBackendGetCallback pfnCallback,
+        void*                         pContext) = 0;
+
+    /// Stores a value. The backend must copy the value before returning; the store itself may complete later.
+    ///
+    /// @param [in]  key        Key of the value
+    /// @param [in]  pValue     Value to store
+    /// @param [in]  valueSize  Size of the value in bytes
+    ///
+    /// @returns Success if the store was accepted, ErrorUnavailable if the backend is unusable from now on.
+    virtual Result PutAsync(
+        uint64_t    key,
+        const void* pValue,
+        size_t      valueSize) = 0;
+
+protected:
+    /// @internal Destructor. Prevent use of delete operator on this interface.
+    virtual ~IShaderCacheBackend() {}
+};
+
 /// Specifies all information necessary to create a shader cache object.
 struct ShaderCacheCreateInfo
 {
@@ -559,6 +645,12 @@ struct ShaderCacheCreateInfo
     const void*            pClientData;
     ShaderCacheGetValue    pfnGetValueFunc;    ///< [Optional] Function to lookup shader cache data in an external cache
     ShaderCacheStoreValue  pfnStoreValueFunc;  ///< [Optional] Function to store shader cache data in an external cache
+
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 37
+    /// [Optional] External store backing the shader cache. It takes precedence over pfnGetValueFunc and
+    /// pfnStoreValueFunc, and must outlive the shader cache.
+    IShaderCacheBackend*   pBackend;
+#endif
 };
 
 // =====================================================================================================================
@@ -597,6 +689,34 @@ public:
     /// Frees all resources associated with this object.
     virtual void Destroy() = 0;
 
+    // NOTE: Methods added after the initial interface are appended below, so that the vtable slots of the methods
+    // above stay the same for clients built against older interface versions.
+
+    /// Serializes the shader cache data through the specified callback, chunk by chunk, so that the whole serialized
+    /// data never has to reside in memory at once. The written data has the same format as that of Serialize().
+    ///
+    /// @param [in]  pfnWrite   Callback receiving the serialized data in order.
+    /// @param [in]  pUserData  User data passed to the callback.
+    ///
+    /// @returns Success if data was serialized successfully, otherwise the failure returned by the callback.
+    virtual Result SerializeToStream(
+        ShaderCacheWriteFunc pfnWrite,
+        void*                pUserData) = 0;
+
+    /// Starts fetching the compiled data of the specified pipelines from the backend of the shader cache, so that
+    /// building them later does not wait for the backend. Only whole-pipeline entries are prefetched. This is a no-op
+    /// if the shader cache has no backend.
+    ///
+    /// @param [in]  graphicsPipelineCount  Count of graphics pipelines
+    /// @param [in]  ppGraphicsPipelines    Build info of graphics pipelines (may be null if the count is zero)
+    /// @param [in]  computePipelineCount   Count of compute pipelines
+    /// @param [in]  ppComputePipelines     Build info of compute pipelines (may be null if the count is zero)
+    virtual void PrefetchPipelines(
+        uint32_t                                graphicsPipelineCount,
+        const GraphicsPipelineBuildInfo* const* ppGraphicsPipelines,
+        uint32_t                                computePipelineCount,
+        const ComputePipelineBuildInfo* const*  ppComputePipelines) = 0;
+
 protected:
     /// @internal Constructor. Prevent use of new operator on this interface.
     IShaderCache() {}
@@ -706,6 +826,12 @@ class ICompiler
 public:
     /// Creates pipeline compiler from the specified info.
     ///
+    /// Compilers with different options may coexist in one process. The options are process-global LLVM options, so
+    /// the options of a compiler are applied while it builds, and builds of compilers whose option strings differ in
+    /// any way are serialized against each other: a build waits until all builds running under different options have
+    /// finished, then all options are parsed again. Builds of compilers with the same option strings run concurrently.
+    /// Clients that need concurrent builds should create their compilers with the same options.
+    ///
     /// @param [in]  optionCount    Count of compilation-option strings
     /// @param [in]  options        An array of compilation-option strings
     /// @param [out] ppCompiler     Pointer to the created pipeline compiler object
@@ -765,6 +891,71 @@ public:
         const ShaderCacheCreateInfo* pCreateInfo,
         IShaderCache**               ppShaderCache) = 0;
 
+    // NOTE: Methods added after the initial interface are appended below, so that the vtable slots of the methods
+    // above stay the same for clients built against older interface versions.
+
+    /// Build graphics pipeline from the specified info for several GPU targets. SPIR-V translation and lowering are
+    /// done once by this compiler and shared by all targets, while patching and code generation are done by the
+    /// compiler of each target, in parallel. The compilers of all targets must have been created with the same options
+    /// as this compiler. The pipeline cache in the build info is ignored; the result of each target is stored in the
+    /// internal shader cache of its compiler. Because the targets are built in parallel, pfnOutputAlloc must be
+    /// thread-safe. With option -use-builder-recorder other than 1, lowering generates IR for a specific target, so
+    /// each target translates and lowers the pipeline itself.
+    ///
+    /// @param [in]  pPipelineInfo      Info to build this graphics pipeline
+    /// @param [in]  targetCount        Count of targets
+    /// @param [in]  ppTargetCompilers  Compilers of the targets, one per target
+    /// @param [out] pPipelineOuts      Outputs of building this graphics pipeline, one per target
+    ///
+    /// @returns Result::Success if successful. Other return codes indicate failure.
+    virtual Result BuildGraphicsPipelineMultiTarget(const GraphicsPipelineBuildInfo* pPipelineInfo,
+                                                    uint32_t                         targetCount,
+                                                    ICompiler*const*                 ppTargetCompilers,
+                                                    GraphicsPipelineBuildOut*        pPipelineOuts) = 0;
+
+    /// Build compute pipeline from the specified info for several GPU targets. See BuildGraphicsPipelineMultiTarget.
+    ///
+    /// @param [in]  pPipelineInfo      Info to build this compute pipeline
+    /// @param [in]  targetCount        Count of targets
+    /// @param [in]  ppTargetCompilers  Compilers of the targets, one per target
+    /// @param [out] pPipelineOuts      Outputs of building this compute pipeline, one per target
+    ///
+    /// @returns Result::Success if successful. Other return codes indicate failure.
+    virtual Result BuildComputePipelineMultiTarget(const ComputePipelineBuildInfo* pPipelineInfo,
+                                                   uint32_t                        targetCount,
+                                                   ICompiler*const*                ppTargetCompilers,
+                                                   ComputePipelineBuildOut*        pPipelineOuts) = 0;
+
+    /// Queues graphics pipelines which are likely to be built later, e.g. with the shader modules just built, for
+    /// speculative compilation on low-priority background threads (see option -speculative-compile-threads). The
+    /// results are stored in the internal shader cache and in the pipeline cache of the build info, so that a later
+    /// build of the same pipeline hits the cache. A build of a pipeline which is still queued, or still in SPIR-V
+    /// translation and lowering of its speculative build, preempts the speculative build, i.e. drops it from the queue
+    /// or cancels it, and builds the pipeline itself, rather than waiting for a low-priority thread. A speculative
+    /// build past lowering is joined instead: the build waits for its result rather than throwing the work done away.
+    ///
+    /// The build infos and the shader module data they reference are copied, so they need not outlive this call.
+    /// However, the pipeline cache in the build info must remain valid until this compiler is destroyed, which
+    /// cancels the speculative builds. The allocator, user data and budget of the build infos are ignored. Pipelines
+    /// are dropped if the queue is full.
+    ///
+    /// @param [in]  pipelineCount  Count of pipelines
+    /// @param [in]  pPipelineInfos Infos to build the graphics pipelines
+    ///
+    /// @returns Result::Success if successful. Other return codes indicate failure.
+    virtual Result SpeculateGraphicsPipelines(uint32_t                         pipelineCount,
+                                              const GraphicsPipelineBuildInfo* pPipelineInfos) = 0;
+
+    /// Queues compute pipelines which are likely to be built later for speculative compilation. See
+    /// SpeculateGraphicsPipelines.
+    ///
+    /// @param [in]  pipelineCount  Count of pipelines
+    /// @param [in]  pPipelineInfos Infos to build the compute pipelines
+    ///
+    /// @returns Result::Success if successful. Other return codes indicate failure.
+    virtual Result SpeculateComputePipelines(uint32_t                        pipelineCount,
+                                             const ComputePipelineBuildInfo* pPipelineInfos) = 0;
+
 protected:
     ICompiler() {}
     /// Destructor
@@ -43,6 +43,24 @@ using namespace llvm;
 using namespace SPIRV;
 using namespace Llpc;
 
+namespace llvm
+{
+
+namespace cl
+{
+
+// -max-reg-indexed-array-size: maximum size of dynamically indexed private arrays kept in VGPRs
+static opt<uint32_t> MaxRegIndexedArraySize("max-reg-indexed-array-size",
+                                            desc("Maximum size (in DWORDs) of dynamically indexed private arrays that "
+                                                 "are kept in VGPRs with indexed register access rather than in "
+                                                 "scratch memory (0 - disable)"),
+                                            value_desc("size"),
+                                            init(32));
+
+} // cl
+
+} // llvm
+
 namespace Llpc
 {
 
@@ -74,6 +92,8 @@ bool SpirvLowerMemoryOp::runOnModule(
 
     SpirvLower::Init(&module);
 
+    PromoteDynIndexedArrays();
+
     visit(m_pModule);
 
     // Remove those instructions that are replaced by this lower pass
@@ -304,6 +324,333 @@ bool SpirvLowerMemoryOp::NeedExpandDynamicIndex(
     return needExpand && allowExpand;
 }
 
+// =====================================================================================================================
+// Promotes dynamically indexed private arrays that are too large to be expanded with "select" chains (see
+// NeedExpandDynamicIndex) to vectors, so that they are kept in VGPRs with indexed register access rather than being
+// placed in scratch memory.
+void SpirvLowerMemoryOp::PromoteDynIndexedArrays()
+{
+    std::vector<AllocaInst*> allocas;
+    for (auto& func : *m_pModule)
+    {
+        if (func.empty())
+        {
+            continue;
+        }
+
+        for (auto& inst : func.getEntryBlock())
+        {
+            auto pAlloca = dyn_cast<AllocaInst>(&inst);
+            if ((pAlloca != nullptr) && IsRegIndexedArrayCandidate(pAlloca))
+            {
+                allocas.push_back(pAlloca);
+            }
+        }
+    }
+
+    for (auto pAlloca : allocas)
+    {
+        PromoteArrayToVector(pAlloca);
+    }
+}
+
+// =====================================================================================================================
+// Checks whether the specified private array is dynamically indexed and is worth being kept in VGPRs.
+bool SpirvLowerMemoryOp::IsRegIndexedArrayCandidate(
+    AllocaInst* pAlloca     // [in] "Alloca" instruction of the array
+    ) const
+{
+    static const uint32_t MaxDynIndexBound = 8;
+
+    // NOTE: Keeping an array in VGPRs occupies one VGPR per DWORD for the whole lifetime of the array, which reduces
+    // occupancy, while each indexed register access costs only a few ALU instructions compared with a scratch memory
+    // round trip. So the larger the array is, the more dynamic accesses are required to pay off: one access for every
+    // 16 DWORDs of the array.
+    static const uint32_t DwordsPerDynAccess = 16;
+
+    auto pArrayTy = dyn_cast<ArrayType>(pAlloca->getAllocatedType());
+    if ((pArrayTy == nullptr) ||
+        (pAlloca->getType()->getPointerAddressSpace() != SPIRAS_Private) ||
+        pAlloca->isArrayAllocation() ||
+        (pArrayTy->getNumElements() <= MaxDynIndexBound))
+    {
+        return false;
+    }
+
+    // Only arrays of 32-bit scalars or vectors are handled
+    auto pElemTy = pArrayTy->getElementType();
+    auto pScalarTy = pElemTy->getScalarType();
+    if ((pScalarTy->isFloatTy() == false) && (pScalarTy->isIntegerTy(32) == false))
+    {
+        return false;
+    }
+
+    const uint32_t compCount = pElemTy->isVectorTy() ? pElemTy->getVectorNumElements() : 1;
+    const uint32_t dwordCount = pArrayTy->getNumElements() * compCount;
+    if (dwordCount > cl::MaxRegIndexedArraySize)
+    {
+        return false;
+    }
+
+    // The array must only be accessed by "load"/"store" of the whole array, or by "getelementptr" that selects one
+    // element (and optionally one component of it) followed by "load"/"store".
+    uint32_t dynAccessCount = 0;
+    for (auto pUser : pAlloca->users())
+    {
+        if (isa<LoadInst>(pUser))
+        {
+            continue;
+        }
+
+        if (auto pStore = dyn_cast<StoreInst>(pUser))
+        {
+            if (pStore->getValueOperand() == pAlloca)
+            {
+                return false;
+            }
+            continue;
+        }
+
+        auto pGetElemPtr = dyn_cast<GetElementPtrInst>(pUser);
+        if ((pGetElemPtr == nullptr) || (pGetElemPtr->getPointerOperand() != pAlloca))
+        {
+            return false;
+        }
+
+        const uint32_t operandCount = pGetElemPtr->getNumOperands();
+        auto pFirstIndex = dyn_cast<ConstantInt>(pGetElemPtr->getOperand(1));
+        if ((pFirstIndex == nullptr) || (pFirstIndex->isZero() == false) || (operandCount < 3) || (operandCount > 4))
+        {
+            return false;
+        }
+        if ((operandCount == 4) && (isa<ConstantInt>(pGetElemPtr->getOperand(3)) == false))
+        {
+            return false;
+        }
+
+        for (auto pGetElemPtrUser : pGetElemPtr->users())
+        {
+            auto pStore = dyn_cast<StoreInst>(pGetElemPtrUser);
+            if ((isa<LoadInst>(pGetElemPtrUser) == false) &&
+                ((pStore == nullptr) || (pStore->getValueOperand() == pGetElemPtr)))
+            {
+                return false;
+            }
+
+            if (isa<Constant>(pGetElemPtr->getOperand(2)) == false)
+            {
+                ++dynAccessCount;
+            }
+        }
+    }
+
+    return (dynAccessCount > 0) && (dynAccessCount * DwordsPerDynAccess >= dwordCount);
+}
+
+// =====================================================================================================================
+// Promotes the specified private array to a flattened vector, which is kept in VGPRs once "alloca" is promoted to
+// registers. Dynamic element accesses become "extractelement"/"insertelement" with dynamic indices, which are lowered
+// to indexed register access by the backend.
+void SpirvLowerMemoryOp::PromoteArrayToVector(
+    AllocaInst* pAlloca)    // [in] "Alloca" instruction of the array
+{
+    auto pArrayTy = cast<ArrayType>(pAlloca->getAllocatedType());
+    auto pElemTy = pArrayTy->getElementType();
+    auto pScalarTy = pElemTy->getScalarType();
+    const uint32_t elemCount = pArrayTy->getNumElements();
+    const uint32_t compCount = pElemTy->isVectorTy() ? pElemTy->getVectorNumElements() : 1;
+
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 23
+    const bool robustBufferAccess = m_pContext->GetTargetMachinePipelineOptions()->robustBufferAccess;
+#else
+    const bool robustBufferAccess = false;
+#endif
+
+    auto pVectorTy = VectorType::get(pScalarTy, elemCount * compCount);
+    auto pVectorAlloca = new AllocaInst(pVectorTy, pAlloca->getType()->getPointerAddressSpace(), "", pAlloca);
+    pVectorAlloca->takeName(pAlloca);
+
+    std::vector<User*> users(pAlloca->user_begin(), pAlloca->user_end());
+    for (auto pUser : users)
+    {
+        Value* pIndex = ConstantInt::get(m_pContext->Int32Ty(), 0);
+        std::vector<Instruction*> accesses;
+        uint32_t accessCompCount = elemCount * compCount;
+        uint32_t accessComp = 0;
+
+        auto pGetElemPtr = dyn_cast<GetElementPtrInst>(pUser);
+        if (pGetElemPtr != nullptr)
+        {
+            // Access of one element, or one component of one element
+            pIndex = pGetElemPtr->getOperand(2);
+            accessCompCount = compCount;
+            if (pGetElemPtr->getNumOperands() == 4)
+            {
+                accessComp = cast<ConstantInt>(pGetElemPtr->getOperand(3))->getZExtValue();
+                accessCompCount = 1;
+            }
+
+            for (auto pGetElemPtrUser : pGetElemPtr->users())
+            {
+                accesses.push_back(cast<Instruction>(pGetElemPtrUser));
+            }
+        }
+        else
+        {
+            // Access of the whole array
+            accesses.push_back(cast<Instruction>(pUser));
+        }
+
+        for (auto pAccess : accesses)
+        {
+            auto pVector = new LoadInst(pVectorAlloca, "", pAccess);
+
+            if (auto pLoad = dyn_cast<LoadInst>(pAccess))
+            {
+                // Gather the accessed components from the vector
+                Value* pLoadValue = UndefValue::get(pLoad->getType());
+                for (uint32_t i = 0; i < accessCompCount; ++i)
+                {
+                    if (pGetElemPtr != nullptr)
+                    {
+                        auto pVectorIndex = GetVectorIndex(pIndex, compCount, accessComp + i, pLoad);
+                        auto pComp = ExtractElementInst::Create(pVector, pVectorIndex, "", pLoad);
+                        pLoadValue = (accessCompCount == 1) ?
+                                     pComp :
+                                     InsertElementInst::Create(pLoadValue,
+                                                               pComp,
+                                                               ConstantInt::get(m_pContext->Int32Ty(), i),
+                                                               "",
+                                                               pLoad);
+                    }
+                    else
+                    {
+                        // Load of the whole array, rebuild the array from the components of its elements
+                        const uint32_t elemIdx = i / compCount;
+                        Value* pComp = ExtractElementInst::Create(pVector,
+                                                                  ConstantInt::get(m_pContext->Int32Ty(), i),
+                                                                  "",
+                                                                  pLoad);
+                        if (compCount > 1)
+                        {
+                            auto pElem = ExtractValueInst::Create(pLoadValue, elemIdx, "", pLoad);
+                            pComp = InsertElementInst::Create(pElem,
+                                                              pComp,
+                                                              ConstantInt::get(m_pContext->Int32Ty(), i % compCount),
+                                                              "",
+                                                              pLoad);
+                        }
+                        pLoadValue = InsertValueInst::Create(pLoadValue, pComp, elemIdx, "", pLoad);
+                    }
+                }
+
+                if (robustBufferAccess && (pGetElemPtr != nullptr) && (isa<Constant>(pIndex) == false))
+                {
+                    // NOTE: An out-of-bounds "extractelement" yields an undefined value, so out-of-bounds loads
+                    // return zero instead, like out-of-bounds stores are dropped below.
+                    auto pInBounds = new ICmpInst(pLoad,
+                                                  ICmpInst::ICMP_ULT,
+                                                  pIndex,
+                                                  ConstantInt::get(pIndex->getType(), elemCount));
+                    pLoadValue = SelectInst::Create(pInBounds,
+                                                    pLoadValue,
+                                                    Constant::getNullValue(pLoad->getType()),
+                                                    "",
+                                                    pLoad);
+                }
+
+                pLoad->replaceAllUsesWith(pLoadValue);
+            }
+            else
+            {
+                // Scatter the stored components to the vector
+                auto pStore = cast<StoreInst>(pAccess);
+                Value* pStoreValue = pStore->getValueOperand();
+                Value* pNewVector = pVector;
+                for (uint32_t i = 0; i < accessCompCount; ++i)
+                {
+                    Value* pComp = pStoreValue;
+                    Value* pVectorIndex = nullptr;
+                    if (pGetElemPtr != nullptr)
+                    {
+                        pVectorIndex = GetVectorIndex(pIndex, compCount, accessComp + i, pStore);
+                        if (accessCompCount > 1)
+                        {
+                            pComp = ExtractElementInst::Create(pStoreValue,
+                                                               ConstantInt::get(m_pContext->Int32Ty(), i),
+                                                               "",
+                                                               pStore);
+                        }
+                    }
+                    else
+                    {
+                        // Store of the whole array, split the array to the components of its elements
+                        pVectorIndex = ConstantInt::get(m_pContext->Int32Ty(), i);
+                        pComp = ExtractValueInst::Create(pStoreValue, i / compCount, "", pStore);
+                        if (compCount > 1)
+                        {
+                            pComp = ExtractElementInst::Create(pComp,
+                                                               ConstantInt::get(m_pContext->Int32Ty(), i % compCount),
+                                                               "",
+                                                               pStore);
+                        }
+                    }
+
+                    pNewVector = InsertElementInst::Create(pNewVector, pComp, pVectorIndex, "", pStore);
+                }
+
+                if (robustBufferAccess && (pGetElemPtr != nullptr) && (isa<Constant>(pIndex) == false))
+                {
+                    // NOTE: An out-of-bounds "insertelement" yields an undefined vector, so out-of-bounds stores
+                    // must be dropped explicitly to keep the other elements intact.
+                    auto pInBounds = new ICmpInst(pStore,
+                                                  ICmpInst::ICMP_ULT,
+                                                  pIndex,
+                                                  ConstantInt::get(pIndex->getType(), elemCount));
+                    pNewVector = SelectInst::Create(pInBounds, pNewVector, pVector, "", pStore);
+                }
+
+                new StoreInst(pNewVector, pVectorAlloca, pStore);
+            }
+
+            pAccess->eraseFromParent();
+        }
+
+        if (pGetElemPtr != nullptr)
+        {
+            pGetElemPtr->eraseFromParent();
+        }
+    }
+
+    pAlloca->eraseFromParent();
+}
+
+// =====================================================================================================================
+// Gets the index of the specified component of an array element in the flattened vector of the array.
+Value* SpirvLowerMemoryOp::GetVectorIndex(
+    Value*       pIndex,        // [in] Index of the array element
+    uint32_t     compCount,     // Count of components of each array element
+    uint32_t     comp,          // Component of the array element
+    Instruction* pInsertPos)    // [in] Where to insert instructions
+{
+    Value* pVectorIndex = CastInst::CreateIntegerCast(pIndex, m_pContext->Int32Ty(), false, "", pInsertPos);
+    if (compCount > 1)
+    {
+        pVectorIndex = BinaryOperator::CreateMul(pVectorIndex,
+                                                 ConstantInt::get(m_pContext->Int32Ty(), compCount),
+                                                 "",
+                                                 pInsertPos);
+    }
+    if (comp > 0)
+    {
+        pVectorIndex = BinaryOperator::CreateAdd(pVectorIndex,
+                                                 ConstantInt::get(m_pContext->Int32Ty(), comp),
+                                                 "",
+                                                 pInsertPos);
+    }
+    return pVectorIndex;
+}
+
 // =====================================================================================================================
 // Expands "load" instruction with constant-index "getelementptr" instructions.
 void SpirvLowerMemoryOp::ExpandLoadInst(
@@ -66,6 +66,11 @@ public:
 private:
     LLPC_DISALLOW_COPY_AND_ASSIGN(SpirvLowerMemoryOp);
 
+    void PromoteDynIndexedArrays();
+    bool IsRegIndexedArrayCandidate(llvm::AllocaInst* pAlloca) const;
+    void PromoteArrayToVector(llvm::AllocaInst* pAlloca);
+    llvm::Value* GetVectorIndex(llvm::Value* pIndex, uint32_t compCount, uint32_t comp, llvm::Instruction* pInsertPos);
+
     bool NeedExpandDynamicIndex(llvm::GetElementPtrInst* pGetElemPtr,
                                 uint32_t*                pOperandIndex,
                                 uint32_t*                pDynIndexBound) const;
@@ -87,7 +87,15 @@ Result CodeGenManager::CreateTargetMachine(
     Context*               pContext,          // [in/out] Pipeline context
     const PipelineOptions* pPipelineOptions)  // [in] Pipeline options
 {
+    // The fast optimization tier, used to retry a pipeline build that exceeded its time limit, runs less expensive
+    // code generation.
+    const PipelineContext* pPipelineContext = pContext->GetPipelineContext();
+    CodeGenOpt::Level optLevel = ((pPipelineContext != nullptr) && pPipelineContext->IsFastOptTier()) ?
+                                 CodeGenOpt::Less :
+                                 CodeGenOpt::Default;
+
     if ((pContext->GetTargetMachine() != nullptr) &&
+        (pContext->GetTargetMachine()->getOptLevel() == optLevel) &&
         (pPipelineOptions->includeDisassembly == pContext->GetTargetMachinePipelineOptions()->includeDisassembly) &&
 #if LLPC_CLIENT_INTERFACE_MAJOR_VERSION < 30
         (pPipelineOptions->autoLayoutDesc == pContext->GetTargetMachinePipelineOptions()->autoLayoutDesc) &&
@@ -126,7 +134,9 @@ Result CodeGenManager::CreateTargetMachine(
                                                            pContext->GetGpuNameString(),
                                                            features,
                                                            targetOpts,
-                                                           relocModel);
+                                                           relocModel,
+                                                           None,
+                                                           optLevel);
         if (pTargetMachine != nullptr)
         {
             pContext->SetTargetMachine(pTargetMachine, pPipelineOptions);
@@ -81,6 +81,11 @@ opt<bool> UseLlvmOpt("use-llvm-opt",
                      desc("Use LLVM's standard optimization set instead of the curated optimization set"),
                      init(false));
 
+// -pack-in-out: pack generic inputs/outputs of different locations into shared locations
+opt<bool> PackInOut("pack-in-out",
+                    desc("Pack scalar and vector generic inputs/outputs of different locations into shared locations"),
+                    init(false));
+
 } // cl
 
 } // llvm
@@ -118,6 +123,9 @@ void Patch::AddPrePatchPasses(
     // Build null fragment shader if necessary
     passMgr.add(CreatePatchNullFragShader());
 
+    // Select the wave size of each shader stage (must be before resource collecting, which consults the wave size)
+    passMgr.add(CreatePatchWaveSizeSelect());
+
     // Patch resource collecting, remove inactive resources (should be the first preliminary pass)
     passMgr.add(CreatePatchResourceCollect());
 
@@ -262,8 +270,23 @@ void Patch::AddOptimizationPasses(
     Context*              pContext, // [in] LLPC context
     legacy::PassManager&  passMgr)  // [in/out] Pass manager to add passes to
 {
+    // Set up a reduced set of optimization passes for the fast optimization tier, which is used to retry a pipeline
+    // build that exceeded its time limit. It has no loop optimizations.
+    if (pContext->GetPipelineContext()->IsFastOptTier())
+    {
+        bool expensiveCombines = false;
+
+        passMgr.add(createPromoteMemoryToRegisterPass());
+        passMgr.add(createSROAPass());
+        passMgr.add(createEarlyCSEPass(true));
+        passMgr.add(createInstructionCombiningPass(expensiveCombines));
+        passMgr.add(CreatePatchPeepholeOpt());
+        passMgr.add(createCFGSimplificationPass());
+        passMgr.add(createAggressiveDCEPass());
+        passMgr.add(createGlobalDCEPass());
+    }
     // Set up standard optimization passes.
-    if (cl::UseLlvmOpt == false)
+    else if (cl::UseLlvmOpt == false)
     {
         uint32_t optLevel = 3;
         bool expensiveCombines = false;
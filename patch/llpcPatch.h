@@ -50,6 +50,7 @@ class PassManager;
 } // legacy
 
 void initializePatchBufferOpPass(PassRegistry&);
+void initializePatchColorExportEpilogPass(PassRegistry&);
 void initializePatchCopyShaderPass(PassRegistry&);
 void initializePatchDescriptorLoadPass(PassRegistry&);
 void initializePatchEntryPointMutatePass(PassRegistry&);
@@ -62,6 +63,8 @@ void initializePatchPreparePipelineAbiPass(PassRegistry&);
 void initializePatchPushConstOpPass(PassRegistry&);
 void initializePatchResourceCollectPass(PassRegistry&);
 void initializePatchSetupTargetFeaturesPass(PassRegistry&);
+void initializePatchVertexFetchPrologPass(PassRegistry&);
+void initializePatchWaveSizeSelectPass(PassRegistry&);
 
 } // llvm
 
@@ -73,6 +76,7 @@ inline static void InitializePatchPasses(
     llvm::PassRegistry& passRegistry)   // Pass registry
 {
   initializePatchBufferOpPass(passRegistry);
+  initializePatchColorExportEpilogPass(passRegistry);
   initializePatchCopyShaderPass(passRegistry);
   initializePatchDescriptorLoadPass(passRegistry);
   initializePatchEntryPointMutatePass(passRegistry);
@@ -84,9 +88,12 @@ inline static void InitializePatchPasses(
   initializePatchPushConstOpPass(passRegistry);
   initializePatchResourceCollectPass(passRegistry);
   initializePatchSetupTargetFeaturesPass(passRegistry);
+  initializePatchVertexFetchPrologPass(passRegistry);
+  initializePatchWaveSizeSelectPass(passRegistry);
 }
 
 llvm::FunctionPass* CreatePatchBufferOp();
+llvm::ModulePass* CreatePatchColorExportEpilog();
 llvm::ModulePass* CreatePatchCopyShader();
 llvm::ModulePass* CreatePatchDescriptorLoad();
 llvm::ModulePass* CreatePatchEntryPointMutate();
@@ -99,6 +106,8 @@ llvm::ModulePass* CreatePatchPreparePipelineAbi(bool onlySetCallingConvs, uint32
 llvm::ModulePass* CreatePatchPushConstOp();
 llvm::ModulePass* CreatePatchResourceCollect();
 llvm::ModulePass* CreatePatchSetupTargetFeatures();
+llvm::ModulePass* CreatePatchVertexFetchProlog();
+llvm::ModulePass* CreatePatchWaveSizeSelect();
 
 class Context;
 class PipelineState;
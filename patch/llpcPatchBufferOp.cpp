@@ -1062,12 +1062,6 @@ void PatchBufferOp::visitPtrToIntInst(
 void PatchBufferOp::PostVisitMemCpyInst(
     MemCpyInst& memCpyInst) // [in] The memcpy instruction
 {
-    Value* const pDest = memCpyInst.getArgOperand(0);
-    Value* const pSrc = memCpyInst.getArgOperand(1);
-
-    const uint32_t destAddrSpace = pDest->getType()->getPointerAddressSpace();
-    const uint32_t srcAddrSpace = pSrc->getType()->getPointerAddressSpace();
-
     m_pBuilder->SetInsertPoint(&memCpyInst);
 
     const uint32_t destAlignment = memCpyInst.getParamAlignment(0);
@@ -1083,127 +1077,71 @@ void PatchBufferOp::PostVisitMemCpyInst(
     // causes LLVM's optimizations and our AMDGPU backend to crawl (and generate worse code!).
     if ((pConstantLength == nullptr) || (constantLength > MinMemOpLoopBytes))
     {
-        // NOTE: We want to perform our memcpy operation on the greatest stride of bytes possible (load/storing up to
-        // DWORDx4 or 16 bytes per loop iteration). If we have a constant length, we check if the the alignment and
-        // number of bytes to copy lets us load/store 16 bytes per loop iteration, and if not we check 8, then 4, then
-        // 2. Worst case we have to load/store a single byte per loop.
-        uint32_t stride = (pConstantLength == nullptr) ? 1 : 16;
+        Value* const pLength = memCpyInst.getArgOperand(2);
 
-        while (stride != 1)
-        {
-            // We only care about DWORD alignment (4 bytes) so clamp the max check here to that.
-            const uint32_t minStride = std::min(stride, 4u);
-            if ((destAlignment >= minStride) && (srcAlignment >= minStride) && ((constantLength % stride) == 0))
-            {
-                break;
-            }
+        Type* const pLengthType = pLength->getType();
 
-            stride /= 2;
-        }
+        const uint32_t stride = GetMemOpLoopStride(std::min(destAlignment, srcAlignment), pConstantLength);
 
-        Type* pCastDestType = nullptr;
-        Type* pCastSrcType = nullptr;
+        Type* const pStrideType = (stride == 16) ? m_pContext->Int32x4Ty() : m_pBuilder->getIntNTy(stride * 8);
 
+        // NOTE: With a DWORDx4 stride, the loop only covers the length rounded down to a multiple of 16 bytes. The
+        // remaining bytes are copied after the loop.
+        Value* pLoopEnd = pLength;
         if (stride == 16)
         {
-            pCastDestType = m_pContext->Int32x4Ty()->getPointerTo(destAddrSpace);
-            pCastSrcType = m_pContext->Int32x4Ty()->getPointerTo(srcAddrSpace);
-        }
-        else
-        {
-            LLPC_ASSERT(stride < 8);
-            pCastDestType = m_pBuilder->getIntNTy(stride * 8)->getPointerTo(destAddrSpace);
-            pCastSrcType = m_pBuilder->getIntNTy(stride * 8)->getPointerTo(srcAddrSpace);
+            pLoopEnd = m_pBuilder->CreateAnd(pLength, ConstantInt::get(pLengthType, ~static_cast<uint64_t>(15)));
+            CopyMetadata(pLoopEnd, &memCpyInst);
         }
 
-        Value* pLength = memCpyInst.getArgOperand(2);
-
-        Type* const pLengthType = pLength->getType();
-
         Value* const pIndex = MakeLoop(ConstantInt::get(pLengthType, 0),
-                                       pLength,
+                                       pLoopEnd,
                                        ConstantInt::get(pLengthType, stride),
                                        &memCpyInst);
 
-        // Get the current index into our source pointer.
-        Value* const pSrcPtr = m_pBuilder->CreateGEP(pSrc, pIndex);
-        CopyMetadata(pSrcPtr, &memCpyInst);
-
-        Value* const pCastSrc = m_pBuilder->CreateBitCast(pSrcPtr, pCastSrcType);
-        CopyMetadata(pCastSrc, &memCpyInst);
-
-        // Perform a load for the value.
-        LoadInst* const pSrcLoad = m_pBuilder->CreateLoad(pCastSrc);
-        CopyMetadata(pSrcLoad, &memCpyInst);
-
-        // Get the current index into our destination pointer.
-        Value* const pDestPtr = m_pBuilder->CreateGEP(pDest, pIndex);
-        CopyMetadata(pDestPtr, &memCpyInst);
-
-        Value* const pCastDest = m_pBuilder->CreateBitCast(pDestPtr, pCastDestType);
-        CopyMetadata(pCastDest, &memCpyInst);
+        CopyMemory(memCpyInst,
+                   pIndex,
+                   pStrideType,
+                   MinAlign(destAlignment, stride),
+                   MinAlign(srcAlignment, stride));
 
-        // And perform a store for the value at this byte.
-        StoreInst* const pDestStore = m_pBuilder->CreateStore(pSrcLoad, pCastDest);
-        CopyMetadata(pDestStore, &memCpyInst);
-
-        // Visit the newly added instructions to turn them into fat pointer variants.
-        if (GetElementPtrInst* const pGetElemPtr = dyn_cast<GetElementPtrInst>(pSrcPtr))
-        {
-            visitGetElementPtrInst(*pGetElemPtr);
-        }
-
-        if (GetElementPtrInst* const pGetElemPtr = dyn_cast<GetElementPtrInst>(pDestPtr))
+        if (stride == 16)
         {
-            visitGetElementPtrInst(*pGetElemPtr);
-        }
+            m_pBuilder->SetInsertPoint(&memCpyInst);
 
-        if (BitCastInst* const pCast = dyn_cast<BitCastInst>(pCastSrc))
-        {
-            visitBitCastInst(*pCast);
-        }
+            if (pConstantLength != nullptr)
+            {
+                // Copy the remaining bytes with a single unrolled access, which is split into the widest loads and
+                // stores the alignment allows.
+                const uint64_t remainingBytes = constantLength % 16;
+                if (remainingBytes != 0)
+                {
+                    const uint64_t offset = constantLength - remainingBytes;
+                    CopyMemory(memCpyInst,
+                               ConstantInt::get(pLengthType, offset),
+                               VectorType::get(m_pBuilder->getInt8Ty(), remainingBytes),
+                               MinAlign(destAlignment, offset),
+                               MinAlign(srcAlignment, offset));
+                }
+            }
+            else
+            {
+                // Copy the remaining bytes (fewer than 16) one at a time.
+                Value* const pRemainderIndex = MakeLoop(pLoopEnd,
+                                                        pLength,
+                                                        ConstantInt::get(pLengthType, 1),
+                                                        &memCpyInst);
 
-        if (BitCastInst* const pCast = dyn_cast<BitCastInst>(pCastDest))
-        {
-            visitBitCastInst(*pCast);
+                CopyMemory(memCpyInst, pRemainderIndex, m_pBuilder->getInt8Ty(), 1, 1);
+            }
         }
-
-        visitLoadInst(*pSrcLoad);
-
-        visitStoreInst(*pDestStore);
     }
     else
     {
         // Get an vector type that is the length of the memcpy.
-        VectorType* const pMemoryType = VectorType::get(m_pBuilder->getInt8Ty(), pConstantLength->getZExtValue());
-
-        PointerType* const pCastDestType = pMemoryType->getPointerTo(destAddrSpace);
-        Value* const pCastDest = m_pBuilder->CreateBitCast(pDest, pCastDestType);
-        CopyMetadata(pCastDest, &memCpyInst);
+        VectorType* const pMemoryType = VectorType::get(m_pBuilder->getInt8Ty(), constantLength);
 
-        PointerType* const pCastSrcType = pMemoryType->getPointerTo(srcAddrSpace);
-        Value* const pCastSrc = m_pBuilder->CreateBitCast(pSrc, pCastSrcType);
-        CopyMetadata(pCastSrc, &memCpyInst);
-
-        LoadInst* const pSrcLoad = m_pBuilder->CreateAlignedLoad(pCastSrc, srcAlignment);
-        CopyMetadata(pSrcLoad, &memCpyInst);
-
-        StoreInst* const pDestStore = m_pBuilder->CreateAlignedStore(pSrcLoad, pCastDest, destAlignment);
-        CopyMetadata(pDestStore, &memCpyInst);
-
-        // Visit the newly added instructions to turn them into fat pointer variants.
-        if (BitCastInst* const pCast = dyn_cast<BitCastInst>(pCastDest))
-        {
-            visitBitCastInst(*pCast);
-        }
-
-        if (BitCastInst* const pCast = dyn_cast<BitCastInst>(pCastSrc))
-        {
-            visitBitCastInst(*pCast);
-        }
-
-        visitLoadInst(*pSrcLoad);
-        visitStoreInst(*pDestStore);
+        CopyMemory(memCpyInst, nullptr, pMemoryType, destAlignment, srcAlignment);
     }
 
     // Record the memcpy instruction so we remember to delete it later.
@@ -1215,10 +1153,6 @@ void PatchBufferOp::PostVisitMemCpyInst(
 void PatchBufferOp::PostVisitMemSetInst(
     MemSetInst& memSetInst) // [in] The memset instruction
 {
-    Value* const pDest = memSetInst.getArgOperand(0);
-
-    const uint32_t destAddrSpace = pDest->getType()->getPointerAddressSpace();
-
     m_pBuilder->SetInsertPoint(&memSetInst);
 
     Value* const pValue = memSetInst.getArgOperand(1);
@@ -1235,141 +1169,231 @@ void PatchBufferOp::PostVisitMemSetInst(
     // causes LLVM's optimizations and our AMDGPU backend to crawl (and generate worse code!).
     if ((pConstantLength == nullptr) || (constantLength > MinMemOpLoopBytes))
     {
-        // NOTE: We want to perform our memset operation on the greatest stride of bytes possible (load/storing up to
-        // DWORDx4 or 16 bytes per loop iteration). If we have a constant length, we check if the the alignment and
-        // number of bytes to copy lets us load/store 16 bytes per loop iteration, and if not we check 8, then 4, then
-        // 2. Worst case we have to load/store a single byte per loop.
-        uint32_t stride = (pConstantLength == nullptr) ? 1 : 16;
+        Value* const pLength = memSetInst.getArgOperand(2);
 
-        while (stride != 1)
-        {
-            // We only care about DWORD alignment (4 bytes) so clamp the max check here to that.
-            const uint32_t minStride = std::min(stride, 4u);
-            if ((destAlignment >= minStride) && ((constantLength % stride) == 0))
-            {
-                break;
-            }
+        Type* const pLengthType = pLength->getType();
 
-            stride /= 2;
-        }
+        const uint32_t stride = GetMemOpLoopStride(destAlignment, pConstantLength);
 
-        Type* pCastDestType = nullptr;
+        Type* const pStrideType = (stride == 16) ? m_pContext->Int32x4Ty() : m_pBuilder->getIntNTy(stride * 8);
 
+        // Splat the byte value before the loop, so that it is not recomputed in every iteration.
+        Value* const pNewValue = GetMemSetValue(memSetInst, pValue, pStrideType);
+
+        // NOTE: With a DWORDx4 stride, the loop only covers the length rounded down to a multiple of 16 bytes. The
+        // remaining bytes are set after the loop.
+        Value* pLoopEnd = pLength;
         if (stride == 16)
         {
-            pCastDestType = m_pContext->Int32x4Ty()->getPointerTo(destAddrSpace);
-        }
-        else
-        {
-            LLPC_ASSERT(stride < 8);
-            pCastDestType = m_pBuilder->getIntNTy(stride * 8)->getPointerTo(destAddrSpace);
+            pLoopEnd = m_pBuilder->CreateAnd(pLength, ConstantInt::get(pLengthType, ~static_cast<uint64_t>(15)));
+            CopyMetadata(pLoopEnd, &memSetInst);
         }
 
-        Value* pNewValue = nullptr;
+        Value* const pIndex = MakeLoop(ConstantInt::get(pLengthType, 0),
+                                       pLoopEnd,
+                                       ConstantInt::get(pLengthType, stride),
+                                       &memSetInst);
+
+        SetMemory(memSetInst, pIndex, pNewValue, MinAlign(destAlignment, stride));
 
-        if (Constant* const pConst = dyn_cast<Constant>(pValue))
+        if (stride == 16)
         {
-            pNewValue = ConstantVector::getSplat(stride, pConst);
-            pNewValue = m_pBuilder->CreateBitCast(pNewValue, pCastDestType->getPointerElementType());
-            CopyMetadata(pNewValue, &memSetInst);
+            m_pBuilder->SetInsertPoint(&memSetInst);
+
+            if (pConstantLength != nullptr)
+            {
+                // Set the remaining bytes with a single unrolled access, which is split into the widest stores the
+                // alignment allows.
+                const uint64_t remainingBytes = constantLength % 16;
+                if (remainingBytes != 0)
+                {
+                    const uint64_t offset = constantLength - remainingBytes;
+                    Value* const pRemainderValue =
+                        GetMemSetValue(memSetInst, pValue, VectorType::get(m_pBuilder->getInt8Ty(), remainingBytes));
+
+                    SetMemory(memSetInst,
+                              ConstantInt::get(pLengthType, offset),
+                              pRemainderValue,
+                              MinAlign(destAlignment, offset));
+                }
+            }
+            else
+            {
+                // Set the remaining bytes (fewer than 16) one at a time.
+                Value* const pRemainderIndex = MakeLoop(pLoopEnd,
+                                                        pLength,
+                                                        ConstantInt::get(pLengthType, 1),
+                                                        &memSetInst);
+
+                SetMemory(memSetInst, pRemainderIndex, pValue, 1);
+            }
         }
-        else
-        {
-            Value* const pMemoryPointer = m_pBuilder->CreateAlloca(pCastDestType->getPointerElementType());
-            CopyMetadata(pMemoryPointer, &memSetInst);
+    }
+    else
+    {
+        // Get a vector type that is the length of the memset.
+        VectorType* const pMemoryType = VectorType::get(m_pBuilder->getInt8Ty(), constantLength);
 
-            Type* const pInt8PtrTy = m_pBuilder->getInt8Ty()->getPointerTo(ADDR_SPACE_PRIVATE);
-            Value* const pCastMemoryPointer = m_pBuilder->CreateBitCast(pMemoryPointer, pInt8PtrTy);
-            CopyMetadata(pCastMemoryPointer, &memSetInst);
+        Value* const pNewValue = GetMemSetValue(memSetInst, pValue, pMemoryType);
 
-            Value* const pMemSet = m_pBuilder->CreateMemSet(pCastMemoryPointer,
-                                                            pValue,
-                                                            stride,
-                                                            1);
-            CopyMetadata(pMemSet, &memSetInst);
+        SetMemory(memSetInst, nullptr, pNewValue, destAlignment);
+    }
 
-            pNewValue = m_pBuilder->CreateLoad(pMemoryPointer);
-            CopyMetadata(pNewValue, &memSetInst);
-        }
+    // Record the memset instruction so we remember to delete it later.
+    m_replacementMap[&memSetInst] = std::make_pair(nullptr, nullptr);
+}
 
-        Value* const pLength = memSetInst.getArgOperand(2);
+// =====================================================================================================================
+// Gets the stride of the loop that lowers a memcpy or memset. We want to perform the operation on the greatest stride
+// of bytes possible: if the pointers are DWORD aligned, we load/store DWORDx4 (16 bytes) per loop iteration and handle
+// the remaining bytes after the loop. Otherwise we load/store 2 bytes per loop iteration if the alignment and a
+// constant length allow it, and worst case a single byte per loop iteration.
+uint32_t PatchBufferOp::GetMemOpLoopStride(
+    uint32_t           alignment,       // Alignment of the pointers
+    const ConstantInt* pConstantLength  // [in] Length of the memory operation, if constant
+    ) const
+{
+    // We only care about DWORD alignment (4 bytes), as buffer loads/stores of DWORDx4 only require that.
+    if (alignment >= 4)
+    {
+        return 16;
+    }
 
-        Type* const pLengthType = pLength->getType();
+    if ((alignment >= 2) && (pConstantLength != nullptr) && ((pConstantLength->getZExtValue() % 2) == 0))
+    {
+        return 2;
+    }
 
-        Value* const pIndex = MakeLoop(ConstantInt::get(pLengthType, 0),
-                                       pLength,
-                                       ConstantInt::get(pLengthType, stride),
-                                       &memSetInst);
+    return 1;
+}
 
-        // Get the current index into our destination pointer.
-        Value* const pDestPtr = m_pBuilder->CreateGEP(pDest, pIndex);
-        CopyMetadata(pDestPtr, &memSetInst);
+// =====================================================================================================================
+// Copies a value of the specified type from the source to the destination of a memcpy, at the specified byte offset,
+// and turns the new instructions into fat pointer variants.
+void PatchBufferOp::CopyMemory(
+    MemCpyInst& memCpyInst,     // [in] The memcpy instruction
+    Value*      pOffset,        // [in] Byte offset to copy at (nullptr for zero)
+    Type*       pCopyType,      // [in] Type of the value to copy
+    uint32_t    destAlignment,  // Alignment of the destination at the offset
+    uint32_t    srcAlignment)   // Alignment of the source at the offset
+{
+    Value* const pDest = memCpyInst.getArgOperand(0);
+    Value* const pSrc = memCpyInst.getArgOperand(1);
 
-        Value* const pCastDest = m_pBuilder->CreateBitCast(pDestPtr, pCastDestType);
-        CopyMetadata(pCastDest, &memSetInst);
+    Value* pSrcPtr = pSrc;
+    Value* pDestPtr = pDest;
+    if (pOffset != nullptr)
+    {
+        // Get the current index into our source and destination pointers.
+        pSrcPtr = m_pBuilder->CreateGEP(pSrc, pOffset);
+        CopyMetadata(pSrcPtr, &memCpyInst);
 
-        // And perform a store for the value at this byte.
-        StoreInst* const pDestStore = m_pBuilder->CreateStore(pNewValue, pCastDest);
-        CopyMetadata(pDestStore, &memSetInst);
+        pDestPtr = m_pBuilder->CreateGEP(pDest, pOffset);
+        CopyMetadata(pDestPtr, &memCpyInst);
+    }
 
-        if (GetElementPtrInst* const pGetElemPtr = dyn_cast<GetElementPtrInst>(pDestPtr))
-        {
-            visitGetElementPtrInst(*pGetElemPtr);
-        }
+    PointerType* const pCastSrcType = pCopyType->getPointerTo(pSrc->getType()->getPointerAddressSpace());
+    Value* const pCastSrc = m_pBuilder->CreateBitCast(pSrcPtr, pCastSrcType);
+    CopyMetadata(pCastSrc, &memCpyInst);
 
-        if (BitCastInst* const pCast = dyn_cast<BitCastInst>(pCastDest))
-        {
-            visitBitCastInst(*pCast);
-        }
+    PointerType* const pCastDestType = pCopyType->getPointerTo(pDest->getType()->getPointerAddressSpace());
+    Value* const pCastDest = m_pBuilder->CreateBitCast(pDestPtr, pCastDestType);
+    CopyMetadata(pCastDest, &memCpyInst);
+
+    // Perform a load for the value.
+    LoadInst* const pSrcLoad = m_pBuilder->CreateAlignedLoad(pCastSrc, srcAlignment);
+    CopyMetadata(pSrcLoad, &memCpyInst);
+
+    // And perform a store for the value.
+    StoreInst* const pDestStore = m_pBuilder->CreateAlignedStore(pSrcLoad, pCastDest, destAlignment);
+    CopyMetadata(pDestStore, &memCpyInst);
 
-        visitStoreInst(*pDestStore);
+    // Visit the newly added instructions to turn them into fat pointer variants.
+    if (GetElementPtrInst* const pGetElemPtr = dyn_cast<GetElementPtrInst>(pSrcPtr))
+    {
+        visitGetElementPtrInst(*pGetElemPtr);
     }
-    else
+
+    if (GetElementPtrInst* const pGetElemPtr = dyn_cast<GetElementPtrInst>(pDestPtr))
     {
-        // Get a vector type that is the length of the memset.
-        VectorType* const pMemoryType = VectorType::get(m_pBuilder->getInt8Ty(), pConstantLength->getZExtValue());
+        visitGetElementPtrInst(*pGetElemPtr);
+    }
 
-        Value* pNewValue = nullptr;
+    if (BitCastInst* const pCast = dyn_cast<BitCastInst>(pCastSrc))
+    {
+        visitBitCastInst(*pCast);
+    }
 
-        if (Constant* const pConst = dyn_cast<Constant>(pValue))
-        {
-            pNewValue = ConstantVector::getSplat(pMemoryType->getVectorNumElements(), pConst);
-        }
-        else
-        {
-            Value* const pMemoryPointer = m_pBuilder->CreateAlloca(pMemoryType);
-            CopyMetadata(pMemoryPointer, &memSetInst);
+    if (BitCastInst* const pCast = dyn_cast<BitCastInst>(pCastDest))
+    {
+        visitBitCastInst(*pCast);
+    }
 
-            Type* const pInt8PtrTy = m_pBuilder->getInt8Ty()->getPointerTo(ADDR_SPACE_PRIVATE);
-            Value* const pCastMemoryPointer = m_pBuilder->CreateBitCast(pMemoryPointer, pInt8PtrTy);
-            CopyMetadata(pCastMemoryPointer, &memSetInst);
+    visitLoadInst(*pSrcLoad);
+    visitStoreInst(*pDestStore);
+}
 
-            Value* const pMemSet = m_pBuilder->CreateMemSet(pCastMemoryPointer,
-                                                            pValue,
-                                                            pMemoryType->getVectorNumElements(),
-                                                            1);
-            CopyMetadata(pMemSet, &memSetInst);
+// =====================================================================================================================
+// Gets the value of the specified type that has every byte set to the byte value of a memset.
+Value* PatchBufferOp::GetMemSetValue(
+    MemSetInst& memSetInst, // [in] The memset instruction
+    Value*      pValue,     // [in] The byte value
+    Type*       pSetType)   // [in] Type of the value to get
+{
+    const DataLayout& dataLayout = memSetInst.getModule()->getDataLayout();
+    const uint32_t byteCount = static_cast<uint32_t>(dataLayout.getTypeSizeInBits(pSetType) / 8);
 
-            pNewValue = m_pBuilder->CreateLoad(pMemoryPointer);
-            CopyMetadata(pNewValue, &memSetInst);
-        }
+    Value* pNewValue = pValue;
+    if (byteCount > 1)
+    {
+        pNewValue = m_pBuilder->CreateVectorSplat(byteCount, pValue);
+        CopyMetadata(pNewValue, &memSetInst);
+    }
 
-        PointerType* const pCastDestType = pMemoryType->getPointerTo(destAddrSpace);
-        Value* const pCastDest = m_pBuilder->CreateBitCast(pDest, pCastDestType);
-        CopyMetadata(pCastDest, &memSetInst);
+    pNewValue = m_pBuilder->CreateBitCast(pNewValue, pSetType);
+    CopyMetadata(pNewValue, &memSetInst);
 
-        if (BitCastInst* const pCast = dyn_cast<BitCastInst>(pCastDest))
-        {
-            visitBitCastInst(*pCast);
-        }
+    return pNewValue;
+}
+
+// =====================================================================================================================
+// Stores a value to the destination of a memset, at the specified byte offset, and turns the new instructions into fat
+// pointer variants.
+void PatchBufferOp::SetMemory(
+    MemSetInst& memSetInst,     // [in] The memset instruction
+    Value*      pOffset,        // [in] Byte offset to store at (nullptr for zero)
+    Value*      pNewValue,      // [in] Value to store
+    uint32_t    destAlignment)  // Alignment of the destination at the offset
+{
+    Value* const pDest = memSetInst.getArgOperand(0);
 
-        StoreInst* const pDestStore = m_pBuilder->CreateAlignedStore(pNewValue, pCastDest, destAlignment);
-        CopyMetadata(pDestStore, &memSetInst);
-        visitStoreInst(*pDestStore);
+    Value* pDestPtr = pDest;
+    if (pOffset != nullptr)
+    {
+        // Get the current index into our destination pointer.
+        pDestPtr = m_pBuilder->CreateGEP(pDest, pOffset);
+        CopyMetadata(pDestPtr, &memSetInst);
     }
 
-    // Record the memset instruction so we remember to delete it later.
-    m_replacementMap[&memSetInst] = std::make_pair(nullptr, nullptr);
+    PointerType* const pCastDestType = pNewValue->getType()->getPointerTo(pDest->getType()->getPointerAddressSpace());
+    Value* const pCastDest = m_pBuilder->CreateBitCast(pDestPtr, pCastDestType);
+    CopyMetadata(pCastDest, &memSetInst);
+
+    // And perform a store for the value.
+    StoreInst* const pDestStore = m_pBuilder->CreateAlignedStore(pNewValue, pCastDest, destAlignment);
+    CopyMetadata(pDestStore, &memSetInst);
+
+    if (GetElementPtrInst* const pGetElemPtr = dyn_cast<GetElementPtrInst>(pDestPtr))
+    {
+        visitGetElementPtrInst(*pGetElemPtr);
+    }
+
+    if (BitCastInst* const pCast = dyn_cast<BitCastInst>(pCastDest))
+    {
+        visitBitCastInst(*pCast);
+    }
+
+    visitStoreInst(*pDestStore);
 }
 
 // =====================================================================================================================
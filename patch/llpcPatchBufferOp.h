@@ -89,6 +89,14 @@ private:
                                 llvm::Instruction* const pInsertPos);
     void PostVisitMemCpyInst(llvm::MemCpyInst& memCpyInst);
     void PostVisitMemSetInst(llvm::MemSetInst& memSetInst);
+    uint32_t GetMemOpLoopStride(uint32_t alignment, const llvm::ConstantInt* pConstantLength) const;
+    void CopyMemory(llvm::MemCpyInst& memCpyInst,
+                    llvm::Value*      pOffset,
+                    llvm::Type*       pCopyType,
+                    uint32_t          destAlignment,
+                    uint32_t          srcAlignment);
+    llvm::Value* GetMemSetValue(llvm::MemSetInst& memSetInst, llvm::Value* pValue, llvm::Type* pSetType);
+    void SetMemory(llvm::MemSetInst& memSetInst, llvm::Value* pOffset, llvm::Value* pNewValue, uint32_t destAlignment);
 
     // -----------------------------------------------------------------------------------------------------------------
 
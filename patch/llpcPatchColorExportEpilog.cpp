@@ -0,0 +1,266 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2019 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcPatchColorExportEpilog.cpp
+ * @brief LLPC source file: contains implementation of class Llpc::PatchColorExportEpilog.
+ ***********************************************************************************************************************
+ */
+#define DEBUG_TYPE "llpc-patch-color-export-epilog"
+
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/BinaryFormat/MsgPackDocument.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Metadata.h"
+#include "llvm/Support/Debug.h"
+
+#include "llpcAbiMetadata.h"
+#include "llpcContext.h"
+#include "llpcFragColorExport.h"
+#include "llpcGfx9Chip.h"
+#include "llpcPatchColorExportEpilog.h"
+
+using namespace llvm;
+using namespace Llpc;
+
+namespace Llpc
+{
+
+// =====================================================================================================================
+// Initializes static members.
+char PatchColorExportEpilog::ID = 0;
+
+// =====================================================================================================================
+// Pass creator, creates the pass of LLVM patching operations of generating the color export epilog.
+ModulePass* CreatePatchColorExportEpilog()
+{
+    return new PatchColorExportEpilog();
+}
+
+// =====================================================================================================================
+PatchColorExportEpilog::PatchColorExportEpilog()
+    :
+    Patch(ID)
+{
+    initializePatchColorExportEpilogPass(*PassRegistry::getPassRegistry());
+}
+
+// =====================================================================================================================
+// Executes this patching pass on the specified LLVM module.
+//
+// Each placeholder call "llpc.color.export.epilog.<type>(location, output)" is replaced with the color export of that
+// output. The placeholders are left by PatchInOutImportExport at the end of the fragment shader, after the depth
+// export if any, so the "done" flag of the export sequence is set here.
+bool PatchColorExportEpilog::runOnModule(
+    Module& module)  // [in,out] LLVM module to be run on
+{
+    LLVM_DEBUG(dbgs() << "Run the pass Patch-Color-Export-Epilog\n");
+
+    Patch::Init(&module);
+
+    SmallPtrSet<Function*, 4> exportFuncs;
+    Function* pEntryPoint = nullptr;
+    for (auto& func : module)
+    {
+        if (func.isDeclaration() && func.getName().startswith(LlpcName::ColorExportEpilog) &&
+            (func.use_empty() == false))
+        {
+            exportFuncs.insert(&func);
+            pEntryPoint = cast<Instruction>(func.user_back())->getFunction();
+        }
+    }
+
+    if (exportFuncs.empty())
+    {
+        return false;
+    }
+
+    // Collect the placeholders in program order, so that the last color export can be identified.
+    SmallVector<CallInst*, MaxColorTargets> exportCalls;
+    for (auto& block : *pEntryPoint)
+    {
+        for (auto& inst : block)
+        {
+            auto pCall = dyn_cast<CallInst>(&inst);
+            if ((pCall != nullptr) && (exportFuncs.count(pCall->getCalledFunction()) != 0))
+            {
+                exportCalls.push_back(pCall);
+            }
+        }
+    }
+
+    auto pResUsage = m_pContext->GetShaderResourceUsage(ShaderStageFragment);
+    FragColorExport fragColorExport(m_pModule);
+
+    // The export preceding the color exports, if any, is the depth export.
+    CallInst* pLastExport = FindPrecedingExport(exportCalls.front());
+
+    uint32_t spiShaderColFormat = 0;
+    uint32_t cbShaderMaskClear = 0;
+    for (auto pCall : exportCalls)
+    {
+        const uint32_t location = cast<ConstantInt>(pCall->getArgOperand(0))->getZExtValue();
+        auto pExport = fragColorExport.Run(pCall->getArgOperand(1), location, pCall);
+        if (pExport != nullptr)
+        {
+            pLastExport = cast<CallInst>(pExport);
+        }
+
+        const ExportFormat expFmt = pResUsage->inOutUsage.fs.expFmts[location];
+        spiShaderColFormat |= (expFmt << (4 * location));
+        if (expFmt == EXP_FORMAT_ZERO)
+        {
+            const uint32_t origLoc = pResUsage->inOutUsage.fs.outputOrigLocs[location];
+            cbShaderMaskClear |= (0xF << (4 * origLoc));
+        }
+    }
+
+#if LLPC_BUILD_GFX10
+    // NOTE: GFX10 can allow no dummy export when the fragment shader does not have discard operation
+    // or ROV (Raster-ordered views)
+    pResUsage->inOutUsage.fs.dummyExport = ((m_pContext->GetGfxIpVersion().major < 10) ||
+                                            pResUsage->builtInUsage.fs.discard);
+#else
+    pResUsage->inOutUsage.fs.dummyExport = true;
+#endif
+    if ((pLastExport == nullptr) && pResUsage->inOutUsage.fs.dummyExport)
+    {
+        // NOTE: All color targets of this pipeline ignore the fragment shader outputs. Export a dummy one, and set the
+        // export format as PatchPreparePipelineAbi would do.
+        auto pUndef = UndefValue::get(m_pContext->FloatTy());
+        Value* args[] =
+        {
+            ConstantInt::get(m_pContext->Int32Ty(), EXP_TARGET_MRT_0),  // tgt
+            ConstantInt::get(m_pContext->Int32Ty(), 0x1),               // en
+            ConstantFP::get(m_pContext->FloatTy(), 0.0),                // src0
+            pUndef,                                                     // src1
+            pUndef,                                                     // src2
+            pUndef,                                                     // src3
+            ConstantInt::get(m_pContext->BoolTy(), false),              // done
+            ConstantInt::get(m_pContext->BoolTy(), true),               // vm
+        };
+
+        pLastExport = cast<CallInst>(EmitCall(m_pModule,
+                                              "llvm.amdgcn.exp.f32",
+                                              m_pContext->VoidTy(),
+                                              args,
+                                              NoAttrib,
+                                              exportCalls.back()));
+        spiShaderColFormat = EXP_FORMAT_32_R;
+    }
+
+    if (pLastExport != nullptr)
+    {
+        // Set "done" flag
+        auto exportName = pLastExport->getCalledFunction()->getName();
+        if (exportName == "llvm.amdgcn.exp.f32")
+        {
+            pLastExport->setOperand(6, ConstantInt::get(m_pContext->BoolTy(), true));
+        }
+        else
+        {
+            LLPC_ASSERT(exportName == "llvm.amdgcn.exp.compr.v2f16");
+            pLastExport->setOperand(4, ConstantInt::get(m_pContext->BoolTy(), true));
+        }
+    }
+
+    for (auto pCall : exportCalls)
+    {
+        pCall->eraseFromParent();
+    }
+
+    for (auto pExportFunc : exportFuncs)
+    {
+        pExportFunc->eraseFromParent();
+    }
+
+    UpdatePalMetadata(spiShaderColFormat, cbShaderMaskClear);
+
+    return true;
+}
+
+// =====================================================================================================================
+// Finds the export instruction preceding the specified instruction in its basic block, if any.
+CallInst* PatchColorExportEpilog::FindPrecedingExport(
+    Instruction* pInst  // [in] Instruction to start from
+    ) const
+{
+    for (auto pPrevInst = pInst->getPrevNode(); pPrevInst != nullptr; pPrevInst = pPrevInst->getPrevNode())
+    {
+        auto pCall = dyn_cast<CallInst>(pPrevInst);
+        if ((pCall != nullptr) &&
+            (pCall->getCalledFunction() != nullptr) &&
+            pCall->getCalledFunction()->getName().startswith("llvm.amdgcn.exp."))
+        {
+            return pCall;
+        }
+    }
+    return nullptr;
+}
+
+// =====================================================================================================================
+// Updates the color export registers in the PAL metadata that PatchPreparePipelineAbi has written to the module.
+void PatchColorExportEpilog::UpdatePalMetadata(
+    uint32_t spiShaderColFormat,    // Value of SPI_SHADER_COL_FORMAT
+    uint32_t cbShaderMaskClear)     // Channels to clear in CB_SHADER_MASK
+{
+    auto pNamedMeta = m_pModule->getNamedMetadata("amdgpu.pal.metadata.msgpack");
+    if ((pNamedMeta == nullptr) || (pNamedMeta->getNumOperands() == 0))
+    {
+        LLPC_NEVER_CALLED();
+        return;
+    }
+
+    auto pAbiMetaString = cast<MDString>(pNamedMeta->getOperand(0)->getOperand(0));
+    msgpack::Document document;
+    if (document.readFromBlob(pAbiMetaString->getString(), false) == false)
+    {
+        LLPC_NEVER_CALLED();
+        return;
+    }
+
+    auto registers = document.getRoot().getMap(true)[Util::Abi::PalCodeObjectMetadataKey::Pipelines]
+                                       .getArray(true)[0].getMap(true)[".registers"].getMap(true);
+
+    // NOTE: SPI_SHADER_COL_FORMAT and CB_SHADER_MASK have the same offsets on all supported hardware.
+    registers[document.getNode(Gfx9::mmSPI_SHADER_COL_FORMAT)] = document.getNode(spiShaderColFormat);
+
+    auto& cbShaderMaskNode = registers[document.getNode(Gfx9::mmCB_SHADER_MASK)];
+    const uint32_t cbShaderMask = cbShaderMaskNode.isEmpty() ? 0 : cbShaderMaskNode.getUInt();
+    cbShaderMaskNode = document.getNode(cbShaderMask & ~cbShaderMaskClear);
+
+    std::string blob;
+    document.writeToBlob(blob);
+    auto pAbiMetaNode = MDNode::get(m_pModule->getContext(), MDString::get(m_pModule->getContext(), blob));
+    pNamedMeta->setOperand(0, pAbiMetaNode);
+}
+
+} // Llpc
+
+// =====================================================================================================================
+// Initializes the pass of LLVM patching operations of generating the color export epilog.
+INITIALIZE_PASS(PatchColorExportEpilog, DEBUG_TYPE,
+                "Patch LLVM for color export epilog", false, false)
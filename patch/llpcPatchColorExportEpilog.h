@@ -0,0 +1,63 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2019 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcPatchColorExportEpilog.h
+ * @brief LLPC header file: contains declaration of class Llpc::PatchColorExportEpilog.
+ ***********************************************************************************************************************
+ */
+#pragma once
+
+#include "llpcPatch.h"
+
+namespace Llpc
+{
+
+// =====================================================================================================================
+// Represents the pass of LLVM patch operations of generating the color export epilog.
+//
+// With "-enable-color-export-epilog", PatchInOutImportExport leaves each fragment color output as a placeholder call,
+// so that the patched fragment shader does not depend on color target formats. This pass runs after all other
+// patching, just before code generation, and replaces the placeholders with the color exports of the current color
+// target formats. It also finishes the export sequence and updates the export registers in PAL metadata.
+class PatchColorExportEpilog: public Patch
+{
+public:
+    PatchColorExportEpilog();
+
+    bool runOnModule(llvm::Module& module) override;
+
+    // -----------------------------------------------------------------------------------------------------------------
+
+    static char ID;   // ID of this pass
+
+private:
+    LLPC_DISALLOW_COPY_AND_ASSIGN(PatchColorExportEpilog);
+
+    llvm::CallInst* FindPrecedingExport(llvm::Instruction* pInst) const;
+    void UpdatePalMetadata(uint32_t spiShaderColFormat, uint32_t cbShaderMaskClear);
+};
+
+} // Llpc
@@ -785,13 +785,11 @@ void PatchCopyShader::ExportGenericOutput(
             }
 
             args.clear();
-            instName = LlpcName::OutputExportXfb;
             args.push_back(ConstantInt::get(m_pContext->Int32Ty(), pXfbOutInfo->xfbBuffer));
             args.push_back(ConstantInt::get(m_pContext->Int32Ty(), pXfbOutInfo->xfbOffset));
             args.push_back(ConstantInt::get(m_pContext->Int32Ty(), pXfbOutInfo->xfbLocOffset));
             args.push_back(pOutputValue);
-            AddTypeMangling(nullptr, args, instName);
-            EmitCall(m_pModule, instName, m_pContext->VoidTy(), args, NoAttrib, pInsertPos);
+            EmitMangledCall(m_pModule, LlpcName::OutputExportXfb, m_pContext->VoidTy(), args, NoAttrib, pInsertPos);
         }
     }
 
@@ -839,13 +837,11 @@ void PatchCopyShader::ExportBuiltInOutput(
             XfbOutInfo* pXfbOutInfo = reinterpret_cast<XfbOutInfo*>(&xfbOutInfo);
 
             args.clear();
-            instName = LlpcName::OutputExportXfb;
             args.push_back(ConstantInt::get(m_pContext->Int32Ty(), pXfbOutInfo->xfbBuffer));
             args.push_back(ConstantInt::get(m_pContext->Int32Ty(), pXfbOutInfo->xfbOffset));
             args.push_back(ConstantInt::get(m_pContext->Int32Ty(), 0));
             args.push_back(pOutputValue);
-            AddTypeMangling(nullptr, args, instName);
-            EmitCall(m_pModule, instName, m_pContext->VoidTy(), args, NoAttrib, pInsertPos);
+            EmitMangledCall(m_pModule, LlpcName::OutputExportXfb, m_pContext->VoidTy(), args, NoAttrib, pInsertPos);
         }
     }
 
@@ -30,6 +30,8 @@
  */
 #define DEBUG_TYPE "llpc-patch-descriptor-load"
 
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/IR/Dominators.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
@@ -50,6 +52,11 @@ namespace cl
 
 extern opt<bool> EnableShadowDescriptorTable;
 
+// -disable-desc-load-hoist: disable hoisting and sharing of invariant descriptor loads
+static opt<bool> DisableDescLoadHoist("disable-desc-load-hoist",
+                                      desc("Disable hoisting and sharing of invariant descriptor loads"),
+                                      init(false));
+
 } // cl
 
 } // llvm
@@ -98,6 +105,7 @@ bool PatchDescriptorLoad::runOnModule(
         if (m_pEntryPoint != nullptr)
         {
             m_shaderStage = static_cast<ShaderStage>(shaderStage);
+            CollectDescLoadHoistPoints();
             visit(*m_pEntryPoint);
         }
     }
@@ -120,6 +128,8 @@ bool PatchDescriptorLoad::runOnModule(
         }
     }
     m_descLoadFuncs.clear();
+    m_descLoadHoistPoints.clear();
+    m_sharedDescs.clear();
 
     // Remove dead llpc.descriptor.point* and llpc.descriptor.index calls that were not
     // processed by the code above. That happens if they were never used in llpc.descriptor.load.from.ptr.
@@ -169,9 +179,18 @@ void PatchDescriptorLoad::ProcessLoadDescFromPtr(
 
     LLPC_ASSERT(pLoadPtr->getCalledFunction()->getName().startswith(LlpcName::DescriptorGetPtrPrefix));
 
-    uint32_t descSet = cast<ConstantInt>(pLoadPtr->getOperand(0))->getZExtValue();
-    uint32_t binding = cast<ConstantInt>(pLoadPtr->getOperand(1))->getZExtValue();
-    Value* pDesc = LoadDescriptor(*pLoadPtr, descSet, binding, pIndex, pLoadFromPtr);
+    Value* pDesc = nullptr;
+    DescLoadKey key;
+    if (GetDescLoadKey(pLoadFromPtr, &key))
+    {
+        pDesc = LoadSharedDescriptor(*pLoadPtr, key);
+    }
+    else
+    {
+        uint32_t descSet = cast<ConstantInt>(pLoadPtr->getOperand(0))->getZExtValue();
+        uint32_t binding = cast<ConstantInt>(pLoadPtr->getOperand(1))->getZExtValue();
+        pDesc = LoadDescriptor(*pLoadPtr, descSet, binding, pIndex, pLoadFromPtr);
+    }
 
     pLoadFromPtr->replaceAllUsesWith(pDesc);
 
@@ -231,10 +250,15 @@ void PatchDescriptorLoad::visitCallInst(
     if (callInst.use_empty() == false)
     {
         Value* pDesc = nullptr;
+        DescLoadKey key;
         if (mangledName == LlpcName::DescriptorLoadSpillTable)
         {
             pDesc = m_pipelineSysValues.Get(m_pEntryPoint)->GetSpilledPushConstTablePtr(m_pPipelineState);
         }
+        else if (GetDescLoadKey(&callInst, &key))
+        {
+            pDesc = LoadSharedDescriptor(callInst, key);
+        }
         else
         {
             uint32_t descSet = cast<ConstantInt>(callInst.getOperand(0))->getZExtValue();
@@ -251,6 +275,168 @@ void PatchDescriptorLoad::visitCallInst(
     m_descLoadFuncs.insert(pCallee);
 }
 
+// =====================================================================================================================
+// Gets the key identifying the descriptor loaded by the specified "llpc.descriptor.load.*" call, if the load is
+// invariant within the shader and so can be hoisted and shared with other loads of the same descriptor.
+//
+// Returns false if the call is not such a descriptor load.
+bool PatchDescriptorLoad::GetDescLoadKey(
+    CallInst*    pCallInst,   // [in] Call instruction
+    DescLoadKey* pKey         // [out] Key of the descriptor load
+    ) const
+{
+    auto pCallee = pCallInst->getCalledFunction();
+    if (cl::DisableDescLoadHoist || (pCallee == nullptr))
+    {
+        return false;
+    }
+
+    StringRef mangledName = pCallee->getName();
+    if (mangledName.startswith(LlpcName::DescriptorLoadFromPtr))
+    {
+        // Trace the pointer back through "llpc.descriptor.index" calls, which must all have constant indices.
+        uint32_t index = 0;
+        auto pLoadPtr = dyn_cast<CallInst>(pCallInst->getOperand(0));
+        while ((pLoadPtr != nullptr) &&
+               (pLoadPtr->getCalledFunction() != nullptr) &&
+               pLoadPtr->getCalledFunction()->getName().startswith(LlpcName::DescriptorIndex))
+        {
+            auto pConstIndex = dyn_cast<ConstantInt>(pLoadPtr->getOperand(1));
+            if (pConstIndex == nullptr)
+            {
+                return false;
+            }
+            index += pConstIndex->getZExtValue();
+            pLoadPtr = dyn_cast<CallInst>(pLoadPtr->getOperand(0));
+        }
+
+        if ((pLoadPtr == nullptr) ||
+            (pLoadPtr->getCalledFunction() == nullptr) ||
+            (pLoadPtr->getCalledFunction()->getName().startswith(LlpcName::DescriptorGetPtrPrefix) == false))
+        {
+            return false;
+        }
+
+        *pKey = DescLoadKey(pLoadPtr->getCalledFunction(),
+                            cast<ConstantInt>(pLoadPtr->getOperand(0))->getZExtValue(),
+                            cast<ConstantInt>(pLoadPtr->getOperand(1))->getZExtValue(),
+                            ConstantInt::get(m_pContext->Int32Ty(), index));
+        return true;
+    }
+
+    if ((mangledName.startswith(LlpcName::DescriptorLoadPrefix) == false) ||
+        mangledName.startswith(LlpcName::DescriptorGetPtrPrefix) ||
+        mangledName.startswith(LlpcName::DescriptorIndex) ||
+        (mangledName == LlpcName::DescriptorLoadSpillTable))
+    {
+        return false;
+    }
+
+    // NOTE: A descriptor array index computed in the shader body could not be hoisted above its definition, so only
+    // constant indices and indices passed in as arguments are considered.
+    Value* pArrayOffset = pCallInst->getOperand(2);
+    if ((isa<Constant>(pArrayOffset) == false) && (isa<Argument>(pArrayOffset) == false))
+    {
+        return false;
+    }
+
+    *pKey = DescLoadKey(pCallee,
+                        cast<ConstantInt>(pCallInst->getOperand(0))->getZExtValue(),
+                        cast<ConstantInt>(pCallInst->getOperand(1))->getZExtValue(),
+                        pArrayOffset);
+    return true;
+}
+
+// =====================================================================================================================
+// Collects the invariant descriptor loads of the current shader entry-point and determines where the shared load of
+// each descriptor is placed. Descriptor tables do not change within a draw, so all loads of the same descriptor can
+// share one load placed in the nearest common dominator of the loads, and that load can be hoisted out of loops.
+void PatchDescriptorLoad::CollectDescLoadHoistPoints()
+{
+    m_descLoadHoistPoints.clear();
+    m_sharedDescs.clear();
+
+    std::map<DescLoadKey, SmallVector<CallInst*, 4>> descLoads;
+    for (auto& block : *m_pEntryPoint)
+    {
+        for (auto& inst : block)
+        {
+            auto pCallInst = dyn_cast<CallInst>(&inst);
+            DescLoadKey key;
+            if ((pCallInst != nullptr) && GetDescLoadKey(pCallInst, &key))
+            {
+                descLoads[key].push_back(pCallInst);
+            }
+        }
+    }
+
+    if (descLoads.empty())
+    {
+        return;
+    }
+
+    DominatorTree domTree(*m_pEntryPoint);
+    LoopInfo loopInfo(domTree);
+
+    for (const auto& descLoad : descLoads)
+    {
+        const auto& calls = descLoad.second;
+
+        BasicBlock* pBlock = calls[0]->getParent();
+        for (uint32_t i = 1; i < calls.size(); ++i)
+        {
+            pBlock = domTree.findNearestCommonDominator(pBlock, calls[i]->getParent());
+        }
+
+        // Hoist out of loops as far as loop preheaders exist
+        for (Loop* pLoop = loopInfo.getLoopFor(pBlock);
+             (pLoop != nullptr) && (pLoop->getLoopPreheader() != nullptr);
+             pLoop = loopInfo.getLoopFor(pBlock))
+        {
+            pBlock = pLoop->getLoopPreheader();
+        }
+
+        // Place the load before the first of the calls in that block (calls are collected in program order), or at
+        // the end of the block if it does not contain any of them.
+        Instruction* pHoistPoint = pBlock->getTerminator();
+        for (CallInst* pCallInst : calls)
+        {
+            if (pCallInst->getParent() == pBlock)
+            {
+                pHoistPoint = pCallInst;
+                break;
+            }
+        }
+
+        m_descLoadHoistPoints[descLoad.first] = pHoistPoint;
+    }
+}
+
+// =====================================================================================================================
+// Gets the descriptor shared by all invariant loads with the specified key, generating its load at the hoist point
+// on first request.
+Value* PatchDescriptorLoad::LoadSharedDescriptor(
+    CallInst&           callInst,   // [in] The llpc.descriptor.load.* or llpc.descriptor.get.* call being replaced
+    const DescLoadKey&  key)        // [in] Key of the descriptor load
+{
+    auto sharedDescIt = m_sharedDescs.find(key);
+    if (sharedDescIt != m_sharedDescs.end())
+    {
+        return sharedDescIt->second;
+    }
+
+    auto hoistPointIt = m_descLoadHoistPoints.find(key);
+    LLPC_ASSERT(hoistPointIt != m_descLoadHoistPoints.end());
+
+    Value* pDesc = LoadDescriptor(callInst,
+                                  std::get<1>(key),
+                                  std::get<2>(key),
+                                  std::get<3>(key),
+                                  hoistPointIt->second);
+    m_sharedDescs[key] = pDesc;
+    return pDesc;
+}
+
 // =====================================================================================================================
 // Generate the code for the descriptor load
 Value* PatchDescriptorLoad::LoadDescriptor(
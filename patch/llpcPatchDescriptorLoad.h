@@ -32,6 +32,8 @@
 
 #include "llvm/IR/InstVisitor.h"
 
+#include <map>
+#include <tuple>
 #include <unordered_set>
 #include "llpcPatch.h"
 #include "llpcPipelineShaders.h"
@@ -67,8 +69,16 @@ public:
 private:
     LLPC_DISALLOW_COPY_AND_ASSIGN(PatchDescriptorLoad);
 
+    // Key identifying a descriptor load: descriptor load (or descriptor pointer) function, descriptor set, binding and
+    // array index (a constant, or an argument of the shader entry-point)
+    typedef std::tuple<llvm::Function*, uint32_t, uint32_t, llvm::Value*> DescLoadKey;
+
     void ProcessLoadDescFromPtr(llvm::CallInst* pLoadFromPtr);
 
+    bool GetDescLoadKey(llvm::CallInst* pCallInst, DescLoadKey* pKey) const;
+    void CollectDescLoadHoistPoints();
+    llvm::Value* LoadSharedDescriptor(llvm::CallInst& callInst, const DescLoadKey& key);
+
     llvm::Value* LoadDescriptor(llvm::CallInst&     callInst,
                                 uint32_t            descSet,
                                 uint32_t            binding,
@@ -104,6 +114,11 @@ private:
     std::vector<llvm::CallInst*>        m_descLoadCalls;      // List of instructions to load descriptors
     std::unordered_set<llvm::Function*> m_descLoadFuncs;      // Set of descriptor load functions
 
+    // Map from invariant descriptor load to the point its shared load is inserted at, which dominates all its uses
+    std::map<DescLoadKey, llvm::Instruction*>   m_descLoadHoistPoints;
+    // Map from invariant descriptor load to the shared loaded descriptor
+    std::map<DescLoadKey, llvm::Value*>         m_sharedDescs;
+
     // Map from descriptor range value to global variables modeling related descriptors (act as immediate constants)
     std::unordered_map<const DescriptorRangeValue*, llvm::GlobalVariable*> m_descs;
 
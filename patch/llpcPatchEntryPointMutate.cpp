@@ -30,10 +30,14 @@
  */
 #define DEBUG_TYPE "llpc-patch-entry-point-mutate"
 
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/IR/Dominators.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/Utils/Cloning.h"
 
+#include <algorithm>
+
 #include "llpcContext.h"
 #include "llpcGfx6Chip.h"
 #include "llpcGfx9Chip.h"
@@ -68,6 +72,12 @@ opt<bool> InRegEsGsLdsSize("inreg-esgs-lds-size",
                           desc("For GS on-chip, add esGsLdsSize in user data"),
                           init(true));
 
+// -opt-user-data-layout: choose user data nodes kept in SGPRs by access frequency when user data has to be spilled
+static opt<bool> OptUserDataLayout("opt-user-data-layout",
+                                   desc("When user data has to be spilled, keep the most frequently accessed user data "
+                                        "nodes in SGPRs rather than the first ones of the resource mapping"),
+                                   init(true));
+
 } // cl
 
 } // llvm
@@ -114,8 +124,29 @@ bool PatchEntryPointMutate::runOnModule(
                              ShaderStageToMask(ShaderStageTessEval))) != 0);
     m_hasGs = ((stageMask & ShaderStageToMask(ShaderStageGeometry)) != 0);
 
-    // Process each shader in turn, but not the copy shader.
     auto pPipelineShaders = &getAnalysis<PipelineShaders>();
+
+    // Collect access weights of user data of all shaders before any entry-point is mutated, as the user data layout of
+    // a merged shader depends on both of its shader stages.
+    for (auto& descAccessWeights : m_descAccessWeights)
+    {
+        descAccessWeights.clear();
+    }
+    memset(m_pushConstAccessWeights, 0, sizeof(m_pushConstAccessWeights));
+
+    if (cl::OptUserDataLayout)
+    {
+        for (uint32_t shaderStage = ShaderStageVertex; shaderStage < ShaderStageNativeStageCount; ++shaderStage)
+        {
+            Function* pEntryPoint = pPipelineShaders->GetEntryPoint(static_cast<ShaderStage>(shaderStage));
+            if (pEntryPoint != nullptr)
+            {
+                CollectUserDataAccessWeights(static_cast<ShaderStage>(shaderStage), pEntryPoint);
+            }
+        }
+    }
+
+    // Process each shader in turn, but not the copy shader.
     for (uint32_t shaderStage = ShaderStageVertex; shaderStage < ShaderStageNativeStageCount; ++shaderStage)
     {
         m_pEntryPoint = pPipelineShaders->GetEntryPoint(static_cast<ShaderStage>(shaderStage));
@@ -266,58 +297,173 @@ void PatchEntryPointMutate::ProcessShader()
 }
 
 // =====================================================================================================================
-// Checks whether the specified resource mapping node is active.
-bool PatchEntryPointMutate::IsResourceNodeActive(
-    const ResourceNode* pNode,               // [in] Resource mapping node
-    bool isRootNode                          // TRUE if node is in root level
-    ) const
+// Gets the shader stage that the current shader stage is merged with on GFX9+ (LS-HS/ES-GS merged shader), or
+// ShaderStageInvalid if it is not merged.
+ShaderStage PatchEntryPointMutate::GetMergedShaderStage() const
 {
-    bool active = false;
-
-    const ResourceUsage* pResUsage1 = m_pContext->GetShaderResourceUsage(m_shaderStage);
-    const ResourceUsage* pResUsage2 = nullptr;
+    auto shaderStage2 = ShaderStageInvalid;
 
     const auto gfxIp = m_pContext->GetGfxIpVersion();
-    if (gfxIp.major >= 9)
+    if ((gfxIp.major >= 9) && (m_hasTs || m_hasGs))
     {
-        // NOTE: For LS-HS/ES-GS merged shader, resource mapping nodes of the two shader stages are merged as a whole.
-        // So we have to check activeness of both shader stages at the same time. Here, we determine the second shader
-       // stage and get its resource usage accordingly.
-        uint32_t stageMask = m_pContext->GetShaderStageMask();
-        const bool hasTs = ((stageMask & (ShaderStageToMask(ShaderStageTessControl) |
-                                            ShaderStageToMask(ShaderStageTessEval))) != 0);
-        const bool hasGs = ((stageMask & ShaderStageToMask(ShaderStageGeometry)) != 0);
-
-        if (hasTs || hasGs)
+        const auto shaderStage1 = m_shaderStage;
+        if (shaderStage1 == ShaderStageVertex)
         {
-            const auto shaderStage1 = m_shaderStage;
-            auto shaderStage2 = ShaderStageInvalid;
+            shaderStage2 = m_hasTs ? ShaderStageTessControl :
+                                     (m_hasGs ? ShaderStageGeometry : ShaderStageInvalid);
+        }
+        else if (shaderStage1 == ShaderStageTessControl)
+        {
+            shaderStage2 = ShaderStageVertex;
+        }
+        else if (shaderStage1 == ShaderStageTessEval)
+        {
+            shaderStage2 = m_hasGs ? ShaderStageGeometry : ShaderStageInvalid;
+        }
+        else if (shaderStage1 == ShaderStageGeometry)
+        {
+            shaderStage2 = m_hasTs ? ShaderStageTessEval : ShaderStageVertex;
+        }
+    }
+
+    return shaderStage2;
+}
+
+// =====================================================================================================================
+// Collects the dynamic access weights of descriptors and push constants in the specified shader. Each access is
+// weighted by the depth of the loop it is in, as an estimate of how often it is executed.
+void PatchEntryPointMutate::CollectUserDataAccessWeights(
+    ShaderStage shaderStage,    // Shader stage
+    Function*   pEntryPoint)    // [in] Entry-point of the shader
+{
+    DominatorTree domTree(*pEntryPoint);
+    LoopInfo loopInfo(domTree);
+
+    auto getAccessWeight = [&](const Instruction* pInst)
+    {
+        uint32_t loopDepth = loopInfo.getLoopDepth(pInst->getParent());
+        loopDepth = (loopDepth < MaxWeightedLoopDepth) ? loopDepth : MaxWeightedLoopDepth;
+        return (1ull << (LoopDepthWeightShift * loopDepth));
+    };
+
+    auto& descAccessWeights = m_descAccessWeights[shaderStage];
+    auto& pushConstAccessWeight = m_pushConstAccessWeights[shaderStage];
 
-            if (shaderStage1 == ShaderStageVertex)
+    for (auto& block : *pEntryPoint)
+    {
+        for (auto& inst : block)
+        {
+            auto pCall = dyn_cast<CallInst>(&inst);
+            if ((pCall == nullptr) || (pCall->getCalledFunction() == nullptr))
             {
-                shaderStage2 = hasTs ? ShaderStageTessControl :
-                                       (hasGs ? ShaderStageGeometry : ShaderStageInvalid);
+                continue;
             }
-            else if (shaderStage1 == ShaderStageTessControl)
+
+            auto mangledName = pCall->getCalledFunction()->getName();
+            if (mangledName.startswith(LlpcName::PushConstLoad))
             {
-                shaderStage2 = ShaderStageVertex;
+                pushConstAccessWeight += getAccessWeight(pCall);
             }
-            else if (shaderStage1 == ShaderStageTessEval)
+            else if (mangledName.startswith(LlpcName::DescriptorLoadSpillTable))
             {
-                shaderStage2 = hasGs ? ShaderStageGeometry : ShaderStageInvalid;
+                // Push constants are accessed by loads through the returned pointer.
+                SmallVector<const User*, 8> workList(pCall->user_begin(), pCall->user_end());
+                while (workList.empty() == false)
+                {
+                    auto pUser = workList.pop_back_val();
+                    if (isa<LoadInst>(pUser))
+                    {
+                        pushConstAccessWeight += getAccessWeight(cast<Instruction>(pUser));
+                    }
+                    else if (isa<BitCastInst>(pUser) || isa<GetElementPtrInst>(pUser))
+                    {
+                        workList.append(pUser->user_begin(), pUser->user_end());
+                    }
+                }
             }
-            else if (shaderStage1 == ShaderStageGeometry)
+            else if (mangledName.startswith(LlpcName::DescriptorLoadBuffer) ||
+                     mangledName.startswith(LlpcName::DescriptorLoadAddress) ||
+                     mangledName.startswith(LlpcName::DescriptorGetTexelBufferPtr) ||
+                     mangledName.startswith(LlpcName::DescriptorGetResourcePtr) ||
+                     mangledName.startswith(LlpcName::DescriptorGetFmaskPtr) ||
+                     mangledName.startswith(LlpcName::DescriptorGetSamplerPtr))
             {
-                shaderStage2 = hasTs ? ShaderStageTessEval : ShaderStageVertex;
+                DescriptorPair descPair = {};
+                descPair.descSet = cast<ConstantInt>(pCall->getOperand(0))->getZExtValue();
+                descPair.binding = cast<ConstantInt>(pCall->getOperand(1))->getZExtValue();
+                descAccessWeights[descPair.u64All] += getAccessWeight(pCall);
             }
+        }
+    }
+}
 
-            if (shaderStage2 != ShaderStageInvalid)
+// =====================================================================================================================
+// Gets the dynamic access weight of the specified resource mapping node in the current shader stage (and the shader
+// stage it is merged with).
+uint64_t PatchEntryPointMutate::GetResourceNodeAccessWeight(
+    const ResourceNode* pNode,               // [in] Resource mapping node
+    bool isRootNode                          // TRUE if node is in root level
+    ) const
+{
+    uint64_t weight = 0;
+
+    if (pNode->type == ResourceMappingNodeType::DescriptorTableVaPtr)
+    {
+        for (uint32_t i = 0; i < pNode->innerTable.size(); ++i)
+        {
+            weight += GetResourceNodeAccessWeight(&pNode->innerTable[i], false);
+        }
+        return weight;
+    }
+
+    const ShaderStage shaderStages[] = { m_shaderStage, GetMergedShaderStage() };
+    for (auto shaderStage : shaderStages)
+    {
+        if (shaderStage == ShaderStageInvalid)
+        {
+            continue;
+        }
+
+        if ((pNode->type == ResourceMappingNodeType::PushConst) && isRootNode)
+        {
+            weight += m_pushConstAccessWeights[shaderStage];
+        }
+        else
+        {
+            DescriptorPair descPair = {};
+            descPair.descSet = pNode->set;
+            descPair.binding = pNode->binding;
+
+            const auto& descAccessWeights = m_descAccessWeights[shaderStage];
+            auto it = descAccessWeights.find(descPair.u64All);
+            if (it != descAccessWeights.end())
             {
-                pResUsage2 = m_pContext->GetShaderResourceUsage(shaderStage2);
+                weight += it->second;
             }
         }
     }
 
+    return weight;
+}
+
+// =====================================================================================================================
+// Checks whether the specified resource mapping node is active.
+bool PatchEntryPointMutate::IsResourceNodeActive(
+    const ResourceNode* pNode,               // [in] Resource mapping node
+    bool isRootNode                          // TRUE if node is in root level
+    ) const
+{
+    bool active = false;
+
+    const ResourceUsage* pResUsage1 = m_pContext->GetShaderResourceUsage(m_shaderStage);
+    const ResourceUsage* pResUsage2 = nullptr;
+
+    const auto shaderStage2 = GetMergedShaderStage();
+    if (shaderStage2 != ShaderStageInvalid)
+    {
+        pResUsage2 = m_pContext->GetShaderResourceUsage(shaderStage2);
+    }
+
     if ((pNode->type == ResourceMappingNodeType::PushConst) && isRootNode)
     {
         active = (pResUsage1->pushConstSizeInBytes > 0);
@@ -626,6 +772,46 @@ FunctionType* PatchEntryPointMutate::GenerateEntryPointType(
         }
     }
 
+    // NOTE: When user data has to be spilled, choose the user data nodes kept in SGPRs by their access weight per DWORD
+    // rather than by their order in the resource mapping, so that frequently accessed descriptor tables and push
+    // constants do not need scalar loads from the spill table.
+    std::vector<bool> inRegNodes;
+    if (needSpill && (useFixedLayout == false) && cl::OptUserDataLayout)
+    {
+        std::vector<uint32_t> nodeIdxs;
+        std::vector<uint64_t> weights(userDataNodes.size(), 0);
+        for (uint32_t i = 0; i < userDataNodes.size(); ++i)
+        {
+            auto pNode = &userDataNodes[i];
+            if ((pNode->type != ResourceMappingNodeType::IndirectUserDataVaPtr) &&
+                (pNode->type != ResourceMappingNodeType::StreamOutTableVaPtr) &&
+                IsResourceNodeActive(pNode, true))
+            {
+                nodeIdxs.push_back(i);
+                weights[i] = GetResourceNodeAccessWeight(pNode, true);
+            }
+        }
+
+        std::stable_sort(nodeIdxs.begin(),
+                         nodeIdxs.end(),
+                         [&](uint32_t idx1, uint32_t idx2)
+                         {
+                             return (weights[idx1] * userDataNodes[idx2].sizeInDwords) >
+                                    (weights[idx2] * userDataNodes[idx1].sizeInDwords);
+                         });
+
+        inRegNodes.resize(userDataNodes.size(), false);
+        uint32_t inRegUserDataCount = 0;
+        for (uint32_t nodeIdx : nodeIdxs)
+        {
+            if (inRegUserDataCount + userDataNodes[nodeIdx].sizeInDwords <= availUserDataCount)
+            {
+                inRegNodes[nodeIdx] = true;
+                inRegUserDataCount += userDataNodes[nodeIdx].sizeInDwords;
+            }
+        }
+    }
+
     // Allocate register for stream-out buffer table
     if (reserveStreamOutTable)
     {
@@ -706,7 +892,9 @@ FunctionType* PatchEntryPointMutate::GenerateEntryPointType(
             }
         }
 
-        if (actualAvailUserDataCount + pNode->sizeInDwords <= availUserDataCount)
+        const bool inReg = inRegNodes.empty() ? (actualAvailUserDataCount + pNode->sizeInDwords <= availUserDataCount) :
+                                                inRegNodes[i];
+        if (inReg)
         {
             // User data isn't spilled
             LLPC_ASSERT(i < InterfaceData::MaxDescTableCount);
@@ -749,9 +937,11 @@ FunctionType* PatchEntryPointMutate::GenerateEntryPointType(
                 }
             }
         }
-        else if (needSpill && (pIntfData->spillTable.offsetInDwords == InvalidValue))
+        else if (needSpill)
         {
-            pIntfData->spillTable.offsetInDwords = pNode->offsetInDwords;
+            // User data from the lowest offset of spilled nodes on are in the spill table.
+            pIntfData->spillTable.offsetInDwords = std::min(pIntfData->spillTable.offsetInDwords,
+                                                            pNode->offsetInDwords);
         }
     }
 
@@ -32,6 +32,8 @@
 
 #include "llvm/IR/InstVisitor.h"
 
+#include <unordered_map>
+
 #include "llpcPatch.h"
 #include "llpcPipelineState.h"
 
@@ -71,15 +73,29 @@ private:
 
     bool IsResourceNodeActive(const ResourceNode* pNode, bool isRootNode) const;
 
+    ShaderStage GetMergedShaderStage() const;
+
+    void CollectUserDataAccessWeights(ShaderStage shaderStage, llvm::Function* pEntryPoint);
+    uint64_t GetResourceNodeAccessWeight(const ResourceNode* pNode, bool isRootNode) const;
+
     // -----------------------------------------------------------------------------------------------------------------
 
     // Reserved argument count for single DWORD descriptor table pointer
     static const uint32_t   TablePtrReservedArgCount = 2;
 
+    // Maximum loop depth distinguished by user data access weights, and shift of access weight per loop level
+    static const uint32_t   MaxWeightedLoopDepth = 4;
+    static const uint32_t   LoopDepthWeightShift = 3;
+
     bool    m_hasTs;    // Whether the pipeline has tessllation shader
     bool    m_hasGs;    // Whether the pipeline has geometry shader
     PipelineState*  m_pPipelineState = nullptr;
                         // PipelineState from PipelineStateWrapper pass
+
+    // Dynamic access weights of descriptors (indexed by descriptor set/binding pair) of each shader stage
+    std::unordered_map<uint64_t, uint64_t>  m_descAccessWeights[ShaderStageNativeStageCount];
+    // Dynamic access weights of push constants of each shader stage
+    uint64_t                                m_pushConstAccessWeights[ShaderStageNativeStageCount] = {};
 };
 
 } // Llpc
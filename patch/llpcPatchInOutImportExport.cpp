@@ -46,6 +46,20 @@
 using namespace llvm;
 using namespace Llpc;
 
+namespace llvm
+{
+
+namespace cl
+{
+
+extern opt<bool> EnableVertexFetchProlog;
+
+extern opt<bool> EnableColorExportEpilog;
+
+} // cl
+
+} // llvm
+
 namespace Llpc
 {
 
@@ -97,6 +111,7 @@ void PatchInOutImportExport::InitPerShader()
     m_pViewportIndex = nullptr;
     m_pLayer = nullptr;
     m_pThreadId = nullptr;
+    m_packedExpValues.clear();
 }
 
 // =====================================================================================================================
@@ -598,6 +613,17 @@ void PatchInOutImportExport::visitCallInst(
                     Value* pElemIdx = callInst.getOperand(isInterpolantInputImport ? 2 : 1);
                     LLPC_ASSERT(IsDontCareValue(pElemIdx) == false);
 
+                    const auto& inputCompMap = pResUsage->inOutUsage.inputCompMap;
+                    if (inputCompMap.find(value) != inputCompMap.end())
+                    {
+                        // NOTE: The input is packed with inputs of other locations, shift its components to those it
+                        // occupies in the mapped location.
+                        InOutCompInfo compInfo = {};
+                        compInfo.u32All = inputCompMap.at(value);
+                        pElemIdx = ConstantInt::get(m_pContext->Int32Ty(),
+                                                    cast<ConstantInt>(pElemIdx)->getZExtValue() + compInfo.compOffset);
+                    }
+
                     Value* pAuxInterpValue = nullptr;
 
                     if (isGenericInputImport)
@@ -895,8 +921,12 @@ void PatchInOutImportExport::visitCallInst(
                 case ShaderStageVertex:
                     {
                         LLPC_ASSERT(callInst.getNumArgOperands() == 3);
-                        const uint32_t compIdx = cast<ConstantInt>(callInst.getOperand(1))->getZExtValue();
-                        PatchVsGenericOutputExport(pOutput, loc, compIdx, &callInst);
+                        uint32_t compIdx = cast<ConstantInt>(callInst.getOperand(1))->getZExtValue();
+                        pOutput = PackGenericOutput(pOutput, value, &compIdx, &callInst);
+                        if (pOutput != nullptr)
+                        {
+                            PatchVsGenericOutputExport(pOutput, loc, compIdx, &callInst);
+                        }
                         break;
                     }
                 case ShaderStageTessControl:
@@ -914,8 +944,12 @@ void PatchInOutImportExport::visitCallInst(
                 case ShaderStageTessEval:
                     {
                         LLPC_ASSERT(callInst.getNumArgOperands() == 3);
-                        const uint32_t compIdx = cast<ConstantInt>(callInst.getOperand(1))->getZExtValue();
-                        PatchTesGenericOutputExport(pOutput, loc, compIdx, &callInst);
+                        uint32_t compIdx = cast<ConstantInt>(callInst.getOperand(1))->getZExtValue();
+                        pOutput = PackGenericOutput(pOutput, value, &compIdx, &callInst);
+                        if (pOutput != nullptr)
+                        {
+                            PatchTesGenericOutputExport(pOutput, loc, compIdx, &callInst);
+                        }
                         break;
                     }
                 case ShaderStageGeometry:
@@ -1042,6 +1076,9 @@ void PatchInOutImportExport::visitReturnInst(
 
         auto& inOutUsage = m_pContext->GetShaderResourceUsage(m_shaderStage)->inOutUsage;
 
+        // Export packed generic outputs, now that all of their components have been collected
+        AddExportInstForPackedGenericOutput(pInsertPos);
+
         const auto enableMultiView = (reinterpret_cast<const GraphicsPipelineBuildInfo*>(
             m_pContext->GetPipelineBuildInfo()))->iaState.enableMultiView;
 
@@ -1612,6 +1649,7 @@ void PatchInOutImportExport::visitReturnInst(
         }
 
         // Export fragment colors
+        bool hasColorExportEpilog = false;
         for (uint32_t location = 0; location < MaxColorTargets; ++location)
         {
             auto& expFragColor = m_expFragColors[location];
@@ -1653,11 +1691,34 @@ void PatchInOutImportExport::visitReturnInst(
                     }
                 }
 
-                // Do fragment color exporting
-                auto pExport = m_pFragColorExport->Run(pOutput, location, pInsertPos);
-                if (pExport != nullptr)
+                if (cl::EnableColorExportEpilog)
                 {
-                    m_pLastExport = cast<CallInst>(pExport);
+                    // Leave the color export to the color export epilog, so that the fragment shader does not depend
+                    // on color target formats. The epilog also finishes the export sequence.
+                    Value* args[] =
+                    {
+                        ConstantInt::get(m_pContext->Int32Ty(), location),
+                        pOutput,
+                    };
+
+                    EmitMangledCall(m_pModule,
+                                    LlpcName::ColorExportEpilog,
+                                    pOutput->getType(),
+                                    m_pContext->VoidTy(),
+                                    args,
+                                    NoAttrib,
+                                    pInsertPos);
+                    hasColorExportEpilog = true;
+                    m_pLastExport = nullptr;
+                }
+                else
+                {
+                    // Do fragment color exporting
+                    auto pExport = m_pFragColorExport->Run(pOutput, location, pInsertPos);
+                    if (pExport != nullptr)
+                    {
+                        m_pLastExport = cast<CallInst>(pExport);
+                    }
                 }
             }
         }
@@ -1672,7 +1733,7 @@ void PatchInOutImportExport::visitReturnInst(
 #else
         pResUsage->inOutUsage.fs.dummyExport = true;
 #endif
-        if ((m_pLastExport == nullptr) && pResUsage->inOutUsage.fs.dummyExport)
+        if ((m_pLastExport == nullptr) && pResUsage->inOutUsage.fs.dummyExport && (hasColorExportEpilog == false))
         {
             args.clear();
             args.push_back(ConstantInt::get(m_pContext->Int32Ty(), EXP_TARGET_MRT_0)); // tgt
@@ -1715,8 +1776,36 @@ Value* PatchInOutImportExport::PatchVsGenericInputImport(
 {
     Value* pInput = UndefValue::get(pInputTy);
 
-    // Do vertex fetch operations
     LLPC_ASSERT(m_pVertexFetch != nullptr);
+    if (cl::EnableVertexFetchProlog)
+    {
+        // Leave the vertex fetch to the vertex fetch prolog, so that the vertex shader does not depend on vertex input
+        // state. The placeholder call carries the values that the prolog receives from the vertex shader.
+        auto pVbTablePtr = m_pipelineSysValues.Get(m_pEntryPoint)->GetVertexBufTablePtr(m_pPipelineState);
+        if (pVbTablePtr != nullptr)
+        {
+            Value* args[] =
+            {
+                ConstantInt::get(m_pContext->Int32Ty(), location),
+                ConstantInt::get(m_pContext->Int32Ty(), compIdx),
+                pVbTablePtr,
+                m_pVertexFetch->GetVertexIndex(),
+                m_pVertexFetch->GetInstanceId(),
+                m_pVertexFetch->GetBaseInstance(),
+            };
+
+            pInput = EmitMangledCall(m_pModule,
+                                     LlpcName::VertexFetchProlog,
+                                     pInputTy,
+                                     pInputTy,
+                                     args,
+                                     Attribute::ReadNone,
+                                     pInsertPos);
+        }
+        return pInput;
+    }
+
+    // Do vertex fetch operations
     auto pVertex = m_pVertexFetch->Run(pInputTy, location, compIdx, pInsertPos);
 
     // Cast vertex fetch results if necessary
@@ -2243,8 +2332,13 @@ void PatchInOutImportExport::PatchGsGenericOutputExport(
         args.push_back(ConstantInt::get(m_pContext->Int32Ty(), streamId));
         args.push_back(pOutput);
 
-        std::string callName = LlpcName::NggGsOutputExport + GetTypeName(pOutput->getType());
-        EmitCall(m_pModule, callName, m_pContext->VoidTy(), args, NoAttrib, pInsertPos);
+        EmitMangledCall(m_pModule,
+                        LlpcName::NggGsOutputExport,
+                        pOutput->getType(),
+                        m_pContext->VoidTy(),
+                        args,
+                        NoAttrib,
+                        pInsertPos);
         return;
     }
 #endif
@@ -4289,8 +4383,13 @@ void PatchInOutImportExport::PatchGsBuiltInOutputExport(
         args.push_back(ConstantInt::get(m_pContext->Int32Ty(), streamId));
         args.push_back(pOutput);
 
-        std::string callName = LlpcName::NggGsOutputExport + GetTypeName(pOutput->getType());
-        EmitCall(m_pModule, callName, m_pContext->VoidTy(), args, NoAttrib, pInsertPos);
+        EmitMangledCall(m_pModule,
+                        LlpcName::NggGsOutputExport,
+                        pOutput->getType(),
+                        m_pContext->VoidTy(),
+                        args,
+                        NoAttrib,
+                        pInsertPos);
         return;
     }
 #endif
@@ -4700,7 +4799,6 @@ void PatchInOutImportExport::CreateStreamOutBufferStoreFunction(
     LLPC_ASSERT((bitWidth == 16) || (bitWidth == 32));
 
     uint32_t format = 0;
-    std::string callName = "llvm.amdgcn.struct.tbuffer.store.";
 
     CombineFormat formatOprd = {};
     formatOprd.bits.nfmt = BUF_NUM_FORMAT_FLOAT;
@@ -4709,19 +4807,16 @@ void PatchInOutImportExport::CreateStreamOutBufferStoreFunction(
     case 1:
         {
             formatOprd.bits.dfmt = (bitWidth == 32) ? BUF_DATA_FORMAT_32 : BUF_DATA_FORMAT_16;
-            callName += (bitWidth == 32) ? "f32" : "f16";
             break;
         }
     case 2:
         {
             formatOprd.bits.dfmt = (bitWidth == 32) ? BUF_DATA_FORMAT_32_32 : BUF_DATA_FORMAT_16_16;
-            callName += (bitWidth == 32) ? "v2f32" : "v2f16";
             break;
         }
     case 4:
         {
             formatOprd.bits.dfmt = (bitWidth == 32) ? BUF_DATA_FORMAT_32_32_32_32 : BUF_DATA_FORMAT_16_16_16_16;
-            callName += (bitWidth == 32) ? "v4f32" : "v4f16";
             break;
         }
     default:
@@ -4770,7 +4865,13 @@ void PatchInOutImportExport::CreateStreamOutBufferStoreFunction(
     coherent.bits.glc = true;
     coherent.bits.slc = true;
     args.push_back(ConstantInt::get(m_pContext->Int32Ty(), coherent.u32All));           // glc, slc
-    EmitCall(m_pModule, callName, m_pContext->VoidTy(), args, NoAttrib, pStoreBlock);
+    EmitMangledCall(m_pModule,
+                    "llvm.amdgcn.struct.tbuffer.store.",
+                    pStoreTy,
+                    m_pContext->VoidTy(),
+                    args,
+                    NoAttrib,
+                    pStoreBlock);
     BranchInst::Create(pEndBlock, pStoreBlock);
 }
 
@@ -4825,8 +4926,6 @@ uint32_t PatchInOutImportExport::CombineBufferStore(
         m_pContext->Int32x4Ty(),
     };
 
-    std::string funcName = "llvm.amdgcn.raw.tbuffer.store.";
-
     // Start from 4-component combination
     uint32_t compCount = 4;
     for (; compCount > 0; compCount--)
@@ -4837,7 +4936,6 @@ uint32_t PatchInOutImportExport::CombineBufferStore(
 
         if (startIdx + compCount <= storeValues.size())
         {
-            funcName += GetTypeName(storeTys[compCount - 1]);
             Value* pStoreValue = nullptr;
             if (compCount > 1)
             {
@@ -4872,7 +4970,13 @@ uint32_t PatchInOutImportExport::CombineBufferStore(
             args.push_back(ConstantInt::get(m_pContext->Int32Ty(), formats[compCount - 1]));    // format
             args.push_back(ConstantInt::get(m_pContext->Int32Ty(), coherent.u32All));         // glc
 
-            EmitCall(m_pModule, funcName, m_pContext->VoidTy(), args, NoAttrib, pInsertPos);
+            EmitMangledCall(m_pModule,
+                            "llvm.amdgcn.raw.tbuffer.store.",
+                            storeTys[compCount - 1],
+                            m_pContext->VoidTy(),
+                            args,
+                            NoAttrib,
+                            pInsertPos);
 
             break;
         }
@@ -4930,7 +5034,6 @@ uint32_t PatchInOutImportExport::CombineBufferLoad(
         m_pContext->Int32x4Ty(),
     };
 
-    std::string funcName = "llvm.amdgcn.raw.tbuffer.load.";
     LLPC_ASSERT(loadValues.size() > 0);
 
     // 4-component combination
@@ -4943,8 +5046,6 @@ uint32_t PatchInOutImportExport::CombineBufferLoad(
 
         if (startIdx + compCount <= loadValues.size())
         {
-            funcName += GetTypeName(loadTyps[compCount - 1]);
-
             Value* pLoadValue = nullptr;
             std::vector<Value*> args;
             args.push_back(pBufDesc);                                                      // rsrc
@@ -4958,7 +5059,13 @@ uint32_t PatchInOutImportExport::CombineBufferLoad(
             args.push_back(ConstantInt::get(m_pContext->Int32Ty(), formats[compCount - 1]));  // format
             args.push_back(ConstantInt::get(m_pContext->Int32Ty(), coherent.u32All));       // glc
 
-            pLoadValue = EmitCall(m_pModule, funcName, loadTyps[compCount - 1], args, NoAttrib, pInsertPos);
+            pLoadValue = EmitMangledCall(m_pModule,
+                                         "llvm.amdgcn.raw.tbuffer.load.",
+                                         loadTyps[compCount - 1],
+                                         loadTyps[compCount - 1],
+                                         args,
+                                         NoAttrib,
+                                         pInsertPos);
             LLPC_ASSERT(pLoadValue != nullptr);
             if (compCount > 1)
             {
@@ -6511,6 +6618,57 @@ uint32_t PatchInOutImportExport::CalcPatchCountPerThreadGroup(
     return patchCountPerThreadGroup;
 }
 
+// =====================================================================================================================
+// Adjusts a generic output to the components it occupies in its mapped location, if generic outputs are packed. Returns
+// nullptr if none of the components of the output is used by fragment shader.
+Value* PatchInOutImportExport::PackGenericOutput(
+    Value*       pOutput,        // [in] Output value
+    uint32_t     origLocation,   // Shader specified location of the output
+    uint32_t*    pCompIdx,       // [in,out] Index used for vector element indexing
+    Instruction* pInsertPos)     // [in] Where to insert the instructions
+{
+    const auto& outputCompMap = m_pContext->GetShaderResourceUsage(m_shaderStage)->inOutUsage.outputCompMap;
+    if (outputCompMap.find(origLocation) == outputCompMap.end())
+    {
+        return pOutput;
+    }
+
+    InOutCompInfo compInfo = {};
+    compInfo.u32All = outputCompMap.at(origLocation);
+
+    // NOTE: Fragment shader might read fewer components than the output has. Those components beyond must be dropped
+    // since they might be occupied by outputs of other locations.
+    auto pOutputTy = pOutput->getType();
+    LLPC_ASSERT(pOutputTy->getScalarSizeInBits() == 32);
+
+    const uint32_t compCount = pOutputTy->isVectorTy() ? pOutputTy->getVectorNumElements() : 1;
+    if (*pCompIdx >= compInfo.compCount)
+    {
+        return nullptr;
+    }
+
+    const uint32_t packedCompCount = std::min(compCount, compInfo.compCount - *pCompIdx);
+    if (packedCompCount < compCount)
+    {
+        if (packedCompCount == 1)
+        {
+            pOutput = ExtractElementInst::Create(pOutput, ConstantInt::get(m_pContext->Int32Ty(), 0), "", pInsertPos);
+        }
+        else
+        {
+            std::vector<Constant*> shuffleMask;
+            for (uint32_t i = 0; i < packedCompCount; ++i)
+            {
+                shuffleMask.push_back(ConstantInt::get(m_pContext->Int32Ty(), i));
+            }
+            pOutput = new ShuffleVectorInst(pOutput, pOutput, ConstantVector::get(shuffleMask), "", pInsertPos);
+        }
+    }
+
+    *pCompIdx += compInfo.compOffset;
+    return pOutput;
+}
+
 // =====================================================================================================================
 // Inserts "exp" instruction to export generic output.
 void PatchInOutImportExport::AddExportInstForGenericOutput(
@@ -6609,7 +6767,20 @@ void PatchInOutImportExport::AddExportInstForGenericOutput(
 
     std::vector<Value*> args;
 
-    if (numChannels <= 4)
+    if ((inOutUsage.outputCompMap.empty() == false) && (numChannels <= 4))
+    {
+        // NOTE: Generic outputs are packed, outputs of different locations might share the mapped location. Collect
+        // the components here and export all of them at once (see AddExportInstForPackedGenericOutput). Outputs
+        // occupying two locations are never packed with others, so they are still exported here.
+        LLPC_ASSERT(startChannel + numChannels <= 4);
+        auto& packedValues = m_packedExpValues[location];
+        packedValues.resize(4, nullptr);
+        for (uint32_t i = 0; i < numChannels; ++i)
+        {
+            packedValues[startChannel + i] = exportValues[i];
+        }
+    }
+    else if (numChannels <= 4)
     {
         LLPC_ASSERT(startChannel + numChannels <= 4);
         const uint32_t channelMask = ((1 << (startChannel + numChannels)) - 1) - ((1 << startChannel) - 1);
@@ -6692,6 +6863,46 @@ void PatchInOutImportExport::AddExportInstForGenericOutput(
     }
 }
 
+// =====================================================================================================================
+// Inserts "exp" instructions to export packed generic outputs, one for each mapped location.
+void PatchInOutImportExport::AddExportInstForPackedGenericOutput(
+    Instruction* pInsertPos)     // [in] Where to insert the "exp" instructions
+{
+    auto& inOutUsage = m_pContext->GetShaderResourceUsage(m_shaderStage)->inOutUsage;
+
+    for (const auto& packedValues : m_packedExpValues)
+    {
+        uint32_t channelMask = 0;
+        std::vector<Value*> args;
+        args.push_back(ConstantInt::get(m_pContext->Int32Ty(), EXP_TARGET_PARAM_0 + packedValues.first)); // tgt
+        args.push_back(nullptr);                                                                           // en
+
+        // src0 ~ src3
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            Value* pValue = packedValues.second[i];
+            if (pValue != nullptr)
+            {
+                channelMask |= (1 << i);
+            }
+            else
+            {
+                // Inactive components (dummy)
+                pValue = UndefValue::get(m_pContext->FloatTy());
+            }
+            args.push_back(pValue);
+        }
+        args[1] = ConstantInt::get(m_pContext->Int32Ty(), channelMask);
+
+        args.push_back(ConstantInt::get(m_pContext->BoolTy(), false));  // done
+        args.push_back(ConstantInt::get(m_pContext->BoolTy(), false));  // vm
+
+        EmitCall(m_pModule, "llvm.amdgcn.exp.f32", m_pContext->VoidTy(), args, NoAttrib, pInsertPos);
+        ++inOutUsage.expCount;
+    }
+    m_packedExpValues.clear();
+}
+
 // =====================================================================================================================
 // Inserts "exp" instruction to export built-in output.
 void PatchInOutImportExport::AddExportInstForBuiltInOutput(
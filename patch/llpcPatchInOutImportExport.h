@@ -296,10 +296,16 @@ private:
                                           llvm::Value*       pVertexIdx,
                                           llvm::Instruction* pInsertPos);
 
+    llvm::Value* PackGenericOutput(llvm::Value*       pOutput,
+                                   uint32_t           origLocation,
+                                   uint32_t*          pCompIdx,
+                                   llvm::Instruction* pInsertPos);
+
     void AddExportInstForGenericOutput(llvm::Value*       pOutput,
                                        uint32_t           location,
                                        uint32_t           compIdx,
                                        llvm::Instruction* pInsertPos);
+    void AddExportInstForPackedGenericOutput(llvm::Instruction* pInsertPos);
     void AddExportInstForBuiltInOutput(llvm::Value* pOutput, uint32_t builtInId, llvm::Instruction* pInsertPos);
 
     llvm::Value* AdjustCentroidIJ(llvm::Value* pCentroidIJ, llvm::Value* pCenterIJ, llvm::Instruction* pInsertPos);
@@ -341,6 +347,8 @@ private:
     llvm::Value*            m_pThreadId;                // Thread ID
 
     std::vector<Value*>     m_expFragColors[MaxColorTargets]; // Exported fragment colors
+    std::map<uint32_t, std::vector<Value*>> m_packedExpValues; // Exported values of packed generic outputs (per mapped
+                                                               // location, exported once all of them are collected)
     std::vector<llvm::CallInst*> m_importCalls; // List of "call" instructions to import inputs
     std::vector<llvm::CallInst*> m_exportCalls; // List of "call" instructions to export outputs
     PipelineState*          m_pPipelineState = nullptr; // PipelineState from PipelineStateWrapper pass
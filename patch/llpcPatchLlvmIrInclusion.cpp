@@ -30,9 +30,12 @@
  */
 #define DEBUG_TYPE "llpc-patch-llvm-ir-inclusion"
 
-#include "llvm/IR/Constants.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/Support/Compression.h"
+#include "llvm/Support/raw_ostream.h"
 
 #include "llpcContext.h"
+#include "llpcElfReader.h"
 #include "llpcPatchLlvmIrInclusion.h"
 
 using namespace llvm;
@@ -63,35 +66,46 @@ PatchLlvmIrInclusion::PatchLlvmIrInclusion()
 // =====================================================================================================================
 // Executes this patching pass on the specified LLVM module.
 //
-// This pass includes LLVM IR as a separate section in the ELF binary by inserting a new global variable with explicit
-// section.
+// This pass records the LLVM IR as compressed bitcode in the pipeline context. The compiler attaches it to the ELF
+// binary as a separate section after code generation, so the IR neither stays in the LLVM context nor goes through
+// the backend.
 bool PatchLlvmIrInclusion::runOnModule(
-    Module& module)  // [in,out] LLVM module to be run on
+    Module& module)  // [in] LLVM module to be run on
 {
     Patch::Init(&module);
 
-    std::string moduleStr;
-    raw_string_ostream llvmIr(moduleStr);
-    llvmIr << *m_pModule;
-    llvmIr.flush();
+    SmallVector<char, 0> bitcode;
+    raw_svector_ostream bitcodeStream(bitcode);
+    WriteBitcodeToFile(*m_pModule, bitcodeStream);
 
-    auto pGlobalTy = ArrayType::get(m_pContext->Int8Ty(), moduleStr.size());
-    auto pInitializer = ConstantDataArray::getString(m_pModule->getContext(), moduleStr, false);
-    auto pGlobal = new GlobalVariable(*m_pModule,
-                                      pGlobalTy,
-                                      true,
-                                      GlobalValue::ExternalLinkage,
-                                      pInitializer,
-                                      "llvmir",
-                                      nullptr,
-                                      GlobalValue::NotThreadLocal,
-                                      false);
-    LLPC_ASSERT(pGlobal != nullptr);
+    LlvmIrBitcodeHeader header = {};
+    header.magic = LlvmIrBitcodeMagic;
+    header.compression = LlvmIrBitcodeCompressionNone;
+    header.bitcodeSize = bitcode.size();
 
-    std::string namePrefix = Util::Abi::AmdGpuCommentName;
-    pGlobal->setSection(namePrefix + "llvmir");
+    StringRef data(bitcode.data(), bitcode.size());
+    SmallVector<char, 0> compressedBitcode;
+    if (zlib::isAvailable())
+    {
+        if (Error err = zlib::compress(data, compressedBitcode))
+        {
+            // Fall back to uncompressed bitcode.
+            consumeError(std::move(err));
+        }
+        else
+        {
+            header.compression = LlvmIrBitcodeCompressionZlib;
+            data = StringRef(compressedBitcode.data(), compressedBitcode.size());
+        }
+    }
+    header.dataSize = data.size();
 
-    return true;
+    auto& record = m_pContext->GetPipelineContext()->GetLlvmIrBitcode();
+    record.resize(sizeof(header) + data.size());
+    memcpy(record.data(), &header, sizeof(header));
+    memcpy(record.data() + sizeof(header), data.data(), data.size());
+
+    return false;
 }
 
 } // Llpc
@@ -93,6 +93,12 @@ bool PatchLoadScalarizer::runOnFunction(
 {
     LLVM_DEBUG(dbgs() << "Run the pass Patch-Load-Scalarizer-Opt\n");
 
+    // This is an optional optimization, skipped e.g. once the build budget has expired.
+    if (skipFunction(function))
+    {
+        return false;
+    }
+
     bool enableLoadScalarizerPerShader = false;
 
     auto pPipelineShaders = &getAnalysis<PipelineShaders>();
@@ -88,6 +88,12 @@ bool PatchPeepholeOpt::runOnFunction(
 {
     LLVM_DEBUG(dbgs() << "Run the pass Patch-Peephole-Opt\n");
 
+    // This is an optional optimization, skipped e.g. once the build budget has expired.
+    if (skipFunction(function))
+    {
+        return false;
+    }
+
     visit(function);
 
     const bool changed = m_instsToErase.empty() == false;
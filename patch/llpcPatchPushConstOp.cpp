@@ -162,9 +162,10 @@ void PatchPushConstOp::visitCallInst(
     auto pIntfData = m_pContext->GetShaderInterfaceData(m_shaderStage);
     uint32_t pushConstNodeIdx = pIntfData->pushConst.resNodeIdx;
     LLPC_ASSERT(pushConstNodeIdx != InvalidValue);
-    auto pPushConstNode = &m_pPipelineState->GetUserDataNodes()[pushConstNodeIdx];
 
-    if (pPushConstNode->offsetInDwords < pIntfData->spillTable.offsetInDwords)
+    // NOTE: The push constant node is not necessarily below the spill threshold when it is kept in SGPRs, as user data
+    // nodes kept in SGPRs are chosen by access frequency.
+    if (pIntfData->entryArgIdxs.resNodeValues[pushConstNodeIdx] > 0)
     {
         auto pPushConst = GetFunctionArgument(m_pEntryPoint, pIntfData->entryArgIdxs.resNodeValues[pushConstNodeIdx]);
 
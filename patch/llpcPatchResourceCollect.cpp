@@ -42,6 +42,19 @@
 using namespace llvm;
 using namespace Llpc;
 
+namespace llvm
+{
+
+namespace cl
+{
+
+extern opt<bool> EnableVertexFetchProlog;
+extern opt<bool> PackInOut;
+
+} // cl
+
+} // llvm
+
 namespace Llpc
 {
 
@@ -122,6 +135,7 @@ void PatchResourceCollect::ProcessShader()
     m_hasPushConstOp = false;
     m_hasDynIndexedInput = false;
     m_hasDynIndexedOutput = false;
+    m_fsInputUsages.clear();
     m_pResUsage = m_pContext->GetShaderResourceUsage(m_shaderStage);
 
     // Invoke handling of "call" instruction
@@ -164,9 +178,21 @@ void PatchResourceCollect::ProcessShader()
         auto pPipelineInfo = static_cast<const GraphicsPipelineBuildInfo*>(m_pContext->GetPipelineBuildInfo());
         auto pVertexInput = pPipelineInfo->pVertexInput;
 
+        if (cl::EnableVertexFetchProlog)
+        {
+            // NOTE: The vertex fetch prolog receives both vertex index and instance index whatever the input rates of
+            // the vertex bindings are, so that the vertex shader does not depend on vertex input state.
+            if (m_pResUsage->inOutUsage.inputLocMap.empty() == false)
+            {
+                m_pResUsage->builtInUsage.vs.vertexIndex = true;
+                m_pResUsage->builtInUsage.vs.baseVertex = true;
+                m_pResUsage->builtInUsage.vs.instanceIndex = true;
+                m_pResUsage->builtInUsage.vs.baseInstance = true;
+            }
+        }
         // TODO: In the future, we might check if the corresponding vertex attribute is active in vertex shader
         // and set the usage based on this info.
-        if (pVertexInput != nullptr)
+        else if (pVertexInput != nullptr)
         {
             for (uint32_t i = 0; i < pVertexInput->vertexBindingDescriptionCount; ++i)
             {
@@ -310,6 +336,12 @@ void PatchResourceCollect::visitCallInst(
                     LLPC_ASSERT(pInputTy->getPrimitiveSizeInBits() <= (8 * 2 * SizeOfVec4));
                     m_activeInputLocs.insert(loc + 1);
                 }
+
+                if (m_shaderStage == ShaderStageFragment)
+                {
+                    const uint32_t interpMode = cast<ConstantInt>(callInst.getOperand(2))->getZExtValue();
+                    CollectFsInputUsage(loc, pInputTy, callInst.getOperand(1), interpMode);
+                }
             }
         }
     }
@@ -336,6 +368,9 @@ void PatchResourceCollect::visitCallInst(
 
                 LLPC_ASSERT(callInst.getType()->getPrimitiveSizeInBits() <= (8 * SizeOfVec4));
                 m_activeInputLocs.insert(loc);
+
+                const uint32_t interpMode = cast<ConstantInt>(callInst.getOperand(3))->getZExtValue();
+                CollectFsInputUsage(loc, callInst.getType(), callInst.getOperand(2), interpMode);
             }
             else
             {
@@ -468,6 +503,48 @@ void PatchResourceCollect::visitCallInst(
     }
 }
 
+// =====================================================================================================================
+// Collects the components occupied by a generic input of fragment shader, which are used in input packing.
+void PatchResourceCollect::CollectFsInputUsage(
+    uint32_t loc,           // Location of the input
+    Type*    pInputTy,      // [in] Type of the input
+    Value*   pCompIdx,      // [in] Index used for vector element indexing
+    uint32_t interpMode)    // Interpolation mode
+{
+    // NOTE: "Smooth" and "no perspective" inputs are interpolated from the same attribute data with different I/J, so
+    // they could share a location. Only 32-bit inputs with constant component indexing could be packed.
+    if (interpMode == InterpModeNoPersp)
+    {
+        interpMode = InterpModeSmooth;
+    }
+
+    const bool packable = (pInputTy->getScalarSizeInBits() == 32) && isa<ConstantInt>(pCompIdx);
+    uint32_t compCount = 4;
+    if (packable)
+    {
+        compCount = cast<ConstantInt>(pCompIdx)->getZExtValue() +
+                    (pInputTy->isVectorTy() ? pInputTy->getVectorNumElements() : 1);
+    }
+
+    auto usageIt = m_fsInputUsages.find(loc);
+    if (usageIt == m_fsInputUsages.end())
+    {
+        m_fsInputUsages[loc] = { compCount, interpMode, packable };
+    }
+    else
+    {
+        auto& usage = usageIt->second;
+        usage.compCount = std::max(usage.compCount, compCount);
+        usage.packable  = usage.packable && packable && (usage.interpMode == interpMode);
+    }
+
+    if (pInputTy->getPrimitiveSizeInBits() > (8 * SizeOfVec4))
+    {
+        // The input occupies two consecutive locations
+        m_fsInputUsages[loc + 1] = { 4, interpMode, false };
+    }
+}
+
 // =====================================================================================================================
 // Clears inactive (those actually unused) inputs.
 void PatchResourceCollect::ClearInactiveInput()
@@ -1062,14 +1139,25 @@ void PatchResourceCollect::MatchGenericInOut()
     if (inLocMap.empty() == false)
     {
         LLPC_ASSERT(inOutUsage.inputMapLocCount == 0);
-        for (auto& locMap : inLocMap)
+
+        // NOTE: Generic inputs of fragment shader are packed only if they are exported by VS or TES via parameter
+        // exports. Outputs of geometry shader are exported by copy shader with their own location mapping.
+        if (cl::PackInOut && (m_shaderStage == ShaderStageFragment) && (m_hasDynIndexedInput == false) &&
+            (m_pContext->GetPrevShaderStage(ShaderStageFragment) != ShaderStageGeometry))
         {
-            LLPC_ASSERT(locMap.second == InvalidValue);
-            // NOTE: For vertex shader, the input location mapping is actually trivial.
-            locMap.second = (m_shaderStage == ShaderStageVertex) ? locMap.first : nextMapLoc++;
-            inOutUsage.inputMapLocCount = std::max(inOutUsage.inputMapLocCount, locMap.second + 1);
-            LLPC_OUTS("(" << GetShaderStageAbbreviation(m_shaderStage, true) << ") Input:  loc = "
-                          << locMap.first << "  =>  Mapped = " << locMap.second << "\n");
+            PackFsGenericInput();
+        }
+        else
+        {
+            for (auto& locMap : inLocMap)
+            {
+                LLPC_ASSERT(locMap.second == InvalidValue);
+                // NOTE: For vertex shader, the input location mapping is actually trivial.
+                locMap.second = (m_shaderStage == ShaderStageVertex) ? locMap.first : nextMapLoc++;
+                inOutUsage.inputMapLocCount = std::max(inOutUsage.inputMapLocCount, locMap.second + 1);
+                LLPC_OUTS("(" << GetShaderStageAbbreviation(m_shaderStage, true) << ") Input:  loc = "
+                              << locMap.first << "  =>  Mapped = " << locMap.second << "\n");
+            }
         }
         LLPC_OUTS("\n");
     }
@@ -1083,7 +1171,16 @@ void PatchResourceCollect::MatchGenericInOut()
             memset(&outOrigLocs, InvalidValue, sizeof(inOutUsage.fs.outputOrigLocs));
         }
 
-        nextMapLoc = 0;
+        // NOTE: If generic inputs of fragment shader are packed, generic outputs of the previous stage must follow the
+        // same location mapping. Those outputs not used by fragment shader (transform feedback only) are mapped to the
+        // locations after the inputs.
+        const auto nextStage = m_pContext->GetNextShaderStage(m_shaderStage);
+        const auto pNextResUsage =
+            (nextStage == ShaderStageFragment) ? m_pContext->GetShaderResourceUsage(nextStage) : nullptr;
+        const bool followPackedInput =
+            (pNextResUsage != nullptr) && (pNextResUsage->inOutUsage.inputCompMap.empty() == false);
+
+        nextMapLoc = followPackedInput ? pNextResUsage->inOutUsage.inputMapLocCount : 0;
         LLPC_ASSERT(inOutUsage.outputMapLocCount == 0);
         for (auto locMapIt = outLocMap.begin(); locMapIt != outLocMap.end();)
         {
@@ -1115,7 +1212,21 @@ void PatchResourceCollect::MatchGenericInOut()
                 if (locMap.second == InvalidValue)
                 {
                     // Only do location mapping if the output has not been mapped
-                    locMap.second = nextMapLoc++;
+                    if (followPackedInput &&
+                        (pNextResUsage->inOutUsage.inputLocMap.find(locMap.first) !=
+                         pNextResUsage->inOutUsage.inputLocMap.end()))
+                    {
+                        const auto& nextInOutUsage = pNextResUsage->inOutUsage;
+                        locMap.second = nextInOutUsage.inputLocMap.at(locMap.first);
+                        if (nextInOutUsage.inputCompMap.find(locMap.first) != nextInOutUsage.inputCompMap.end())
+                        {
+                            inOutUsage.outputCompMap[locMap.first] = nextInOutUsage.inputCompMap.at(locMap.first);
+                        }
+                    }
+                    else
+                    {
+                        locMap.second = nextMapLoc++;
+                    }
                 }
                 else
                 {
@@ -1185,6 +1296,85 @@ void PatchResourceCollect::MatchGenericInOut()
     LLPC_OUTS("\n");
 }
 
+// =====================================================================================================================
+// Maps generic inputs of fragment shader to locations, packing inputs of different locations into shared locations at
+// component level so that fewer parameter exports are required.
+//
+// NOTE: The interpolation attributes (flat, custom) are specified per mapped location, so only inputs of the same
+// interpolation mode could share a location. Packable inputs are placed in decreasing order of component count, each
+// in the first location that still has enough free components (first fit decreasing).
+void PatchResourceCollect::PackFsGenericInput()
+{
+    LLPC_ASSERT(m_shaderStage == ShaderStageFragment);
+    auto& inOutUsage = m_pResUsage->inOutUsage;
+
+    // Mapped locations: <count of occupied components, interpolation mode>
+    std::vector<std::pair<uint32_t, uint32_t>> mapLocs;
+    std::vector<uint32_t> packableLocs;
+
+    // Inputs that could not be packed occupy their mapped locations exclusively
+    for (auto& locMap : inOutUsage.inputLocMap)
+    {
+        LLPC_ASSERT(locMap.second == InvalidValue);
+        auto usageIt = m_fsInputUsages.find(locMap.first);
+        if ((usageIt != m_fsInputUsages.end()) && usageIt->second.packable)
+        {
+            packableLocs.push_back(locMap.first);
+        }
+        else
+        {
+            locMap.second = mapLocs.size();
+            mapLocs.push_back({ 4, InvalidValue });
+        }
+    }
+
+    std::stable_sort(packableLocs.begin(),
+                     packableLocs.end(),
+                     [this](uint32_t loc1, uint32_t loc2)
+                     { return m_fsInputUsages[loc1].compCount > m_fsInputUsages[loc2].compCount; });
+
+    for (uint32_t loc : packableLocs)
+    {
+        const auto& usage = m_fsInputUsages[loc];
+
+        uint32_t mapLoc = 0;
+        while ((mapLoc < mapLocs.size()) &&
+               ((mapLocs[mapLoc].second != usage.interpMode) || (mapLocs[mapLoc].first + usage.compCount > 4)))
+        {
+            ++mapLoc;
+        }
+
+        if (mapLoc == mapLocs.size())
+        {
+            mapLocs.push_back({ 0, usage.interpMode });
+        }
+
+        InOutCompInfo compInfo = {};
+        compInfo.compOffset = mapLocs[mapLoc].first;
+        compInfo.compCount  = usage.compCount;
+        mapLocs[mapLoc].first += usage.compCount;
+
+        inOutUsage.inputLocMap[loc] = mapLoc;
+        inOutUsage.inputCompMap[loc] = compInfo.u32All;
+    }
+
+    inOutUsage.inputMapLocCount = mapLocs.size();
+
+    for (const auto& locMap : inOutUsage.inputLocMap)
+    {
+        LLPC_OUTS("(" << GetShaderStageAbbreviation(m_shaderStage, true) << ") Input:  loc = "
+                      << locMap.first << "  =>  Mapped = " << locMap.second);
+        auto compIt = inOutUsage.inputCompMap.find(locMap.first);
+        if (compIt != inOutUsage.inputCompMap.end())
+        {
+            InOutCompInfo compInfo = {};
+            compInfo.u32All = compIt->second;
+            LLPC_OUTS(", component = " << compInfo.compOffset << " (count = " << compInfo.compCount << ")");
+        }
+        LLPC_OUTS("\n");
+    }
+}
+
 // =====================================================================================================================
 // Maps special built-in input/output to generic ones.
 //
@@ -32,6 +32,7 @@
 
 #include "llvm/IR/InstVisitor.h"
 
+#include <map>
 #include <unordered_set>
 #include "llpcPatch.h"
 #include "llpcPipelineShaders.h"
@@ -69,7 +70,10 @@ private:
     void ClearInactiveInput();
     void ClearInactiveOutput();
 
+    void CollectFsInputUsage(uint32_t loc, llvm::Type* pInputTy, llvm::Value* pCompIdx, uint32_t interpMode);
+
     void MatchGenericInOut();
+    void PackFsGenericInput();
     void MapBuiltInToGenericInOut();
 
     void ReviseTessExecutionMode();
@@ -78,6 +82,14 @@ private:
 
     // -----------------------------------------------------------------------------------------------------------------
 
+    // Represents the usage of generic inputs of fragment shader at one location
+    struct FsInputUsage
+    {
+        uint32_t    compCount;      // Count of occupied components (counted from component 0)
+        uint32_t    interpMode;     // Interpolation mode ("no perspective" is treated as "smooth")
+        bool        packable;       // Whether the location could be packed with other locations
+    };
+
     std::unordered_set<llvm::CallInst*> m_deadCalls;            // Dead calls
 
     std::unordered_set<uint32_t>    m_activeInputLocs;          // Locations of active generic inputs
@@ -87,6 +99,8 @@ private:
     std::unordered_set<uint32_t>    m_importedOutputLocs;       // Locations of imported generic outputs
     std::unordered_set<uint32_t>    m_importedOutputBuiltIns;   // IDs of imported built-in outputs
 
+    std::map<uint32_t, FsInputUsage> m_fsInputUsages;           // Usages of generic inputs of fragment shader
+
     bool            m_hasPushConstOp;           // Whether push constant is active
     bool            m_hasDynIndexedInput;       // Whether dynamic indices are used in generic input addressing (valid
                                                 // for tessellation shader, fragment shader with input interpolation)
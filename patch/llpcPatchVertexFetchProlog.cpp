@@ -0,0 +1,129 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2019 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcPatchVertexFetchProlog.cpp
+ * @brief LLPC source file: contains implementation of class Llpc::PatchVertexFetchProlog.
+ ***********************************************************************************************************************
+ */
+#define DEBUG_TYPE "llpc-patch-vertex-fetch-prolog"
+
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Support/Debug.h"
+
+#include "llpcContext.h"
+#include "llpcPatchVertexFetchProlog.h"
+#include "llpcVertexFetch.h"
+
+using namespace llvm;
+using namespace Llpc;
+
+namespace Llpc
+{
+
+// =====================================================================================================================
+// Initializes static members.
+char PatchVertexFetchProlog::ID = 0;
+
+// =====================================================================================================================
+// Pass creator, creates the pass of LLVM patching operations of generating the vertex fetch prolog.
+ModulePass* CreatePatchVertexFetchProlog()
+{
+    return new PatchVertexFetchProlog();
+}
+
+// =====================================================================================================================
+PatchVertexFetchProlog::PatchVertexFetchProlog()
+    :
+    Patch(ID)
+{
+    initializePatchVertexFetchPrologPass(*PassRegistry::getPassRegistry());
+}
+
+// =====================================================================================================================
+// Executes this patching pass on the specified LLVM module.
+//
+// Each placeholder call "llpc.vertex.fetch.prolog.<type>(location, compIdx, vbTablePtr, vertexIndex, instanceId,
+// baseInstance)" is replaced with the vertex fetch of that input. The placeholders are "readnone", so the optimizer
+// has already commoned them and hoisted them out of loops; the fetches are generated where the placeholders are.
+bool PatchVertexFetchProlog::runOnModule(
+    Module& module)  // [in,out] LLVM module to be run on
+{
+    LLVM_DEBUG(dbgs() << "Run the pass Patch-Vertex-Fetch-Prolog\n");
+
+    Patch::Init(&module);
+
+    SmallVector<Function*, 4> fetchFuncs;
+    for (auto& func : module)
+    {
+        if (func.isDeclaration() && func.getName().startswith(LlpcName::VertexFetchProlog))
+        {
+            fetchFuncs.push_back(&func);
+        }
+    }
+
+    if (fetchFuncs.empty())
+    {
+        return false;
+    }
+
+    VertexFetch vertexFetch(m_pModule);
+    for (auto pFetchFunc : fetchFuncs)
+    {
+        while (pFetchFunc->use_empty() == false)
+        {
+            auto pCall = cast<CallInst>(pFetchFunc->user_back());
+            const uint32_t location = cast<ConstantInt>(pCall->getArgOperand(0))->getZExtValue();
+            const uint32_t compIdx = cast<ConstantInt>(pCall->getArgOperand(1))->getZExtValue();
+
+            vertexFetch.SetPrologInterface(pCall->getArgOperand(2),
+                                           pCall->getArgOperand(3),
+                                           pCall->getArgOperand(4),
+                                           pCall->getArgOperand(5),
+                                           pCall);
+
+            Value* pVertex = vertexFetch.Run(pCall->getType(), location, compIdx, pCall);
+            if (pVertex->getType() != pCall->getType())
+            {
+                LLPC_ASSERT(CanBitCast(pVertex->getType(), pCall->getType()));
+                pVertex = new BitCastInst(pVertex, pCall->getType(), "", pCall);
+            }
+
+            pCall->replaceAllUsesWith(pVertex);
+            pCall->eraseFromParent();
+        }
+        pFetchFunc->eraseFromParent();
+    }
+
+    return true;
+}
+
+} // Llpc
+
+// =====================================================================================================================
+// Initializes the pass of LLVM patching operations of generating the vertex fetch prolog.
+INITIALIZE_PASS(PatchVertexFetchProlog, DEBUG_TYPE,
+                "Patch LLVM for vertex fetch prolog", false, false)
@@ -0,0 +1,501 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2019 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcPatchWaveSizeSelect.cpp
+ * @brief LLPC source file: contains implementation of class Llpc::PatchWaveSizeSelect.
+ ***********************************************************************************************************************
+ */
+#define DEBUG_TYPE "llpc-patch-wave-size-select"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+
+#include <algorithm>
+
+#include "SPIRVInternal.h"
+#include "llpcCompiler.h"
+#include "llpcContext.h"
+#include "llpcInternal.h"
+#include "llpcPatchWaveSizeSelect.h"
+
+using namespace llvm;
+using namespace Llpc;
+
+namespace llvm
+{
+
+namespace cl
+{
+
+// -enable-wave-size-select: select wave32 or wave64 for each shader stage with a static cost model
+static opt<bool> EnableWaveSizeSelect("enable-wave-size-select",
+                                      desc("Select wave32 or wave64 for each shader stage whose wave size is not "
+                                           "specified, according to a static cost model of its IR (GFX10+)"),
+                                      init(false));
+
+} // cl
+
+} // llvm
+
+namespace Llpc
+{
+
+// Parameters of the static cost model. Wave32 is favored by divergent branches (a divergent branch wastes the lanes
+// of half as many threads), by high VGPR use (a wave32 allocates half the VGPRs of a wave64, so occupancy degrades
+// more gracefully) and by compute workgroups that leave a wave64 partially filled. Wave64 is favored by memory
+// operations (fewer instructions issued per thread and better latency hiding), by LDS use and for fragment shaders,
+// for which wave64 is the recommended default.
+static const uint32_t DivergentBranchWeight     = 2;    // Weight of one divergent branch for wave32
+static const uint32_t HighVgprThreshold         = 64;   // VGPR use above which wave32 is favored
+static const uint32_t VgprsPerWave32Point       = 16;   // VGPRs above the threshold per point for wave32
+static const uint32_t SmallWorkgroupWeight      = 16;   // Weight for wave32 of a workgroup fitting in one wave32
+static const uint32_t PartialWaveWeight         = 4;    // Weight for wave32 of a workgroup not filling its wave64s
+static const uint32_t MemoryOpsPerWave64Point   = 8;    // Memory operations per point for wave64
+static const uint32_t LdsWave64Weight           = 2;    // Weight of LDS use for wave64
+static const uint32_t FragmentWave64Weight      = 4;    // Weight of fragment shaders for wave64
+
+// =====================================================================================================================
+// Initializes static members.
+char PatchWaveSizeSelect::ID = 0;
+
+// =====================================================================================================================
+// Pass creator, creates the pass of LLVM patching operations of selecting the wave size of each shader stage.
+ModulePass* CreatePatchWaveSizeSelect()
+{
+    return new PatchWaveSizeSelect();
+}
+
+// =====================================================================================================================
+PatchWaveSizeSelect::PatchWaveSizeSelect()
+    :
+    Patch(ID)
+{
+    initializePipelineShadersPass(*PassRegistry::getPassRegistry());
+    initializePatchWaveSizeSelectPass(*PassRegistry::getPassRegistry());
+}
+
+// =====================================================================================================================
+// Executes this LLVM patching pass on the specified LLVM module.
+bool PatchWaveSizeSelect::runOnModule(
+    Module& module)  // [in] LLVM module to be run on
+{
+    LLVM_DEBUG(dbgs() << "Run the pass Patch-Wave-Size-Select\n");
+
+    Patch::Init(&module);
+
+#if LLPC_BUILD_GFX10
+    if ((cl::EnableWaveSizeSelect == false) || (m_pContext->GetGfxIpVersion().major != 10))
+    {
+        return false;
+    }
+
+    // NOTE: Subgroup operations have already been lowered against the wave size, and with gl_SubgroupSize used in any
+    // stage the wave size of all stages is the subgroup size exposed via the API.
+    const uint32_t stageMask = m_pContext->GetShaderStageMask();
+    for (uint32_t stage = 0; stage < ShaderStageNativeStageCount; ++stage)
+    {
+        if ((stageMask & ShaderStageToMask(static_cast<ShaderStage>(stage))) == 0)
+        {
+            continue;
+        }
+
+        const PipelineShaderInfo* pShaderInfo = m_pContext->GetPipelineShaderInfo(static_cast<ShaderStage>(stage));
+        const ShaderModuleData* pModuleData = reinterpret_cast<const ShaderModuleData*>(pShaderInfo->pModuleData);
+        if ((pModuleData != nullptr) && pModuleData->moduleInfo.useSubgroupSize)
+        {
+            return false;
+        }
+    }
+
+    WaveSizeMetrics metrics[ShaderStageNativeStageCount] = {};
+    auto pPipelineShaders = &getAnalysis<PipelineShaders>();
+    for (uint32_t stage = 0; stage < ShaderStageNativeStageCount; ++stage)
+    {
+        m_shaderStage = static_cast<ShaderStage>(stage);
+        m_pEntryPoint = pPipelineShaders->GetEntryPoint(m_shaderStage);
+        if ((m_pEntryPoint != nullptr) && IsWaveSizeSelectable(m_shaderStage))
+        {
+            CollectMetrics(m_pEntryPoint, &metrics[stage]);
+            m_pContext->GetShaderResourceUsage(m_shaderStage)->waveSize = SelectWaveSize(m_shaderStage,
+                                                                                         metrics[stage]);
+        }
+    }
+
+    // NOTE: The vertex shader is merged with the tessellation control shader (LS-HS), and both halves of the merged
+    // shader must run with the same wave size. Select it from the combined metrics of both stages.
+    if ((stageMask & ShaderStageToMask(ShaderStageVertex)) && (stageMask & ShaderStageToMask(ShaderStageTessControl)))
+    {
+        ResourceUsage* pVsResUsage  = m_pContext->GetShaderResourceUsage(ShaderStageVertex);
+        ResourceUsage* pTcsResUsage = m_pContext->GetShaderResourceUsage(ShaderStageTessControl);
+        if (IsWaveSizeSelectable(ShaderStageVertex) && IsWaveSizeSelectable(ShaderStageTessControl))
+        {
+            WaveSizeMetrics lsHsMetrics = metrics[ShaderStageTessControl];
+            lsHsMetrics.divergentBranches += metrics[ShaderStageVertex].divergentBranches;
+            lsHsMetrics.vgprEstimate = std::max(lsHsMetrics.vgprEstimate, metrics[ShaderStageVertex].vgprEstimate);
+            lsHsMetrics.memoryOps += metrics[ShaderStageVertex].memoryOps;
+
+            pTcsResUsage->waveSize = SelectWaveSize(ShaderStageTessControl, lsHsMetrics);
+            pVsResUsage->waveSize  = pTcsResUsage->waveSize;
+        }
+        else
+        {
+            pTcsResUsage->waveSize = 0;
+            pVsResUsage->waveSize  = 0;
+        }
+    }
+
+    for (uint32_t stage = 0; stage < ShaderStageNativeStageCount; ++stage)
+    {
+        const ShaderStage shaderStage = static_cast<ShaderStage>(stage);
+        if ((pPipelineShaders->GetEntryPoint(shaderStage) != nullptr) && IsWaveSizeSelectable(shaderStage))
+        {
+            const uint32_t waveSize = m_pContext->GetShaderResourceUsage(shaderStage)->waveSize;
+            LLPC_OUTS("// LLPC wave size selection (" << GetShaderStageAbbreviation(shaderStage, true) << "): "
+                      << "divergent branches = " << metrics[stage].divergentBranches
+                      << ", VGPRs = " << metrics[stage].vgprEstimate
+                      << ", memory ops = " << metrics[stage].memoryOps
+                      << ", LDS = " << metrics[stage].ldsBytes << " bytes -> "
+                      << ((waveSize != 0) ? ("wave" + std::to_string(waveSize)) : std::string("default")) << "\n");
+        }
+    }
+
+    m_divergentValues.clear();
+#endif
+
+    // The pass only records the selected wave sizes, the IR is unchanged.
+    return false;
+}
+
+// =====================================================================================================================
+// Checks whether the wave size of the specified shader stage may be selected by the heuristic.
+bool PatchWaveSizeSelect::IsWaveSizeSelectable(
+    ShaderStage shaderStage   // Shader stage
+    ) const
+{
+    bool selectable = false;
+#if LLPC_BUILD_GFX10
+    const PipelineShaderInfo* pShaderInfo = m_pContext->GetPipelineShaderInfo(shaderStage);
+    const bool hasGs = ((m_pContext->GetShaderStageMask() & ShaderStageToMask(ShaderStageGeometry)) != 0);
+
+    // NOTE: Geometry shader pipelines run the stages other than the fragment shader with wave64, since the hardware
+    // path for GS wave32 is not tested.
+    selectable = (pShaderInfo != nullptr) &&
+                 (pShaderInfo->options.waveSize == 0) &&
+                 ((hasGs == false) || (shaderStage == ShaderStageFragment));
+#endif
+    return selectable;
+}
+
+// =====================================================================================================================
+// Collects the cost model inputs of the specified shader.
+void PatchWaveSizeSelect::CollectMetrics(
+    Function*        pEntryPoint,   // [in] Entry-point of the shader
+    WaveSizeMetrics* pMetrics)      // [out] Cost model inputs of the shader
+{
+    *pMetrics = {};
+
+    CollectDivergentValues(pEntryPoint);
+
+    DominatorTree domTree(*pEntryPoint);
+    LoopInfo loopInfo(domTree);
+
+    for (auto& block : *pEntryPoint)
+    {
+        auto pTerminator = block.getTerminator();
+        Value* pCond = nullptr;
+        if (auto pBranch = dyn_cast_or_null<BranchInst>(pTerminator))
+        {
+            pCond = pBranch->isConditional() ? pBranch->getCondition() : nullptr;
+        }
+        else if (auto pSwitch = dyn_cast_or_null<SwitchInst>(pTerminator))
+        {
+            pCond = pSwitch->getCondition();
+        }
+
+        if ((pCond != nullptr) && (m_divergentValues.count(pCond) != 0))
+        {
+            pMetrics->divergentBranches += 1 + loopInfo.getLoopDepth(&block);
+        }
+
+        for (auto& inst : block)
+        {
+            auto pCall = dyn_cast<CallInst>(&inst);
+            auto pCallee = (pCall != nullptr) ? pCall->getCalledFunction() : nullptr;
+            if (pCallee == nullptr)
+            {
+                continue;
+            }
+
+            StringRef calleeName = pCallee->getName();
+            if (calleeName.startswith(LlpcName::BufferCallPrefix) ||
+                calleeName.startswith("llvm.amdgcn.image.") ||
+                (calleeName.startswith("llvm.amdgcn.") && calleeName.contains("buffer.")))
+            {
+                ++pMetrics->memoryOps;
+            }
+        }
+    }
+
+    pMetrics->vgprEstimate = EstimateVgprUsage(pEntryPoint);
+
+    if (m_shaderStage == ShaderStageCompute)
+    {
+        const DataLayout& dataLayout = m_pModule->getDataLayout();
+        for (auto& global : m_pModule->globals())
+        {
+            if (global.getType()->getAddressSpace() == SPIRAS_Local)
+            {
+                pMetrics->ldsBytes += dataLayout.getTypeAllocSize(global.getValueType());
+            }
+        }
+
+        const auto& builtInUsage = m_pContext->GetShaderResourceUsage(ShaderStageCompute)->builtInUsage.cs;
+        pMetrics->workgroupSize = std::max(1u, builtInUsage.workgroupSizeX) *
+                                  std::max(1u, builtInUsage.workgroupSizeY) *
+                                  std::max(1u, builtInUsage.workgroupSizeZ);
+    }
+}
+
+// =====================================================================================================================
+// Collects the values of the specified shader that may differ between the lanes of a wave: per-lane inputs, results
+// of atomic operations and of loads from LDS, and everything computed from them. Private memory that is written with
+// such a value is divergent as well. Divergence caused by control flow alone (values merged after a divergent branch)
+// is not tracked.
+void PatchWaveSizeSelect::CollectDivergentValues(
+    Function* pEntryPoint)    // [in] Entry-point of the shader
+{
+    m_divergentValues.clear();
+
+    std::vector<Value*> worklist;
+    auto markDivergent = [&](Value* pValue)
+    {
+        if (m_divergentValues.insert(pValue).second)
+        {
+            worklist.push_back(pValue);
+        }
+    };
+
+    for (auto& block : *pEntryPoint)
+    {
+        for (auto& inst : block)
+        {
+            if (isa<AtomicRMWInst>(inst) || isa<AtomicCmpXchgInst>(inst))
+            {
+                markDivergent(&inst);
+            }
+            else if (auto pLoad = dyn_cast<LoadInst>(&inst))
+            {
+                if (pLoad->getPointerAddressSpace() == SPIRAS_Local)
+                {
+                    markDivergent(&inst);
+                }
+            }
+            else if (auto pCall = dyn_cast<CallInst>(&inst))
+            {
+                auto pCallee = pCall->getCalledFunction();
+                if ((pCallee != nullptr) &&
+                    (pCallee->getName().startswith(LlpcName::InputCallPrefix) ||
+                     pCallee->getName().startswith("llvm.amdgcn.mbcnt") ||
+                     pCallee->getName().contains("atomic")))
+                {
+                    markDivergent(&inst);
+                }
+            }
+        }
+    }
+
+    const DataLayout& dataLayout = m_pModule->getDataLayout();
+    while (worklist.empty() == false)
+    {
+        Value* pValue = worklist.back();
+        worklist.pop_back();
+
+        for (User* pUser : pValue->users())
+        {
+            if (auto pStore = dyn_cast<StoreInst>(pUser))
+            {
+                if (pStore->getValueOperand() == pValue)
+                {
+                    Value* pObject = GetUnderlyingObject(pStore->getPointerOperand(), dataLayout);
+                    if (isa<AllocaInst>(pObject))
+                    {
+                        markDivergent(pObject);
+                    }
+                }
+            }
+            else if (isa<Instruction>(pUser) && (pUser->getType()->isVoidTy() == false))
+            {
+                markDivergent(pUser);
+            }
+        }
+    }
+}
+
+// =====================================================================================================================
+// Estimates the count of VGPRs of the specified shader by a linear scan over its divergent values: each value is
+// live from its definition to its last use (extended to the end of the loops that use it without defining it), and
+// the estimate is the largest total size of the values live at the same time.
+uint32_t PatchWaveSizeSelect::EstimateVgprUsage(
+    Function* pEntryPoint     // [in] Entry-point of the shader
+    ) const
+{
+    DominatorTree domTree(*pEntryPoint);
+    LoopInfo loopInfo(domTree);
+
+    DenseMap<const Instruction*, uint32_t> positions;
+    uint32_t position = 0;
+    for (auto& block : *pEntryPoint)
+    {
+        for (auto& inst : block)
+        {
+            positions[&inst] = position++;
+        }
+    }
+
+    DenseMap<const Loop*, uint32_t> loopEnds;
+    for (const Loop* pLoop : loopInfo.getLoopsInPreorder())
+    {
+        uint32_t loopEnd = 0;
+        for (const BasicBlock* pBlock : pLoop->blocks())
+        {
+            loopEnd = std::max(loopEnd, positions[pBlock->getTerminator()]);
+        }
+        loopEnds[pLoop] = loopEnd;
+    }
+
+    const DataLayout& dataLayout = m_pModule->getDataLayout();
+    std::vector<std::pair<uint32_t, int32_t>> events;
+    for (auto& block : *pEntryPoint)
+    {
+        for (auto& inst : block)
+        {
+            if ((m_divergentValues.count(&inst) == 0) || isa<AllocaInst>(inst) || inst.use_empty())
+            {
+                continue;
+            }
+
+            const uint32_t start = positions[&inst];
+            uint32_t end = start;
+            for (const Use& use : inst.uses())
+            {
+                auto pUserInst = cast<Instruction>(use.getUser());
+                const BasicBlock* pUseBlock = pUserInst->getParent();
+                if (auto pPhi = dyn_cast<PHINode>(pUserInst))
+                {
+                    pUseBlock = pPhi->getIncomingBlock(use);
+                    end = std::max(end, positions[pUseBlock->getTerminator()]);
+                }
+                else
+                {
+                    end = std::max(end, positions[pUserInst]);
+                }
+
+                for (const Loop* pLoop = loopInfo.getLoopFor(pUseBlock);
+                     (pLoop != nullptr) && (pLoop->contains(&block) == false);
+                     pLoop = pLoop->getParentLoop())
+                {
+                    end = std::max(end, loopEnds[pLoop]);
+                }
+            }
+
+            const int32_t sizeInDwords =
+                static_cast<int32_t>(std::max<uint64_t>(1, (dataLayout.getTypeStoreSize(inst.getType()) + 3) / 4));
+            events.push_back({ start, sizeInDwords });
+            events.push_back({ end + 1, -sizeInDwords });
+        }
+    }
+
+    // Process the ends of live ranges before the starts at the same position.
+    std::sort(events.begin(), events.end());
+
+    int32_t liveDwords = 0;
+    int32_t maxLiveDwords = 0;
+    for (const auto& event : events)
+    {
+        liveDwords += event.second;
+        maxLiveDwords = std::max(maxLiveDwords, liveDwords);
+    }
+    return static_cast<uint32_t>(maxLiveDwords);
+}
+
+// =====================================================================================================================
+// Selects the wave size of the specified shader stage from its cost model inputs. Returns 0 if neither wave size is
+// favored, so that the default wave size of the stage is kept.
+uint32_t PatchWaveSizeSelect::SelectWaveSize(
+    ShaderStage            shaderStage,   // Shader stage
+    const WaveSizeMetrics& metrics        // [in] Cost model inputs of the shader
+    ) const
+{
+    uint32_t wave32Weight = metrics.divergentBranches * DivergentBranchWeight;
+    if (metrics.vgprEstimate > HighVgprThreshold)
+    {
+        wave32Weight += (metrics.vgprEstimate - HighVgprThreshold) / VgprsPerWave32Point;
+    }
+
+    uint32_t wave64Weight = metrics.memoryOps / MemoryOpsPerWave64Point;
+    if (metrics.ldsBytes > 0)
+    {
+        wave64Weight += LdsWave64Weight;
+    }
+
+    if (shaderStage == ShaderStageFragment)
+    {
+        wave64Weight += FragmentWave64Weight;
+    }
+    else if (shaderStage == ShaderStageCompute)
+    {
+        if (metrics.workgroupSize <= 32)
+        {
+            wave32Weight += SmallWorkgroupWeight;
+        }
+        else if ((metrics.workgroupSize % 64) != 0)
+        {
+            wave32Weight += PartialWaveWeight;
+        }
+    }
+
+    uint32_t waveSize = 0;
+    if (wave32Weight > wave64Weight)
+    {
+        waveSize = 32;
+    }
+    else if (wave64Weight > wave32Weight)
+    {
+        waveSize = 64;
+    }
+    return waveSize;
+}
+
+} // Llpc
+
+// =====================================================================================================================
+// Initializes the pass of LLVM patch operations of selecting the wave size of each shader stage.
+INITIALIZE_PASS(PatchWaveSizeSelect, DEBUG_TYPE, "Patch LLVM for wave size selection", false, false)
@@ -0,0 +1,88 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2019 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcPatchWaveSizeSelect.h
+ * @brief LLPC header file: contains declaration of class Llpc::PatchWaveSizeSelect.
+ ***********************************************************************************************************************
+ */
+#pragma once
+
+#include "llvm/ADT/DenseSet.h"
+
+#include "llpcPatch.h"
+#include "llpcPipelineShaders.h"
+
+namespace Llpc
+{
+
+// =====================================================================================================================
+// Represents the pass of LLVM patch operations of selecting the wave size of each shader stage.
+//
+// With "-enable-wave-size-select", each shader stage whose wave size is neither specified by tuning option nor
+// constrained by subgroup operations gets wave32 or wave64 according to a static cost model of its IR. The pass runs
+// before PatchResourceCollect, since the wave size is already consulted while resources are collected.
+class PatchWaveSizeSelect: public Patch
+{
+public:
+    PatchWaveSizeSelect();
+
+    void getAnalysisUsage(llvm::AnalysisUsage& analysisUsage) const override
+    {
+        analysisUsage.addRequired<PipelineShaders>();
+        analysisUsage.addPreserved<PipelineShaders>();
+    }
+
+    bool runOnModule(llvm::Module& module) override;
+
+    // -----------------------------------------------------------------------------------------------------------------
+
+    static char ID;   // ID of this pass
+
+private:
+    LLPC_DISALLOW_COPY_AND_ASSIGN(PatchWaveSizeSelect);
+
+    // Represents the cost model inputs of a shader
+    struct WaveSizeMetrics
+    {
+        uint32_t divergentBranches;   // Count of divergent branches, weighted by loop depth
+        uint32_t vgprEstimate;        // Estimated count of VGPRs live at the same time
+        uint32_t memoryOps;           // Count of image and buffer memory operations
+        uint32_t ldsBytes;            // Size of LDS variables used by the shader in bytes
+        uint32_t workgroupSize;       // Count of threads of a workgroup (compute shader only)
+    };
+
+    bool IsWaveSizeSelectable(ShaderStage shaderStage) const;
+    void CollectMetrics(llvm::Function* pEntryPoint, WaveSizeMetrics* pMetrics);
+    void CollectDivergentValues(llvm::Function* pEntryPoint);
+    uint32_t EstimateVgprUsage(llvm::Function* pEntryPoint) const;
+    uint32_t SelectWaveSize(ShaderStage shaderStage, const WaveSizeMetrics& metrics) const;
+
+    // -----------------------------------------------------------------------------------------------------------------
+
+    llvm::DenseSet<llvm::Value*>    m_divergentValues;  // Values that may differ between the lanes of a wave
+};
+
+} // Llpc
@@ -1072,7 +1072,8 @@ VertexFetch::VertexFetch(
     m_pContext(static_cast<Context*>(&m_pModule->getContext())),
     m_pShaderSysValues(pShaderSysValues),
     m_pPipelineState(pPipelineState),
-    m_pVertexInput(static_cast<const GraphicsPipelineBuildInfo*>(m_pContext->GetPipelineBuildInfo())->pVertexInput)
+    m_pVertexInput(static_cast<const GraphicsPipelineBuildInfo*>(m_pContext->GetPipelineBuildInfo())->pVertexInput),
+    m_pVbTablePtr(nullptr)
 {
     LLPC_ASSERT(GetShaderStageFromFunction(pEntryPoint) == ShaderStageVertex); // Must be vertex shader
 
@@ -1104,7 +1105,41 @@ VertexFetch::VertexFetch(
         m_pInstanceIndex = BinaryOperator::CreateAdd(m_pBaseInstance, m_pInstanceId, "", &*pInsertPos);
     }
 
-    // Initialize default fetch values
+    InitFetchDefaults();
+}
+
+// =====================================================================================================================
+// Constructs the vertex fetch manager used by the vertex fetch prolog. The values that the prolog receives from the
+// vertex shader are set by SetPrologInterface() instead of being taken from the entry-point.
+VertexFetch::VertexFetch(
+    Module* pModule)    // [in] LLVM module
+    :
+    m_pModule(pModule),
+    m_pContext(static_cast<Context*>(&m_pModule->getContext())),
+    m_pShaderSysValues(nullptr),
+    m_pPipelineState(nullptr),
+    m_pVertexInput(static_cast<const GraphicsPipelineBuildInfo*>(m_pContext->GetPipelineBuildInfo())->pVertexInput),
+    m_pVertexDivisor(nullptr),
+    m_pVbTablePtr(nullptr),
+    m_pVertexIndex(nullptr),
+    m_pInstanceIndex(nullptr),
+    m_pBaseInstance(nullptr),
+    m_pInstanceId(nullptr)
+{
+    if (m_pVertexInput != nullptr)
+    {
+        m_pVertexDivisor = FindVkStructInChain<VkPipelineVertexInputDivisorStateCreateInfoEXT>(
+            VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_DIVISOR_STATE_CREATE_INFO_EXT,
+            m_pVertexInput->pNext);
+    }
+
+    InitFetchDefaults();
+}
+
+// =====================================================================================================================
+// Initializes default values for vertex fetch.
+void VertexFetch::InitFetchDefaults()
+{
     std::vector<Constant*> defaults;
     auto pZero = ConstantInt::get(m_pContext->Int32Ty(), 0);
 
@@ -1187,6 +1222,23 @@ VertexFetch::VertexFetch(
     m_fetchDefaults.pDouble = ConstantVector::get(defaults);
 }
 
+// =====================================================================================================================
+// Sets the values that the vertex fetch prolog receives from the vertex shader. They are used by subsequent vertex
+// fetch operations.
+void VertexFetch::SetPrologInterface(
+    Value*       pVbTablePtr,   // [in] Pointer to vertex buffer table
+    Value*       pVertexIndex,  // [in] Vertex index
+    Value*       pInstanceId,   // [in] Instance ID
+    Value*       pBaseInstance, // [in] Base instance
+    Instruction* pInsertPos)    // [in] Where to insert instructions
+{
+    m_pVbTablePtr    = pVbTablePtr;
+    m_pVertexIndex   = pVertexIndex;
+    m_pInstanceId    = pInstanceId;
+    m_pBaseInstance  = pBaseInstance;
+    m_pInstanceIndex = BinaryOperator::CreateAdd(m_pBaseInstance, m_pInstanceId, "", pInsertPos);
+}
+
 // =====================================================================================================================
 // Executes vertex fetch operations based on the specified vertex input type and its location.
 Value* VertexFetch::Run(
@@ -1663,7 +1715,8 @@ Value* VertexFetch::LoadVertexBufferDescriptor(
     idxs.push_back(ConstantInt::get(m_pContext->Int64Ty(), 0, false));
     idxs.push_back(ConstantInt::get(m_pContext->Int64Ty(), binding, false));
 
-    auto pVbTablePtr = m_pShaderSysValues->GetVertexBufTablePtr(m_pPipelineState);
+    auto pVbTablePtr = (m_pVbTablePtr != nullptr) ? m_pVbTablePtr :
+                                                    m_pShaderSysValues->GetVertexBufTablePtr(m_pPipelineState);
     auto pVbDescPtr = GetElementPtrInst::Create(nullptr, pVbTablePtr, idxs, "", pInsertPos);
     pVbDescPtr->setMetadata(m_pContext->MetaIdUniform(), m_pContext->GetEmptyMetadataNode());
 
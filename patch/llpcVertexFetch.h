@@ -68,6 +68,7 @@ class VertexFetch
 {
 public:
     VertexFetch(llvm::Function* pEntrypoint, ShaderSystemValues* pShaderSysValues, PipelineState* pPipelineState);
+    VertexFetch(llvm::Module* pModule);
 
     static const VertexFormatInfo* GetVertexFormatInfo(VkFormat format);
 
@@ -79,10 +80,24 @@ public:
     // Gets variable corresponding to instance index
     llvm::Value* GetInstanceIndex() { return m_pInstanceIndex; }
 
+    // Gets variable corresponding to instance ID
+    llvm::Value* GetInstanceId() { return m_pInstanceId; }
+
+    // Gets variable corresponding to base instance
+    llvm::Value* GetBaseInstance() { return m_pBaseInstance; }
+
+    void SetPrologInterface(llvm::Value*       pVbTablePtr,
+                            llvm::Value*       pVertexIndex,
+                            llvm::Value*       pInstanceId,
+                            llvm::Value*       pBaseInstance,
+                            llvm::Instruction* pInsertPos);
+
 private:
     LLPC_DISALLOW_DEFAULT_CTOR(VertexFetch);
     LLPC_DISALLOW_COPY_AND_ASSIGN(VertexFetch);
 
+    void InitFetchDefaults();
+
     static const VertexCompFormatInfo* GetVertexComponentFormatInfo(uint32_t dfmt);
 
     uint32_t MapVertexFormat(uint32_t dfmt, uint32_t nfmt) const;
@@ -121,6 +136,9 @@ private:
     const VkPipelineVertexInputStateCreateInfo*   m_pVertexInput; // Vertex input info
     const VkPipelineVertexInputDivisorStateCreateInfoEXT* m_pVertexDivisor; // Vertex input divisor info
 
+    llvm::Value*    m_pVbTablePtr;      // Vertex buffer table pointer passed to vertex fetch prolog (nullptr if the
+                                        //   vertex fetches are done in the vertex shader itself)
+
     llvm::Value*    m_pVertexIndex;     // Vertex index
     llvm::Value*    m_pInstanceIndex;   // Instance index
     llvm::Value*    m_pBaseInstance;    // Base instance
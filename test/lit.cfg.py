@@ -42,7 +42,7 @@ config.test_format = lit.formats.ShTest(True)
 config.suffixes = ['.vert', '.tesc', '.tese', '.geom', '.frag', '.comp', '.spvas', '.pipe', '.ll']
 
 # excludes: A list of directories  and fles to exclude from the testsuite.
-config.excludes = ['CMakeLists.txt', 'litScripts', 'internal', 'avoid', 'error']
+config.excludes = ['CMakeLists.txt', 'litScripts', 'internal', 'avoid', 'error', 'Inputs']
 
 # test_source_root: The root path where tests are located.
 config.test_source_root = os.path.dirname(__file__)
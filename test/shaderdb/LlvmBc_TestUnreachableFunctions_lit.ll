@@ -0,0 +1,58 @@
+; Builds a fragment shader from LLVM IR, which amdllpc passes to the pipeline build as LLVM bitcode. Only the functions
+; reachable from the entry point are loaded: the helper called by the entry point is kept, while the unreachable
+; helpers, including the ones with linkonce_odr linkage and the ones only called by unreachable helpers, are dropped
+; when the bitcode is loaded. The same file is built twice in the same context, so the second build clones the module
+; kept by the first one rather than loading the bitcode again.
+
+; BEGIN_SHADERTEST
+; RUN: amdllpc -v %gfxip -trace-file=%t.json %s %s | FileCheck -check-prefix=SHADERTEST %s
+; SHADERTEST-LABEL: {{^// LLPC}} loaded LLVM bitcode
+; SHADERTEST-NOT: @unreachable_
+; SHADERTEST: define internal spir_func void @reachable_helper()
+; SHADERTEST-NOT: @unreachable_
+; SHADERTEST-LABEL: {{^// LLPC}} pipeline patching results
+; SHADERTEST-LABEL: {{^// LLPC}} loaded LLVM bitcode
+; SHADERTEST-NOT: @unreachable_
+; SHADERTEST: define internal spir_func void @reachable_helper()
+; SHADERTEST-NOT: @unreachable_
+; SHADERTEST-LABEL: {{^// LLPC}} pipeline patching results
+; SHADERTEST: AMDLLPC SUCCESS
+; RUN: FileCheck -check-prefix=TRACETEST %s < %t.json
+; TRACETEST: "name":"LibraryCache","cat":"cache"
+; TRACETEST-NOT: "name":"LibraryCache"
+; END_SHADERTEST
+
+define spir_func void @main() !spirv.ExecutionModel !0
+{
+entry:
+    call spir_func void @reachable_helper()
+    ret void
+}
+
+define internal spir_func void @reachable_helper()
+{
+entry:
+    ret void
+}
+
+define internal spir_func void @unreachable_helper()
+{
+entry:
+    call spir_func void @unreachable_callee()
+    ret void
+}
+
+define internal spir_func void @unreachable_callee()
+{
+entry:
+    ret void
+}
+
+define linkonce_odr spir_func void @unreachable_odr_helper()
+{
+entry:
+    call spir_func void @unreachable_callee()
+    ret void
+}
+
+!0 = !{i32 4}
@@ -0,0 +1,41 @@
+#version 450
+
+layout(set = 0, binding = 0) uniform sampler2D samp;
+layout(set = 0, binding = 1) uniform Uniforms
+{
+    int count;
+};
+
+layout(location = 0) in vec2 inUv;
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+    vec4 color = vec4(0.0);
+    for (int i = 0; i < count; ++i)
+    {
+        color += texture(samp, inUv * float(i));
+    }
+
+    if (inUv.x > 0.5)
+    {
+        color += texture(samp, inUv.yx);
+    }
+    else
+    {
+        color -= texture(samp, inUv);
+    }
+
+    outColor = color;
+}
+
+// BEGIN_SHADERTEST
+/*
+; RUN: amdllpc -spvgen-dir=%spvgendir% -v %gfxip %s | FileCheck -check-prefix=SHADERTEST %s
+; SHADERTEST-LABEL: {{^// LLPC}} pipeline patching results
+; SHADERTEST: load <8 x i32>, <8 x i32> addrspace(4)*
+; SHADERTEST-NOT: load <8 x i32>, <8 x i32> addrspace(4)*
+; SHADERTEST: {{^}}}
+; SHADERTEST: AMDLLPC SUCCESS
+*/
+// END_SHADERTEST
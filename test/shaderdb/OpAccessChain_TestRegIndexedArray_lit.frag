@@ -0,0 +1,44 @@
+#version 450
+
+layout(location = 0) in flat int index;
+
+layout(location = 0) out vec4 output1;
+
+layout(binding = 0) uniform Uniforms
+{
+    vec4 weights[16];
+};
+
+void main()
+{
+    float values[16];
+    for (int i = 0; i < 16; ++i)
+    {
+        values[i] = weights[i].x;
+    }
+
+    values[index] += 1.0;
+    output1 = vec4(values[index], values[(index + 1) & 15], values[(index + 2) & 15], 0.0);
+}
+
+// BEGIN_SHADERTEST
+/*
+; RUN: amdllpc -spvgen-dir=%spvgendir% -v %gfxip %s | FileCheck -check-prefix=SHADERTEST %s
+; SHADERTEST-LABEL: {{^// LLPC}} SPIR-V lowering results
+; SHADERTEST-NOT: alloca [16 x float]
+; SHADERTEST: insertelement <16 x float> %{{[0-9]+}}, float %{{[0-9]+}}, i32 %{{[0-9]+}}
+; SHADERTEST: extractelement <16 x float> %{{[0-9]+}}, i32 %{{[0-9]+}}
+; SHADERTEST-LABEL: {{^// LLPC}} scratch memory usage
+; SHADERTEST: .ps : 0 bytes
+; SHADERTEST: AMDLLPC SUCCESS
+
+; Under robust buffer access, an out-of-bounds dynamic index loads zero and drops the store.
+; RUN: amdllpc -spvgen-dir=%spvgendir% -v %gfxip -robust-buffer-access %s | FileCheck -check-prefix=ROBUSTTEST %s
+; ROBUSTTEST-LABEL: {{^// LLPC}} SPIR-V lowering results
+; ROBUSTTEST-NOT: alloca [16 x float]
+; ROBUSTTEST: [[INBOUNDS:%[0-9]+]] = icmp ult i32 %{{[0-9]+}}, 16
+; ROBUSTTEST: select i1 [[INBOUNDS]], float %{{[0-9]+}}, float 0.000000e+00
+; ROBUSTTEST: select i1 %{{[0-9]+}}, <16 x float> %{{[0-9]+}}, <16 x float> %{{[0-9]+}}
+; ROBUSTTEST: AMDLLPC SUCCESS
+*/
+// END_SHADERTEST
@@ -34,17 +34,21 @@
 #endif
 
 #include "amdllpc.h"
+#include "llpcDirectoryCacheBackend.h"
 
 #include "llvm/AsmParser/Parser.h"
+#include "llvm/Bitcode/BitcodeReader.h"
 #include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Verifier.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Compression.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/raw_ostream.h"
@@ -63,6 +67,7 @@
     #endif
 #endif
 
+#include <algorithm>
 #include <sstream>
 #include <stdlib.h> // getenv
 
@@ -100,7 +105,7 @@ static cl::opt<std::string> GfxIp("gfxip",
 static GfxIpVersion ParsedGfxIp = {8, 0, 0};
 
 // Input sources
-static cl::list<std::string> InFiles(cl::Positional, cl::OneOrMore, cl::ValueRequired,
+static cl::list<std::string> InFiles(cl::Positional, cl::ZeroOrMore, cl::ValueRequired,
             cl::desc("<source>...\n"
               "Type of input file is determined by its filename extension:\n"
               "  .spv      SPIR-V binary\n"
@@ -253,6 +258,13 @@ static cl::opt<uint32_t> NggVertsPerSubgroup(
     cl::desc("Preferred number of vertices consumed by a primitive shader sub-group (NGG)"),
     cl::value_desc("verts"),
     cl::init(256));
+
+// -ngg-autotune: tune the NGG state of the input pipelines and write the recommended states to the specified file
+static cl::opt<std::string> NggAutotune(
+    "ngg-autotune",
+    cl::desc("Sweep the NGG state options of each input pipeline, score the variants with a static cost model and "
+             "write the recommended NGG state per pipeline hash to the specified file"),
+    cl::value_desc("filename"));
 #endif
 
 // -spvgen-dir: load SPVGEN from specified directory
@@ -261,6 +273,83 @@ static cl::opt<std::string> SpvGenDir("spvgen-dir", cl::desc("Directory to load
 static cl::opt<bool> RobustBufferAccess("robust-buffer-access",
                                         cl::desc("Validate if the index is out of bounds"), cl::init(false));
 
+// -upgrade-shader-cache: upgrade an existing shader cache file to the running compiler
+static cl::opt<std::string> UpgradeShaderCache("upgrade-shader-cache",
+                                               cl::desc("Upgrade the specified shader cache file, recompiling the "
+                                                        "input pipelines if codegen-relevant inputs changed"),
+                                               cl::value_desc("filename"));
+
+// -upgrade-shader-cache-out: output file of shader cache upgrade
+static cl::opt<std::string> UpgradeShaderCacheOut("upgrade-shader-cache-out",
+                                                  cl::desc("Output file of shader cache upgrade (default: overwrite "
+                                                           "the input shader cache file)"),
+                                                  cl::value_desc("filename"));
+
+// -rekey-shader-cache: carry over all entries of the upgraded shader cache without recompiling
+static cl::opt<bool> RekeyShaderCache("rekey-shader-cache",
+                                      cl::desc("Re-key the upgraded shader cache, carrying over all entries that are "
+                                               "not recompiled (use only if codegen is known to be unchanged; "
+                                               "refused if the target or options changed)"),
+                                      cl::init(false));
+
+// -shader-cache-backend-dir: back the pipeline shader cache with a local directory
+static cl::opt<std::string> ShaderCacheBackendDir("shader-cache-backend-dir",
+                                                  cl::desc("Directory of a local store backing the application "
+                                                           "shader cache passed to pipeline builds"),
+                                                  cl::value_desc("directory"));
+
+// -shader-cache-prefetch: prefetch each pipeline from the backend of the pipeline shader cache
+static cl::opt<bool> ShaderCachePrefetch("shader-cache-prefetch",
+                                         cl::desc("Prefetch each input pipeline from the backend of the application "
+                                                  "shader cache (see -shader-cache-backend-dir) before building it"),
+                                         cl::init(false));
+
+// -shader-cache-in: seed the pipeline shader cache from shader cache files
+static cl::list<std::string> ShaderCacheIn("shader-cache-in",
+                                           cl::desc("Seed the application shader cache passed to pipeline builds "
+                                                    "from the specified shader cache files, merging them"),
+                                           cl::value_desc("filename,..."),
+                                           cl::CommaSeparated);
+
+// -shader-cache-out: write the pipeline shader cache to a file
+static cl::opt<std::string> ShaderCacheOut("shader-cache-out",
+                                           cl::desc("Write the application shader cache passed to pipeline builds to "
+                                                    "the specified file after all input pipelines are built"),
+                                           cl::value_desc("filename"));
+
+// -include-llvm-ir: include the LLVM IR of the pipeline in the pipeline ELF
+static cl::opt<bool> IncludeLlvmIr("include-llvm-ir",
+                                   cl::desc("Include the LLVM IR of the pipeline in the pipeline ELF, as compressed "
+                                            "bitcode in the .AMDGPU.llvmbc section"),
+                                   cl::init(false));
+
+// -decode-llvm-ir: decode the LLVM IR bitcode included in a pipeline ELF
+static cl::opt<std::string> DecodeLlvmIr("decode-llvm-ir",
+                                         cl::desc("Decode the LLVM IR included in the specified pipeline ELF (built "
+                                                  "with -include-llvm-ir) and output it as text"),
+                                         cl::value_desc("filename"));
+
+// -multi-target-gfxip: also build each pipeline for several graphics IP versions with one multi-target build
+static cl::list<std::string> MultiTargetGfxIp("multi-target-gfxip",
+                                              cl::desc("Also build each pipeline for the specified graphics IP "
+                                                       "versions with one multi-target build, and output the ELF info "
+                                                       "of each target"),
+                                              cl::value_desc("major.minor.step,..."),
+                                              cl::CommaSeparated);
+
+// -speculate: queue each pipeline for speculative compilation right before building it
+static cl::opt<bool> Speculate("speculate",
+                               cl::desc("Queue each pipeline for speculative compilation right before building it, "
+                                        "so that the build preempts or joins the speculative one"),
+                               cl::init(false));
+
+// The application shader cache passed to pipeline builds, used by shader cache upgrade and cache backends.
+static IShaderCache* PipelineShaderCache = nullptr;
+
+// Compilers and graphics IP versions of the targets of multi-target builds (see -multi-target-gfxip).
+static std::vector<ICompiler*>   TargetCompilers;
+static std::vector<GfxIpVersion> TargetGfxIps;
+
 namespace llvm
 {
 
@@ -385,11 +474,37 @@ static Result Init(
             "-filetype",                           "-filetype=obj",   // Target = obj, ELF binary; target = asm, ISA assembly text
         };
 
+        // NOTE: The options the compiler is created with make up the build ID of its shader caches, so the input files
+        // and the options naming shader cache files are left out of them, otherwise caches written and read by
+        // different runs of the tool would never match. Parse all arguments here first to know the input files; the
+        // compiler only parses the options it is created with again, after resetting them.
+        if (cl::ParseCommandLineOptions(argc, argv, "AMD LLPC compiler", &errs()) == false)
+        {
+            result = Result::ErrorInvalidValue;
+        }
+
+        const cl::Option* cacheFileOptions[] =
+        {
+            &UpgradeShaderCache, &UpgradeShaderCacheOut, &RekeyShaderCache,
+            &ShaderCacheBackendDir, &ShaderCacheIn, &ShaderCacheOut,
+        };
+
         // Build new arguments, starting with those supplied in command line
         std::vector<const char*> newArgs;
         for (int32_t i = 0; i < argc; ++i)
         {
-            newArgs.push_back(argv[i]);
+            StringRef arg(argv[i]);
+            StringRef optionName = arg.ltrim('-').split('=').first;
+            bool isToolArg = (i > 0) && (std::find(InFiles.begin(), InFiles.end(), argv[i]) != InFiles.end());
+            for (auto pOption : cacheFileOptions)
+            {
+                isToolArg |= arg.startswith("-") && (optionName == pOption->ArgStr);
+            }
+
+            if (isToolArg == false)
+            {
+                newArgs.push_back(argv[i]);
+            }
         }
 
         static const size_t defaultOptionCount = sizeof(defaultOptions) / (2 * sizeof(defaultOptions[0]));
@@ -496,7 +611,41 @@ static Result Init(
         // Subsequent command option parse will correct its value if this option is specified externally.
         cl::DisableNullFragShader.setValue(true);
 
-        result = ICompiler::Create(ParsedGfxIp, newArgs.size(), &newArgs[0], ppCompiler);
+        if (result == Result::Success)
+        {
+            result = ICompiler::Create(ParsedGfxIp, newArgs.size(), &newArgs[0], ppCompiler);
+        }
+
+        // Create a compiler for each target of multi-target builds. The options, including -gfxip, must be those of
+        // the compiler above, which lowers the pipelines for all targets.
+        for (uint32_t i = 0; (i < MultiTargetGfxIp.size()) && (result == Result::Success); ++i)
+        {
+            SmallVector<StringRef, 3> tokens;
+            StringRef(MultiTargetGfxIp[i]).split(tokens, '.');
+
+            GfxIpVersion targetGfxIp = {};
+            uint32_t* pVersions[] = { &targetGfxIp.major, &targetGfxIp.minor, &targetGfxIp.stepping };
+            for (uint32_t j = 0; (j < tokens.size()) && (j < 3); ++j)
+            {
+                if (tokens[j].getAsInteger(10, *pVersions[j]))
+                {
+                    LLPC_ERRS("Invalid graphics IP version in -multi-target-gfxip: " << MultiTargetGfxIp[i] << "\n");
+                    result = Result::ErrorInvalidValue;
+                }
+            }
+
+            ICompiler* pTargetCompiler = nullptr;
+            if (result == Result::Success)
+            {
+                result = ICompiler::Create(targetGfxIp, newArgs.size(), &newArgs[0], &pTargetCompiler);
+            }
+
+            if (result == Result::Success)
+            {
+                TargetCompilers.push_back(pTargetCompiler);
+                TargetGfxIps.push_back(targetGfxIp);
+            }
+        }
     }
 
     if ((result == Result::Success) && (SpvGenDir != ""))
@@ -591,6 +740,19 @@ void* VKAPI_CALL AllocateBuffer(
     return pAllocBuf;
 }
 
+// =====================================================================================================================
+// Allocates the output buffer of a target of a multi-target build. The targets are built in parallel, so unlike
+// AllocateBuffer, the buffer is only returned; it is stored in the build output of the target.
+void* VKAPI_CALL AllocateTargetBuffer(
+    void*  pInstance,   // [in] Dummy instance object, unused
+    void*  pUserData,   // [in] User data, unused
+    size_t size)        // Requested allocation size
+{
+    void* pAllocBuf = malloc(size);
+    memset(pAllocBuf, 0, size);
+    return pAllocBuf;
+}
+
 // =====================================================================================================================
 // Checks whether the specified file name represents a SPRI-V assembly text file (.spvas).
 static bool IsSpirvTextFile(
@@ -906,6 +1068,47 @@ static Result AssembleSpirv(
     return result;
 }
 
+// =====================================================================================================================
+// Outputs the scratch memory usage of each hardware shader stage of a pipeline binary, read from its PAL metadata.
+static void DumpScratchMemoryUsage(
+    ElfReader<Elf64>& reader)   // [in] ELF reader of the pipeline binary
+{
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 432
+    if (reader.IsSectionPresent(NoteName) == false)
+    {
+        return;
+    }
+
+    auto note = reader.GetNote(Util::Abi::PipelineAbiNoteType::PalMetadata);
+    msgpack::Document document;
+    if ((note.pData == nullptr) ||
+        (document.readFromBlob(StringRef(reinterpret_cast<const char*>(note.pData), note.hdr.descSize),
+                               false) == false))
+    {
+        return;
+    }
+
+    auto hwStages = document.getRoot().getMap(true)[Util::Abi::PalCodeObjectMetadataKey::Pipelines]
+                                      .getArray(true)[0]
+                                      .getMap(true)[Util::Abi::PipelineMetadataKey::HardwareStages]
+                                      .getMap(true);
+
+    LLPC_OUTS("===============================================================================\n");
+    LLPC_OUTS("// LLPC scratch memory usage\n\n");
+    for (auto& hwStage : hwStages)
+    {
+        uint32_t scratchSize = 0;
+        auto node = hwStage.second.getMap(true)[Util::Abi::HardwareStageMetadataKey::ScratchMemorySize];
+        if (node.getKind() == msgpack::Type::UInt)
+        {
+            scratchSize = node.getUInt();
+        }
+        LLPC_OUTS(format("%-4s", hwStage.first.getString().str().c_str()) << ": " << scratchSize << " bytes\n");
+    }
+    LLPC_OUTS("\n");
+#endif
+}
+
 // =====================================================================================================================
 // Decodes the binary after building a pipeline and outputs the decoded info.
 static Result DecodePipelineBinary(
@@ -922,11 +1125,103 @@ static Result DecodePipelineBinary(
         LLPC_OUTS("===============================================================================\n");
         LLPC_OUTS("// LLPC final ELF info\n");
         LLPC_OUTS(reader);
+
+        DumpScratchMemoryUsage(reader);
     }
 
     return Result::Success;
 }
 
+// =====================================================================================================================
+// Decodes the LLVM IR bitcode records included in the specified pipeline ELF file, and outputs each module as text.
+static Result DecodeLlvmIrFromElf(
+    const std::string& elfFileName,     // [in] Name of pipeline ELF file
+    const std::string& outFileName)     // [in] Name of the file to output the LLVM IR text ("" or "-" for stdout)
+{
+    Result result = Result::Success;
+
+    auto fileOrErr = MemoryBuffer::getFile(elfFileName);
+    if (!fileOrErr)
+    {
+        LLPC_ERRS("Fails to read ELF file: " << elfFileName << "\n");
+        result = Result::ErrorUnavailable;
+    }
+
+    ElfReader<Elf64> reader(ParsedGfxIp);
+    ElfReader<Elf64>::SectionBuffer* pSection = nullptr;
+    if (result == Result::Success)
+    {
+        size_t readSize = 0;
+        if ((IsElfBinary((*fileOrErr)->getBufferStart(), (*fileOrErr)->getBufferSize()) == false) ||
+            (reader.ReadFromBuffer((*fileOrErr)->getBufferStart(), &readSize) != Result::Success))
+        {
+            LLPC_ERRS("Invalid ELF file: " << elfFileName << "\n");
+            result = Result::ErrorInvalidValue;
+        }
+        else if ((reader.GetSectionIndex(LlvmIrBitcodeName) < 0) ||
+                 (reader.GetSectionDataBySectionIndex(reader.GetSectionIndex(LlvmIrBitcodeName), &pSection) !=
+                  Result::Success))
+        {
+            LLPC_ERRS("No LLVM IR included in ELF file: " << elfFileName << "\n");
+            result = Result::ErrorUnavailable;
+        }
+    }
+
+    std::error_code errCode;
+    raw_fd_ostream outFile(outFileName.empty() ? "-" : outFileName, errCode, sys::fs::F_Text);
+    if ((result == Result::Success) && errCode)
+    {
+        LLPC_ERRS("Fails to open output file: " << outFileName << "\n");
+        result = Result::ErrorUnavailable;
+    }
+
+    // Each record is a bitcode header followed by the (possibly compressed) bitcode of one module.
+    size_t offset = 0;
+    while ((result == Result::Success) && (offset < pSection->secHead.sh_size))
+    {
+        LlvmIrBitcodeHeader header = {};
+        if (offset + sizeof(header) <= pSection->secHead.sh_size)
+        {
+            memcpy(&header, pSection->pData + offset, sizeof(header));
+        }
+        if ((header.magic != LlvmIrBitcodeMagic) ||
+            (offset + sizeof(header) + header.dataSize > pSection->secHead.sh_size))
+        {
+            LLPC_ERRS("Corrupted LLVM IR bitcode record at offset " << offset << "\n");
+            result = Result::ErrorInvalidValue;
+            break;
+        }
+
+        StringRef data(reinterpret_cast<const char*>(pSection->pData) + offset + sizeof(header), header.dataSize);
+        SmallVector<char, 0> uncompressedData;
+        if (header.compression == LlvmIrBitcodeCompressionZlib)
+        {
+            Error err = zlib::uncompress(data, uncompressedData, header.bitcodeSize);
+            if (err)
+            {
+                LLPC_ERRS("Fails to uncompress LLVM IR bitcode: " << toString(std::move(err)) << "\n");
+                result = Result::ErrorInvalidValue;
+                break;
+            }
+            data = StringRef(uncompressedData.data(), uncompressedData.size());
+        }
+
+        LLVMContext context;
+        auto moduleOrErr = parseBitcodeFile(MemoryBufferRef(data, elfFileName), context);
+        if (!moduleOrErr)
+        {
+            LLPC_ERRS("Fails to parse LLVM IR bitcode: " << toString(moduleOrErr.takeError()) << "\n");
+            result = Result::ErrorInvalidValue;
+            break;
+        }
+
+        outFile << **moduleOrErr;
+        offset += sizeof(header) + header.dataSize;
+    }
+
+    return result;
+}
+
 // =====================================================================================================================
 // Builds shader module based on the specified SPIR-V binary.
 static Result BuildShaderModules(
@@ -1014,6 +1309,7 @@ static Result BuildPipeline(
         pPipelineInfo->pInstance      = nullptr; // Dummy, unused
         pPipelineInfo->pUserData      = &pCompileInfo->pPipelineBuf;
         pPipelineInfo->pfnOutputAlloc = AllocateBuffer;
+        pPipelineInfo->pShaderCache   = PipelineShaderCache;
 
         // NOTE: If number of patch control points is not specified, we set it to 3.
         if (pPipelineInfo->iaState.patchControlPoints == 0)
@@ -1023,6 +1319,7 @@ static Result BuildPipeline(
 #if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 23
         pPipelineInfo->options.robustBufferAccess = RobustBufferAccess;
 #endif
+        pPipelineInfo->options.includeIr |= IncludeLlvmIr;
 
         void* pPipelineDumpHandle = nullptr;
         if (llvm::cl::EnablePipelineDump)
@@ -1050,7 +1347,27 @@ static Result BuildPipeline(
             outs().flush();
         }
 
-        result = pCompiler->BuildGraphicsPipeline(pPipelineInfo, pPipelineOut, pPipelineDumpHandle);
+#if LLPC_BUILD_GFX10
+        if (NggAutotune.empty() == false)
+        {
+            result = AutotuneNggState(pCompiler, pPipelineInfo, ParsedGfxIp);
+        }
+#endif
+
+        if ((result == Result::Success) && Speculate)
+        {
+            result = pCompiler->SpeculateGraphicsPipelines(1, pPipelineInfo);
+        }
+
+        if (ShaderCachePrefetch && (PipelineShaderCache != nullptr))
+        {
+            PipelineShaderCache->PrefetchPipelines(1, &pPipelineInfo, 0, nullptr);
+        }
+
+        if (result == Result::Success)
+        {
+            result = pCompiler->BuildGraphicsPipeline(pPipelineInfo, pPipelineOut, pPipelineDumpHandle);
+        }
 
         if (result == Result::Success)
         {
@@ -1103,9 +1420,11 @@ static Result BuildPipeline(
         pPipelineInfo->pInstance      = nullptr; // Dummy, unused
         pPipelineInfo->pUserData      = &pCompileInfo->pPipelineBuf;
         pPipelineInfo->pfnOutputAlloc = AllocateBuffer;
+        pPipelineInfo->pShaderCache   = PipelineShaderCache;
 #if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 23
         pPipelineInfo->options.robustBufferAccess = RobustBufferAccess;
 #endif
+        pPipelineInfo->options.includeIr |= IncludeLlvmIr;
 
         void* pPipelineDumpHandle = nullptr;
         if (llvm::cl::EnablePipelineDump)
@@ -1132,7 +1451,20 @@ static Result BuildPipeline(
             outs().flush();
         }
 
-        result = pCompiler->BuildComputePipeline(pPipelineInfo, pPipelineOut, pPipelineDumpHandle);
+        if (Speculate)
+        {
+            result = pCompiler->SpeculateComputePipelines(1, pPipelineInfo);
+        }
+
+        if (ShaderCachePrefetch && (PipelineShaderCache != nullptr))
+        {
+            PipelineShaderCache->PrefetchPipelines(0, nullptr, 1, &pPipelineInfo);
+        }
+
+        if (result == Result::Success)
+        {
+            result = pCompiler->BuildComputePipeline(pPipelineInfo, pPipelineOut, pPipelineDumpHandle);
+        }
 
         if (result == Result::Success)
         {
@@ -1153,6 +1485,78 @@ static Result BuildPipeline(
     return result;
 }
 
+// =====================================================================================================================
+// Builds the pipeline, which has been built by BuildPipeline, for all targets of -multi-target-gfxip with one
+// multi-target build, and outputs the ELF info of each target.
+static Result BuildPipelineMultiTarget(
+    ICompiler*    pCompiler,        // [in] LLPC compiler object, which lowers the pipeline for all targets
+    CompileInfo*  pCompileInfo)     // [in] Compilation info of LLPC standalone tool
+{
+    Result result = Result::Success;
+    const uint32_t targetCount = TargetCompilers.size();
+
+    std::vector<BinaryData> pipelineBins(targetCount);
+    bool isGraphics = (pCompileInfo->stageMask & (ShaderStageToMask(ShaderStageCompute) -1)) ? true : false;
+    if (isGraphics)
+    {
+        GraphicsPipelineBuildInfo pipelineInfo = pCompileInfo->gfxPipelineInfo;
+        pipelineInfo.pUserData      = nullptr;
+        pipelineInfo.pfnOutputAlloc = AllocateTargetBuffer;
+
+        std::vector<GraphicsPipelineBuildOut> pipelineOuts(targetCount);
+        result = pCompiler->BuildGraphicsPipelineMultiTarget(&pipelineInfo,
+                                                             targetCount,
+                                                             &TargetCompilers[0],
+                                                             &pipelineOuts[0]);
+        for (uint32_t i = 0; i < targetCount; ++i)
+        {
+            pipelineBins[i] = pipelineOuts[i].pipelineBin;
+        }
+    }
+    else
+    {
+        ComputePipelineBuildInfo pipelineInfo = pCompileInfo->compPipelineInfo;
+        pipelineInfo.pUserData      = nullptr;
+        pipelineInfo.pfnOutputAlloc = AllocateTargetBuffer;
+
+        std::vector<ComputePipelineBuildOut> pipelineOuts(targetCount);
+        result = pCompiler->BuildComputePipelineMultiTarget(&pipelineInfo,
+                                                            targetCount,
+                                                            &TargetCompilers[0],
+                                                            &pipelineOuts[0]);
+        for (uint32_t i = 0; i < targetCount; ++i)
+        {
+            pipelineBins[i] = pipelineOuts[i].pipelineBin;
+        }
+    }
+
+    for (uint32_t i = 0; i < targetCount; ++i)
+    {
+        const GfxIpVersion& gfxIp = TargetGfxIps[i];
+        if (result == Result::Success)
+        {
+            // Ignore failure from ElfReader, as in DecodePipelineBinary.
+            ElfReader<Elf64> reader(gfxIp);
+            size_t readSize = 0;
+            if (reader.ReadFromBuffer(pipelineBins[i].pCode, &readSize) == Result::Success)
+            {
+                LLPC_OUTS("===============================================================================\n");
+                LLPC_OUTS("// LLPC multi-target ELF info (gfxip " << gfxIp.major << "." << gfxIp.minor << "." <<
+                          gfxIp.stepping << ")\n");
+                LLPC_OUTS(reader);
+            }
+        }
+        free(const_cast<void*>(pipelineBins[i].pCode));
+    }
+
+    if (result != Result::Success)
+    {
+        LLPC_ERRS("Fails to build multi-target pipeline\n");
+    }
+
+    return result;
+}
+
 // =====================================================================================================================
 // Output LLPC resulting binary (ELF binary, ISA assembly text, or LLVM bitcode) to the specified target file.
 static Result OutputElf(
@@ -1584,10 +1988,15 @@ static Result ProcessPipeline(
     {
         compileInfo.pFileNames = fileNames.c_str();
         result = BuildPipeline(pCompiler, &compileInfo);
-        if (result == Result::Success)
+        if ((result == Result::Success) && UpgradeShaderCache.empty())
         {
             result = OutputElf(&compileInfo, OutFile, inFiles[0]);
         }
+
+        if ((result == Result::Success) && (TargetCompilers.empty() == false))
+        {
+            result = BuildPipelineMultiTarget(pCompiler, &compileInfo);
+        }
     }
 
     //
@@ -1673,7 +2082,55 @@ int32_t main(
     }
 #endif
 
-    if (IsPipelineInfoFile(InFiles[0]) || IsLlvmIrFile(InFiles[0]))
+    bool needCompile = true;
+    DirectoryCacheBackend* pCacheBackend = nullptr;
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 37
+    if ((result == Result::Success) && (ShaderCacheBackendDir.empty() == false) && UpgradeShaderCache.empty())
+    {
+        // Back the pipeline shader cache with a local directory, standing in for a remote store.
+        pCacheBackend = new DirectoryCacheBackend(ShaderCacheBackendDir, std::thread::hardware_concurrency());
+
+        ShaderCacheCreateInfo createInfo = {};
+        createInfo.pBackend = pCacheBackend;
+        result = pCompiler->CreateShaderCache(&createInfo, &PipelineShaderCache);
+    }
+    else
+#endif
+    if ((result == Result::Success) && (UpgradeShaderCache.empty() == false))
+    {
+        result = BeginShaderCacheUpgrade(pCompiler,
+                                         UpgradeShaderCache,
+                                         RekeyShaderCache,
+                                         &PipelineShaderCache,
+                                         &needCompile);
+    }
+    else if ((result == Result::Success) && ((ShaderCacheIn.empty() == false) || (ShaderCacheOut.empty() == false)))
+    {
+        result = LoadShaderCacheFiles(pCompiler,
+                                      std::vector<std::string>(ShaderCacheIn.begin(), ShaderCacheIn.end()),
+                                      &PipelineShaderCache);
+
+        // Merging shader cache files needs no input pipelines.
+        needCompile = (InFiles.empty() == false) || ShaderCacheIn.empty();
+    }
+
+    if ((result == Result::Success) && (DecodeLlvmIr.empty() == false))
+    {
+        result = DecodeLlvmIrFromElf(DecodeLlvmIr, OutFile);
+        needCompile = false;
+    }
+
+    if ((result == Result::Success) && needCompile && InFiles.empty())
+    {
+        LLPC_ERRS("\nNo input files specified\n");
+        result = Result::ErrorInvalidValue;
+    }
+
+    if ((result != Result::Success) || (needCompile == false))
+    {
+        // Nothing to compile.
+    }
+    else if (IsPipelineInfoFile(InFiles[0]) || IsLlvmIrFile(InFiles[0]))
     {
         uint32_t nextFile = 0;
 
@@ -1757,6 +2214,35 @@ int32_t main(
         }
     }
 
+    if ((result == Result::Success) && (UpgradeShaderCache.empty() == false))
+    {
+        result = EndShaderCacheUpgrade(UpgradeShaderCacheOut.empty() ? UpgradeShaderCache : UpgradeShaderCacheOut);
+    }
+    else if (PipelineShaderCache != nullptr)
+    {
+        if ((result == Result::Success) && (ShaderCacheOut.empty() == false))
+        {
+            result = WriteShaderCacheFile(PipelineShaderCache, ShaderCacheOut);
+        }
+        PipelineShaderCache->Destroy();
+        if (pCacheBackend != nullptr)
+        {
+            pCacheBackend->ReportStatistics();
+            delete pCacheBackend;
+        }
+    }
+
+#if LLPC_BUILD_GFX10
+    if ((result == Result::Success) && (NggAutotune.empty() == false))
+    {
+        result = WriteNggAutotuneResults(NggAutotune);
+    }
+#endif
+
+    for (auto pTargetCompiler : TargetCompilers)
+    {
+        pTargetCompiler->Destroy();
+    }
     pCompiler->Destroy();
 
     if (result == Result::Success)
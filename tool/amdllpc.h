@@ -30,6 +30,8 @@
  */
 #pragma once
 
+#include <string>
+#include <vector>
 #include "llpc.h"
 
 // Lay out dummy descriptors and other information for one shader stage. This is used when running amdllpc on a single
@@ -41,3 +43,32 @@ void DoAutoLayoutDesc(Llpc::ShaderStage                 shaderStage,
                       Llpc::PipelineShaderInfo*         pShaderInfo,
                       uint32_t&                         topLevelOffset);
 
+
+// Reads an existing shader cache file for offline upgrade and creates the shader cache that input pipelines are
+// recompiled into.
+Llpc::Result BeginShaderCacheUpgrade(Llpc::ICompiler*      pCompiler,
+                                     const std::string&    cacheFile,
+                                     bool                  rekey,
+                                     Llpc::IShaderCache**  ppShaderCache,
+                                     bool*                 pNeedRecompile);
+
+// Writes the upgraded shader cache file and reports which entries were carried over, recompiled or dropped.
+Llpc::Result EndShaderCacheUpgrade(const std::string& outFile);
+
+// Creates the shader cache passed to pipeline builds, merging the entries of the specified shader cache files.
+Llpc::Result LoadShaderCacheFiles(Llpc::ICompiler*                 pCompiler,
+                                  const std::vector<std::string>&  cacheFiles,
+                                  Llpc::IShaderCache**             ppShaderCache);
+
+// Writes a shader cache file and reports the entries it holds.
+Llpc::Result WriteShaderCacheFile(Llpc::IShaderCache* pShaderCache, const std::string& outFile);
+
+#if LLPC_BUILD_GFX10
+// Sweeps the NGG state options of a graphics pipeline and records the variant with the lowest estimated cost.
+Llpc::Result AutotuneNggState(Llpc::ICompiler*                        pCompiler,
+                              const Llpc::GraphicsPipelineBuildInfo*  pPipelineInfo,
+                              Llpc::GfxIpVersion                      gfxIp);
+
+// Writes the recommended NGG state of all tuned pipelines, one line per pipeline hash.
+Llpc::Result WriteNggAutotuneResults(const std::string& outFile);
+#endif
@@ -0,0 +1,877 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2019 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcBench.cpp
+ * @brief LLPC source file: pipeline compile throughput benchmark (llpc-bench)
+ ***********************************************************************************************************************
+ */
+#ifdef WIN_OS
+    // NOTE: Disable Windows-defined min()/max() because we use STL-defined std::min()/std::max() in LLPC.
+    #define NOMINMAX
+#endif
+
+#include "amdllpc.h"
+
+#include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/PrettyStackTrace.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+
+#ifdef WIN_OS
+    #include <windows.h>
+    #include <psapi.h>
+#else
+    #include <sys/resource.h>
+#endif
+
+#ifndef LLPC_ENABLE_SPIRV_OPT
+    #define SPVGEN_STATIC_LIB   1
+#endif
+#include "spvgen.h"
+#include "vfx.h"
+
+#include "llpc.h"
+#include "llpcDebug.h"
+#include "llpcInternal.h"
+#include "llpcTimerProfiler.h"
+
+#define DEBUG_TYPE "llpc-bench"
+
+using namespace llvm;
+using namespace Llpc;
+
+// Input sources: files or directories, which are searched recursively
+static cl::list<std::string> InFiles(cl::Positional, cl::OneOrMore, cl::ValueRequired,
+                                     cl::desc("<source files or directories>"));
+
+// -gfxip: graphics IP version
+static cl::opt<std::string> GfxIp("gfxip",
+                                  cl::desc("Graphics IP version"),
+                                  cl::value_desc("major.minor.step"),
+                                  cl::init("8.0.0"));
+
+// -o: output
+static cl::opt<std::string> OutFile("o",
+                                    cl::desc("Output file of the benchmark results in JSON"),
+                                    cl::value_desc("filename (\"-\" for stdout)"),
+                                    cl::init("-"));
+
+// -iterations: count of timed passes over the corpus
+static cl::opt<uint32_t> Iterations("iterations",
+                                    cl::desc("Count of timed passes over the corpus, for each of cold and warm cache"),
+                                    cl::init(5));
+
+// -phase-times: profile the compilation phases in an additional pass over the corpus
+static cl::opt<bool> ProfilePhases("phase-times",
+                                   cl::desc("Profile the compilation phases in an additional pass over the corpus"),
+                                   cl::init(true));
+
+// -spvgen-dir: load SPVGEN from specified directory
+static cl::opt<std::string> SpvGenDir("spvgen-dir", cl::desc("Directory to load SPVGEN library from"));
+
+// Represents a pipeline of the benchmark corpus, loaded once and built on every pass over the corpus.
+struct BenchPipeline
+{
+    std::string                 name;               // Name of the source file
+    bool                        isGraphics;         // Whether it is a graphics pipeline
+    bool                        failed;             // Whether building the pipeline failed
+    GraphicsPipelineBuildInfo   gfxPipelineInfo;    // Info to build graphics pipeline
+    ComputePipelineBuildInfo    compPipelineInfo;   // Info to build compute pipeline
+    std::vector<double>         coldLatencies;      // Build latencies with cold caches, in seconds
+    std::vector<double>         warmLatencies;      // Build latencies with warm caches, in seconds
+};
+
+// Represents the benchmark corpus and the resources it holds until the benchmark finishes.
+struct BenchCorpus
+{
+    std::vector<BenchPipeline>  pipelines;          // Pipelines of the corpus
+    std::vector<std::string>    loadFailures;       // Names of the source files that could not be loaded
+    std::vector<void*>          pipelineDocs;       // VFX docs of the loaded pipeline files
+    std::vector<char*>          spirvBins;          // SPIR-V binaries of the loaded shader files
+    std::vector<void*>          moduleBufs;         // Allocation buffers of the built shader modules
+    double                      moduleSeconds;      // Time spent building shader modules
+};
+
+// Represents the results of timed passes over the corpus.
+struct PassStats
+{
+    double   seconds;           // Time spent building pipelines
+    uint32_t pipelineCount;     // Count of pipelines built
+    double   latencyP50;        // Median build latency, in seconds
+    double   latencyP99;        // 99th percentile build latency, in seconds
+};
+
+// =====================================================================================================================
+// Callback function to allocate buffer for building shader module and building pipeline.
+static void* VKAPI_CALL AllocateBuffer(
+    void*  pInstance,   // [in] Dummy instance object, unused
+    void*  pUserData,   // [in] User data
+    size_t size)        // Requested allocation size
+{
+    void* pAllocBuf = malloc(size);
+    memset(pAllocBuf, 0, size);
+
+    void** ppOutBuf = reinterpret_cast<void**>(pUserData);
+    *ppOutBuf = pAllocBuf;
+    return pAllocBuf;
+}
+
+// =====================================================================================================================
+// Gets the peak resident set size of this process, in kilobytes.
+static uint64_t GetPeakRssKb()
+{
+#ifdef WIN_OS
+    PROCESS_MEMORY_COUNTERS counters = {};
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return counters.PeakWorkingSetSize / 1024;
+#else
+    struct rusage usage = {};
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+// =====================================================================================================================
+// Gets the specified percentile of the latencies, using the nearest-rank method.
+static double GetPercentile(
+    std::vector<double>* pLatencies,    // [in,out] Latencies, sorted on return
+    double               percentile)    // Percentile, in the range (0, 100]
+{
+    double value = 0.0;
+    if (pLatencies->empty() == false)
+    {
+        std::sort(pLatencies->begin(), pLatencies->end());
+        size_t rank = static_cast<size_t>(ceil(percentile / 100.0 * pLatencies->size()));
+        value = (*pLatencies)[std::max<size_t>(rank, 1) - 1];
+    }
+    return value;
+}
+
+// =====================================================================================================================
+// Reads a whole file into a string.
+static Result ReadFile(
+    const std::string& fileName,    // [in] Name of the file
+    std::string*       pContent)    // [out] Content of the file
+{
+    auto fileOrErr = MemoryBuffer::getFile(fileName);
+    if (!fileOrErr)
+    {
+        LLPC_ERRS("Fails to open input file: " << fileName << "\n");
+        return Result::ErrorUnavailable;
+    }
+
+    *pContent = (*fileOrErr)->getBuffer().str();
+    return Result::Success;
+}
+
+// =====================================================================================================================
+// Gets SPIR-V binary from a shader file: SPIR-V binary, SPIR-V assembly text or GLSL source text. Source text is
+// translated with SPVGEN.
+static Result GetSpirvBinary(
+    const std::string& fileName,    // [in] Name of the shader file
+    BenchCorpus*       pCorpus,     // [in,out] Benchmark corpus, which takes ownership of the binary
+    BinaryData*        pSpvBin)     // [out] SPIR-V binary
+{
+    std::string content;
+    Result result = ReadFile(fileName, &content);
+    const StringRef ext = sys::path::extension(fileName);
+
+    std::string spirv;
+    if (result != Result::Success)
+    {
+        // Nothing to translate.
+    }
+    else if (ext == ".spv")
+    {
+        spirv = std::move(content);
+    }
+    else if (InitSpvGen() == false)
+    {
+        LLPC_ERRS("Failed to load SPVGEN -- cannot translate " << fileName << "\n");
+        result = Result::ErrorUnavailable;
+    }
+    else if (ext == ".spvas")
+    {
+        int32_t binSize = content.size() * 4 + 1024; // Estimated SPIR-V binary size
+        std::vector<uint32_t> spvBin(binSize / sizeof(uint32_t));
+
+        const char* pLog = nullptr;
+        binSize = spvAssembleSpirv(content.c_str(), binSize, spvBin.data(), &pLog);
+        if (binSize < 0)
+        {
+            LLPC_ERRS("Fails to assemble SPIR-V " << fileName << ":\n" << pLog << "\n");
+            result = Result::ErrorInvalidShader;
+        }
+        else
+        {
+            spirv.assign(reinterpret_cast<const char*>(spvBin.data()), binSize);
+        }
+    }
+    else
+    {
+        bool isHlsl = false;
+        SpvGenStage lang = spvGetStageTypeFromName(fileName.c_str(), &isHlsl);
+        if (lang == SpvGenStageInvalid)
+        {
+            result = Result::ErrorInvalidShader;
+        }
+        else
+        {
+            int32_t sourceStringCount = 1;
+            const char* pGlslText = content.c_str();
+            const char* const* sourceList[1] = { &pGlslText };
+            const char* pFileName = fileName.c_str();
+            const char* const* fileList[1] = { &pFileName };
+            const char* entryPoints[] = { "main" };
+
+            void* pProgram = nullptr;
+            const char* pLog = nullptr;
+            int compileOption = SpvGenOptionDefaultDesktop | SpvGenOptionVulkanRules | SpvGenOptionDebug;
+            compileOption |= isHlsl ? SpvGenOptionReadHlsl : 0;
+            if (spvCompileAndLinkProgramEx(1,
+                                           &lang,
+                                           &sourceStringCount,
+                                           sourceList,
+                                           fileList,
+                                           isHlsl ? entryPoints : nullptr,
+                                           &pProgram,
+                                           &pLog,
+                                           compileOption))
+            {
+                const uint32_t* pSpvBin = nullptr;
+                uint32_t binSize = spvGetSpirvBinaryFromProgram(pProgram, 0, &pSpvBin);
+                spirv.assign(reinterpret_cast<const char*>(pSpvBin), binSize);
+            }
+            else
+            {
+                LLPC_ERRS("Fails to compile GLSL " << fileName << ":\n" << pLog << "\n");
+                result = Result::ErrorInvalidShader;
+            }
+            if (pProgram != nullptr)
+            {
+                spvDestroyProgram(pProgram);
+            }
+        }
+    }
+
+    if (result == Result::Success)
+    {
+        char* pBin = new char[spirv.size()];
+        memcpy(pBin, spirv.data(), spirv.size());
+        pCorpus->spirvBins.push_back(pBin);
+
+        pSpvBin->codeSize = spirv.size();
+        pSpvBin->pCode    = pBin;
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Builds the shader module of one stage of a corpus pipeline and fills in the pipeline shader info of that stage.
+static Result BuildShaderModule(
+    ICompiler*                   pCompiler,         // [in] LLPC compiler object
+    const BinaryData&            spvBin,            // [in] SPIR-V binary of the shader module
+    ShaderStage                  stage,             // Shader stage of the shader module
+    const PipelineOptions&       pipelineOptions,   // [in] Options of the pipeline
+    BenchCorpus*                 pCorpus,           // [in,out] Benchmark corpus, which takes ownership of the module
+    PipelineShaderInfo*          pShaderInfo)       // [out] Pipeline shader info of the stage
+{
+    void* pModuleBuf = nullptr;
+
+    ShaderModuleBuildInfo moduleInfo = {};
+    moduleInfo.pInstance      = nullptr; // Dummy, unused
+    moduleInfo.pUserData      = &pModuleBuf;
+    moduleInfo.pfnOutputAlloc = AllocateBuffer;
+    moduleInfo.shaderBin      = spvBin;
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 32
+    moduleInfo.options.pipelineOptions = pipelineOptions;
+#endif
+
+    ShaderModuleBuildOut moduleOut = {};
+    auto startTime = std::chrono::steady_clock::now();
+    Result result = pCompiler->BuildShaderModule(&moduleInfo, &moduleOut);
+    pCorpus->moduleSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    if (pModuleBuf != nullptr)
+    {
+        pCorpus->moduleBufs.push_back(pModuleBuf);
+    }
+
+    if ((result == Result::Success) || (result == Result::Delayed))
+    {
+        if (pShaderInfo->pEntryTarget == nullptr)
+        {
+            pShaderInfo->pEntryTarget = GetEntryPointNameFromSpirvBinary(&spvBin);
+        }
+        pShaderInfo->pModuleData = moduleOut.pModuleData;
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 21
+        pShaderInfo->entryStage = stage;
+#endif
+        result = Result::Success;
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Loads a pipeline info file (.pipe) into the corpus.
+static Result LoadPipelineFile(
+    ICompiler*         pCompiler,   // [in] LLPC compiler object
+    const std::string& fileName,    // [in] Name of the pipeline info file
+    BenchCorpus*       pCorpus)     // [in,out] Benchmark corpus
+{
+    void* pPipelineDoc = nullptr;
+    const char* pLog = nullptr;
+    if (Vfx::vfxParseFile(fileName.c_str(), 0, nullptr, VfxDocTypePipeline, &pPipelineDoc, &pLog) == false)
+    {
+        LLPC_ERRS("Failed to parse input file: " << fileName << "\n" << pLog << "\n");
+        return Result::ErrorInvalidShader;
+    }
+    pCorpus->pipelineDocs.push_back(pPipelineDoc);
+
+    VfxPipelineStatePtr pPipelineState = nullptr;
+    Vfx::vfxGetPipelineDoc(pPipelineDoc, &pPipelineState);
+    if (pPipelineState->version != Llpc::Version)
+    {
+        LLPC_ERRS("Version incompatible: " << fileName << "\n");
+        return Result::ErrorInvalidShader;
+    }
+
+    BenchPipeline pipeline = {};
+    pipeline.name             = fileName;
+    pipeline.gfxPipelineInfo  = pPipelineState->gfxPipelineInfo;
+    pipeline.compPipelineInfo = pPipelineState->compPipelineInfo;
+
+    uint32_t stageMask = 0;
+    for (uint32_t stage = 0; stage < pPipelineState->numStages; ++stage)
+    {
+        if (pPipelineState->stages[stage].dataSize > 0)
+        {
+            stageMask |= ShaderStageToMask(pPipelineState->stages[stage].stage);
+        }
+    }
+    pipeline.isGraphics = (stageMask & ShaderStageToMask(ShaderStageCompute)) ? false : true;
+
+    PipelineShaderInfo* shaderInfo[ShaderStageNativeStageCount] =
+    {
+        &pipeline.gfxPipelineInfo.vs,
+        &pipeline.gfxPipelineInfo.tcs,
+        &pipeline.gfxPipelineInfo.tes,
+        &pipeline.gfxPipelineInfo.gs,
+        &pipeline.gfxPipelineInfo.fs,
+        &pipeline.compPipelineInfo.cs,
+    };
+    const PipelineOptions& pipelineOptions = pipeline.isGraphics ? pipeline.gfxPipelineInfo.options :
+                                                                   pipeline.compPipelineInfo.options;
+
+    Result result = Result::Success;
+    for (uint32_t stage = 0; (stage < pPipelineState->numStages) && (result == Result::Success); ++stage)
+    {
+        if (pPipelineState->stages[stage].dataSize > 0)
+        {
+            BinaryData spvBin = {};
+            spvBin.codeSize = pPipelineState->stages[stage].dataSize;
+            spvBin.pCode    = pPipelineState->stages[stage].pData;
+
+            const ShaderStage shaderStage = pPipelineState->stages[stage].stage;
+            result = BuildShaderModule(pCompiler,
+                                       spvBin,
+                                       shaderStage,
+                                       pipelineOptions,
+                                       pCorpus,
+                                       shaderInfo[shaderStage]);
+        }
+    }
+
+    if (result == Result::Success)
+    {
+        // NOTE: If number of patch control points is not specified, we set it to 3.
+        if (pipeline.gfxPipelineInfo.iaState.patchControlPoints == 0)
+        {
+            pipeline.gfxPipelineInfo.iaState.patchControlPoints = 3;
+        }
+        pCorpus->pipelines.push_back(pipeline);
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Loads a shader file into the corpus as a pipeline of that single shader, with descriptors laid out automatically.
+static Result LoadShaderFile(
+    ICompiler*         pCompiler,   // [in] LLPC compiler object
+    const std::string& fileName,    // [in] Name of the shader file
+    BenchCorpus*       pCorpus)     // [in,out] Benchmark corpus
+{
+    BinaryData spvBin = {};
+    Result result = GetSpirvBinary(fileName, pCorpus, &spvBin);
+
+    ShaderStage shaderStage = ShaderStageInvalid;
+    if (result == Result::Success)
+    {
+        const uint32_t stageMask = GetStageMaskFromSpirvBinary(&spvBin, GetEntryPointNameFromSpirvBinary(&spvBin));
+        for (uint32_t stage = 0; stage < ShaderStageNativeStageCount; ++stage)
+        {
+            if (stageMask & ShaderStageToMask(static_cast<ShaderStage>(stage)))
+            {
+                shaderStage = static_cast<ShaderStage>(stage);
+                break;
+            }
+        }
+
+        if (shaderStage == ShaderStageInvalid)
+        {
+            LLPC_ERRS("Fails to identify shader stage of " << fileName << "\n");
+            result = Result::ErrorInvalidShader;
+        }
+    }
+
+    if (result == Result::Success)
+    {
+        BenchPipeline pipeline = {};
+        pipeline.name       = fileName;
+        pipeline.isGraphics = (shaderStage != ShaderStageCompute);
+
+        PipelineShaderInfo* shaderInfo[ShaderStageNativeStageCount] =
+        {
+            &pipeline.gfxPipelineInfo.vs,
+            &pipeline.gfxPipelineInfo.tcs,
+            &pipeline.gfxPipelineInfo.tes,
+            &pipeline.gfxPipelineInfo.gs,
+            &pipeline.gfxPipelineInfo.fs,
+            &pipeline.compPipelineInfo.cs,
+        };
+        PipelineShaderInfo* pShaderInfo = shaderInfo[shaderStage];
+
+        uint32_t userDataOffset = 0;
+        DoAutoLayoutDesc(shaderStage,
+                         spvBin,
+                         pipeline.isGraphics ? &pipeline.gfxPipelineInfo : nullptr,
+                         pShaderInfo,
+                         userDataOffset);
+
+        const PipelineOptions& pipelineOptions = pipeline.isGraphics ? pipeline.gfxPipelineInfo.options :
+                                                                       pipeline.compPipelineInfo.options;
+        result = BuildShaderModule(pCompiler, spvBin, shaderStage, pipelineOptions, pCorpus, pShaderInfo);
+
+        if (result == Result::Success)
+        {
+            pipeline.gfxPipelineInfo.iaState.patchControlPoints = 3;
+            pCorpus->pipelines.push_back(pipeline);
+        }
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Loads the corpus from the input files and directories. Files that fail to load are recorded and skipped.
+static void LoadCorpus(
+    ICompiler*   pCompiler, // [in] LLPC compiler object
+    BenchCorpus* pCorpus)   // [out] Benchmark corpus
+{
+    static const char* ShaderExts[] =
+    {
+        ".spv", ".spvas", ".vert", ".tesc", ".tese", ".geom", ".frag", ".comp",
+    };
+
+    std::vector<std::string> fileNames;
+    for (const std::string& inFile : InFiles)
+    {
+        if (sys::fs::is_directory(inFile))
+        {
+            std::error_code errCode;
+            for (sys::fs::recursive_directory_iterator it(inFile, errCode), itEnd;
+                 (it != itEnd) && (!errCode);
+                 it.increment(errCode))
+            {
+                if (sys::fs::is_regular_file(it->path()))
+                {
+                    fileNames.push_back(it->path());
+                }
+            }
+        }
+        else
+        {
+            fileNames.push_back(inFile);
+        }
+    }
+
+    // Sort the files so that results are comparable between runs.
+    std::sort(fileNames.begin(), fileNames.end());
+
+    for (const std::string& fileName : fileNames)
+    {
+        const StringRef ext = sys::path::extension(fileName);
+
+        Result result = Result::ErrorInvalidValue;
+        if (ext == ".pipe")
+        {
+            result = LoadPipelineFile(pCompiler, fileName, pCorpus);
+        }
+        else if (std::find(std::begin(ShaderExts), std::end(ShaderExts), ext) != std::end(ShaderExts))
+        {
+            result = LoadShaderFile(pCompiler, fileName, pCorpus);
+        }
+        else
+        {
+            // Not a source file, e.g. a lit configuration file.
+            continue;
+        }
+
+        if (result != Result::Success)
+        {
+            pCorpus->loadFailures.push_back(fileName);
+        }
+    }
+}
+
+// =====================================================================================================================
+// Builds one corpus pipeline and returns the build latency in seconds.
+static Result BuildPipeline(
+    ICompiler*     pCompiler,       // [in] LLPC compiler object
+    BenchPipeline* pPipeline,       // [in] Corpus pipeline to build
+    IShaderCache*  pShaderCache,    // [in] Pipeline shader cache, or null to build with cold caches
+    double*        pLatency)        // [out] Build latency in seconds
+{
+    void* pPipelineBuf = nullptr;
+    Result result = Result::Success;
+
+    auto startTime = std::chrono::steady_clock::now();
+    if (pPipeline->isGraphics)
+    {
+        GraphicsPipelineBuildInfo pipelineInfo = pPipeline->gfxPipelineInfo;
+        pipelineInfo.pInstance      = nullptr; // Dummy, unused
+        pipelineInfo.pUserData      = &pPipelineBuf;
+        pipelineInfo.pfnOutputAlloc = AllocateBuffer;
+        pipelineInfo.pShaderCache   = pShaderCache;
+
+        GraphicsPipelineBuildOut pipelineOut = {};
+        result = pCompiler->BuildGraphicsPipeline(&pipelineInfo, &pipelineOut);
+    }
+    else
+    {
+        ComputePipelineBuildInfo pipelineInfo = pPipeline->compPipelineInfo;
+        pipelineInfo.pInstance      = nullptr; // Dummy, unused
+        pipelineInfo.pUserData      = &pPipelineBuf;
+        pipelineInfo.pfnOutputAlloc = AllocateBuffer;
+        pipelineInfo.pShaderCache   = pShaderCache;
+
+        ComputePipelineBuildOut pipelineOut = {};
+        result = pCompiler->BuildComputePipeline(&pipelineInfo, &pipelineOut);
+    }
+    *pLatency = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    free(pPipelineBuf);
+    return result;
+}
+
+// =====================================================================================================================
+// Runs passes over the corpus and returns their statistics. Pipelines that fail to build are marked as failed and
+// skipped by all later passes.
+static PassStats RunPasses(
+    ICompiler*    pCompiler,        // [in] LLPC compiler object
+    BenchCorpus*  pCorpus,          // [in,out] Benchmark corpus
+    uint32_t      passCount,        // Count of passes
+    IShaderCache* pShaderCache,     // [in] Pipeline shader cache, or null to build with cold caches
+    bool          warm)             // Whether the latencies are recorded as warm cache latencies
+{
+    PassStats stats = {};
+    std::vector<double> latencies;
+
+    for (uint32_t pass = 0; pass < passCount; ++pass)
+    {
+        for (BenchPipeline& pipeline : pCorpus->pipelines)
+        {
+            if (pipeline.failed)
+            {
+                continue;
+            }
+
+            double latency = 0.0;
+            if (BuildPipeline(pCompiler, &pipeline, pShaderCache, &latency) != Result::Success)
+            {
+                LLPC_ERRS("Fails to build pipeline: " << pipeline.name << "\n");
+                pipeline.failed = true;
+                continue;
+            }
+
+            (warm ? pipeline.warmLatencies : pipeline.coldLatencies).push_back(latency);
+            latencies.push_back(latency);
+            stats.seconds += latency;
+            ++stats.pipelineCount;
+        }
+    }
+
+    stats.latencyP50 = GetPercentile(&latencies, 50.0);
+    stats.latencyP99 = GetPercentile(&latencies, 99.0);
+    return stats;
+}
+
+// =====================================================================================================================
+// Converts the statistics of timed passes to JSON.
+static json::Object PassStatsToJson(
+    const PassStats& stats)     // [in] Statistics of timed passes
+{
+    return json::Object
+    {
+        { "seconds",            stats.seconds },
+        { "pipelines",          static_cast<int64_t>(stats.pipelineCount) },
+        { "pipelinesPerSecond", (stats.seconds > 0.0) ? (stats.pipelineCount / stats.seconds) : 0.0 },
+        { "latencyP50Ms",       stats.latencyP50 * 1000.0 },
+        { "latencyP99Ms",       stats.latencyP99 * 1000.0 },
+    };
+}
+
+// =====================================================================================================================
+// Main function of LLPC pipeline compile throughput benchmark, entry-point. It loads a corpus of pipeline info files
+// and shader files once, then builds all of its pipelines repeatedly, with cold caches and with a warm pipeline shader
+// cache, and writes the results in JSON.
+//
+// Returns 0 if successful. Other numeric values indicate failure.
+int32_t main(
+    int32_t argc,       // Count of arguments
+    char*   argv[])     // [in] List of arguments
+{
+    EnablePrettyStackTrace();
+    sys::PrintStackTraceOnErrorSignal(argv[0]);
+    PrettyStackTraceProgram X(argc, argv);
+
+    // NOTE: For comparable results, these options are kept the same as those amdllpc and the Vulkan ICD use unless
+    // they are specified in the command line.
+    static const char* defaultOptions[] =
+    {
+        "-unroll-max-percent-threshold-boost=1000",
+        "-unroll-threshold=700",
+        "-unroll-partial-threshold=700",
+        "-pragma-unroll-threshold=1000",
+        "-unroll-allow-partial",
+        "-simplifycfg-sink-common=false",
+        "-amdgpu-vgpr-index-mode",
+        "-amdgpu-atomic-optimizations",
+        "-use-gpu-divergence-analysis",
+        "-filetype=obj",
+        // NOTE: Builds with cold caches must translate and lower every shader stage, so the process-wide lowered stage
+        // cache is disabled unless it is specified in the command line.
+        "-lowered-stage-cache-size=0",
+    };
+
+    // Build new arguments, starting with those supplied in command line
+    std::vector<const char*> newArgs(argv, argv + argc);
+    GfxIpVersion gfxIp = { 8, 0, 0 };
+    for (int32_t i = 1; i < argc; ++i)
+    {
+        if (strncmp(argv[i], "-gfxip=", strlen("-gfxip=")) == 0)
+        {
+            sscanf(argv[i] + strlen("-gfxip="), "%u.%u.%u", &gfxIp.major, &gfxIp.minor, &gfxIp.stepping);
+        }
+    }
+
+    for (const char* pOption : defaultOptions)
+    {
+        const StringRef name = StringRef(pOption).split('=').first;
+        bool found = false;
+        for (int32_t i = 1; (i < argc) && (found == false); ++i)
+        {
+            const StringRef arg = argv[i];
+            found = arg.startswith(name) && ((arg.size() == name.size()) || (arg[name.size()] == '='));
+        }
+
+        if (found == false)
+        {
+            newArgs.push_back(pOption);
+        }
+    }
+
+    ICompiler* pCompiler = nullptr;
+    Result result = ICompiler::Create(gfxIp, newArgs.size(), &newArgs[0], &pCompiler);
+
+    if ((result == Result::Success) && (SpvGenDir != ""))
+    {
+        // -spvgen-dir option: preload spvgen from the given directory
+        if (InitSpvGen(SpvGenDir.c_str()) == false)
+        {
+            LLPC_ERRS("Failed to load SPVGEN from specified directory\n");
+            result = Result::ErrorUnavailable;
+        }
+    }
+
+    BenchCorpus corpus = {};
+    if (result == Result::Success)
+    {
+        LoadCorpus(pCompiler, &corpus);
+        if (corpus.pipelines.empty())
+        {
+            LLPC_ERRS("No pipelines loaded\n");
+            result = Result::ErrorInvalidValue;
+        }
+    }
+
+    if (result == Result::Success)
+    {
+        // Build every pipeline once before timing, which also drops the pipelines that fail to build.
+        RunPasses(pCompiler, &corpus, 1, nullptr, false);
+        for (BenchPipeline& pipeline : corpus.pipelines)
+        {
+            pipeline.coldLatencies.clear();
+        }
+
+        // Cold caches: no pipeline shader cache, and the internal cache and the lowered stage cache are disabled by
+        // default (-shader-cache-mode=0 -lowered-stage-cache-size=0)
+        PassStats coldStats = RunPasses(pCompiler, &corpus, Iterations, nullptr, false);
+
+        // Warm cache: a pipeline shader cache filled by an untimed pass
+        IShaderCache* pShaderCache = nullptr;
+        ShaderCacheCreateInfo createInfo = {};
+        PassStats warmStats = {};
+        if (pCompiler->CreateShaderCache(&createInfo, &pShaderCache) == Result::Success)
+        {
+            RunPasses(pCompiler, &corpus, 1, pShaderCache, true);
+            for (BenchPipeline& pipeline : corpus.pipelines)
+            {
+                pipeline.warmLatencies.clear();
+            }
+            warmStats = RunPasses(pCompiler, &corpus, Iterations, pShaderCache, true);
+            pShaderCache->Destroy();
+        }
+
+        // Phase times: an additional cold pass with the LLPC phase timers enabled, whose reports are collected
+        // instead of printed
+        json::Object phases;
+        if (ProfilePhases)
+        {
+            TimePassesIsEnabled = true;
+            TimerProfiler::EnablePhaseTimeCollection(true);
+            RunPasses(pCompiler, &corpus, 1, nullptr, false);
+            TimerProfiler::EnablePhaseTimeCollection(false);
+            TimePassesIsEnabled = false;
+
+            static const char* PhaseNames[TimerCount] =
+            {
+                "translate",    // TimerTranslate
+                "lower",        // TimerLower
+                "loadBc",       // TimerLoadBc
+                "patch",        // TimerPatch
+                "opt",          // TimerOpt
+                "codeGen",      // TimerCodeGen
+            };
+
+            const PhaseTimes phaseTimes = TimerProfiler::TakeCollectedPhaseTimes();
+            const double msPerPipeline = (phaseTimes.count > 0) ? (1000.0 / phaseTimes.count) : 0.0;
+            for (uint32_t i = 0; i < TimerCount; ++i)
+            {
+                phases[PhaseNames[i]] = phaseTimes.phases[i] * msPerPipeline;
+            }
+            phases["total"] = phaseTimes.total * msPerPipeline;
+        }
+
+        json::Array pipelines;
+        json::Array failures;
+        for (BenchPipeline& pipeline : corpus.pipelines)
+        {
+            if (pipeline.failed)
+            {
+                failures.push_back(pipeline.name);
+                continue;
+            }
+
+            pipelines.push_back(json::Object
+            {
+                { "name",       pipeline.name },
+                { "coldP50Ms",  GetPercentile(&pipeline.coldLatencies, 50.0) * 1000.0 },
+                { "warmP50Ms",  GetPercentile(&pipeline.warmLatencies, 50.0) * 1000.0 },
+            });
+        }
+
+        for (const std::string& loadFailure : corpus.loadFailures)
+        {
+            failures.push_back(loadFailure);
+        }
+
+        json::Object results
+        {
+            { "gfxip",              formatv("{0}.{1}.{2}", gfxIp.major, gfxIp.minor, gfxIp.stepping).str() },
+            { "iterations",         static_cast<int64_t>(Iterations) },
+            { "pipelineCount",      static_cast<int64_t>(pipelines.size()) },
+            { "shaderModuleSeconds", corpus.moduleSeconds },
+            { "cold",               PassStatsToJson(coldStats) },
+            { "warm",               PassStatsToJson(warmStats) },
+            { "phaseMsPerPipeline", std::move(phases) },
+            { "peakRssKb",          static_cast<int64_t>(GetPeakRssKb()) },
+            { "failures",           std::move(failures) },
+            { "pipelines",          std::move(pipelines) },
+        };
+
+        std::error_code errCode;
+        raw_fd_ostream outStream(OutFile, errCode, sys::fs::F_Text);
+        if (errCode)
+        {
+            LLPC_ERRS("Fails to open output file: " << OutFile << "\n");
+            result = Result::ErrorUnavailable;
+        }
+        else
+        {
+            outStream << formatv("{0:2}", json::Value(std::move(results))) << "\n";
+        }
+    }
+
+    for (void* pModuleBuf : corpus.moduleBufs)
+    {
+        free(pModuleBuf);
+    }
+    for (char* pSpvBin : corpus.spirvBins)
+    {
+        delete[] pSpvBin;
+    }
+    for (void* pPipelineDoc : corpus.pipelineDocs)
+    {
+        Vfx::vfxCloseDoc(pPipelineDoc);
+    }
+
+    if (pCompiler != nullptr)
+    {
+        pCompiler->Destroy();
+    }
+
+    return (result == Result::Success) ? 0 : 1;
+}
@@ -0,0 +1,236 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2019 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcDirectoryCacheBackend.cpp
+ * @brief LLPC source file: contains implementation of class DirectoryCacheBackend.
+ ***********************************************************************************************************************
+ */
+#ifdef WIN_OS
+    // NOTE: Disable Windows-defined min()/max() because we use STL-defined std::min()/std::max() in LLPC.
+    #define NOMINMAX
+#endif
+
+#include "llpcDirectoryCacheBackend.h"
+
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <stdio.h>
+
+#define DEBUG_TYPE "llpc-directory-cache-backend"
+
+using namespace llvm;
+using namespace Llpc;
+
+// =====================================================================================================================
+DirectoryCacheBackend::DirectoryCacheBackend(
+    const std::string& directory,     // [in] Directory holding the stored values, created if it does not exist
+    uint32_t           workerCount)   // Count of worker threads serving the requests
+    :
+    m_directory(directory),
+    m_shutdown(false),
+    m_lookupCount(0),
+    m_hitCount(0),
+    m_prefetchCount(0),
+    m_storeCount(0)
+{
+    sys::fs::create_directories(m_directory);
+
+    for (uint32_t i = 0; i < std::max(1u, workerCount); ++i)
+    {
+        m_workers.push_back(std::thread([this] { RunWorker(); }));
+    }
+}
+
+// =====================================================================================================================
+// Completes all queued requests before returning.
+DirectoryCacheBackend::~DirectoryCacheBackend()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_shutdown = true;
+    }
+    m_queueCond.notify_all();
+
+    for (auto& worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+// =====================================================================================================================
+// Gets the name of the file storing the value with the specified key.
+std::string DirectoryCacheBackend::GetFileName(
+    uint64_t key    // Key of the value
+    ) const
+{
+    std::string fileName;
+    raw_string_ostream(fileName) << m_directory << "/" << format("%016" PRIX64, key) << ".bin";
+    return fileName;
+}
+
+// =====================================================================================================================
+// Queues a lookup of the value with the specified key.
+void DirectoryCacheBackend::GetAsync(
+    uint64_t                      key,          // Key of the value to look up
+    ShaderCacheBackendGetCallback pfnCallback,  // [in] Callback invoked when the lookup completes
+    void*                         pContext)     // [in] Context passed to the callback
+{
+    Enqueue([=] { Get(key, pfnCallback, pContext); });
+}
+
+// =====================================================================================================================
+// Queues lookups of the values with the specified keys, so they are served by all worker threads in parallel.
+void DirectoryCacheBackend::GetBatchAsync(
+    const uint64_t*               pKeys,        // [in] Keys of the values to look up
+    uint32_t                      keyCount,     // Count of keys
+    ShaderCacheBackendGetCallback pfnCallback,  // [in] Callback invoked when the lookup of each key completes
+    void*                         pContext)     // [in] Context passed to the callback
+{
+    m_prefetchCount += keyCount;
+    for (uint32_t i = 0; i < keyCount; ++i)
+    {
+        GetAsync(pKeys[i], pfnCallback, pContext);
+    }
+}
+
+// =====================================================================================================================
+// Queues a store of the specified value. The value is copied before returning.
+Result DirectoryCacheBackend::PutAsync(
+    uint64_t    key,        // Key of the value
+    const void* pValue,     // [in] Value to store
+    size_t      valueSize)  // Size of the value in bytes
+{
+    ++m_storeCount;
+    auto pBytes = static_cast<const uint8_t*>(pValue);
+    std::vector<uint8_t> value(pBytes, pBytes + valueSize);
+    Enqueue([this, key, value] { Put(key, value); });
+    return Result::Success;
+}
+
+// =====================================================================================================================
+// Reports the counts of requests served so far.
+void DirectoryCacheBackend::ReportStatistics() const
+{
+    outs() << "Shader cache backend: " << m_directory << "\n"
+           << "  Lookups          : " << m_lookupCount.load() << " (" << m_hitCount.load() << " hits, "
+           << m_prefetchCount.load() << " prefetched)\n"
+           << "  Stores           : " << m_storeCount.load() << "\n";
+}
+
+// =====================================================================================================================
+// Reads the value with the specified key from its file and invokes the callback.
+void DirectoryCacheBackend::Get(
+    uint64_t                      key,          // Key of the value to look up
+    ShaderCacheBackendGetCallback pfnCallback,  // [in] Callback invoked when the lookup completes
+    void*                         pContext)     // [in] Context passed to the callback
+{
+    Result result = Result::ErrorUnknown;
+    std::vector<uint8_t> value;
+
+    FILE* pFile = fopen(GetFileName(key).c_str(), "rb");
+    if (pFile != nullptr)
+    {
+        fseek(pFile, 0, SEEK_END);
+        size_t fileSize = ftell(pFile);
+        fseek(pFile, 0, SEEK_SET);
+
+        value.resize(fileSize);
+        if (fread(value.data(), 1, fileSize, pFile) == fileSize)
+        {
+            result = Result::Success;
+        }
+        fclose(pFile);
+    }
+
+    ++m_lookupCount;
+    if (result == Result::Success)
+    {
+        ++m_hitCount;
+    }
+
+    pfnCallback(pContext, result, key, value.data(), value.size());
+}
+
+// =====================================================================================================================
+// Writes the value with the specified key to its file. The value is written to a temporary file first, which is then
+// renamed, so that concurrent readers never see a partially written value.
+void DirectoryCacheBackend::Put(
+    uint64_t                    key,     // Key of the value
+    const std::vector<uint8_t>& value)   // Value to store
+{
+    const std::string fileName = GetFileName(key);
+    std::string tempFileName;
+    raw_string_ostream(tempFileName) << fileName << "." << std::hash<std::thread::id>()(std::this_thread::get_id())
+                                     << ".tmp";
+
+    FILE* pFile = fopen(tempFileName.c_str(), "wb");
+    if (pFile != nullptr)
+    {
+        bool written = (fwrite(value.data(), 1, value.size(), pFile) == value.size());
+        written = (fclose(pFile) == 0) && written;
+
+        if ((written == false) || sys::fs::rename(tempFileName, fileName))
+        {
+            sys::fs::remove(tempFileName);
+        }
+    }
+}
+
+// =====================================================================================================================
+// Adds a request to the queue and wakes a worker thread.
+void DirectoryCacheBackend::Enqueue(
+    std::function<void()> request)   // Request to serve
+{
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_queue.push_back(std::move(request));
+    }
+    m_queueCond.notify_one();
+}
+
+// =====================================================================================================================
+// Serves queued requests until shutdown.
+void DirectoryCacheBackend::RunWorker()
+{
+    for (;;)
+    {
+        std::function<void()> request;
+        {
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            m_queueCond.wait(lock, [this] { return m_shutdown || (m_queue.empty() == false); });
+            if (m_queue.empty())
+            {
+                break;
+            }
+            request = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+        request();
+    }
+}
@@ -0,0 +1,89 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2019 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcDirectoryCacheBackend.h
+ * @brief LLPC header file: contains declaration of class DirectoryCacheBackend.
+ ***********************************************************************************************************************
+ */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "llpc.h"
+
+// =====================================================================================================================
+// Reference implementation of IShaderCacheBackend which stores each value in its own file of a local directory. It
+// stands in for a remote store: requests are queued and served by worker threads, and completion callbacks are invoked
+// on those threads.
+class DirectoryCacheBackend : public Llpc::IShaderCacheBackend
+{
+public:
+    DirectoryCacheBackend(const std::string& directory, uint32_t workerCount);
+    virtual ~DirectoryCacheBackend();
+
+    virtual void GetAsync(uint64_t key, Llpc::ShaderCacheBackendGetCallback pfnCallback, void* pContext);
+
+    virtual void GetBatchAsync(const uint64_t*                     pKeys,
+                               uint32_t                            keyCount,
+                               Llpc::ShaderCacheBackendGetCallback pfnCallback,
+                               void*                               pContext);
+
+    virtual Llpc::Result PutAsync(uint64_t key, const void* pValue, size_t valueSize);
+
+    void ReportStatistics() const;
+
+private:
+    DirectoryCacheBackend(const DirectoryCacheBackend&) = delete;
+    DirectoryCacheBackend& operator=(const DirectoryCacheBackend&) = delete;
+
+    std::string GetFileName(uint64_t key) const;
+    void Get(uint64_t key, Llpc::ShaderCacheBackendGetCallback pfnCallback, void* pContext);
+    void Put(uint64_t key, const std::vector<uint8_t>& value);
+
+    void Enqueue(std::function<void()> request);
+    void RunWorker();
+
+    // -----------------------------------------------------------------------------------------------------------------
+
+    std::string                         m_directory;    // Directory holding the stored values
+    std::mutex                          m_queueMutex;   // Mutex protecting the request queue
+    std::condition_variable             m_queueCond;    // Signaled when a request is queued or on shutdown
+    std::deque<std::function<void()>>   m_queue;        // Queued requests
+    bool                                m_shutdown;     // Whether worker threads should exit once the queue is empty
+    std::vector<std::thread>            m_workers;      // Worker threads serving the requests
+
+    std::atomic<uint32_t>               m_lookupCount;      // Count of served lookups
+    std::atomic<uint32_t>               m_hitCount;         // Count of lookups which found the value
+    std::atomic<uint32_t>               m_prefetchCount;    // Count of lookups requested in batches
+    std::atomic<uint32_t>               m_storeCount;       // Count of requested stores
+};
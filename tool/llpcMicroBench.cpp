@@ -0,0 +1,699 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2019 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcMicroBench.cpp
+ * @brief LLPC source file: micro-benchmarks of cache, hashing, ELF and serialization primitives (llpc-microbench)
+ ***********************************************************************************************************************
+ */
+#ifdef WIN_OS
+    // NOTE: Disable Windows-defined min()/max() because we use STL-defined std::min()/std::max() in LLPC.
+    #define NOMINMAX
+#endif
+
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/PrettyStackTrace.h"
+#include "llvm/Support/Regex.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "llpc.h"
+#include "llpcCompiler.h"
+#include "llpcDebug.h"
+#include "llpcElfReader.h"
+#include "llpcElfWriter.h"
+#include "llpcPipelineContext.h"
+#include "llpcPipelineDumper.h"
+#include "llpcShaderCache.h"
+
+#define DEBUG_TYPE "llpc-microbench"
+
+using namespace llvm;
+using namespace Llpc;
+
+// -filter: run only the benchmarks whose names match the regular expression
+static cl::opt<std::string> Filter("filter",
+                                   cl::desc("Run only the benchmarks whose names match the regular expression"),
+                                   cl::value_desc("regex"),
+                                   cl::init(".*"));
+
+// -min-time: minimum time of each benchmark run
+static cl::opt<double> MinTime("min-time",
+                               cl::desc("Minimum time of each benchmark run in seconds"),
+                               cl::init(0.5));
+
+// -elf: pipeline ELF used by the ELF benchmarks
+static cl::opt<std::string> ElfFile("elf",
+                                    cl::desc("Pipeline ELF used by the ELF benchmarks, e.g. the output of amdllpc "
+                                             "(the ELF benchmarks are skipped if it is not specified)"),
+                                    cl::value_desc("filename"));
+
+// -gfxip: graphics IP version of the pipeline ELF
+static cl::opt<std::string> GfxIp("gfxip",
+                                  cl::desc("Graphics IP version of the pipeline ELF"),
+                                  cl::value_desc("major.minor.step"),
+                                  cl::init("9.0.0"));
+
+// -o: output
+static cl::opt<std::string> OutFile("o",
+                                    cl::desc("Output file of the benchmark results in JSON"),
+                                    cl::value_desc("filename (\"-\" for stdout)"));
+
+// =====================================================================================================================
+// Represents the state of one thread of a benchmark run. The benchmark function loops while KeepRunning() returns true.
+class BenchmarkState
+{
+public:
+    BenchmarkState(uint64_t iterations, uint32_t threadIndex)
+        :
+        m_remaining(iterations),
+        m_threadIndex(threadIndex),
+        m_bytesPerIteration(0)
+    {
+    }
+
+    // Returns whether the benchmark function should run another iteration
+    bool KeepRunning() { return (m_remaining-- > 0); }
+
+    // Gets the index of the thread running the benchmark function
+    uint32_t GetThreadIndex() const { return m_threadIndex; }
+
+    // Sets the count of bytes processed by each iteration, to report throughput
+    void SetBytesPerIteration(uint64_t bytes) { m_bytesPerIteration = bytes; }
+
+    // Gets the count of bytes processed by each iteration
+    uint64_t GetBytesPerIteration() const { return m_bytesPerIteration; }
+
+private:
+    uint64_t m_remaining;           // Count of iterations left to run
+    uint32_t m_threadIndex;         // Index of the thread running the benchmark function
+    uint64_t m_bytesPerIteration;   // Count of bytes processed by each iteration
+};
+
+// Represents a registered benchmark.
+struct Benchmark
+{
+    std::string                          name;          // Name of the benchmark
+    uint32_t                             threadCount;   // Count of threads running the benchmark function
+    std::function<void()>                setUp;         // Called before each run, on the main thread (optional)
+    std::function<void(BenchmarkState&)> func;          // Benchmark function, run on each thread
+    std::function<void()>                tearDown;      // Called after each run, on the main thread (optional)
+};
+
+// Represents the result of a benchmark.
+struct BenchmarkResult
+{
+    std::string name;               // Name of the benchmark
+    uint32_t    threadCount;        // Count of threads running the benchmark function
+    uint64_t    iterations;         // Count of iterations run by each thread
+    double      nsPerIteration;     // Wall time of one iteration of one thread, in nanoseconds
+    double      bytesPerSecond;     // Throughput of all threads, or 0 if no byte count is set
+};
+
+static std::vector<Benchmark> Benchmarks;   // All registered benchmarks
+
+// Thread counts of the benchmarks run under contention
+static const uint32_t ThreadCounts[] = { 1, 2, 4, 8 };
+
+// =====================================================================================================================
+// Registers a benchmark run on one thread.
+static void AddBenchmark(
+    const std::string&                   name,          // [in] Name of the benchmark
+    std::function<void(BenchmarkState&)> func)          // Benchmark function
+{
+    Benchmarks.push_back({ name, 1, nullptr, func, nullptr });
+}
+
+// =====================================================================================================================
+// Runs a benchmark for the specified count of iterations per thread, and returns the wall time in seconds.
+static double RunBenchmark(
+    const Benchmark& benchmark,             // [in] Benchmark to run
+    uint64_t         iterations,            // Count of iterations per thread
+    uint64_t*        pBytesPerIteration)    // [out] Count of bytes processed by each iteration
+{
+    if (benchmark.setUp)
+    {
+        benchmark.setUp();
+    }
+
+    std::vector<BenchmarkState> states;
+    for (uint32_t i = 0; i < benchmark.threadCount; ++i)
+    {
+        states.push_back(BenchmarkState(iterations, i));
+    }
+
+    // Release all threads at once, so that they contend for the whole run.
+    std::mutex startMutex;
+    std::condition_variable startCond;
+    bool started = false;
+    std::atomic<uint32_t> readyCount(0);
+
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < benchmark.threadCount; ++i)
+    {
+        threads.push_back(std::thread([&, i]
+        {
+            {
+                std::unique_lock<std::mutex> lock(startMutex);
+                ++readyCount;
+                startCond.notify_all();
+                startCond.wait(lock, [&] { return started; });
+            }
+            benchmark.func(states[i]);
+        }));
+    }
+
+    std::chrono::steady_clock::time_point startTime;
+    {
+        std::unique_lock<std::mutex> lock(startMutex);
+        startCond.wait(lock, [&] { return readyCount == benchmark.threadCount; });
+        started = true;
+        startTime = std::chrono::steady_clock::now();
+    }
+    startCond.notify_all();
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    if (benchmark.tearDown)
+    {
+        benchmark.tearDown();
+    }
+
+    *pBytesPerIteration = states[0].GetBytesPerIteration();
+    return seconds;
+}
+
+// =====================================================================================================================
+// Runs a benchmark with increasing iteration counts until a run takes at least -min-time, and returns its result.
+static BenchmarkResult MeasureBenchmark(
+    const Benchmark& benchmark)     // [in] Benchmark to measure
+{
+    uint64_t iterations = 1;
+    uint64_t bytesPerIteration = 0;
+    double seconds = RunBenchmark(benchmark, iterations, &bytesPerIteration);
+
+    while ((seconds < MinTime) && (iterations < 1000000000))
+    {
+        // Aim slightly beyond the minimum time, growing by at most 10x per step.
+        double scale = (seconds > 0.0) ? (MinTime * 1.4 / seconds) : 10.0;
+        iterations = static_cast<uint64_t>(iterations * std::min(std::max(scale, 2.0), 10.0));
+        seconds = RunBenchmark(benchmark, iterations, &bytesPerIteration);
+    }
+
+    BenchmarkResult result = {};
+    result.name           = benchmark.name;
+    result.threadCount    = benchmark.threadCount;
+    result.iterations     = iterations;
+    result.nsPerIteration = seconds * 1e9 / iterations;
+    result.bytesPerSecond = bytesPerIteration * iterations * benchmark.threadCount / seconds;
+    return result;
+}
+
+// =====================================================================================================================
+// Registers the MetroHash benchmarks: raw hashing of buffers, and the hashing of build info done on every pipeline
+// build to look up the shader caches.
+static void AddHashBenchmarks()
+{
+    for (uint32_t size : { 64, 4096, 65536 })
+    {
+        AddBenchmark(formatv("MetroHash64/{0}", size), [size](BenchmarkState& state)
+        {
+            std::vector<uint8_t> data(size, 0x5A);
+            MetroHash::Hash hash = {};
+            while (state.KeepRunning())
+            {
+                MetroHash::MetroHash64 hasher;
+                hasher.Update(data.data(), data.size());
+                hasher.Finalize(hash.bytes);
+            }
+            state.SetBytesPerIteration(size);
+        });
+    }
+
+    // Build info with realistic sizes: five stages, each with specialization constants and a descriptor set of
+    // 32 descriptors in four tables, and a vertex input state with 4 bindings and 16 attributes.
+    struct SyntheticPipeline
+    {
+        ShaderModuleData                        moduleData[ShaderStageGfxCount];
+        VkSpecializationMapEntry                specMapEntries[16];
+        uint32_t                                specData[16];
+        VkSpecializationInfo                    specInfo;
+        ResourceMappingNode                     tableNodes[4][8];
+        ResourceMappingNode                     userDataNodes[6];
+        VkVertexInputBindingDescription         bindings[4];
+        VkVertexInputAttributeDescription       attribs[16];
+        VkPipelineVertexInputStateCreateInfo    vertexInput;
+        GraphicsPipelineBuildInfo               pipelineInfo;
+    };
+
+    auto pSynthetic = std::make_shared<SyntheticPipeline>();
+    memset(pSynthetic.get(), 0, sizeof(SyntheticPipeline));
+    SyntheticPipeline& synthetic = *pSynthetic;
+
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        synthetic.specMapEntries[i] = { i, i * sizeof(uint32_t), sizeof(uint32_t) };
+        synthetic.specData[i] = i;
+    }
+    synthetic.specInfo = { 16, synthetic.specMapEntries, sizeof(synthetic.specData), synthetic.specData };
+
+    for (uint32_t table = 0; table < 4; ++table)
+    {
+        for (uint32_t i = 0; i < 8; ++i)
+        {
+            ResourceMappingNode& node = synthetic.tableNodes[table][i];
+            node.type             = ResourceMappingNodeType::DescriptorResource;
+            node.sizeInDwords     = 8;
+            node.offsetInDwords   = i * 8;
+            node.srdRange.set     = table;
+            node.srdRange.binding = i;
+        }
+
+        ResourceMappingNode& tableNode = synthetic.userDataNodes[table];
+        tableNode.type              = ResourceMappingNodeType::DescriptorTableVaPtr;
+        tableNode.sizeInDwords      = 1;
+        tableNode.offsetInDwords    = table;
+        tableNode.tablePtr.nodeCount = 8;
+        tableNode.tablePtr.pNext    = synthetic.tableNodes[table];
+    }
+    synthetic.userDataNodes[4].type           = ResourceMappingNodeType::PushConst;
+    synthetic.userDataNodes[4].sizeInDwords   = 16;
+    synthetic.userDataNodes[4].offsetInDwords = 4;
+    synthetic.userDataNodes[5].type           = ResourceMappingNodeType::IndirectUserDataVaPtr;
+    synthetic.userDataNodes[5].sizeInDwords   = 1;
+    synthetic.userDataNodes[5].offsetInDwords = 20;
+    synthetic.userDataNodes[5].userDataPtr.sizeInDwords = 4;
+
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        synthetic.bindings[i] = { i, 16, VK_VERTEX_INPUT_RATE_VERTEX };
+    }
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        synthetic.attribs[i] = { i, i % 4, VK_FORMAT_R32G32B32A32_SFLOAT, (i / 4) * 16 };
+    }
+    synthetic.vertexInput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    synthetic.vertexInput.vertexBindingDescriptionCount   = 4;
+    synthetic.vertexInput.pVertexBindingDescriptions      = synthetic.bindings;
+    synthetic.vertexInput.vertexAttributeDescriptionCount = 16;
+    synthetic.vertexInput.pVertexAttributeDescriptions    = synthetic.attribs;
+
+    GraphicsPipelineBuildInfo& pipelineInfo = synthetic.pipelineInfo;
+    PipelineShaderInfo* shaderInfo[ShaderStageGfxCount] =
+    {
+        &pipelineInfo.vs,
+        &pipelineInfo.tcs,
+        &pipelineInfo.tes,
+        &pipelineInfo.gs,
+        &pipelineInfo.fs,
+    };
+    for (uint32_t stage = 0; stage < ShaderStageGfxCount; ++stage)
+    {
+        synthetic.moduleData[stage].hash[0] = stage + 1;
+        synthetic.moduleData[stage].moduleInfo.cacheHash[0] = stage + 1;
+
+        shaderInfo[stage]->pModuleData         = &synthetic.moduleData[stage];
+        shaderInfo[stage]->pSpecializationInfo = &synthetic.specInfo;
+        shaderInfo[stage]->pEntryTarget        = "main";
+        shaderInfo[stage]->userDataNodeCount   = 6;
+        shaderInfo[stage]->pUserDataNodes      = synthetic.userDataNodes;
+    }
+    pipelineInfo.pVertexInput = &synthetic.vertexInput;
+    pipelineInfo.iaState.topology = VK_PRIMITIVE_TOPOLOGY_PATCH_LIST;
+    pipelineInfo.iaState.patchControlPoints = 3;
+    pipelineInfo.cbState.target[0].format = VK_FORMAT_R8G8B8A8_UNORM;
+    pipelineInfo.cbState.target[0].channelWriteMask = 0xF;
+
+    for (bool isCacheHash : { true, false })
+    {
+        AddBenchmark(isCacheHash ? "GenerateHashForGraphicsPipeline/cache" :
+                                   "GenerateHashForGraphicsPipeline/pipeline",
+                     [pSynthetic, isCacheHash](BenchmarkState& state)
+        {
+            while (state.KeepRunning())
+            {
+                PipelineDumper::GenerateHashForGraphicsPipeline(&pSynthetic->pipelineInfo, isCacheHash);
+            }
+        });
+    }
+}
+
+// =====================================================================================================================
+// Creates a runtime shader cache for the shader cache benchmarks.
+static ShaderCache* CreateShaderCache()
+{
+    ShaderCacheCreateInfo createInfo = {};
+    ShaderCacheAuxCreateInfo auxCreateInfo = {};
+    auxCreateInfo.shaderCacheMode = ShaderCacheMode::ShaderCacheEnableRuntime;
+    auxCreateInfo.gfxIp           = { 9, 0, 0 };
+
+    ShaderCache* pShaderCache = new ShaderCache();
+    Result result = pShaderCache->Init(&createInfo, &auxCreateInfo);
+    LLPC_ASSERT(result == Result::Success);
+    LLPC_UNUSED(result);
+    return pShaderCache;
+}
+
+// =====================================================================================================================
+// Registers the shader cache benchmarks: lookups of cached shaders and insertion of new shaders, under contention
+// from several threads, and the CRC calculated over serialized cache data.
+static void AddShaderCacheBenchmarks()
+{
+    static const uint32_t EntryCount = 4096;    // Count of entries in the populated cache
+    static const uint32_t EntrySize  = 16384;   // Size of a cached pipeline ELF
+
+    auto pPopulatedCache = std::make_shared<std::unique_ptr<ShaderCache>>();
+    auto populate = [pPopulatedCache]
+    {
+        if (*pPopulatedCache == nullptr)
+        {
+            pPopulatedCache->reset(CreateShaderCache());
+            std::vector<uint8_t> blob(EntrySize, 0xA5);
+            for (uint32_t i = 0; i < EntryCount; ++i)
+            {
+                MetroHash::Hash hash = {};
+                hash.dwords[0] = i;
+
+                CacheEntryHandle hEntry = nullptr;
+                if ((*pPopulatedCache)->FindShader(hash, true, &hEntry) == ShaderEntryState::Compiling)
+                {
+                    (*pPopulatedCache)->InsertShader(hEntry, blob.data(), blob.size());
+                }
+            }
+        }
+    };
+
+    for (uint32_t threadCount : ThreadCounts)
+    {
+        Benchmarks.push_back(
+        {
+            formatv("ShaderCache::FindShader/hit/threads:{0}", threadCount),
+            threadCount,
+            populate,
+            [pPopulatedCache](BenchmarkState& state)
+            {
+                ShaderCache* pShaderCache = pPopulatedCache->get();
+                uint32_t key = state.GetThreadIndex() * 7919;
+                while (state.KeepRunning())
+                {
+                    MetroHash::Hash hash = {};
+                    hash.dwords[0] = key % EntryCount;
+                    key += 31;
+
+                    CacheEntryHandle hEntry = nullptr;
+                    const void* pBlob = nullptr;
+                    size_t blobSize = 0;
+                    if (pShaderCache->FindShader(hash, false, &hEntry) == ShaderEntryState::Ready)
+                    {
+                        pShaderCache->RetrieveShader(hEntry, &pBlob, &blobSize);
+                    }
+                }
+            },
+            nullptr,
+        });
+    }
+
+    // Each run inserts new entries into an empty cache, so that every thread misses, allocates and inserts.
+    auto pInsertCache = std::make_shared<std::unique_ptr<ShaderCache>>();
+    for (uint32_t threadCount : ThreadCounts)
+    {
+        Benchmarks.push_back(
+        {
+            formatv("ShaderCache::InsertShader/threads:{0}", threadCount),
+            threadCount,
+            [pInsertCache] { pInsertCache->reset(CreateShaderCache()); },
+            [pInsertCache](BenchmarkState& state)
+            {
+                ShaderCache* pShaderCache = pInsertCache->get();
+                std::vector<uint8_t> blob(1024, 0x3C);
+                MetroHash::Hash hash = {};
+                hash.dwords[1] = state.GetThreadIndex();
+                while (state.KeepRunning())
+                {
+                    ++hash.dwords[0];
+
+                    CacheEntryHandle hEntry = nullptr;
+                    if (pShaderCache->FindShader(hash, true, &hEntry) == ShaderEntryState::Compiling)
+                    {
+                        pShaderCache->InsertShader(hEntry, blob.data(), blob.size());
+                    }
+                }
+            },
+            [pInsertCache] { pInsertCache->reset(); },
+        });
+    }
+
+    for (uint32_t size : { 4096, 1048576 })
+    {
+        AddBenchmark(formatv("ShaderCache::CalculateCrc/{0}", size), [size](BenchmarkState& state)
+        {
+            std::vector<uint8_t> data(size, 0x5A);
+            while (state.KeepRunning())
+            {
+                ShaderCache::CalculateCrc(data.data(), data.size());
+            }
+            state.SetBytesPerIteration(size);
+        });
+    }
+}
+
+// =====================================================================================================================
+// Registers the ELF benchmarks over the pipeline ELF specified by -elf: reading and writing it, and merging the text
+// sections of two pipeline ELFs with ElfWriter::MergeSection.
+static void AddElfBenchmarks()
+{
+    if (ElfFile.empty())
+    {
+        return;
+    }
+
+    auto fileOrErr = MemoryBuffer::getFile(ElfFile);
+    if (!fileOrErr)
+    {
+        LLPC_ERRS("Fails to open ELF file: " << ElfFile << "\n");
+        return;
+    }
+    std::shared_ptr<MemoryBuffer> pElf(std::move(*fileOrErr));
+
+    GfxIpVersion gfxIp = {};
+    sscanf(GfxIp.c_str(), "%u.%u.%u", &gfxIp.major, &gfxIp.minor, &gfxIp.stepping);
+
+    AddBenchmark("ElfReader::ReadFromBuffer", [pElf, gfxIp](BenchmarkState& state)
+    {
+        while (state.KeepRunning())
+        {
+            ElfReader<Elf64> reader(gfxIp);
+            size_t readSize = 0;
+            reader.ReadFromBuffer(pElf->getBufferStart(), &readSize);
+        }
+        state.SetBytesPerIteration(pElf->getBufferSize());
+    });
+
+    AddBenchmark("ElfWriter::ReadFromBuffer", [pElf, gfxIp](BenchmarkState& state)
+    {
+        while (state.KeepRunning())
+        {
+            ElfWriter<Elf64> writer(gfxIp);
+            writer.ReadFromBuffer(pElf->getBufferStart(), pElf->getBufferSize());
+        }
+        state.SetBytesPerIteration(pElf->getBufferSize());
+    });
+
+    AddBenchmark("ElfWriter::WriteToBuffer", [pElf, gfxIp](BenchmarkState& state)
+    {
+        ElfWriter<Elf64> writer(gfxIp);
+        writer.ReadFromBuffer(pElf->getBufferStart(), pElf->getBufferSize());
+        while (state.KeepRunning())
+        {
+            ElfPackage package;
+            writer.WriteToBuffer(&package);
+        }
+        state.SetBytesPerIteration(pElf->getBufferSize());
+    });
+
+    // NOTE: This times reading the ELF, merging the text section of a second ELF into it and writing the result. It is
+    // not all of MergeElfBinary, which also merges the PAL metadata notes and needs a pipeline context for that.
+    AddBenchmark("ElfWriter::MergeSection/text", [pElf, gfxIp](BenchmarkState& state)
+    {
+        ElfReader<Elf64> reader(gfxIp);
+        size_t readSize = 0;
+        reader.ReadFromBuffer(pElf->getBufferStart(), &readSize);
+
+        ElfReader<Elf64>::SectionBuffer* pFragmentTextSection = nullptr;
+        reader.GetSectionDataBySectionIndex(reader.GetSectionIndex(TextName), &pFragmentTextSection);
+
+        while (state.KeepRunning())
+        {
+            ElfWriter<Elf64> writer(gfxIp);
+            writer.ReadFromBuffer(pElf->getBufferStart(), pElf->getBufferSize());
+
+            const uint32_t textSecIndex = writer.GetSectionIndex(TextName);
+            const ElfWriter<Elf64>::SectionBuffer* pTextSection = nullptr;
+            writer.GetSectionDataBySectionIndex(textSecIndex, &pTextSection);
+
+            ElfWriter<Elf64>::SectionBuffer newSection = {};
+            ElfWriter<Elf64>::MergeSection(pTextSection,
+                                           Pow2Align(pTextSection->secHead.sh_size, 0x100),
+                                           nullptr,
+                                           pFragmentTextSection,
+                                           0,
+                                           nullptr,
+                                           &newSection);
+            writer.SetSection(textSecIndex, &newSection);
+
+            ElfPackage package;
+            writer.WriteToBuffer(&package);
+        }
+        state.SetBytesPerIteration(pElf->getBufferSize() * 2);
+    });
+}
+
+// =====================================================================================================================
+// Registers the resource usage serialization benchmarks. Resource usage is serialized with each shader module entry
+// and deserialized when the entry is loaded for a pipeline build.
+static void AddResourceUsageBenchmarks()
+{
+    // Resource usage with realistic sizes: 32 descriptors and 16 input and output locations.
+    auto pResUsage = std::make_shared<ResourceUsage>();
+    for (uint32_t i = 0; i < 32; ++i)
+    {
+        pResUsage->descPairs.insert((static_cast<uint64_t>(i / 8) << 32) | (i % 8));
+    }
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        pResUsage->inOutUsage.inputLocMap[i] = i;
+        pResUsage->inOutUsage.outputLocMap[i] = i;
+        pResUsage->inOutUsage.inputCompMap[i] = i;
+    }
+    pResUsage->inOutUsage.builtInOutputLocMap[0] = 16;
+
+    auto pData = std::make_shared<std::string>();
+    SerializeResourceUsage(*pResUsage, pData.get());
+
+    AddBenchmark("ResourceUsage/serialize", [pResUsage, pData](BenchmarkState& state)
+    {
+        while (state.KeepRunning())
+        {
+            std::string data;
+            SerializeResourceUsage(*pResUsage, &data);
+        }
+        state.SetBytesPerIteration(pData->size());
+    });
+
+    AddBenchmark("ResourceUsage/deserialize", [pData](BenchmarkState& state)
+    {
+        while (state.KeepRunning())
+        {
+            ResourceUsage resUsage;
+            DeserializeResourceUsage(*pData, &resUsage);
+        }
+        state.SetBytesPerIteration(pData->size());
+    });
+}
+
+// =====================================================================================================================
+// Main function of LLPC micro-benchmarks, entry-point. It runs the registered benchmarks that match -filter and
+// prints one line per benchmark, and optionally writes the results in JSON.
+//
+// Returns 0 if successful. Other numeric values indicate failure.
+int32_t main(
+    int32_t argc,       // Count of arguments
+    char*   argv[])     // [in] List of arguments
+{
+    EnablePrettyStackTrace();
+    sys::PrintStackTraceOnErrorSignal(argv[0]);
+    PrettyStackTraceProgram X(argc, argv);
+
+    cl::ParseCommandLineOptions(argc, argv, "LLPC micro-benchmarks\n");
+
+    AddHashBenchmarks();
+    AddShaderCacheBenchmarks();
+    AddElfBenchmarks();
+    AddResourceUsageBenchmarks();
+
+    Regex filter(Filter);
+    json::Array results;
+
+    outs() << format("%-48s %8s %14s %12s %12s\n", "Benchmark", "Threads", "Iterations", "ns/iter", "MB/s");
+    for (const Benchmark& benchmark : Benchmarks)
+    {
+        if (filter.match(benchmark.name) == false)
+        {
+            continue;
+        }
+
+        BenchmarkResult result = MeasureBenchmark(benchmark);
+        outs() << format("%-48s %8u %14" PRIu64 " %12.1f %12.1f\n",
+                         result.name.c_str(),
+                         result.threadCount,
+                         result.iterations,
+                         result.nsPerIteration,
+                         result.bytesPerSecond / (1024.0 * 1024.0));
+        outs().flush();
+
+        results.push_back(json::Object
+        {
+            { "name",           result.name },
+            { "threads",        static_cast<int64_t>(result.threadCount) },
+            { "iterations",     static_cast<int64_t>(result.iterations) },
+            { "nsPerIteration", result.nsPerIteration },
+            { "bytesPerSecond", result.bytesPerSecond },
+        });
+    }
+
+    int32_t exitCode = 0;
+    if (OutFile.empty() == false)
+    {
+        std::error_code errCode;
+        raw_fd_ostream outStream(OutFile, errCode, sys::fs::F_Text);
+        if (errCode)
+        {
+            LLPC_ERRS("Fails to open output file: " << OutFile << "\n");
+            exitCode = 1;
+        }
+        else
+        {
+            outStream << formatv("{0:2}", json::Value(std::move(results))) << "\n";
+        }
+    }
+
+    return exitCode;
+}
@@ -0,0 +1,400 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2019 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcNggAutotune.cpp
+ * @brief LLPC source file: offline tuning of NGG state with AMDLLPC
+ ***********************************************************************************************************************
+ */
+#ifdef WIN_OS
+    // NOTE: Disable Windows-defined min()/max() because we use STL-defined std::min()/std::max() in LLPC.
+    #define NOMINMAX
+#endif
+
+#include "amdllpc.h"
+
+#if LLPC_BUILD_GFX10
+
+#include "llpcDebug.h"
+#include "llpcElfReader.h"
+#include "llpcGfx9Chip.h"
+
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <map>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define DEBUG_TYPE "llpc-ngg-autotune"
+
+using namespace llvm;
+using namespace Llpc;
+
+// -ngg-autotune-cull-rate: expected percentage of primitives discarded by the NGG cullers
+static cl::opt<uint32_t> NggAutotuneCullRate("ngg-autotune-cull-rate",
+                                             cl::desc("Expected percentage of primitives discarded when all NGG "
+                                                      "cullers are enabled, used by the NGG autotuning cost model"),
+                                             cl::value_desc("percent"),
+                                             cl::init(25));
+
+// Parameters of the static cost model used to score NGG state variants
+static const uint32_t WaveSize              = 64;       // Wavefront size of the primitive shader
+static const uint32_t ExportCostPerVertex   = 4;        // Cost of one export instruction issued by a vertex thread
+static const uint32_t SetupCostPerPrim      = 8;        // Cost of primitive setup for a primitive that is not culled
+static const uint32_t LdsBytesPerCu         = 65536;    // LDS available to the subgroups on one CU
+static const uint32_t MaxSubgroupsPerCu     = 16;       // Maximum count of subgroups in flight on one CU
+static const uint32_t MinSubgroupsPerCu     = 4;        // Count of subgroups in flight needed to hide latency
+
+// Represents the cost of an NGG state variant as read from the built pipeline ELF.
+struct NggVariantCost
+{
+    uint32_t instDwords;        // Code size of the primitive shader in dwords
+    uint32_t ldsBytes;          // LDS size of one subgroup in bytes
+    uint32_t vertsPerSubgroup;  // Count of vertices consumed by one subgroup
+    uint32_t primsPerSubgroup;  // Count of primitives processed by one subgroup
+    uint32_t exportCount;       // Count of position and parameter exports of one vertex
+    float    score;             // Estimated cost of one input primitive (lower is better)
+};
+
+// Represents a set of NGG cullers tried by the autotuning, with the share of the expected cull rate it achieves.
+struct NggCullerSet
+{
+    const char* pName;                  // Name of the culler set
+    bool        enableBackfaceCulling;  // Enable backface culler
+    bool        enableFrustumCulling;   // Enable frustum culler
+    bool        enableSmallPrimFilter;  // Enable small primitive filter
+    float       cullShare;              // Share of the expected cull rate achieved by this set
+};
+
+static const NggCullerSet CullerSets[] =
+{
+    { "none",                       false, false, false, 0.0f },
+    { "backface",                   true,  false, false, 0.7f },
+    { "backface+frustum",           true,  true,  false, 0.9f },
+    { "backface+frustum+smallprim", true,  true,  true,  1.0f },
+};
+
+// Recommended NGG state of each tuned pipeline, keyed by pipeline hash
+static std::map<uint64_t, NggState> TunedNggStates;
+
+// =====================================================================================================================
+// Reads the cost model inputs of a built NGG pipeline from its ELF. Returns false if the pipeline has no primitive
+// shader, e.g. because NGG was disabled for it.
+static bool ReadNggVariantCost(
+    const BinaryData& pipelineBin,  // [in] Pipeline binary
+    GfxIpVersion      gfxIp,        // Graphics IP version
+    NggVariantCost*   pCost)        // [out] Cost model inputs of the pipeline
+{
+    *pCost = {};
+
+    ElfReader<Elf64> reader(gfxIp);
+    size_t readSize = 0;
+    if ((reader.ReadFromBuffer(pipelineBin.pCode, &readSize) != Result::Success) ||
+        (reader.IsSectionPresent(NoteName) == false))
+    {
+        return false;
+    }
+
+    const char* pGsEntryName =
+        Util::Abi::PipelineAbiSymbolNameStrings[static_cast<uint32_t>(Util::Abi::PipelineSymbolType::GsMainEntry)];
+    for (uint32_t i = 0; i < reader.GetSymbolCount(); ++i)
+    {
+        ElfSymbol symbol = {};
+        reader.GetSymbol(i, &symbol);
+        if (strcmp(symbol.pSymName, pGsEntryName) == 0)
+        {
+            pCost->instDwords = symbol.size / sizeof(uint32_t);
+            break;
+        }
+    }
+
+    auto note = reader.GetNote(Util::Abi::PipelineAbiNoteType::PalMetadata);
+    msgpack::Document document;
+    if ((pCost->instDwords == 0) ||
+        (note.pData == nullptr) ||
+        (document.readFromBlob(StringRef(reinterpret_cast<const char*>(note.pData), note.hdr.descSize),
+                               false) == false))
+    {
+        return false;
+    }
+
+    auto pipelineNode = document.getRoot().getMap(true)[Util::Abi::PalCodeObjectMetadataKey::Pipelines]
+                                          .getArray(true)[0]
+                                          .getMap(true);
+
+    auto ldsSizeNode = pipelineNode[Util::Abi::PipelineMetadataKey::HardwareStages]
+                                   .getMap(true)[HwStageNames[static_cast<uint32_t>(Util::Abi::HardwareStage::Gs)]]
+                                   .getMap(true)[Util::Abi::HardwareStageMetadataKey::LdsSize];
+    if (ldsSizeNode.getKind() == msgpack::Type::UInt)
+    {
+        pCost->ldsBytes = ldsSizeNode.getUInt();
+    }
+
+    // Looks up a register value, returning 0 if the pipeline does not set it.
+    auto registers = pipelineNode[".registers"].getMap(true);
+    auto getRegister = [&](uint32_t regId) -> uint32_t
+    {
+        auto it = registers.find(document.getNode(regId));
+        return ((it != registers.end()) && (it->second.getKind() == msgpack::Type::UInt)) ? it->second.getUInt() : 0;
+    };
+
+    Gfx9::regVGT_GS_ONCHIP_CNTL vgtGsOnchipCntl;
+    vgtGsOnchipCntl.u32All = getRegister(Gfx9::mmVGT_GS_ONCHIP_CNTL);
+    pCost->vertsPerSubgroup = std::max(1u, static_cast<uint32_t>(vgtGsOnchipCntl.bits.ES_VERTS_PER_SUBGRP));
+    pCost->primsPerSubgroup = std::max(1u, static_cast<uint32_t>(vgtGsOnchipCntl.bits.GS_PRIMS_PER_SUBGRP));
+
+    Gfx9::regSPI_VS_OUT_CONFIG spiVsOutConfig;
+    spiVsOutConfig.u32All = getRegister(Gfx9::mmSPI_VS_OUT_CONFIG);
+    pCost->exportCount = spiVsOutConfig.bits.VS_EXPORT_COUNT + 1;
+
+    Gfx9::regSPI_SHADER_POS_FORMAT spiShaderPosFormat;
+    spiShaderPosFormat.u32All = getRegister(Gfx9::mmSPI_SHADER_POS_FORMAT);
+    pCost->exportCount += (spiShaderPosFormat.bits.POS0_EXPORT_FORMAT != 0) ? 1 : 0;
+    pCost->exportCount += (spiShaderPosFormat.bits.POS1_EXPORT_FORMAT != 0) ? 1 : 0;
+    pCost->exportCount += (spiShaderPosFormat.bits.POS2_EXPORT_FORMAT != 0) ? 1 : 0;
+    pCost->exportCount += (spiShaderPosFormat.bits.POS3_EXPORT_FORMAT != 0) ? 1 : 0;
+
+    return true;
+}
+
+// =====================================================================================================================
+// Estimates the cost of one input primitive for an NGG state variant. The subgroup runs the primitive shader code once
+// per wave, exports the surviving vertices and sets up the surviving primitives; that cost is amortized over the
+// primitives of the subgroup, and raised when the LDS use of a subgroup limits how many subgroups hide each other's
+// latency.
+static float ScoreNggVariant(
+    const NggVariantCost& cost,       // [in] Cost model inputs of the variant
+    float                 cullRate)   // Expected fraction of primitives discarded by the enabled cullers
+{
+    const uint32_t wavesPerSubgroup =
+        (std::max(cost.vertsPerSubgroup, cost.primsPerSubgroup) + WaveSize - 1) / WaveSize;
+
+    float subgroupCost = static_cast<float>(cost.instDwords * wavesPerSubgroup);
+    subgroupCost += (1.0f - cullRate) * cost.exportCount * cost.vertsPerSubgroup * ExportCostPerVertex;
+    subgroupCost += (1.0f - cullRate) * cost.primsPerSubgroup * SetupCostPerPrim;
+
+    uint32_t subgroupsPerCu = (cost.ldsBytes > 0) ? (LdsBytesPerCu / cost.ldsBytes) : MaxSubgroupsPerCu;
+    subgroupsPerCu = std::max(1u, std::min(subgroupsPerCu, MaxSubgroupsPerCu));
+
+    float primCost = subgroupCost / cost.primsPerSubgroup;
+    if (subgroupsPerCu < MinSubgroupsPerCu)
+    {
+        primCost *= static_cast<float>(MinSubgroupsPerCu) / subgroupsPerCu;
+    }
+    return primCost;
+}
+
+// =====================================================================================================================
+// Builds the pipeline with the specified NGG state and scores it. Returns false if the variant fails to build or does
+// not run as an NGG pipeline.
+static bool BuildNggVariant(
+    ICompiler*                       pCompiler,     // [in] LLPC compiler object
+    const GraphicsPipelineBuildInfo& pipelineInfo,  // [in] Info to build the pipeline
+    const NggState&                  nggState,      // [in] NGG state of the variant
+    GfxIpVersion                     gfxIp,         // Graphics IP version
+    NggVariantCost*                  pCost)         // [out] Cost of the variant
+{
+    void* pPipelineBuf = nullptr;
+    GraphicsPipelineBuildInfo variantInfo = pipelineInfo;
+    variantInfo.pUserData    = &pPipelineBuf;
+    variantInfo.pShaderCache = nullptr;
+    variantInfo.nggState     = nggState;
+
+    GraphicsPipelineBuildOut variantOut = {};
+    bool success = (pCompiler->BuildGraphicsPipeline(&variantInfo, &variantOut, nullptr) == Result::Success) &&
+                   ReadNggVariantCost(variantOut.pipelineBin, gfxIp, pCost);
+    free(pPipelineBuf);
+
+    if (success)
+    {
+        float cullRate = 0.0f;
+        for (const auto& cullerSet : CullerSets)
+        {
+            if ((cullerSet.enableBackfaceCulling == nggState.enableBackfaceCulling) &&
+                (cullerSet.enableFrustumCulling == nggState.enableFrustumCulling) &&
+                (cullerSet.enableSmallPrimFilter == nggState.enableSmallPrimFilter))
+            {
+                cullRate = cullerSet.cullShare * std::min(NggAutotuneCullRate.getValue(), 100u) / 100.0f;
+            }
+        }
+        pCost->score = ScoreNggVariant(*pCost, cullRate);
+
+        LLPC_OUTS("  sizing=" << static_cast<uint32_t>(nggState.subgroupSizing)
+                  << " prims=" << nggState.primsPerSubgroup << " verts=" << nggState.vertsPerSubgroup
+                  << " compact=" << static_cast<uint32_t>(nggState.compactMode)
+                  << " cull=" << nggState.enableBackfaceCulling << nggState.enableFrustumCulling
+                  << nggState.enableSmallPrimFilter
+                  << " : inst=" << pCost->instDwords << " lds=" << pCost->ldsBytes
+                  << " subgroup=" << pCost->vertsPerSubgroup << "/" << pCost->primsPerSubgroup
+                  << " exports=" << pCost->exportCount << " score=" << format("%.3f", pCost->score) << "\n");
+    }
+
+    return success;
+}
+
+// =====================================================================================================================
+// Sweeps the NGG subgroup sizing, culler and compaction options of a graphics pipeline and records the NGG state with
+// the lowest estimated cost under the hash of the pipeline. The options are tuned one after the other (subgroup sizing
+// first, since it determines the amortization of everything else), each starting from the best state found so far.
+Result AutotuneNggState(
+    ICompiler*                       pCompiler,     // [in] LLPC compiler object
+    const GraphicsPipelineBuildInfo* pPipelineInfo, // [in] Info to build the pipeline, with the default NGG state
+    GfxIpVersion                     gfxIp)         // Graphics IP version
+{
+    const uint64_t hash = IPipelineDumper::GetPipelineHash(pPipelineInfo);
+
+    if ((gfxIp.major < 10) || (pPipelineInfo->nggState.enableNgg == false))
+    {
+        outs() << "NGG autotune: " << format("0x%016" PRIX64, hash) << " skipped (NGG is disabled)\n";
+        return Result::Success;
+    }
+
+    LLPC_OUTS("===============================================================================\n");
+    LLPC_OUTS("// LLPC NGG autotune variants of pipeline " << format("0x%016" PRIX64, hash) << "\n\n");
+
+    NggState bestState = pPipelineInfo->nggState;
+    NggVariantCost bestCost = {};
+    if (BuildNggVariant(pCompiler, *pPipelineInfo, bestState, gfxIp, &bestCost) == false)
+    {
+        outs() << "NGG autotune: " << format("0x%016" PRIX64, hash) << " skipped (not built as NGG pipeline)\n";
+        return Result::Success;
+    }
+    const float defaultScore = bestCost.score;
+
+    // Tries a variant derived from the best state found so far, and keeps it if it scores better.
+    auto tryVariant = [&](const NggState& nggState)
+    {
+        NggVariantCost cost = {};
+        if (BuildNggVariant(pCompiler, *pPipelineInfo, nggState, gfxIp, &cost) && (cost.score < bestCost.score))
+        {
+            bestState = nggState;
+            bestCost  = cost;
+        }
+    };
+
+    // Subgroup sizing
+    static const NggSubgroupSizingType SizingTypes[] =
+    {
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 26
+        NggSubgroupSizingType::Auto,
+#endif
+        NggSubgroupSizingType::MaximumSize,
+        NggSubgroupSizingType::HalfSize,
+        NggSubgroupSizingType::OptimizeForVerts,
+        NggSubgroupSizingType::OptimizeForPrims,
+    };
+    static const uint32_t ExplicitSubgroupSizes[] = { 256, 128, 64 };
+
+    const NggState sizingBase = bestState;
+    for (auto sizingType : SizingTypes)
+    {
+        NggState nggState = sizingBase;
+        nggState.subgroupSizing = sizingType;
+        tryVariant(nggState);
+    }
+    for (auto subgroupSize : ExplicitSubgroupSizes)
+    {
+        NggState nggState = sizingBase;
+        nggState.subgroupSizing   = NggSubgroupSizingType::Explicit;
+        nggState.primsPerSubgroup = subgroupSize;
+        nggState.vertsPerSubgroup = subgroupSize;
+        tryVariant(nggState);
+    }
+
+    // Cullers
+    const NggState cullerBase = bestState;
+    for (const auto& cullerSet : CullerSets)
+    {
+        NggState nggState = cullerBase;
+        nggState.enableBackfaceCulling = cullerSet.enableBackfaceCulling;
+        nggState.enableFrustumCulling  = cullerSet.enableFrustumCulling;
+        nggState.enableSmallPrimFilter = cullerSet.enableSmallPrimFilter;
+        tryVariant(nggState);
+    }
+
+    // Compaction mode
+    const NggState compactBase = bestState;
+    for (auto compactMode : { NggCompactSubgroup, NggCompactVertices })
+    {
+        NggState nggState = compactBase;
+        nggState.compactMode = compactMode;
+        tryVariant(nggState);
+    }
+
+    TunedNggStates[hash] = bestState;
+
+    outs() << "NGG autotune: " << format("0x%016" PRIX64, hash)
+           << " score " << format("%.3f", defaultScore) << " -> " << format("%.3f", bestCost.score) << "\n";
+
+    return Result::Success;
+}
+
+// =====================================================================================================================
+// Writes the recommended NGG state of all tuned pipelines as a lookup table, one line per pipeline hash.
+Result WriteNggAutotuneResults(
+    const std::string& outFile)     // [in] Name of the output file
+{
+    FILE* pOutFile = fopen(outFile.c_str(), "w");
+    if (pOutFile == nullptr)
+    {
+        LLPC_ERRS("Fails to open NGG autotune output file: " << outFile << "\n");
+        return Result::ErrorUnavailable;
+    }
+
+    fprintf(pOutFile, "; pipelineHash subgroupSizing primsPerSubgroup vertsPerSubgroup compactMode "
+                      "enableBackfaceCulling enableFrustumCulling enableSmallPrimFilter\n");
+    for (const auto& tunedState : TunedNggStates)
+    {
+        const NggState& nggState = tunedState.second;
+        fprintf(pOutFile,
+                "0x%016" PRIX64 " %u %u %u %u %u %u %u\n",
+                tunedState.first,
+                static_cast<uint32_t>(nggState.subgroupSizing),
+                nggState.primsPerSubgroup,
+                nggState.vertsPerSubgroup,
+                static_cast<uint32_t>(nggState.compactMode),
+                nggState.enableBackfaceCulling,
+                nggState.enableFrustumCulling,
+                nggState.enableSmallPrimFilter);
+    }
+
+    Result result = (fclose(pOutFile) == 0) ? Result::Success : Result::ErrorUnavailable;
+    if (result == Result::Success)
+    {
+        outs() << "NGG autotune results (" << TunedNggStates.size() << " pipelines): " << outFile << "\n";
+    }
+    else
+    {
+        LLPC_ERRS("Failed to write NGG autotune output file: " << outFile << "\n");
+    }
+
+    TunedNggStates.clear();
+    return result;
+}
+
+#endif
@@ -0,0 +1,436 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2019 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcShaderCacheUpgrade.cpp
+ * @brief LLPC source file: offline upgrade, merging and writing of shader cache files with AMDLLPC
+ ***********************************************************************************************************************
+ */
+#ifdef WIN_OS
+    // NOTE: Disable Windows-defined min()/max() because we use STL-defined std::min()/std::max() in LLPC.
+    #define NOMINMAX
+#endif
+
+#include "amdllpc.h"
+
+#include "llpcDebug.h"
+#include "llpcShaderCache.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <stdio.h>
+
+#define DEBUG_TYPE "llpc-shader-cache-upgrade"
+
+using namespace llvm;
+using namespace Llpc;
+
+// Represents the state of an offline shader cache upgrade.
+struct ShaderCacheUpgradeState
+{
+    std::vector<uint8_t>                oldCacheData;   // Contents of the old shader cache file
+    std::vector<SerializedShaderEntry>  oldEntries;     // Shader entries of the old shader cache file
+    uint32_t                            mismatch;       // Mask of BuildIdMismatch flags against the running compiler
+    bool                                rekey;          // Whether to carry over all entries without recompiling
+    ShaderCache*                        pNewCache;      // Shader cache receiving the upgraded entries
+};
+
+static ShaderCacheUpgradeState UpgradeState = {};
+
+// =====================================================================================================================
+// Gets the printable names of the build ID components flagged in the specified mismatch mask.
+static std::string GetMismatchNames(
+    uint32_t mismatch)  // Mask of BuildIdMismatch flags
+{
+    static const struct
+    {
+        BuildIdMismatch flag;
+        const char*     pName;
+    } MismatchNames[] =
+    {
+        { BuildIdMismatchFormat,       "format"  },
+        { BuildIdMismatchGfxIp,        "gfxip"   },
+        { BuildIdMismatchLlpcRevision, "llpc"    },
+        { BuildIdMismatchLlvmRevision, "llvm"    },
+        { BuildIdMismatchOptions,      "options" },
+    };
+
+    std::string names;
+    for (const auto& mismatchName : MismatchNames)
+    {
+        if (mismatch & mismatchName.flag)
+        {
+            names += names.empty() ? "" : ", ";
+            names += mismatchName.pName;
+        }
+    }
+    return names.empty() ? "none" : names;
+}
+
+// =====================================================================================================================
+// Callback to write a chunk of serialized shader cache data to the file passed as user data.
+static Result WriteToFile(
+    void*       pUserData,  // [in] Output file
+    const void* pData,      // [in] Data to write
+    size_t      dataSize)   // Size of data in bytes
+{
+    return (fwrite(pData, 1, dataSize, static_cast<FILE*>(pUserData)) == dataSize) ? Result::Success :
+                                                                                     Result::ErrorUnavailable;
+}
+
+// =====================================================================================================================
+// Reads the contents of a shader cache file.
+static Result ReadShaderCacheFile(
+    const std::string&    cacheFile,    // [in] Shader cache file to read
+    std::vector<uint8_t>* pCacheData)   // [out] Contents of the shader cache file
+{
+    Result result = Result::Success;
+
+    FILE* pCacheFile = fopen(cacheFile.c_str(), "rb");
+    if (pCacheFile == nullptr)
+    {
+        LLPC_ERRS("Fails to open shader cache file: " << cacheFile << "\n");
+        result = Result::ErrorUnavailable;
+    }
+
+    if (result == Result::Success)
+    {
+        fseek(pCacheFile, 0, SEEK_END);
+        size_t fileSize = ftell(pCacheFile);
+        fseek(pCacheFile, 0, SEEK_SET);
+
+        pCacheData->resize(fileSize);
+        if (fread(pCacheData->data(), 1, fileSize, pCacheFile) != fileSize)
+        {
+            LLPC_ERRS("Fails to read shader cache file: " << cacheFile << "\n");
+            result = Result::ErrorUnavailable;
+        }
+        fclose(pCacheFile);
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Reads an existing shader cache file and creates the shader cache that receives the upgraded entries. Pipelines only
+// have to be recompiled (into the returned shader cache) when a codegen-relevant component of the build ID changed and
+// re-keying was not requested.
+Result BeginShaderCacheUpgrade(
+    ICompiler*         pCompiler,           // [in] LLPC compiler object
+    const std::string& cacheFile,           // [in] Shader cache file to upgrade
+    bool               rekey,               // Carry over all entries without recompiling
+    IShaderCache**     ppShaderCache,       // [out] Shader cache to pass to pipeline builds
+    bool*              pNeedRecompile)      // [out] Whether input pipelines have to be recompiled
+{
+    Result result = ReadShaderCacheFile(cacheFile, &UpgradeState.oldCacheData);
+
+    BuildUniqueId oldBuildId = {};
+    if (result == Result::Success)
+    {
+        result = ShaderCache::ParseSerializedCache(UpgradeState.oldCacheData.data(),
+                                                   UpgradeState.oldCacheData.size(),
+                                                   &oldBuildId,
+                                                   &UpgradeState.oldEntries);
+        if (result == Result::Unsupported)
+        {
+            outs() << "Shader cache: " << cacheFile << "\n"
+                   << "  Changed build ID : " << GetMismatchNames(BuildIdMismatchFormat) << "\n";
+            LLPC_ERRS("Shader cache file has format version " << oldBuildId.formatVersion << ", expected "
+                      << ShaderCacheFormatVersion << "; its entries cannot be upgraded: " << cacheFile << "\n");
+            result = Result::ErrorInvalidValue;
+        }
+        else if (result != Result::Success)
+        {
+            LLPC_ERRS("Corrupted shader cache file: " << cacheFile << "\n");
+        }
+    }
+
+    if (result == Result::Success)
+    {
+        ShaderCacheCreateInfo createInfo = {};
+        IShaderCache* pShaderCache = nullptr;
+        result = pCompiler->CreateShaderCache(&createInfo, &pShaderCache);
+        UpgradeState.pNewCache = static_cast<ShaderCache*>(pShaderCache);
+    }
+
+    if (result == Result::Success)
+    {
+        UpgradeState.mismatch = UpgradeState.pNewCache->CompareBuildId(oldBuildId);
+        UpgradeState.rekey    = rekey;
+
+        outs() << "Shader cache: " << cacheFile << "\n"
+               << "  Entries          : " << UpgradeState.oldEntries.size() << "\n"
+               << "  Changed build ID : " << GetMismatchNames(UpgradeState.mismatch) << "\n";
+
+        // NOTE: Re-keying only applies to revision changes that are known not to affect the generated code. Entries
+        // compiled for another target or with other compilation options are never valid for this compiler.
+        const uint32_t codegenMismatch = UpgradeState.mismatch & (BuildIdMismatchGfxIp | BuildIdMismatchOptions);
+        if (rekey && (codegenMismatch != BuildIdMismatchNone))
+        {
+            LLPC_ERRS("Shader cache cannot be re-keyed, entries were built with a different "
+                      << GetMismatchNames(codegenMismatch) << ": " << cacheFile << "\n");
+            UpgradeState.pNewCache->Destroy();
+            UpgradeState = {};
+            result = Result::ErrorInvalidValue;
+        }
+    }
+
+    if (result == Result::Success)
+    {
+        *ppShaderCache  = UpgradeState.pNewCache;
+        *pNeedRecompile = (UpgradeState.mismatch != BuildIdMismatchNone) && (rekey == false);
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Merges the recompiled entries with the carried-over entries of the old shader cache, writes the upgraded shader
+// cache file and reports the fate of every old entry.
+Result EndShaderCacheUpgrade(
+    const std::string& outFile)     // [in] Name of the upgraded shader cache file
+{
+    Result result = Result::Success;
+    ShaderCache* pNewCache = UpgradeState.pNewCache;
+
+    // Collect the entries produced by recompiling the input pipelines.
+    std::vector<uint8_t> recompiledData;
+    std::vector<SerializedShaderEntry> recompiledEntries;
+    size_t dataSize = 0;
+    pNewCache->Serialize(nullptr, &dataSize);
+    recompiledData.resize(dataSize);
+    result = pNewCache->Serialize(recompiledData.data(), &dataSize);
+
+    if (result == Result::Success)
+    {
+        BuildUniqueId newBuildId = {};
+        result = ShaderCache::ParseSerializedCache(recompiledData.data(), dataSize, &newBuildId, &recompiledEntries);
+    }
+
+    uint32_t carriedOverCount = 0;
+    uint32_t identicalCount   = 0;
+    uint32_t changedCount     = 0;
+    uint32_t droppedCount     = 0;
+    uint32_t newCount         = recompiledEntries.size();
+
+    if (result == Result::Success)
+    {
+        DenseMap<uint64_t, const SerializedShaderEntry*> recompiledMap;
+        for (const auto& entry : recompiledEntries)
+        {
+            recompiledMap[entry.key] = &entry;
+        }
+
+        const bool carryOver = (UpgradeState.mismatch == BuildIdMismatchNone) || UpgradeState.rekey;
+        for (const auto& oldEntry : UpgradeState.oldEntries)
+        {
+            auto it = recompiledMap.find(oldEntry.key);
+            if (it != recompiledMap.end())
+            {
+                --newCount;
+                const SerializedShaderEntry* pNewEntry = it->second;
+                if ((pNewEntry->size == oldEntry.size) && (memcmp(pNewEntry->pData, oldEntry.pData, oldEntry.size) == 0))
+                {
+                    ++identicalCount;
+                }
+                else
+                {
+                    ++changedCount;
+                    LLPC_OUTS("  Changed: " << format("0x%016" PRIX64, oldEntry.key) << "\n");
+                }
+            }
+            else if (carryOver)
+            {
+                pNewCache->ImportShader(oldEntry.key, oldEntry.pData, oldEntry.size);
+                ++carriedOverCount;
+            }
+            else
+            {
+                ++droppedCount;
+                LLPC_OUTS("  Dropped: " << format("0x%016" PRIX64, oldEntry.key) << "\n");
+            }
+        }
+    }
+
+    if (result == Result::Success)
+    {
+        FILE* pOutFile = fopen(outFile.c_str(), "wb");
+        result = (pOutFile != nullptr) ? pNewCache->SerializeToStream(WriteToFile, pOutFile) : Result::ErrorUnavailable;
+        if ((pOutFile != nullptr) && (fclose(pOutFile) != 0))
+        {
+            result = Result::ErrorUnavailable;
+        }
+        if (result != Result::Success)
+        {
+            LLPC_ERRS("Failed to write shader cache file: " << outFile << "\n");
+        }
+    }
+
+    if (result == Result::Success)
+    {
+        outs() << "Upgraded shader cache: " << outFile << "\n"
+               << "  Carried over     : " << carriedOverCount << "\n"
+               << "  Recompiled       : " << (identicalCount + changedCount)
+               << " (" << identicalCount << " identical, " << changedCount << " changed)\n"
+               << "  Dropped          : " << droppedCount << "\n"
+               << "  New              : " << newCount << "\n";
+    }
+
+    pNewCache->Destroy();
+    UpgradeState = {};
+
+    return result;
+}
+
+// =====================================================================================================================
+// Creates the shader cache passed to pipeline builds, seeded from the specified shader cache files. Each file is loaded
+// into a shader cache of its own, then all of them are merged, so that entries present in several files are kept once.
+Result LoadShaderCacheFiles(
+    ICompiler*                      pCompiler,      // [in] LLPC compiler object
+    const std::vector<std::string>& cacheFiles,     // [in] Shader cache files to load
+    IShaderCache**                  ppShaderCache)  // [out] Shader cache to pass to pipeline builds
+{
+    Result result = Result::Success;
+    std::vector<const IShaderCache*> srcCaches;
+
+    for (uint32_t i = 0; (i < cacheFiles.size()) && (result == Result::Success); ++i)
+    {
+        std::vector<uint8_t> cacheData;
+        result = ReadShaderCacheFile(cacheFiles[i], &cacheData);
+
+        BuildUniqueId buildId = {};
+        std::vector<SerializedShaderEntry> entries;
+        if (result == Result::Success)
+        {
+            result = ShaderCache::ParseSerializedCache(cacheData.data(), cacheData.size(), &buildId, &entries);
+            if (result != Result::Success)
+            {
+                LLPC_ERRS("Corrupted shader cache file: " << cacheFiles[i] << "\n");
+                result = Result::ErrorInvalidValue;
+            }
+        }
+
+        IShaderCache* pSrcCache = nullptr;
+        if (result == Result::Success)
+        {
+            ShaderCacheCreateInfo createInfo = {};
+            createInfo.pInitialData    = cacheData.data();
+            createInfo.initialDataSize = cacheData.size();
+            result = pCompiler->CreateShaderCache(&createInfo, &pSrcCache);
+        }
+
+        if (result == Result::Success)
+        {
+            srcCaches.push_back(pSrcCache);
+
+            // NOTE: The shader cache drops the entries of a file built with a different build ID.
+            outs() << "Shader cache: " << cacheFiles[i] << "\n"
+                   << "  Entries          : " << entries.size() << "\n"
+                   << "  Changed build ID : "
+                   << GetMismatchNames(static_cast<ShaderCache*>(pSrcCache)->CompareBuildId(buildId)) << "\n";
+        }
+    }
+
+    IShaderCache* pShaderCache = nullptr;
+    if (result == Result::Success)
+    {
+        ShaderCacheCreateInfo createInfo = {};
+        result = pCompiler->CreateShaderCache(&createInfo, &pShaderCache);
+    }
+
+    if ((result == Result::Success) && (srcCaches.empty() == false))
+    {
+        result = pShaderCache->Merge(srcCaches.size(), srcCaches.data());
+    }
+
+    for (auto pSrcCache : srcCaches)
+    {
+        const_cast<IShaderCache*>(pSrcCache)->Destroy();
+    }
+
+    if ((result != Result::Success) && (pShaderCache != nullptr))
+    {
+        pShaderCache->Destroy();
+        pShaderCache = nullptr;
+    }
+
+    *ppShaderCache = pShaderCache;
+
+    return result;
+}
+
+// =====================================================================================================================
+// Writes the specified shader cache to a file, then reads the file back and reports the entries it holds.
+Result WriteShaderCacheFile(
+    IShaderCache*      pShaderCache,    // [in] Shader cache to write
+    const std::string& outFile)         // [in] Name of the shader cache file
+{
+    FILE* pOutFile = fopen(outFile.c_str(), "wb");
+    Result result = (pOutFile != nullptr) ? pShaderCache->SerializeToStream(WriteToFile, pOutFile) :
+                                            Result::ErrorUnavailable;
+    if ((pOutFile != nullptr) && (fclose(pOutFile) != 0))
+    {
+        result = Result::ErrorUnavailable;
+    }
+    if (result != Result::Success)
+    {
+        LLPC_ERRS("Failed to write shader cache file: " << outFile << "\n");
+    }
+
+    std::vector<uint8_t> cacheData;
+    if (result == Result::Success)
+    {
+        result = ReadShaderCacheFile(outFile, &cacheData);
+    }
+
+    BuildUniqueId buildId = {};
+    std::vector<SerializedShaderEntry> entries;
+    if (result == Result::Success)
+    {
+        result = ShaderCache::ParseSerializedCache(cacheData.data(), cacheData.size(), &buildId, &entries);
+        if (result != Result::Success)
+        {
+            LLPC_ERRS("Corrupted shader cache file: " << outFile << "\n");
+            result = Result::ErrorUnknown;
+        }
+    }
+
+    if (result == Result::Success)
+    {
+        size_t dataSize = 0;
+        for (const auto& entry : entries)
+        {
+            dataSize += entry.size;
+        }
+
+        outs() << "Written shader cache: " << outFile << "\n"
+               << "  Entries          : " << entries.size() << "\n"
+               << "  Data size        : " << dataSize << " bytes\n";
+    }
+
+    return result;
+}
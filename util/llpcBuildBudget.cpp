@@ -0,0 +1,90 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2019 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcBuildBudget.cpp
+ * @brief LLPC source file: contains implementation of LLPC utility classes BuildBudget and BuildBudgetPassGate.
+ ***********************************************************************************************************************
+ */
+#include "llpcBuildBudget.h"
+
+#define DEBUG_TYPE "llpc-build-budget"
+
+using namespace llvm;
+
+namespace Llpc
+{
+
+// =====================================================================================================================
+BuildBudget::BuildBudget(
+    const PipelineBuildBudget* pBudget)     // [in] Budget specified in the pipeline build info (could be null)
+    :
+    m_timeLimitMs((pBudget != nullptr) ? pBudget->timeLimitMs : 0),
+    m_pCancelToken((pBudget != nullptr) ? pBudget->pCancelToken : nullptr),
+    m_deadline(std::chrono::steady_clock::now() + std::chrono::milliseconds(m_timeLimitMs)),
+    m_expired(false),
+    m_timedOut(false)
+{
+}
+
+// =====================================================================================================================
+// Checks whether the build is canceled by the client or has exceeded its time limit. Once expired, the budget stays
+// expired.
+bool BuildBudget::IsExpired()
+{
+    if (m_expired == false)
+    {
+        if ((m_pCancelToken != nullptr) && (*m_pCancelToken != 0))
+        {
+            m_expired = true;
+        }
+        else if ((m_timeLimitMs != 0) && (std::chrono::steady_clock::now() >= m_deadline))
+        {
+            m_expired = true;
+            m_timedOut = true;
+        }
+    }
+    return m_expired;
+}
+
+// =====================================================================================================================
+// Decides whether an optional pass is run.
+bool BuildBudgetPassGate::shouldRunPass(
+    const Pass* pPass,          // [in] Pass to run
+    StringRef   description)    // Description of the IR unit the pass runs on
+{
+    bool shouldRun = true;
+    if ((m_pBudget != nullptr) && m_pBudget->IsExpired())
+    {
+        shouldRun = false;
+    }
+    else if (m_pDefaultGate->isEnabled())
+    {
+        shouldRun = m_pDefaultGate->shouldRunPass(pPass, description);
+    }
+    return shouldRun;
+}
+
+} // Llpc
@@ -0,0 +1,102 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2019 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+ /**
+  ***********************************************************************************************************************
+  * @file  llpcBuildBudget.h
+  * @brief LLPC header file: contains the definition of LLPC utility classes BuildBudget and BuildBudgetPassGate.
+  ***********************************************************************************************************************
+  */
+
+#pragma once
+
+#include "llvm/IR/OptBisect.h"
+
+#include "llpc.h"
+#include "llpcDebug.h"
+
+#include <chrono>
+
+namespace Llpc
+{
+
+// =====================================================================================================================
+// Represents the compile-time budget of a pipeline build: a time limit and a cancel token set by the client.
+class BuildBudget
+{
+public:
+    BuildBudget(const PipelineBuildBudget* pBudget);
+
+    // Checks whether the build has a time limit or a cancel token.
+    bool IsEnabled() const { return (m_timeLimitMs != 0) || (m_pCancelToken != nullptr); }
+
+    bool IsExpired();
+
+    // Checks whether the budget expired because the time limit was exceeded, rather than canceled by the client.
+    bool IsTimedOut() const { return m_timedOut; }
+
+private:
+    LLPC_DISALLOW_DEFAULT_CTOR(BuildBudget);
+    LLPC_DISALLOW_COPY_AND_ASSIGN(BuildBudget);
+
+    // -----------------------------------------------------------------------------------------------------------------
+
+    uint32_t                              m_timeLimitMs;    // Time limit in milliseconds (0 - no limit)
+    const volatile uint32_t*              m_pCancelToken;   // Cancel token set by the client (could be null)
+    std::chrono::steady_clock::time_point m_deadline;       // Time when the time limit is exceeded
+    bool                                  m_expired;        // Whether the budget has expired
+    bool                                  m_timedOut;       // Whether the time limit was exceeded
+};
+
+// =====================================================================================================================
+// Represents the pass gate of an LLPC context. Once the budget of the build expires, optional passes (those checking
+// skipFunction() or skipModule(), i.e. most optimization and code generation passes) are skipped, so that the running
+// pass manager completes quickly. Otherwise, the decision is left to the default gate (-opt-bisect-limit).
+class BuildBudgetPassGate : public llvm::OptPassGate
+{
+public:
+    BuildBudgetPassGate(llvm::OptPassGate* pDefaultGate) : m_pDefaultGate(pDefaultGate), m_pBudget(nullptr) {}
+
+    // Sets the budget checked by this gate (could be null)
+    void SetBudget(BuildBudget* pBudget) { m_pBudget = pBudget; }
+
+    bool shouldRunPass(const llvm::Pass* pPass, llvm::StringRef description) override;
+
+    // Checks whether the gate is consulted by the passes.
+    bool isEnabled() const override
+    {
+        return ((m_pBudget != nullptr) && m_pBudget->IsEnabled()) || m_pDefaultGate->isEnabled();
+    }
+
+private:
+    LLPC_DISALLOW_DEFAULT_CTOR(BuildBudgetPassGate);
+    LLPC_DISALLOW_COPY_AND_ASSIGN(BuildBudgetPassGate);
+
+    // -----------------------------------------------------------------------------------------------------------------
+
+    llvm::OptPassGate* m_pDefaultGate;  // Default pass gate of the LLVM context
+    BuildBudget*       m_pBudget;       // Budget of the running build (could be null)
+};
+
+} // Llpc
@@ -90,11 +90,22 @@ using namespace llvm;
 namespace Llpc
 {
 
+// Whether general message output is disabled on the calling thread (see DisableThreadOuts())
+static thread_local bool s_threadOutsDisabled = false;
+
 // =====================================================================================================================
 // Gets the value of option "allow-out".
 bool EnableOuts()
 {
-    return cl::EnableOuts || cl::Verbose;
+    return (cl::EnableOuts || cl::Verbose) && (s_threadOutsDisabled == false);
+}
+
+// =====================================================================================================================
+// Disables general message output on the calling thread, e.g. on a background thread whose messages would interleave
+// with those of the client's builds.
+void DisableThreadOuts()
+{
+    s_threadOutsDisabled = true;
 }
 
 // =====================================================================================================================
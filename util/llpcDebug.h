@@ -90,6 +90,9 @@ template<class Elf> class ElfReader;
 // Gets the value of option "enable-outs"
 bool EnableOuts();
 
+// Disables general message output on the calling thread
+void DisableThreadOuts();
+
 // Gets the value of option "enable-errs"
 bool EnableErrs();
 
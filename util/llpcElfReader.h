@@ -171,6 +171,29 @@ static const char   CommentName[]      = ".comment";   // Name of ".comment" sec
 
 static const uint32_t NT_AMD_AMDGPU_ISA = 11;          // Note type of AMDGPU ISA version
 
+// Name of the section holding the LLVM IR of the pipeline, included when PipelineOptions::includeIr is set
+static const char   LlvmIrBitcodeName[] = ".AMDGPU.llvmbc";
+
+static const uint32_t LlvmIrBitcodeMagic = 0x43424C4C;  // "LLBC" in little-endian
+
+// Enumerates the compression of the bitcode in an LLVM IR bitcode record
+enum LlvmIrBitcodeCompression : uint32_t
+{
+    LlvmIrBitcodeCompressionNone = 0,   // Uncompressed
+    LlvmIrBitcodeCompressionZlib = 1,   // Compressed with zlib
+};
+
+// Represents the header of an LLVM IR bitcode record. The ".AMDGPU.llvmbc" section holds one record for each module
+// compiled into the pipeline ELF (two if it was merged from per-stage cache entries). Each header is immediately
+// followed by dataSize bytes of bitcode.
+struct LlvmIrBitcodeHeader
+{
+    uint32_t magic;         // LlvmIrBitcodeMagic
+    uint32_t compression;   // Compression of the bitcode (LlvmIrBitcodeCompression)
+    uint32_t dataSize;      // Size of the (compressed) bitcode in bytes
+    uint32_t bitcodeSize;   // Size of the uncompressed bitcode in bytes
+};
+
 // Represents the layout of standard note header
 struct NoteHeader
 {
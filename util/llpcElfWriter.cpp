@@ -413,6 +413,58 @@ void ElfWriter<Elf>::SetSection(
     m_sections[secIndex] = *pSection;
 }
 
+// =====================================================================================================================
+// Appends a new data section with the specified name and contents. The section name is added to the section name
+// string table.
+template<class Elf>
+void ElfWriter<Elf>::AddSection(
+    const char* pName,      // [in] Section name
+    const void* pData,      // [in] Section data
+    size_t      dataSize)   // Size of section data in bytes
+{
+    LLPC_ASSERT(GetSectionIndex(pName) == InvalidValue);
+
+    // Append the section name to the section name string table.
+    auto pShStrTabSection = &m_sections[m_header.e_shstrndx];
+    const uint8_t* pOldShStrTab = pShStrTabSection->pData;
+    const size_t oldShStrTabSize = pShStrTabSection->secHead.sh_size;
+    const size_t nameSize = strlen(pName) + 1;
+
+    auto pShStrTab = new uint8_t[oldShStrTabSize + nameSize];
+    memcpy(pShStrTab, pOldShStrTab, oldShStrTabSize);
+    memcpy(pShStrTab + oldShStrTabSize, pName, nameSize);
+    pShStrTabSection->pData = pShStrTab;
+    pShStrTabSection->secHead.sh_size = oldShStrTabSize + nameSize;
+
+    // Names of previously added sections point into the old string table.
+    for (auto& section : m_sections)
+    {
+        const uint8_t* pSecName = reinterpret_cast<const uint8_t*>(section.pName);
+        if ((pSecName >= pOldShStrTab) && (pSecName < pOldShStrTab + oldShStrTabSize))
+        {
+            section.pName = reinterpret_cast<const char*>(pShStrTab + (pSecName - pOldShStrTab));
+        }
+    }
+    delete[] pOldShStrTab;
+
+    // Add the section, keeping a null terminator after the data as ReadFromBuffer does.
+    auto pSecData = new uint8_t[dataSize + 1];
+    memcpy(pSecData, pData, dataSize);
+    pSecData[dataSize] = 0;
+
+    SectionBuffer section = {};
+    section.secHead.sh_name = static_cast<uint32_t>(oldShStrTabSize);
+    section.secHead.sh_type = SHT_PROGBITS;
+    section.secHead.sh_size = dataSize;
+    section.secHead.sh_addralign = 1;
+    section.pData = pSecData;
+    section.pName = reinterpret_cast<const char*>(pShStrTab + oldShStrTabSize);
+
+    m_map[pName] = static_cast<uint32_t>(m_sections.size());
+    m_sections.push_back(section);
+    ++m_header.e_shnum;
+}
+
 // =====================================================================================================================
 // Determines the size needed for a memory buffer to store this ELF.
 template<class Elf>
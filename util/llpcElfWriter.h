@@ -79,6 +79,8 @@ public:
 
     void SetSection(uint32_t secIndex, SectionBuffer* pSection);
 
+    void AddSection(const char* pName, const void* pData, size_t dataSize);
+
     ElfSymbol* GetSymbol(const char* pSymbolName);
 
     ElfNote GetNote(Util::Abi::PipelineAbiNoteType noteType);
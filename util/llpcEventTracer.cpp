@@ -0,0 +1,325 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2019 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcEventTracer.cpp
+ * @brief LLPC source file: contains implementation of LLPC utility classes EventTracer and TraceScope.
+ ***********************************************************************************************************************
+ */
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "llpcEventTracer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifdef WIN_OS
+    #include <process.h>
+#else
+    #include <unistd.h>
+#endif
+
+#define DEBUG_TYPE "llpc-event-tracer"
+
+using namespace llvm;
+
+namespace llvm
+{
+
+namespace cl
+{
+
+// -trace-file: file where compilation events are written in Chrome trace event format
+opt<std::string> TraceFile("trace-file",
+                           desc("File where compilation events are written in Chrome trace event format"),
+                           value_desc("filename"),
+                           init(""));
+
+// -trace-sample-rate: trace one in every N pipeline builds
+opt<uint32_t> TraceSampleRate("trace-sample-rate",
+                              desc("Trace one in every N pipeline and shader module builds"),
+                              value_desc("N"),
+                              init(1));
+
+} // cl
+
+} // llvm
+
+namespace Llpc
+{
+
+// Represents one recorded trace event.
+struct TraceEvent
+{
+    const char* pName;      // Name of the event
+    const char* pCategory;  // Category of the event
+    const char* pDetail;    // Detail of the event (could be null)
+    uint64_t    hash;       // Hash code recorded with the event (0 if not set)
+    uint64_t    time;       // Begin time in nanoseconds
+    uint64_t    duration;   // Duration in nanoseconds, for complete events
+    char        phase;      // Chrome trace event phase: 'X' (complete), 'B' (begin) or 'E' (end)
+};
+
+// Represents the trace state of one thread.
+struct ThreadTraceState
+{
+    uint32_t                depth;      // Nesting depth of trace scopes
+    bool                    recording;  // Whether the current root is sampled
+    uint32_t                threadId;   // Sequential ID of the thread in the trace (0 if not assigned yet)
+    std::vector<TraceEvent> events;     // Events recorded in the current root
+};
+
+// Represents the trace file. The JSON array is terminated when the process exits.
+struct TraceFileStream
+{
+    ~TraceFileStream()
+    {
+        if (pStream != nullptr)
+        {
+            *pStream << "\n]\n";
+        }
+    }
+
+    std::unique_ptr<raw_fd_ostream> pStream;  // Output stream (null if not opened yet)
+    bool                            failed;   // Whether the file failed to open
+    bool                            written;  // Whether an event has been written to the file
+};
+
+static thread_local ThreadTraceState t_traceState = {};
+
+static std::atomic<uint32_t> s_rootCount(0);                    // Count of roots entered, for sampling
+static std::atomic<uint32_t> s_threadCount(0);                  // Count of threads that recorded events
+static std::mutex            s_traceFileMutex;                  // Mutex protecting the trace file
+static TraceFileStream       s_traceFile = {};                  // Trace file
+static const auto            s_traceEpoch = std::chrono::steady_clock::now(); // Time origin of the trace
+
+// =====================================================================================================================
+// Gets the current time of the trace, in nanoseconds.
+static uint64_t GetTraceTime()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                                s_traceEpoch).count();
+}
+
+// =====================================================================================================================
+// Gets the ID of the current process.
+static uint32_t GetProcessId()
+{
+#ifdef WIN_OS
+    return _getpid();
+#else
+    return getpid();
+#endif
+}
+
+// =====================================================================================================================
+// Writes the events recorded on the current thread to the trace file, and clears them.
+static void WriteEvents(
+    ThreadTraceState* pState)   // [in,out] Trace state of the current thread
+{
+    std::lock_guard<std::mutex> lock(s_traceFileMutex);
+
+    if ((s_traceFile.pStream == nullptr) && (s_traceFile.failed == false))
+    {
+        std::error_code errCode;
+        s_traceFile.pStream.reset(new raw_fd_ostream(cl::TraceFile, errCode, sys::fs::F_Text));
+        if (errCode)
+        {
+            LLPC_ERRS("Fails to open trace file: " << cl::TraceFile << "\n");
+            s_traceFile.pStream = nullptr;
+            s_traceFile.failed = true;
+        }
+        else
+        {
+            *s_traceFile.pStream << "[\n";
+        }
+    }
+
+    if (s_traceFile.pStream != nullptr)
+    {
+        auto& out = *s_traceFile.pStream;
+        const uint32_t processId = GetProcessId();
+        for (const auto& event : pState->events)
+        {
+            // NOTE: Events are separated by a comma before each event, so that the file is valid Chrome trace at any
+            // time, even before the array is terminated.
+            out << (s_traceFile.written ? ",\n" : "")
+                << "{\"name\":\"" << event.pName
+                << "\",\"cat\":\"" << event.pCategory
+                << "\",\"ph\":\"" << event.phase
+                << "\",\"ts\":" << format("%.3f", event.time / 1000.0);
+            if (event.phase == 'X')
+            {
+                out << ",\"dur\":" << format("%.3f", event.duration / 1000.0);
+            }
+            out << ",\"pid\":" << processId << ",\"tid\":" << pState->threadId;
+
+            if ((event.pDetail != nullptr) || (event.hash != 0))
+            {
+                out << ",\"args\":{";
+                if (event.pDetail != nullptr)
+                {
+                    out << "\"detail\":\"" << event.pDetail << "\"" << ((event.hash != 0) ? "," : "");
+                }
+                if (event.hash != 0)
+                {
+                    out << "\"hash\":\"" << format("0x%016" PRIX64, event.hash) << "\"";
+                }
+                out << "}";
+            }
+            out << "}";
+            s_traceFile.written = true;
+        }
+
+        // Flush so that the events of a long-running process can be inspected while it runs.
+        out.flush();
+    }
+
+    pState->events.clear();
+}
+
+// =====================================================================================================================
+// Ends the phases recorded in the current root which have begun but not ended, e.g. because a pass manager failed or
+// was cut short by the build budget, so that every 'B' event has a matching 'E' event.
+static void EndOpenPhases(
+    ThreadTraceState* pState)   // [in,out] Trace state of the current thread
+{
+    std::vector<const char*> openPhases;
+    for (const auto& event : pState->events)
+    {
+        if (event.phase == 'B')
+        {
+            openPhases.push_back(event.pName);
+        }
+        else if ((event.phase == 'E') && (openPhases.empty() == false))
+        {
+            openPhases.pop_back();
+        }
+    }
+
+    const uint64_t endTime = GetTraceTime();
+    while (openPhases.empty() == false)
+    {
+        pState->events.push_back({ openPhases.back(), TraceCategoryPhase, nullptr, 0, endTime, 0, 'E' });
+        openPhases.pop_back();
+    }
+}
+
+// =====================================================================================================================
+// Returns whether events are recorded on the current thread, i.e. whether it is inside a sampled root.
+bool EventTracer::IsRecording()
+{
+    return t_traceState.recording;
+}
+
+// =====================================================================================================================
+// Records the begin or end of a compilation phase on the current thread. It is called when a phase timer of
+// TimerProfiler is started or stopped, so the trace shows the same phases as the timer reports.
+void EventTracer::RecordPhase(
+    StringRef timerName,    // Name of the phase timer
+    bool      begin)        // Whether the phase begins or ends
+{
+    auto& state = t_traceState;
+    if (state.recording)
+    {
+        // Timer names are set by TimerProfiler.
+        const char* pName = StringSwitch<const char*>(timerName)
+                            .Case("llpc-translate", "Translate")
+                            .Case("llpc-lower", "Lower")
+                            .Case("llpc-load", "LoadBc")
+                            .Case("llpc-patch", "Patch")
+                            .Case("llpc-opt", "Optimization")
+                            .Case("llpc-codegen", "CodeGen")
+                            .Default("Phase");
+
+        state.events.push_back({ pName, TraceCategoryPhase, nullptr, 0, GetTraceTime(), 0, begin ? 'B' : 'E' });
+    }
+}
+
+// =====================================================================================================================
+TraceScope::TraceScope(
+    const char* pName,      // [in] Name of the event (static string)
+    const char* pCategory,  // [in] Category of the event (static string)
+    const char* pDetail)    // [in] Detail of the event, e.g. the shader stage (static string, could be null)
+    :
+    m_pName(pName),
+    m_pCategory(pCategory),
+    m_pDetail(pDetail),
+    m_hash(0),
+    m_beginTime(0)
+{
+    auto& state = t_traceState;
+    if (state.depth == 0)
+    {
+        // Entering a root: decide whether it is sampled.
+        state.recording = (cl::TraceFile.empty() == false) &&
+                          ((s_rootCount++ % std::max(1u, static_cast<uint32_t>(cl::TraceSampleRate))) == 0);
+        if (state.recording && (state.threadId == 0))
+        {
+            state.threadId = ++s_threadCount;
+        }
+    }
+    ++state.depth;
+
+    m_recording = state.recording;
+    if (m_recording)
+    {
+        m_beginTime = GetTraceTime();
+    }
+}
+
+// =====================================================================================================================
+TraceScope::~TraceScope()
+{
+    auto& state = t_traceState;
+    if (m_recording)
+    {
+        state.events.push_back({ m_pName,
+                                 m_pCategory,
+                                 m_pDetail,
+                                 m_hash,
+                                 m_beginTime,
+                                 GetTraceTime() - m_beginTime,
+                                 'X' });
+    }
+
+    --state.depth;
+    if ((state.depth == 0) && state.recording)
+    {
+        EndOpenPhases(&state);
+        WriteEvents(&state);
+        state.recording = false;
+    }
+}
+
+} // Llpc
@@ -0,0 +1,97 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2019 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+ /**
+  ***********************************************************************************************************************
+  * @file  llpcEventTracer.h
+  * @brief LLPC header file: contains the definition of LLPC utility classes EventTracer and TraceScope.
+  ***********************************************************************************************************************
+  */
+
+#pragma once
+
+#include "llvm/ADT/StringRef.h"
+
+#include "llpc.h"
+#include "llpcDebug.h"
+
+namespace Llpc
+{
+
+// Categories of trace events
+static const char TraceCategoryPipeline[] = "pipeline";   // Builds of pipelines and shader modules
+static const char TraceCategoryCache[]    = "cache";      // Shader cache lookups
+static const char TraceCategoryContext[]  = "context";    // Acquisition of LLPC contexts
+static const char TraceCategoryStage[]    = "stage";      // Per-stage translation and lowering
+static const char TraceCategoryPhase[]    = "phase";      // Compilation phases, driven by the phase timers
+static const char TraceCategoryElf[]      = "elf";        // ELF merging
+
+// =====================================================================================================================
+// Represents the recorder of compilation events, written to the file specified by -trace-file in Chrome trace event
+// format (viewable in chrome://tracing or Perfetto).
+//
+// Events are recorded per thread without locking. A trace scope entered on a thread outside of any other trace scope is
+// a root (e.g. a pipeline build); one in every -trace-sample-rate roots is sampled, and only the events inside sampled
+// roots are recorded. The events of a root are written to the file when the root exits.
+class EventTracer
+{
+public:
+    static bool IsRecording();
+
+    static void RecordPhase(llvm::StringRef timerName, bool begin);
+
+private:
+    LLPC_DISALLOW_DEFAULT_CTOR(EventTracer);
+    LLPC_DISALLOW_COPY_AND_ASSIGN(EventTracer);
+
+    friend class TraceScope;
+};
+
+// =====================================================================================================================
+// Represents a region of a compilation recorded as one trace event, from construction to destruction.
+class TraceScope
+{
+public:
+    TraceScope(const char* pName, const char* pCategory, const char* pDetail = nullptr);
+
+    ~TraceScope();
+
+    // Sets the hash code recorded with the event, e.g. the pipeline hash.
+    void SetHash(uint64_t hash) { m_hash = hash; }
+
+private:
+    LLPC_DISALLOW_DEFAULT_CTOR(TraceScope);
+    LLPC_DISALLOW_COPY_AND_ASSIGN(TraceScope);
+
+    // -----------------------------------------------------------------------------------------------------------------
+
+    const char* m_pName;        // Name of the event (static string)
+    const char* m_pCategory;    // Category of the event (static string)
+    const char* m_pDetail;      // Detail of the event, e.g. the shader stage (static string, could be null)
+    uint64_t    m_hash;         // Hash code recorded with the event (0 if not set)
+    uint64_t    m_beginTime;    // Time when the scope is entered, in nanoseconds
+    bool        m_recording;    // Whether the scope is recorded
+};
+
+} // Llpc
@@ -77,15 +77,14 @@ Function* GetEntryPoint(
 }
 
 // =====================================================================================================================
-// Emits a LLVM function call (inserted before the specified instruction), builds it automically based on return type
-// and its parameters.
-CallInst* EmitCall(
+// Gets the declaration of the function with the specified name in the module, creating it based on return type and
+// parameters if it does not exist yet.
+static Function* GetFunctionDecl(
     Module*                       pModule,          // [in] LLVM module
     StringRef                     funcName,         // Name string of the function
     Type*                         pRetTy,           // [in] Return type
     ArrayRef<Value *>             args,             // [in] Parameters
-    ArrayRef<Attribute::AttrKind> attribs,          // Attributes
-    Instruction*                  pInsertPos)       // [in] Where to insert this call
+    ArrayRef<Attribute::AttrKind> attribs)          // Attributes
 {
     Function* pFunc = dyn_cast_or_null<Function>(pModule->getFunction(funcName));
     if (pFunc == nullptr)
@@ -108,6 +107,65 @@ CallInst* EmitCall(
         }
     }
 
+    return pFunc;
+}
+
+// =====================================================================================================================
+// Gets the declaration of the function with the specified base name and type mangling suffix in the module. The suffix
+// is the name of the mangled type if one is specified, or the LLVM-style type mangling of the return type and the
+// parameters otherwise. The declaration is looked up in the per-module cache of the context first, so that the mangled
+// name only has to be built the first time a function is called.
+static Function* GetMangledFunctionDecl(
+    Module*                       pModule,          // [in] LLVM module
+    const char*                   pBaseName,        // [in] Base name of the function
+    Type*                         pMangledTy,       // [in] Type whose name is the mangling suffix (could be null)
+    Type*                         pRetTy,           // [in] Return type
+    ArrayRef<Value *>             args,             // [in] Parameters
+    ArrayRef<Attribute::AttrKind> attribs)          // Attributes
+{
+    SmallVector<Type*, 8> argTys;
+    for (auto pArg : args)
+    {
+        argTys.push_back(pArg->getType());
+    }
+    auto pFuncTy = FunctionType::get(pRetTy, argTys, false);
+
+    // NOTE: The mangling suffix is derived from the return type and the parameter types only, or from a type that is
+    // always the return type or the same parameter type for a given base name, so the function type identifies the
+    // mangled name together with the base name.
+    Context* pContext = static_cast<Context*>(&pModule->getContext());
+    Function* pFunc = pContext->GetCachedFunctionDecl(pModule, pBaseName, pFuncTy);
+    if (pFunc == nullptr)
+    {
+        std::string funcName = pBaseName;
+        if (pMangledTy != nullptr)
+        {
+            funcName += GetTypeName(pMangledTy);
+        }
+        else
+        {
+            AddTypeMangling(pRetTy, args, funcName);
+        }
+        pFunc = GetFunctionDecl(pModule, funcName, pRetTy, args, attribs);
+        pContext->CacheFunctionDecl(pModule, pBaseName, pFuncTy, pFunc);
+    }
+
+    return pFunc;
+}
+
+// =====================================================================================================================
+// Emits a LLVM function call (inserted before the specified instruction), builds it automically based on return type
+// and its parameters.
+CallInst* EmitCall(
+    Module*                       pModule,          // [in] LLVM module
+    StringRef                     funcName,         // Name string of the function
+    Type*                         pRetTy,           // [in] Return type
+    ArrayRef<Value *>             args,             // [in] Parameters
+    ArrayRef<Attribute::AttrKind> attribs,          // Attributes
+    Instruction*                  pInsertPos)       // [in] Where to insert this call
+{
+    Function* pFunc = GetFunctionDecl(pModule, funcName, pRetTy, args, attribs);
+
     auto pCallInst = CallInst::Create(pFunc, args, "", pInsertPos);
     pCallInst->setCallingConv(CallingConv::C);
     pCallInst->setAttributes(pFunc->getAttributes());
@@ -126,26 +184,89 @@ CallInst* EmitCall(
     ArrayRef<Attribute::AttrKind> attribs,          // Attributes
     BasicBlock*                   pInsertAtEnd)     // [in] Which block to insert this call at the end
 {
-    Function* pFunc = dyn_cast_or_null<Function>(pModule->getFunction(funcName));
-    if (pFunc == nullptr)
-    {
-        std::vector<Type*> argTys;
-        for (auto arg : args)
-        {
-            argTys.push_back(arg->getType());
-        }
+    Function* pFunc = GetFunctionDecl(pModule, funcName, pRetTy, args, attribs);
 
-        auto pFuncTy = FunctionType::get(pRetTy, argTys, false);
-        pFunc = Function::Create(pFuncTy, GlobalValue::ExternalLinkage, funcName, pModule);
+    auto pCallInst = CallInst::Create(pFunc, args, "", pInsertAtEnd);
+    pCallInst->setCallingConv(CallingConv::C);
+    pCallInst->setAttributes(pFunc->getAttributes());
 
-        pFunc->setCallingConv(CallingConv::C);
-        pFunc->addFnAttr(Attribute::NoUnwind);
+    return pCallInst;
+}
 
-        for (auto attrib : attribs)
-        {
-            pFunc->addFnAttr(attrib);
-        }
-    }
+// =====================================================================================================================
+// Emits a LLVM function call (inserted before the specified instruction) to the function with the specified base name
+// and LLVM-style type mangling suffix for return type and parameters (see AddTypeMangling).
+CallInst* EmitMangledCall(
+    Module*                       pModule,          // [in] LLVM module
+    const char*                   pBaseName,        // [in] Base name of the function, must have static storage
+    Type*                         pRetTy,           // [in] Return type
+    ArrayRef<Value *>             args,             // [in] Parameters
+    ArrayRef<Attribute::AttrKind> attribs,          // Attributes
+    Instruction*                  pInsertPos)       // [in] Where to insert this call
+{
+    Function* pFunc = GetMangledFunctionDecl(pModule, pBaseName, nullptr, pRetTy, args, attribs);
+
+    auto pCallInst = CallInst::Create(pFunc, args, "", pInsertPos);
+    pCallInst->setCallingConv(CallingConv::C);
+    pCallInst->setAttributes(pFunc->getAttributes());
+
+    return pCallInst;
+}
+
+// =====================================================================================================================
+// Emits a LLVM function call (inserted at the end of the specified basic block) to the function with the specified
+// base name and LLVM-style type mangling suffix for return type and parameters (see AddTypeMangling).
+CallInst* EmitMangledCall(
+    Module*                       pModule,          // [in] LLVM module
+    const char*                   pBaseName,        // [in] Base name of the function, must have static storage
+    Type*                         pRetTy,           // [in] Return type
+    ArrayRef<Value *>             args,             // [in] Parameters
+    ArrayRef<Attribute::AttrKind> attribs,          // Attributes
+    BasicBlock*                   pInsertAtEnd)     // [in] Which block to insert this call at the end
+{
+    Function* pFunc = GetMangledFunctionDecl(pModule, pBaseName, nullptr, pRetTy, args, attribs);
+
+    auto pCallInst = CallInst::Create(pFunc, args, "", pInsertAtEnd);
+    pCallInst->setCallingConv(CallingConv::C);
+    pCallInst->setAttributes(pFunc->getAttributes());
+
+    return pCallInst;
+}
+
+// =====================================================================================================================
+// Emits a LLVM function call (inserted before the specified instruction) to the function whose name is the specified
+// base name followed by the name of the mangled type (see GetTypeName), as used by overloaded intrinsics.
+CallInst* EmitMangledCall(
+    Module*                       pModule,          // [in] LLVM module
+    const char*                   pBaseName,        // [in] Base name of the function, must have static storage
+    Type*                         pMangledTy,       // [in] Type whose name is appended to the base name
+    Type*                         pRetTy,           // [in] Return type
+    ArrayRef<Value *>             args,             // [in] Parameters
+    ArrayRef<Attribute::AttrKind> attribs,          // Attributes
+    Instruction*                  pInsertPos)       // [in] Where to insert this call
+{
+    Function* pFunc = GetMangledFunctionDecl(pModule, pBaseName, pMangledTy, pRetTy, args, attribs);
+
+    auto pCallInst = CallInst::Create(pFunc, args, "", pInsertPos);
+    pCallInst->setCallingConv(CallingConv::C);
+    pCallInst->setAttributes(pFunc->getAttributes());
+
+    return pCallInst;
+}
+
+// =====================================================================================================================
+// Emits a LLVM function call (inserted at the end of the specified basic block) to the function whose name is the
+// specified base name followed by the name of the mangled type (see GetTypeName), as used by overloaded intrinsics.
+CallInst* EmitMangledCall(
+    Module*                       pModule,          // [in] LLVM module
+    const char*                   pBaseName,        // [in] Base name of the function, must have static storage
+    Type*                         pMangledTy,       // [in] Type whose name is appended to the base name
+    Type*                         pRetTy,           // [in] Return type
+    ArrayRef<Value *>             args,             // [in] Parameters
+    ArrayRef<Attribute::AttrKind> attribs,          // Attributes
+    BasicBlock*                   pInsertAtEnd)     // [in] Which block to insert this call at the end
+{
+    Function* pFunc = GetMangledFunctionDecl(pModule, pBaseName, pMangledTy, pRetTy, args, attribs);
 
     auto pCallInst = CallInst::Create(pFunc, args, "", pInsertAtEnd);
     pCallInst->setCallingConv(CallingConv::C);
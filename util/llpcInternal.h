@@ -108,12 +108,14 @@ namespace LlpcName
     const static char InputImportGeneric[]            = "llpc.input.import.generic.";
     const static char InputImportBuiltIn[]            = "llpc.input.import.builtin.";
     const static char InputImportInterpolant[]        = "llpc.input.import.interpolant.";
+    const static char VertexFetchProlog[]             = "llpc.vertex.fetch.prolog.";
     const static char OutputCallPrefix[]              = "llpc.output.";
     const static char OutputImportGeneric[]           = "llpc.output.import.generic.";
     const static char OutputImportBuiltIn[]           = "llpc.output.import.builtin.";
     const static char OutputExportGeneric[]           = "llpc.output.export.generic.";
     const static char OutputExportBuiltIn[]           = "llpc.output.export.builtin.";
     const static char OutputExportXfb[]               = "llpc.output.export.xfb.";
+    const static char ColorExportEpilog[]             = "llpc.color.export.epilog.";
     const static char BufferCallPrefix[]              = "llpc.buffer.";
     const static char BufferAtomic[]                  = "llpc.buffer.atomic.";
     const static char BufferLoad[]                    = "llpc.buffer.load.";
@@ -247,6 +249,48 @@ llvm::CallInst* EmitCall(llvm::Module*                             pModule,
                          llvm::ArrayRef<llvm::Attribute::AttrKind> attribs,
                          llvm::BasicBlock*                         pInsertAtEnd);
 
+// Emits a LLVM function call (inserted before the specified instruction) to the function with the specified base name
+// and type mangling suffix. The declaration is cached per module, so the base name must have static storage duration
+// (a string literal or an LlpcName constant).
+llvm::CallInst* EmitMangledCall(llvm::Module*                             pModule,
+                                const char*                               pBaseName,
+                                llvm::Type*                               pRetTy,
+                                llvm::ArrayRef<llvm::Value *>             args,
+                                llvm::ArrayRef<llvm::Attribute::AttrKind> attribs,
+                                llvm::Instruction*                        pInsertPos);
+
+// Emits a LLVM function call (inserted at the end of the specified basic block) to the function with the specified
+// base name and type mangling suffix. The declaration is cached per module, so the base name must have static storage
+// duration (a string literal or an LlpcName constant).
+llvm::CallInst* EmitMangledCall(llvm::Module*                             pModule,
+                                const char*                               pBaseName,
+                                llvm::Type*                               pRetTy,
+                                llvm::ArrayRef<llvm::Value *>             args,
+                                llvm::ArrayRef<llvm::Attribute::AttrKind> attribs,
+                                llvm::BasicBlock*                         pInsertAtEnd);
+
+// Emits a LLVM function call (inserted before the specified instruction) to the function with the specified base name
+// followed by the name of the mangled type. The declaration is cached per module, so the base name must have static
+// storage duration, and must always be mangled with the return type or the same parameter type.
+llvm::CallInst* EmitMangledCall(llvm::Module*                             pModule,
+                                const char*                               pBaseName,
+                                llvm::Type*                               pMangledTy,
+                                llvm::Type*                               pRetTy,
+                                llvm::ArrayRef<llvm::Value *>             args,
+                                llvm::ArrayRef<llvm::Attribute::AttrKind> attribs,
+                                llvm::Instruction*                        pInsertPos);
+
+// Emits a LLVM function call (inserted at the end of the specified basic block) to the function with the specified
+// base name followed by the name of the mangled type. The declaration is cached per module, so the base name must have
+// static storage duration, and must always be mangled with the return type or the same parameter type.
+llvm::CallInst* EmitMangledCall(llvm::Module*                             pModule,
+                                const char*                               pBaseName,
+                                llvm::Type*                               pMangledTy,
+                                llvm::Type*                               pRetTy,
+                                llvm::ArrayRef<llvm::Value *>             args,
+                                llvm::ArrayRef<llvm::Attribute::AttrKind> attribs,
+                                llvm::BasicBlock*                         pInsertAtEnd);
+
 // Adds LLVM-style type mangling suffix for the specified return type and args to the name.
 void AddTypeMangling(llvm::Type* pReturnTy, llvm::ArrayRef<llvm::Value*> args, std::string& name);
 
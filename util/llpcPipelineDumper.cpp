@@ -920,7 +920,7 @@ MetroHash::Hash PipelineDumper::GenerateHashForGraphicsPipeline(
     hasher.Update(pPipeline->iaState.deviceIndex);
     UpdateHashForVertexInputState(pPipeline->pVertexInput, &hasher);
     UpdateHashForNonFragmentState(pPipeline, isCacheHash, &hasher);
-    UpdateHashForFragmentState(pPipeline, &hasher);
+    UpdateHashForFragmentState(pPipeline, true, &hasher);
 
     MetroHash::Hash hash = {};
     hasher.Finalize(hash.bytes);
@@ -1079,8 +1079,10 @@ void PipelineDumper::UpdateHashForNonFragmentState(
 // =====================================================================================================================
 // Update hash code from fragment pipeline state
 void PipelineDumper::UpdateHashForFragmentState(
-    const GraphicsPipelineBuildInfo* pPipeline,     // [in] Info to build a graphics pipeline
-    MetroHash64*                     pHasher)       // [in,out] Hasher to generate hash code
+    const GraphicsPipelineBuildInfo* pPipeline,             // [in] Info to build a graphics pipeline
+    bool                             includeExportState,    // TRUE to include the color target state that only
+                                                            // affects fragment color export
+    MetroHash64*                     pHasher)               // [in,out] Hasher to generate hash code
 {
     auto pRsState = &pPipeline->rsState;
     pHasher->Update(pRsState->innerCoverage);
@@ -1093,7 +1095,12 @@ void PipelineDumper::UpdateHashForFragmentState(
     pHasher->Update(pCbState->dualSourceBlendEnable);
     for (uint32_t i = 0; i < MaxColorTargets; ++i)
     {
-        if (pCbState->target[i].format != VK_FORMAT_UNDEFINED)
+        if (includeExportState == false)
+        {
+            // NOTE: Only whether the color target is present affects fragment shader compilation before color export.
+            pHasher->Update(pCbState->target[i].format != VK_FORMAT_UNDEFINED);
+        }
+        else if (pCbState->target[i].format != VK_FORMAT_UNDEFINED)
         {
             pHasher->Update(pCbState->target[i].channelWriteMask);
             pHasher->Update(pCbState->target[i].blendEnable);
@@ -1703,6 +1710,26 @@ OStream& operator<<(
                 OutputText(pSection->pData, 0, static_cast<uint32_t>(pSection->secHead.sh_size), out);
             }
         }
+        else if (strcmp(pSection->pName, LlvmIrBitcodeName) == 0)
+        {
+            // Output LLVM IR bitcode records, without the bitcode itself
+            out << pSection->pName << " (size = " << pSection->secHead.sh_size << " bytes)\n";
+
+            size_t offset = 0;
+            while (offset + sizeof(LlvmIrBitcodeHeader) <= pSection->secHead.sh_size)
+            {
+                LlvmIrBitcodeHeader header = {};
+                memcpy(&header, pSection->pData + offset, sizeof(header));
+                if (header.magic != LlvmIrBitcodeMagic)
+                {
+                    break;
+                }
+
+                out << "    bitcode (offset = " << offset << "  size = " << header.dataSize
+                    << "  uncompressed size = " << header.bitcodeSize << ")\n";
+                offset += sizeof(header) + header.dataSize;
+            }
+        }
         else
         {
             // Output binary based sections
@@ -131,6 +131,7 @@ public:
 
     static void UpdateHashForFragmentState(
         const GraphicsPipelineBuildInfo* pPipeline,
+        bool                             includeExportState,
 #if defined(SINGLE_EXTERNAL_METROHASH)
         Util::MetroHash64*               pHasher);
 #else
@@ -28,6 +28,7 @@
 * @brief LLPC source file: pass to start or stop a timer
 ***********************************************************************************************************************
 */
+#include "llpcEventTracer.h"
 #include "llpcInternal.h"
 
 #include "llvm/Support/Timer.h"
@@ -82,6 +83,7 @@ ModulePass* Llpc::CreateStartStopTimer(
 bool StartStopTimer::runOnModule(
     Module& module)  // [in,out] LLVM module to be run on
 {
+    EventTracer::RecordPhase(m_pTimer->getName(), m_starting);
     if (m_starting)
     {
         m_pTimer->startTimer();
@@ -35,15 +35,22 @@
 #include "llvm/Support/raw_ostream.h"
 
 #include "llpc.h"
+#include "llpcEventTracer.h"
 #include "llpcInternal.h"
 #include "llpcPassManager.h"
 #include "llpcTimerProfiler.h"
 
+#include <mutex>
+
 using namespace llvm;
 
 namespace Llpc
 {
 
+static std::mutex s_phaseTimesMutex;            // Mutex protecting the collected phase times
+static bool       s_collectPhaseTimes = false;  // Whether phase times are collected instead of reported
+static PhaseTimes s_collectedPhaseTimes = {};   // Phase times collected from destroyed profilers
+
 // =====================================================================================================================
 TimerProfiler::TimerProfiler(
     uint64_t      hash64,              // Hash code
@@ -51,9 +58,10 @@ TimerProfiler::TimerProfiler(
     uint32_t      enableMask)           // Mask of enabled phase timers
     :
     m_total("", "", GetDummyTimeRecords()),
-    m_phases("", "", GetDummyTimeRecords())
+    m_phases("", "", GetDummyTimeRecords()),
+    m_enabled(TimePassesIsEnabled || EventTracer::IsRecording())
 {
-    if (TimePassesIsEnabled)
+    if (m_enabled)
     {
         std::string hashString;
         raw_string_ostream ostream(hashString);
@@ -113,10 +121,31 @@ TimerProfiler::TimerProfiler(
 // =====================================================================================================================
 TimerProfiler::~TimerProfiler()
 {
-    if (TimePassesIsEnabled)
+    if (m_enabled)
     {
         // Stop whole timer
         m_wholeTimer.stopTimer();
+
+        std::lock_guard<std::mutex> lock(s_phaseTimesMutex);
+        if (TimePassesIsEnabled == false)
+        {
+            // The timers only drive the trace events of this compilation, so no report is printed.
+            m_total.clear();
+            m_phases.clear();
+        }
+        else if (s_collectPhaseTimes)
+        {
+            for (uint32_t i = 0; i < TimerCount; ++i)
+            {
+                s_collectedPhaseTimes.phases[i] += m_phaseTimers[i].getTotalTime().getWallTime();
+            }
+            s_collectedPhaseTimes.total += m_wholeTimer.getTotalTime().getWallTime();
+            ++s_collectedPhaseTimes.count;
+
+            // Clear the timers so that the timer groups do not print their reports
+            m_total.clear();
+            m_phases.clear();
+        }
     }
 }
 
@@ -127,7 +156,7 @@ void TimerProfiler::AddTimerStartStopPass(
     TimerKind    timerKind,      // Kind of phase timer
     bool         start)          // Start or  stop timer
 {
-    if (TimePassesIsEnabled)
+    if (m_enabled)
     {
         pPassMgr->add(CreateStartStopTimer(&m_phaseTimers[timerKind], start));
     }
@@ -139,8 +168,9 @@ void TimerProfiler::StartStopTimer(
     TimerKind timerKind,         // Kind of phase timer
     bool      start)             // Start or  stop timer
 {
-    if (TimePassesIsEnabled)
+    if (m_enabled)
     {
+        EventTracer::RecordPhase(m_phaseTimers[timerKind].getName(), start);
         if (start)
         {
             m_phaseTimers[timerKind].startTimer();
@@ -153,11 +183,11 @@ void TimerProfiler::StartStopTimer(
 }
 
 // =====================================================================================================================
-// Gets a specific timer. Returns nullptr if TimePassesIsEnabled isn't enabled.
+// Gets a specific timer. Returns nullptr if neither TimePassesIsEnabled is enabled nor the compilation is traced.
 llvm::Timer* TimerProfiler::GetTimer(
     TimerKind    timerKind)           // Kind of phase timer
 {
-    return TimePassesIsEnabled ? &m_phaseTimers[timerKind] : nullptr;
+    return m_enabled ? &m_phaseTimers[timerKind] : nullptr;
 }
 
 // =====================================================================================================================
@@ -188,5 +218,24 @@ const StringMap<TimeRecord>& TimerProfiler::GetDummyTimeRecords()
     return dummyTimeRecords;
 }
 
-} // Llpc
+// =====================================================================================================================
+// Enables or disables collection of phase times. While it is enabled, the times of each profiler are added to the
+// collected times at destruction, instead of being reported to the log. Timers are only active if -time-passes is set.
+void TimerProfiler::EnablePhaseTimeCollection(
+    bool enable)    // Whether to collect phase times
+{
+    std::lock_guard<std::mutex> lock(s_phaseTimesMutex);
+    s_collectPhaseTimes = enable;
+}
+
+// =====================================================================================================================
+// Returns the phase times collected so far, and resets them.
+PhaseTimes TimerProfiler::TakeCollectedPhaseTimes()
+{
+    std::lock_guard<std::mutex> lock(s_phaseTimesMutex);
+    PhaseTimes phaseTimes = s_collectedPhaseTimes;
+    s_collectedPhaseTimes = {};
+    return phaseTimes;
+}
 
+} // Llpc
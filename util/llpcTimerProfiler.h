@@ -56,6 +56,15 @@ enum TimerKind : uint32_t
     TimerCount
 };
 
+// =====================================================================================================================
+// Represents wall times collected from the profilers of pipeline compilations.
+struct PhaseTimes
+{
+    double   phases[TimerCount];    // Seconds spent in each phase
+    double   total;                 // Seconds spent in whole compilations
+    uint32_t count;                 // Count of profilers the times are collected from
+};
+
 // =====================================================================================================================
 // Represents a utility class for time profile, it wraps LLVM Timer and TimerGroup in internal.
 class TimerProfiler
@@ -73,6 +82,9 @@ public:
 
     static const llvm::StringMap<llvm::TimeRecord>& GetDummyTimeRecords();
 
+    static void EnablePhaseTimeCollection(bool enable);
+    static PhaseTimes TakeCollectedPhaseTimes();
+
     // -----------------------------------------------------------------------------------------------------------------
 
     static const uint32_t PipelineTimerEnableMask = ((1 << TimerCount) - 1);
@@ -87,6 +99,7 @@ private:
     llvm::TimerGroup m_phases;               // TimeGroup for each phase
     llvm::Timer m_wholeTimer;                // Whole timer
     llvm::Timer m_phaseTimers[TimerCount];   // Phase timer
+    bool m_enabled;                          // Whether timers are enabled, for -time-passes or the event trace
 };
 
 } // Llpc